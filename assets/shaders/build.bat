@@ -7,6 +7,7 @@ glslangValidator -V outline.vert -o outline.vert.spv
 glslangValidator -V outline.frag -o outline.frag.spv
 glslangValidator -V fullscreen.vert -o fullscreen.vert.spv
 glslangValidator -V finalize.frag -o finalize.frag.spv
+glslangValidator -V sprite.frag -o sprite.frag.spv
 glslangValidator -V object_pass_through.vert -o object_pass_through.vert.spv
 glslangValidator -V explode.geom -o explode.geom.spv
 glslangValidator -V view_normal.geom -o view_normal.geom.spv
@@ -24,4 +25,10 @@ glslangValidator -V lighting_point.vert -o lighting_point.vert.spv
 glslangValidator -V lighting_point.frag -o lighting_point.frag.spv
 glslangValidator -V ssao.frag -o ssao.frag.spv
 glslangValidator -V ssao_blur.frag -o ssao_blur.frag.spv
+glslangValidator -V -DPACKED_VERTEX shader.vert -o shader_packed.vert.spv
+glslangValidator -V -DPACKED_VERTEX -DVERTEX_COLOR shader.vert -o shader_color_packed.vert.spv
+glslangValidator -V -DPACKED_VERTEX shadow.vert -o shadow_packed.vert.spv
+glslangValidator -V -DPACKED_VERTEX shadow_point.vert -o shadow_point_packed.vert.spv
+glslangValidator -V -DPACKED_VERTEX object.vert -o object_packed.vert.spv
+glslangValidator -V -DPACKED_VERTEX outline.vert -o outline_packed.vert.spv
 PAUSE
\ No newline at end of file
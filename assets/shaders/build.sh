@@ -1,10 +1,35 @@
 #!/bin/bash
 
+glslangValidator -V object.vert -o object.vert.spv
 glslangValidator -V shader.vert -o shader.vert.spv
 glslangValidator -V shader.frag -o shader.frag.spv
 glslangValidator -V sky.vert -o sky.vert.spv
 glslangValidator -V sky.frag -o sky.frag.spv
-glslangValidator -V object.vert -o object.vert.spv
-glslangValidator -V sprite.frag -o sprite.frag.spv
-glslangValidator -V finalize.frag -o finalize.frag.spv
+glslangValidator -V outline.vert -o outline.vert.spv
+glslangValidator -V outline.frag -o outline.frag.spv
 glslangValidator -V fullscreen.vert -o fullscreen.vert.spv
+glslangValidator -V finalize.frag -o finalize.frag.spv
+glslangValidator -V sprite.frag -o sprite.frag.spv
+glslangValidator -V object_pass_through.vert -o object_pass_through.vert.spv
+glslangValidator -V explode.geom -o explode.geom.spv
+glslangValidator -V view_normal.geom -o view_normal.geom.spv
+glslangValidator -V view_normal.frag -o view_normal.frag.spv
+glslangValidator -V shadow.vert -o shadow.vert.spv
+glslangValidator -V shadow.frag -o shadow.frag.spv
+glslangValidator -V shadow_point.vert -o shadow_point.vert.spv
+glslangValidator -V shadow_point.geom -o shadow_point.geom.spv
+glslangValidator -V shadow_point.frag -o shadow_point.frag.spv
+glslangValidator -V bloom.frag -o bloom.frag.spv
+glslangValidator -V object_deffered.frag -o object_deffered.frag.spv
+glslangValidator -V lighting_directional.vert -o lighting_directional.vert.spv
+glslangValidator -V lighting_directional.frag -o lighting_directional.frag.spv
+glslangValidator -V lighting_point.vert -o lighting_point.vert.spv
+glslangValidator -V lighting_point.frag -o lighting_point.frag.spv
+glslangValidator -V ssao.frag -o ssao.frag.spv
+glslangValidator -V ssao_blur.frag -o ssao_blur.frag.spv
+glslangValidator -V -DPACKED_VERTEX shader.vert -o shader_packed.vert.spv
+glslangValidator -V -DPACKED_VERTEX -DVERTEX_COLOR shader.vert -o shader_color_packed.vert.spv
+glslangValidator -V -DPACKED_VERTEX shadow.vert -o shadow_packed.vert.spv
+glslangValidator -V -DPACKED_VERTEX shadow_point.vert -o shadow_point_packed.vert.spv
+glslangValidator -V -DPACKED_VERTEX object.vert -o object_packed.vert.spv
+glslangValidator -V -DPACKED_VERTEX outline.vert -o outline_packed.vert.spv
@@ -7,6 +7,15 @@
 #define DISPLACEMENT_TEX_BINDING_FLAG (1 << 3)
 #define AO_TEX_BINDING_FLAG (1 << 4)
 
+// NOTE: Inverse of EncodeOctahedral in VertexPacking.h, the input comes from snorm16x2 vertex attributes
+vec3 decode_octahedral(vec2 encoded) {
+    vec3 direction = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    float t = max(-direction.z, 0.0);
+    direction.x += direction.x >= 0.0 ? -t : t;
+    direction.y += direction.y >= 0.0 ? -t : t;
+    return normalize(direction);
+}
+
 bool has_texture(uint bindingFlags, uint textureFlags) {
     return (bindingFlags & textureFlags) == textureFlags;
 }
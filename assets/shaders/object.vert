@@ -1,5 +1,8 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_include : enable
+
+#include "common.glsl"
 
 layout(set = 0, binding = 0) uniform CameraConstants {
     mat4 view_matrix;
@@ -18,11 +21,18 @@ layout(set = 1, binding = 0) uniform ObjectConstants {
     mat4 inv_model_matrix;
 } object_constants;
 
+#ifdef PACKED_VERTEX
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec2 in_tex_coord;
+layout(location = 2) in vec2 in_normal;
+layout(location = 3) in vec2 in_tangent;
+#else
 layout(location = 0) in vec3 in_position;
 layout(location = 1) in vec4 in_color;
 layout(location = 2) in vec2 in_tex_coord;
 layout(location = 3) in vec3 in_normal;
 layout(location = 4) in vec3 in_tangent;
+#endif
 
 layout(location = 0) out vec3 out_position;
 layout(location = 1) out vec4 out_color;
@@ -30,13 +40,21 @@ layout(location = 2) out vec2 out_tex_coord;
 layout(location = 3) out vec3 out_normal;
 
 void main() {
+#ifdef PACKED_VERTEX
+    vec4 color = vec4(1.0);
+    vec3 normal = decode_octahedral(in_normal);
+#else
+    vec4 color = in_color;
+    vec3 normal = in_normal;
+#endif
+
     mat4 model_matrix = object_constants.model_matrix;
     mat4 inv_model_matrix = object_constants.inv_model_matrix;
     vec4 world_position = model_matrix * vec4(in_position, 1.0);
 
     gl_Position = camera_constants.projection_matrix * camera_constants.view_matrix * world_position;
     out_position = world_position.xyz;
-    out_color = in_color;
+    out_color = color;
     out_tex_coord = in_tex_coord;
-    out_normal = normalize(mat3(transpose(inv_model_matrix)) * in_normal);
+    out_normal = normalize(mat3(transpose(inv_model_matrix)) * normal);
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_include : enable
+
+#include "common.glsl"
 
 layout(set = 0, binding = 0) uniform CameraConstants {
     mat4 view_matrix;
@@ -18,18 +21,31 @@ layout(set = 1, binding = 0) uniform ObjectConstants {
     mat4 inv_model_matrix;
 } object_constants;
 
+#ifdef PACKED_VERTEX
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec2 in_tex_coord;
+layout(location = 2) in vec2 in_normal;
+layout(location = 3) in vec2 in_tangent;
+#else
 layout(location = 0) in vec3 in_position;
 layout(location = 1) in vec4 in_color;
 layout(location = 2) in vec2 in_tex_coord;
 layout(location = 3) in vec3 in_normal;
 layout(location = 4) in vec3 in_tangent;
+#endif
 
 void main() {
     mat4 model_matrix = object_constants.model_matrix;
     mat4 inv_model_matrix = object_constants.inv_model_matrix;
     
+#ifdef PACKED_VERTEX
+    // NOTE: Quantized positions are not in object space, push the outline out along the world space normal instead
+    vec3 normal = normalize(mat3(transpose(inv_model_matrix)) * decode_octahedral(in_normal));
+    vec4 world_position = model_matrix * vec4(in_position, 1.0) + vec4(0.02 * normal, 0.0);
+#else
     vec3 normal = normalize(mat3(transpose(inv_model_matrix)) * in_normal);
     vec4 world_position = model_matrix * vec4(in_position + 0.02 * normal, 1.0);
+#endif
 
     gl_Position = camera_constants.projection_matrix * camera_constants.view_matrix * world_position;
 }
\ No newline at end of file
@@ -109,8 +109,9 @@ void main() {
 
     vec3 normal = fs_in.normal;
     if (has_texture(materialConstants.texture_binding_flags, NORMAL_TEX_BINDING_FLAG)) {
-        normal = texture(normal_texture, texcoord).rgb;
-        normal = normal * 2.0 - 1.0;
+        // NOTE: z is rebuilt from xy so two channel (BC5) normal maps work as well
+        vec2 normal_xy = texture(normal_texture, texcoord).rg * 2.0 - 1.0;
+        normal = vec3(normal_xy, sqrt(max(1.0 - dot(normal_xy, normal_xy), 0.0)));
         normal = normalize(fs_in.TBN_matrix * normal);
     }
 
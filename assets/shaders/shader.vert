@@ -1,5 +1,8 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
+#extension GL_ARB_shading_language_include : enable
+
+#include "common.glsl"
 
 layout(set = 0, binding = 0) uniform CameraConstants {
     mat4 view_matrix;
@@ -13,6 +16,17 @@ layout(set = 0, binding = 0) uniform CameraConstants {
     float padding2;
 } camera_constants;
 
+#ifdef PACKED_VERTEX
+layout(location = 0) in vec3 in_position;
+layout(location = 1) in vec2 in_tex_coord;
+layout(location = 2) in vec2 in_normal;
+layout(location = 3) in vec2 in_tangent;
+layout(location = 4) in mat4 in_instance_model_matrix;
+layout(location = 8) in mat4 in_instance_inv_model_matrix;
+#ifdef VERTEX_COLOR
+layout(location = 12) in vec4 in_color;
+#endif
+#else
 layout(location = 0) in vec3 in_position;
 layout(location = 1) in vec4 in_color;
 layout(location = 2) in vec2 in_tex_coord;
@@ -20,6 +34,7 @@ layout(location = 3) in vec3 in_normal;
 layout(location = 4) in vec3 in_tangent;
 layout(location = 5) in mat4 in_instance_model_matrix;
 layout(location = 9) in mat4 in_instance_inv_model_matrix;
+#endif
 
 out VS_OUT {
     layout(location = 0) vec3 position;
@@ -30,10 +45,24 @@ out VS_OUT {
 } vs_out;
 
 void main() {
+#ifdef PACKED_VERTEX
+#ifdef VERTEX_COLOR
+    vec4 color = in_color;
+#else
+    vec4 color = vec4(1.0);
+#endif
+    vec3 normal = decode_octahedral(in_normal);
+    vec3 tangent = decode_octahedral(in_tangent);
+#else
+    vec4 color = in_color;
+    vec3 normal = in_normal;
+    vec3 tangent = in_tangent;
+#endif
+
     mat3 normal_matrix = mat3(transpose(in_instance_inv_model_matrix));
     
-    vec3 N = normalize(normal_matrix * in_normal);
-    vec3 T = normalize(normal_matrix * in_tangent);
+    vec3 N = normalize(normal_matrix * normal);
+    vec3 T = normalize(normal_matrix * tangent);
     T = T - dot(T, N) * N;
     vec3 B = cross(N, T);
 
@@ -41,7 +70,7 @@ void main() {
 
     gl_Position = camera_constants.projection_matrix * camera_constants.view_matrix * world_position;
     vs_out.position = world_position.xyz;
-    vs_out.color = in_color;
+    vs_out.color = color;
     vs_out.tex_coord = in_tex_coord;
     vs_out.normal = N;
     vs_out.TBN_matrix = mat3(T, B, N);
@@ -73,4 +73,124 @@ project "graphics"
         }
 
     filter "action:vs*"
-        buildoptions { "/utf-8" }
\ No newline at end of file
+        buildoptions { "/utf-8" }
+
+project "assetpack"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+
+    targetdir "%{wks.location}/bin/%{cfg.buildcfg}"
+    objdir "%{wks.location}/bin-int/%{cfg.buildcfg}/%{prj.name}"
+
+    pchheader "pch.h"
+    pchsource "src/pch.cpp"
+
+    files {
+        "tools/assetpack/**.cpp",
+        "src/pch.cpp",
+        "src/Utils/AssetPack.h",
+        "src/Utils/AssetPack.cpp",
+        "src/Log/**.h",
+        "src/Log/**.cpp",
+        "src/Platform/FileSystem.h",
+        "src/Platform/MappedFile.h",
+        "src/Platform/AsyncFileReader.h",
+        "src/Platform/Windows/FileSystem.cpp",
+        "src/Platform/Windows/MappedFile.cpp",
+        "src/Platform/Windows/AsyncFileReader.cpp",
+    }
+
+    includedirs {
+        "./src",
+        vcpkg_root .. "/installed/%{cfg.architecture:gsub('x86_64','x64')}-%{cfg.system}/include",
+    }
+
+    filter "configurations:Debug"
+        runtime "Debug"
+        symbols "on"
+
+        libdirs {
+            vcpkg_root .. "/installed/%{cfg.architecture:gsub('x86_64','x64')}-%{cfg.system}/debug/lib",
+        }
+
+        links {
+            "spdlogd.lib",
+            "fmtd.lib"
+        }
+
+    filter "configurations:Release"
+        runtime "Release"
+        optimize "on"
+
+        libdirs {
+            vcpkg_root .. "/installed/%{cfg.architecture:gsub('x86_64','x64')}-%{cfg.system}/lib",
+        }
+
+        links {
+            "spdlog.lib",
+            "fmt.lib"
+        }
+
+    filter "action:vs*"
+        buildoptions { "/utf-8" }
+
+project "meshcodec"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++17"
+
+    targetdir "%{wks.location}/bin/%{cfg.buildcfg}"
+    objdir "%{wks.location}/bin-int/%{cfg.buildcfg}/%{prj.name}"
+
+    pchheader "pch.h"
+    pchsource "src/pch.cpp"
+
+    files {
+        "tools/meshcodec/**.cpp",
+        "src/pch.cpp",
+        "src/Model/MeshCodec.h",
+        "src/Model/MeshCodec.cpp",
+        "src/Model/CookedMesh.h",
+        "src/Model/CookedMesh.cpp",
+        "src/Utils/Hash.h",
+        "src/Utils/Hash.cpp",
+        "src/Log/**.h",
+        "src/Log/**.cpp",
+        "src/Platform/MappedFile.h",
+        "src/Platform/Windows/MappedFile.cpp",
+    }
+
+    includedirs {
+        "./src",
+        vcpkg_root .. "/installed/%{cfg.architecture:gsub('x86_64','x64')}-%{cfg.system}/include",
+    }
+
+    filter "configurations:Debug"
+        runtime "Debug"
+        symbols "on"
+
+        libdirs {
+            vcpkg_root .. "/installed/%{cfg.architecture:gsub('x86_64','x64')}-%{cfg.system}/debug/lib",
+        }
+
+        links {
+            "spdlogd.lib",
+            "fmtd.lib"
+        }
+
+    filter "configurations:Release"
+        runtime "Release"
+        optimize "on"
+
+        libdirs {
+            vcpkg_root .. "/installed/%{cfg.architecture:gsub('x86_64','x64')}-%{cfg.system}/lib",
+        }
+
+        links {
+            "spdlog.lib",
+            "fmt.lib"
+        }
+
+    filter "action:vs*"
+        buildoptions { "/utf-8" }
@@ -5,6 +5,11 @@
 #include "Graphics/GraphicsBuffers.h"
 #include "Graphics/GraphicsTextures.h"
 #include "Graphics/GraphicsHelper.h"
+#include "Model/Meshlet.h"
+
+namespace flaw {
+    class BVHCache;
+}
 
 using namespace flaw;
 
@@ -96,6 +101,29 @@ struct TexturedVertex {
 	vec3 tangent;
 };
 
+enum class VertexFormat {
+    Textured,        // TexturedVertex
+    Packed,          // PackedVertex
+    PackedQuantized, // QuantizedPackedVertex
+    Count
+};
+
+// NOTE: Static mesh vertex without the color, half UVs and octahedral snorm16 normal and tangent. 24 bytes against 60.
+struct PackedVertex {
+    vec3 position;
+    uint16_t texCoord[2];
+    int16_t normal[2];
+    int16_t tangent[2];
+};
+
+// NOTE: PackedVertex with unorm16 positions over the mesh bounds, decoded through Mesh::positionDecode. 20 bytes.
+struct QuantizedPackedVertex {
+    uint16_t position[4];
+    uint16_t texCoord[2];
+    int16_t normal[2];
+    int16_t tangent[2];
+};
+
 struct Material {
     vec3 diffuseColor;
     float specular;
@@ -112,14 +140,46 @@ struct MeshSegment {
     uint32_t vertexOffset;
     uint32_t indexOffset;
     uint32_t indexCount;
+
+    // NOTE: Object space bounding sphere and UV units per object space unit, used to pick texture mips to stream
+    vec3 boundsCenter = vec3(0.0f);
+    float boundsRadius = 0.0f;
+    float uvDensity = 0.0f;
+
+    // NOTE: Range in Mesh::meshlets, empty for meshes that were not cooked, which are drawn whole
+    uint32_t meshletOffset = 0;
+    uint32_t meshletCount = 0;
 };
 
+struct MeshPoolAllocation;
+
 struct Mesh {
+    // NOTE: Pool pages shared with other meshes for pooled meshes, segment offsets already point at the mesh's ranges in them
     Ref<VertexBuffer> vertexBuffer;
     Ref<IndexBuffer> indexBuffer;
+    Ref<MeshPoolAllocation> poolAllocation;
+
+    VertexFormat vertexFormat = VertexFormat::Textured;
+
+    // NOTE: Maps stored positions to object space. Folded into the model matrix of every draw, the inverse model matrix stays the object's own.
+    mat4 positionDecode = mat4(1.0f);
+
+    // NOTE: RGBA8 vertex colors of packed meshes, only set when they are not all white. Indexed like vertexBuffer, for pooled
+    // meshes it is the color stream of their page.
+    Ref<VertexBuffer> colorBuffer;
 
     std::vector<MeshSegment> segments;
     std::vector<Ref<Material>> materials;
+
+    // NOTE: Meshlet index offsets are relative to their segment's indexOffset
+    std::vector<Meshlet> meshlets;
+
+    // NOTE: Object space triangles of model meshes for raycasts, mapped from the cache next to the cooked mesh or built from the
+    // cooked mesh on the first Asset_GetMeshBVH. The cooked path is empty for meshes that have no cooked file to build from.
+    Ref<BVHCache> bvh;
+    std::string cookedPath;
+    uint64_t cookedSourceKey = 0;
+    uint64_t cookedImportKey = 0;
 };
 
 struct ShadowMap {
@@ -65,6 +65,8 @@ namespace flaw {
 
 		void Update(const uint32_t* indices, uint32_t count) override;
 
+		void CopyTo(Ref<IndexBuffer> dstBuffer, uint32_t srcOffset = 0, uint32_t dstOffset = 0) override;
+
 		uint32_t IndexCount() const override { return _indexCount; }
 
 		const GraphicsNativeBuffer& GetNativeBuffer() const override { return _nativeBuffer; }
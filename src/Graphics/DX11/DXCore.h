@@ -48,6 +48,32 @@ namespace flaw {
 			case 4: return DXGI_FORMAT_R32G32B32A32_SINT;
 			}
 			break;
+		case ElementType::Half:
+			switch (count) {
+			case 1: return DXGI_FORMAT_R16_FLOAT;
+			case 2: return DXGI_FORMAT_R16G16_FLOAT;
+			case 4: return DXGI_FORMAT_R16G16B16A16_FLOAT;
+			}
+			break;
+		case ElementType::Unorm16:
+			switch (count) {
+			case 1: return DXGI_FORMAT_R16_UNORM;
+			case 2: return DXGI_FORMAT_R16G16_UNORM;
+			case 4: return DXGI_FORMAT_R16G16B16A16_UNORM;
+			}
+			break;
+		case ElementType::Snorm16:
+			switch (count) {
+			case 1: return DXGI_FORMAT_R16_SNORM;
+			case 2: return DXGI_FORMAT_R16G16_SNORM;
+			case 4: return DXGI_FORMAT_R16G16B16A16_SNORM;
+			}
+			break;
+		case ElementType::Unorm8:
+			switch (count) {
+			case 4: return DXGI_FORMAT_R8G8B8A8_UNORM;
+			}
+			break;
 		}
 		return DXGI_FORMAT_UNKNOWN;
 	}
@@ -84,6 +110,22 @@ namespace flaw {
 			return DXGI_FORMAT_D32_FLOAT;
 		case PixelFormat::BGRA8:
 			return DXGI_FORMAT_B8G8R8A8_UNORM;
+		case PixelFormat::BC1Unorm:
+			return DXGI_FORMAT_BC1_UNORM;
+		case PixelFormat::BC1Srgb:
+			return DXGI_FORMAT_BC1_UNORM_SRGB;
+		case PixelFormat::BC3Unorm:
+			return DXGI_FORMAT_BC3_UNORM;
+		case PixelFormat::BC3Srgb:
+			return DXGI_FORMAT_BC3_UNORM_SRGB;
+		case PixelFormat::BC4Unorm:
+			return DXGI_FORMAT_BC4_UNORM;
+		case PixelFormat::BC5Unorm:
+			return DXGI_FORMAT_BC5_UNORM;
+		case PixelFormat::BC7Unorm:
+			return DXGI_FORMAT_BC7_UNORM;
+		case PixelFormat::BC7Srgb:
+			return DXGI_FORMAT_BC7_UNORM_SRGB;
 		}
 
 		throw std::runtime_error("Unsupported PixelFormat");	
@@ -121,6 +163,22 @@ namespace flaw {
 			return PixelFormat::D32F;
 		case DXGI_FORMAT_B8G8R8A8_UNORM:
 			return PixelFormat::BGRA8;
+		case DXGI_FORMAT_BC1_UNORM:
+			return PixelFormat::BC1Unorm;
+		case DXGI_FORMAT_BC1_UNORM_SRGB:
+			return PixelFormat::BC1Srgb;
+		case DXGI_FORMAT_BC3_UNORM:
+			return PixelFormat::BC3Unorm;
+		case DXGI_FORMAT_BC3_UNORM_SRGB:
+			return PixelFormat::BC3Srgb;
+		case DXGI_FORMAT_BC4_UNORM:
+			return PixelFormat::BC4Unorm;
+		case DXGI_FORMAT_BC5_UNORM:
+			return PixelFormat::BC5Unorm;
+		case DXGI_FORMAT_BC7_UNORM:
+			return PixelFormat::BC7Unorm;
+		case DXGI_FORMAT_BC7_UNORM_SRGB:
+			return PixelFormat::BC7Srgb;
 		}
 
 		throw std::runtime_error("Unsupported DXGI_FORMAT");
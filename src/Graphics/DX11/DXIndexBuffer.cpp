@@ -46,6 +46,26 @@ namespace flaw {
 
 		_indexCount = count;
 	}
+
+	void DXIndexBuffer::CopyTo(Ref<IndexBuffer> dstBuffer, uint32_t srcOffset, uint32_t dstOffset) {
+		auto dxDstBuffer = std::static_pointer_cast<DXIndexBuffer>(dstBuffer);
+		FASSERT(dxDstBuffer, "Destination buffer is not a DXIndexBuffer");
+
+		if (dstOffset + _bufferByteSize - srcOffset > dxDstBuffer->_bufferByteSize) {
+			LOG_ERROR("Copy exceeds destination buffer size");
+			return;
+		}
+
+		D3D11_BOX srcBox = {};
+		srcBox.left = srcOffset;
+		srcBox.right = _bufferByteSize;
+		srcBox.top = 0;
+		srcBox.bottom = 1;
+		srcBox.front = 0;
+		srcBox.back = 1;
+
+		_context.DeviceContext()->CopySubresourceRegion(dxDstBuffer->_nativeBuffer.buffer.Get(), 0, dstOffset, 0, 0, _nativeBuffer.buffer.Get(), 0, &srcBox);
+	}
 }
 
 #endif
\ No newline at end of file
@@ -190,7 +190,7 @@ namespace flaw {
 				0, // Mip level
 				nullptr, // D3D11_BOX
 				data,
-				_width * GetSizePerPixel(_format), // Row pitch
+				GetRowPitch(_format, _width), // Row pitch
 				0 // Depth pitch
 			);
 		}
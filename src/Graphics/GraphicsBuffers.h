@@ -45,6 +45,9 @@ namespace flaw {
 
 		virtual void CopyTo(Ref<VertexBuffer> dstBuffer, uint32_t srcOffset = 0, uint32_t dstOffset = 0) = 0;
 
+		// NOTE: Host memory of a buffer the backend keeps mapped, written directly instead of through Update. nullptr otherwise.
+		virtual void* GetMappedData() const { return nullptr; }
+
 		virtual uint32_t Size() const = 0;
 	};
 
@@ -61,6 +64,12 @@ namespace flaw {
 
 		virtual void Update(const uint32_t* indices, uint32_t count) = 0;
 
+		// NOTE: Copies the whole buffer from srcOffset, offsets are in bytes
+		virtual void CopyTo(Ref<IndexBuffer> dstBuffer, uint32_t srcOffset = 0, uint32_t dstOffset = 0) = 0;
+
+		// NOTE: Same as VertexBuffer::GetMappedData
+		virtual uint32_t* GetMappedData() const { return nullptr; }
+
 		virtual uint32_t IndexCount() const = 0;
 	};
 
@@ -55,5 +55,9 @@ namespace flaw {
 
 		virtual Ref<ComputeShader> CreateComputeShader(const ComputeShader::Descriptor& descriptor) = 0;
 		virtual Ref<ComputePipeline> CreateComputePipeline() = 0;
+
+		// NOTE: Replaces the stages loaded from filePath in every live shader and rebuilds the pipelines using them, a pipeline
+		// that fails to build keeps its previous version. Returns the number of pipelines rebuilt.
+		virtual uint32_t ReloadShaderFile(const char* filePath, const std::vector<int8_t>& code) { return 0; }
 	};
 }
\ No newline at end of file
@@ -16,6 +16,7 @@ namespace flaw {
 			return 3;
 		case PixelFormat::RGBA8Unorm:
 		case PixelFormat::BGRX8Unorm:
+		case PixelFormat::BGRA8:
 		case PixelFormat::RGBA8Srgb:
 		case PixelFormat::R32F:
 		case PixelFormat::R32_UINT:
@@ -34,7 +35,90 @@ namespace flaw {
 			return 16;
 		}
 
-		throw std::runtime_error("Unknown pixel format");
+		throw std::runtime_error("Unknown pixel format, use GetTextureSize for block compressed formats");
+	}
+
+	inline bool IsBlockCompressedFormat(PixelFormat format) {
+		switch (format) {
+		case PixelFormat::BC1Unorm:
+		case PixelFormat::BC1Srgb:
+		case PixelFormat::BC3Unorm:
+		case PixelFormat::BC3Srgb:
+		case PixelFormat::BC4Unorm:
+		case PixelFormat::BC5Unorm:
+		case PixelFormat::BC7Unorm:
+		case PixelFormat::BC7Srgb:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	inline bool IsSrgbFormat(PixelFormat format) {
+		switch (format) {
+		case PixelFormat::RGBA8Srgb:
+		case PixelFormat::BC1Srgb:
+		case PixelFormat::BC3Srgb:
+		case PixelFormat::BC7Srgb:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// NOTE: sRGB variant of a format with the same memory layout, the format itself if there is none
+	inline PixelFormat GetSrgbFormat(PixelFormat format) {
+		switch (format) {
+		case PixelFormat::RGBA8Unorm: return PixelFormat::RGBA8Srgb;
+		case PixelFormat::BC1Unorm: return PixelFormat::BC1Srgb;
+		case PixelFormat::BC3Unorm: return PixelFormat::BC3Srgb;
+		case PixelFormat::BC7Unorm: return PixelFormat::BC7Srgb;
+		default: return format;
+		}
+	}
+
+	// NOTE: Bytes per 4x4 block for block compressed formats
+	inline uint32_t GetBlockSize(PixelFormat format) {
+		switch (format) {
+		case PixelFormat::BC1Unorm:
+		case PixelFormat::BC1Srgb:
+		case PixelFormat::BC4Unorm:
+			return 8;
+		case PixelFormat::BC3Unorm:
+		case PixelFormat::BC3Srgb:
+		case PixelFormat::BC5Unorm:
+		case PixelFormat::BC7Unorm:
+		case PixelFormat::BC7Srgb:
+			return 16;
+		default:
+			throw std::runtime_error("Not a block compressed pixel format");
+		}
+	}
+
+	// NOTE: Bytes per row of texels, per row of blocks for block compressed formats
+	inline uint32_t GetRowPitch(PixelFormat format, uint32_t width) {
+		if (IsBlockCompressedFormat(format)) {
+			return ((width + 3) / 4) * GetBlockSize(format);
+		}
+
+		return width * GetSizePerPixel(format);
+	}
+
+	inline uint32_t GetRowCount(PixelFormat format, uint32_t height) {
+		return IsBlockCompressedFormat(format) ? (height + 3) / 4 : height;
+	}
+
+	inline uint64_t GetTextureSize(PixelFormat format, uint32_t width, uint32_t height) {
+		return static_cast<uint64_t>(GetRowPitch(format, width)) * GetRowCount(format, height);
+	}
+
+	// NOTE: Size of mip levels [0, mipLevels) packed back to back, the layout expected by Texture2D::Descriptor::dataMipLevels
+	inline uint64_t GetMipChainSize(PixelFormat format, uint32_t width, uint32_t height, uint32_t mipLevels) {
+		uint64_t size = 0;
+		for (uint32_t i = 0; i < mipLevels; ++i) {
+			size += GetTextureSize(format, std::max(1u, width >> i), std::max(1u, height >> i));
+		}
+		return size;
 	}
 
 	inline bool IsDepthFormat(PixelFormat format) {
@@ -56,6 +140,12 @@ namespace flaw {
 			return sizeof(uint32_t);
 		case ElementType::Int:
 			return sizeof(int32_t);
+		case ElementType::Half:
+		case ElementType::Unorm16:
+		case ElementType::Snorm16:
+			return sizeof(uint16_t);
+		case ElementType::Unorm8:
+			return sizeof(uint8_t);
 		}
 
 		throw std::runtime_error("Unknown element type");
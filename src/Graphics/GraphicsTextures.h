@@ -31,6 +31,7 @@ namespace flaw {
 			MemoryProperty memProperty = MemoryProperty::Static;
 			TextureUsages texUsages = 0;
 			uint32_t mipLevels = 1;
+			uint32_t dataMipLevels = 1; // mip levels contained in data, packed back to back from level 0. The rest are generated.
 			uint32_t sampleCount = 1;
 			TextureLayout initialLayout = TextureLayout::Undefined;
 			FilterMode minFilter = FilterMode::Nearest;
@@ -57,6 +58,7 @@ namespace flaw {
 			MemoryProperty memProperty = MemoryProperty::Static;
 			TextureUsages texUsages = 0;
 			uint32_t mipLevels = 1;
+			uint32_t dataMipLevels = 1; // mip levels contained in data per layer, see Texture2D::Descriptor
 			uint32_t sampleCount = 1;
 			TextureLayout initialLayout = TextureLayout::Undefined;
 			uint32_t layers = 0;
@@ -83,6 +85,7 @@ namespace flaw {
 			MemoryProperty memProperty = MemoryProperty::Static;
 			TextureUsages texUsages = 0;
 			uint32_t mipLevels = 1;
+			uint32_t dataMipLevels = 1; // mip levels contained in data per face, faces stored one after another
 			uint32_t sampleCount = 1;
 			TextureLayout initialLayout = TextureLayout::Undefined;
 			FilterMode minFilter = FilterMode::Nearest;
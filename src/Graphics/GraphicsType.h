@@ -110,12 +110,26 @@ namespace flaw {
 		D32F_S8UI,
 		D32F,
 		BGRA8,
+
+		// NOTE: Block compressed, 4x4 texel blocks
+		BC1Unorm,
+		BC1Srgb,
+		BC3Unorm,
+		BC3Srgb,
+		BC4Unorm,
+		BC5Unorm,
+		BC7Unorm,
+		BC7Srgb,
 	};
 
 	enum class ElementType {
 		Float,
 		Uint32,
 		Int,
+		Half,    // 16 bit float, read as float
+		Unorm16, // read as float in [0, 1]
+		Snorm16, // read as float in [-1, 1]
+		Unorm8,  // read as float in [0, 1]
 	};
 
 	enum class TextureType {
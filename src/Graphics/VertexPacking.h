@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Core.h"
+#include "Math/Math.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace flaw {
+	// NOTE: Round to nearest even, overflow goes to infinity and values below the half range flush to signed zero
+	inline uint16_t FloatToHalf(float value) {
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		const uint32_t sign = (bits >> 16) & 0x8000;
+		const uint32_t absBits = bits & 0x7fffffff;
+
+		if (absBits >= 0x7f800000) {
+			return sign | 0x7c00 | (absBits > 0x7f800000 ? 0x200 : 0);
+		}
+
+		if (absBits >= 0x477ff000) {
+			return sign | 0x7c00;
+		}
+
+		if (absBits < 0x38800000) {
+			// NOTE: Subnormal half, shift the mantissa with its implicit bit into place
+			if (absBits < 0x33000000) {
+				return sign;
+			}
+
+			const uint32_t exponent = absBits >> 23;
+			const uint32_t mantissa = (absBits & 0x7fffff) | 0x800000;
+			const uint32_t shift = 126 - exponent;
+			const uint32_t rounded = (mantissa + (1u << (shift - 1)) - 1 + ((mantissa >> shift) & 1)) >> shift;
+			return sign | rounded;
+		}
+
+		const uint32_t rebased = absBits - 0x38000000;
+		return sign | ((rebased + 0xfff + ((rebased >> 13) & 1)) >> 13);
+	}
+
+	inline float HalfToFloat(uint16_t value) {
+		const uint32_t sign = (value & 0x8000u) << 16;
+		uint32_t exponent = (value >> 10) & 0x1f;
+		uint32_t mantissa = value & 0x3ff;
+
+		uint32_t bits;
+		if (exponent == 0x1f) {
+			bits = sign | 0x7f800000 | (mantissa << 13);
+		}
+		else if (exponent != 0) {
+			bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+		}
+		else if (mantissa != 0) {
+			exponent = 113;
+			while ((mantissa & 0x400) == 0) {
+				mantissa <<= 1;
+				exponent--;
+			}
+			bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+		}
+		else {
+			bits = sign;
+		}
+
+		float result;
+		std::memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	inline uint16_t PackUnorm16(float value) {
+		return static_cast<uint16_t>(std::round(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+	}
+
+	inline uint32_t PackUnorm8(float value) {
+		return static_cast<uint32_t>(std::round(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+	}
+
+	inline int16_t PackSnorm16(float value) {
+		return static_cast<int16_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+	}
+
+	inline float UnpackSnorm16(int16_t value) {
+		return std::max(value / 32767.0f, -1.0f);
+	}
+
+	// NOTE: Unit vector folded onto the octahedron and stored as two snorm16, under 0.004 degrees of error.
+	// The sign of the folded coordinates is kept so vectors on the lower hemisphere decode back to their own side.
+	inline void EncodeOctahedral(const vec3& direction, int16_t outEncoded[2]) {
+		const float invL1 = 1.0f / std::max(std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z), 1e-20f);
+
+		float x = direction.x * invL1;
+		float y = direction.y * invL1;
+
+		if (direction.z < 0.0f) {
+			const float foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			const float foldedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = foldedX;
+			y = foldedY;
+		}
+
+		outEncoded[0] = PackSnorm16(x);
+		outEncoded[1] = PackSnorm16(y);
+	}
+
+	inline vec3 DecodeOctahedral(const int16_t encoded[2]) {
+		const float x = UnpackSnorm16(encoded[0]);
+		const float y = UnpackSnorm16(encoded[1]);
+
+		vec3 direction(x, y, 1.0f - std::abs(x) - std::abs(y));
+
+		const float t = std::max(-direction.z, 0.0f);
+		direction.x += direction.x >= 0.0f ? -t : t;
+		direction.y += direction.y >= 0.0f ? -t : t;
+
+		return glm::normalize(direction);
+	}
+}
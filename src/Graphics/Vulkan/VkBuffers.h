@@ -43,6 +43,8 @@ namespace flaw {
 
 		virtual void CopyTo(Ref<VertexBuffer> dstBuffer, uint32_t srcOffset = 0, uint32_t dstOffset = 0) override;
 
+		virtual void* GetMappedData() const override { return _mappedData; }
+
 		virtual uint32_t Size() const override { return _size; }
 
 		const GraphicsNativeBuffer& GetNativeBuffer() const override { return _nativeBuffer; }
@@ -66,6 +68,10 @@ namespace flaw {
 
 		void Update(const uint32_t* indices, uint32_t count) override;
 
+		void CopyTo(Ref<IndexBuffer> dstBuffer, uint32_t srcOffset = 0, uint32_t dstOffset = 0) override;
+
+		uint32_t* GetMappedData() const override { return static_cast<uint32_t*>(_mappedData); }
+
 		uint32_t IndexCount() const override { return _indexCount; }
 
 		const GraphicsNativeBuffer& GetNativeBuffer() const override { return _nativeBuffer; }
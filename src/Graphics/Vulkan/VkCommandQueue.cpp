@@ -134,6 +134,8 @@ namespace flaw {
             LOG_FATAL("Failed to begin Vulkan command buffer: %s", vk::to_string(result).c_str());
             return false;
         }
+
+        _currentIndexBuffer = nullptr;
   
         return true;
     }
@@ -321,7 +323,12 @@ namespace flaw {
 
         auto& commandBuffer = _graphicsFrameCommandBuffers[_currentCommandBufferIndex];
 
-        commandBuffer.bindIndexBuffer(vkNativeBuff.buffer, 0, vk::IndexType::eUint32);
+        // NOTE: Meshes sharing a pool page draw from the same index buffer, only a different one is bound
+        if (vkNativeBuff.buffer != _currentIndexBuffer) {
+            commandBuffer.bindIndexBuffer(vkNativeBuff.buffer, 0, vk::IndexType::eUint32);
+            _currentIndexBuffer = vkNativeBuff.buffer;
+        }
+
         commandBuffer.drawIndexed(indexCount, instanceCount, indexOffset, vertexOffset, instanceOffset);
     }
 
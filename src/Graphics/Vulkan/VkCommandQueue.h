@@ -73,6 +73,7 @@ namespace flaw {
 		Ref<VkRenderPass> _currentBeginRenderPass;
 		Ref<VkFramebuffer> _currentBeginFramebuffer;
 		Ref<VkGraphicsPipeline> _currentPipeline;
+		vk::Buffer _currentIndexBuffer;
     };
 }
 
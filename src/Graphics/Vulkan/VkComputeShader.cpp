@@ -4,7 +4,7 @@
 #ifdef SUPPORT_VULKAN
 
 #include "VkContext.h"
-#include "Platform/FileSystem.h"
+#include "Utils/AssetPack.h"
 #include "Log/Log.h"
 
 namespace flaw {
@@ -30,7 +30,7 @@ namespace flaw {
 
     bool VkComputeShader::CreateShader(const std::string& filePath, const std::string& entryPoint) {
         std::vector<int8_t> sourceCode;
-        if (!FileSystem::ReadFile(filePath.c_str(), sourceCode)) {
+        if (!AssetFiles::Read(filePath.c_str(), sourceCode)) {
             Log::Error("Failed to read compute shader file: %s", filePath.c_str());
             return false;
         }
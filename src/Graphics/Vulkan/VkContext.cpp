@@ -384,7 +384,12 @@ namespace flaw {
     }
 
 	Ref<GraphicsPipeline> VkContext::CreateGraphicsPipeline() {
-        return CreateRef<VkGraphicsPipeline>(*this);
+        auto pipeline = CreateRef<VkGraphicsPipeline>(*this);
+
+        _graphicsPipelines.erase(std::remove_if(_graphicsPipelines.begin(), _graphicsPipelines.end(), [](const auto& weakPipeline) { return weakPipeline.expired(); }), _graphicsPipelines.end());
+        _graphicsPipelines.push_back(pipeline);
+
+        return pipeline;
 	}
 
 	Ref<ConstantBuffer> VkContext::CreateConstantBuffer(const ConstantBuffer::Descriptor& desc) {
@@ -495,6 +500,32 @@ namespace flaw {
 		}
 	}
 
+    uint32_t VkContext::ReloadShaderFile(const char* filePath, const std::vector<int8_t>& code) {
+        // NOTE: A shader is shared by several pipelines, its stages are reloaded once
+        std::unordered_map<GraphicsShader*, bool> reloadedShaders;
+
+        uint32_t rebuiltCount = 0;
+        for (const auto& weakPipeline : _graphicsPipelines) {
+            Ref<VkGraphicsPipeline> pipeline = weakPipeline.lock();
+            if (!pipeline || !pipeline->GetShader()) {
+                continue;
+            }
+
+            auto shader = std::static_pointer_cast<VkGraphicsShader>(pipeline->GetShader());
+
+            auto it = reloadedShaders.find(shader.get());
+            if (it == reloadedShaders.end()) {
+                it = reloadedShaders.emplace(shader.get(), shader->ReloadStages(filePath, code)).first;
+            }
+
+            if (it->second && pipeline->ReloadShader()) {
+                rebuiltCount++;
+            }
+        }
+
+        return rebuiltCount;
+    }
+
     void VkContext::AddDelayedDeletionTasks(const std::function<void()>& task) {
         _delayedDeletionTasks.push(DelayedDeletionTask{ (_currentDeletionCounter + 2) % MaxDeletionCounter, task });
     }
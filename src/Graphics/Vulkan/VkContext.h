@@ -12,6 +12,7 @@
 namespace flaw {
 	class VkSwapchain;
 	class VkCommandQueue;
+	class VkGraphicsPipeline;
 
 	class FAPI VkContext : public GraphicsContext {
 	public:
@@ -58,6 +59,8 @@ namespace flaw {
 		Ref<ComputeShader> CreateComputeShader(const ComputeShader::Descriptor& descriptor) override;
 		Ref<ComputePipeline> CreateComputePipeline() override;
 
+		uint32_t ReloadShaderFile(const char* filePath, const std::vector<int8_t>& code) override;
+
 		void AddOnResizeHandler(uint32_t id, const std::function<void(int32_t, int32_t)>& handler);
 		void RemoveOnResizeHandler(uint32_t id);
 
@@ -133,6 +136,8 @@ namespace flaw {
 			std::function<void()> task;
 		};
 		std::queue<DelayedDeletionTask> _delayedDeletionTasks;
+
+		std::vector<std::weak_ptr<VkGraphicsPipeline>> _graphicsPipelines; // searched by ReloadShaderFile
 	};
 }
 
@@ -3,6 +3,8 @@
 
 #ifdef SUPPORT_VULKAN
 
+#include "Graphics/GraphicsFunc.h"
+
 namespace flaw {
     vk::Format ConvertToVkFormat(PixelFormat format) {
         switch (format) {
@@ -22,6 +24,14 @@ namespace flaw {
         case PixelFormat::D32F_S8UI: return vk::Format::eD32SfloatS8Uint;
         case PixelFormat::D32F: return vk::Format::eD32Sfloat;
         case PixelFormat::BGRA8: return vk::Format::eB8G8R8A8Unorm;
+        case PixelFormat::BC1Unorm: return vk::Format::eBc1RgbaUnormBlock;
+        case PixelFormat::BC1Srgb: return vk::Format::eBc1RgbaSrgbBlock;
+        case PixelFormat::BC3Unorm: return vk::Format::eBc3UnormBlock;
+        case PixelFormat::BC3Srgb: return vk::Format::eBc3SrgbBlock;
+        case PixelFormat::BC4Unorm: return vk::Format::eBc4UnormBlock;
+        case PixelFormat::BC5Unorm: return vk::Format::eBc5UnormBlock;
+        case PixelFormat::BC7Unorm: return vk::Format::eBc7UnormBlock;
+        case PixelFormat::BC7Srgb: return vk::Format::eBc7SrgbBlock;
         default:
             throw std::runtime_error("Unknown pixel format");
         }
@@ -44,6 +54,14 @@ namespace flaw {
         case vk::Format::eD24UnormS8Uint: return PixelFormat::D24S8_UINT;
         case vk::Format::eD32SfloatS8Uint: return PixelFormat::D32F_S8UI;
 		case vk::Format::eD32Sfloat: return PixelFormat::D32F;
+        case vk::Format::eBc1RgbaUnormBlock: return PixelFormat::BC1Unorm;
+        case vk::Format::eBc1RgbaSrgbBlock: return PixelFormat::BC1Srgb;
+        case vk::Format::eBc3UnormBlock: return PixelFormat::BC3Unorm;
+        case vk::Format::eBc3SrgbBlock: return PixelFormat::BC3Srgb;
+        case vk::Format::eBc4UnormBlock: return PixelFormat::BC4Unorm;
+        case vk::Format::eBc5UnormBlock: return PixelFormat::BC5Unorm;
+        case vk::Format::eBc7UnormBlock: return PixelFormat::BC7Unorm;
+        case vk::Format::eBc7SrgbBlock: return PixelFormat::BC7Srgb;
         default:
             throw std::runtime_error("Unknown Vulkan format");
         }
@@ -179,6 +197,36 @@ namespace flaw {
 		return aspectFlags;
     }
 
+    uint64_t GetVkBufferImageCopies(PixelFormat format, uint32_t width, uint32_t height, uint32_t layerCount, uint32_t mipLevels, std::vector<vk::BufferImageCopy>& outRegions) {
+        outRegions.clear();
+        outRegions.reserve(static_cast<size_t>(layerCount) * mipLevels);
+
+        uint64_t bufferOffset = 0;
+        for (uint32_t layer = 0; layer < layerCount; ++layer) {
+            for (uint32_t mip = 0; mip < mipLevels; ++mip) {
+                const uint32_t mipWidth = std::max(1u, width >> mip);
+                const uint32_t mipHeight = std::max(1u, height >> mip);
+
+                vk::BufferImageCopy copyRegion;
+                copyRegion.bufferOffset = bufferOffset;
+                copyRegion.bufferRowLength = 0;
+                copyRegion.bufferImageHeight = 0;
+                copyRegion.imageSubresource.aspectMask = GetVkImageAspectFlags(format);
+                copyRegion.imageSubresource.mipLevel = mip;
+                copyRegion.imageSubresource.baseArrayLayer = layer;
+                copyRegion.imageSubresource.layerCount = 1;
+                copyRegion.imageOffset = vk::Offset3D{ 0, 0, 0 };
+                copyRegion.imageExtent = vk::Extent3D{ mipWidth, mipHeight, 1 };
+
+                outRegions.push_back(copyRegion);
+
+                bufferOffset += GetTextureSize(format, mipWidth, mipHeight);
+            }
+        }
+
+        return bufferOffset;
+    }
+
     vk::ImageUsageFlags GetVkImageUsageFlags(TextureUsages texUsages) {
         vk::ImageUsageFlags usageFlags = {};
 
@@ -248,6 +296,24 @@ namespace flaw {
             if (count == 3) return vk::Format::eR32G32B32Sint;
             if (count == 4) return vk::Format::eR32G32B32A32Sint;
             break;
+        case ElementType::Half:
+            if (count == 1) return vk::Format::eR16Sfloat;
+            if (count == 2) return vk::Format::eR16G16Sfloat;
+            if (count == 4) return vk::Format::eR16G16B16A16Sfloat;
+            break;
+        case ElementType::Unorm16:
+            if (count == 1) return vk::Format::eR16Unorm;
+            if (count == 2) return vk::Format::eR16G16Unorm;
+            if (count == 4) return vk::Format::eR16G16B16A16Unorm;
+            break;
+        case ElementType::Snorm16:
+            if (count == 1) return vk::Format::eR16Snorm;
+            if (count == 2) return vk::Format::eR16G16Snorm;
+            if (count == 4) return vk::Format::eR16G16B16A16Snorm;
+            break;
+        case ElementType::Unorm8:
+            if (count == 4) return vk::Format::eR8G8B8A8Unorm;
+            break;
         default:
             throw std::runtime_error("Unsupported input element type");
         }
@@ -58,6 +58,8 @@ namespace flaw {
 	vk::ImageAspectFlags GetVkImageAspectFlags(vk::Format format);
     vk::ImageUsageFlags GetVkImageUsageFlags(TextureUsages texUsages);
     vk::ColorComponentFlags GetVkColorComponentFlags(PixelFormat format);
+    // NOTE: Copy regions for data laid out per layer, each layer holding its mip chain back to back. Returns the total data size.
+    uint64_t GetVkBufferImageCopies(PixelFormat format, uint32_t width, uint32_t height, uint32_t layerCount, uint32_t mipLevels, std::vector<vk::BufferImageCopy>& outRegions);
 	vk::Filter ConvertToVkFilter(FilterMode filterMode);
 	vk::SamplerAddressMode ConvertToVkSamplerAddressMode(WrapMode wrapMode);
     void GetRequiredVkBufferUsageFlags(MemoryProperty usage, vk::BufferUsageFlags& usageFlags);
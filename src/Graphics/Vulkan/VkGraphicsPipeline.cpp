@@ -228,8 +228,41 @@ namespace flaw {
 
         _shader = vkShader;
 
-        const auto& shaderStages = vkShader->GetShaderStages();
-        
+        UpdateShaderStages();
+    }
+
+    bool VkGraphicsPipeline::ReloadShader() {
+        if (!_shader) {
+            return false;
+        }
+
+        UpdateShaderStages();
+
+        if (!_pipeline || _needRecreatePipeline) {
+            _needRecreatePipeline = true;
+            return true;
+        }
+
+        vk::Pipeline oldPipeline = _pipeline;
+
+        _pipeline = nullptr;
+        CreatePipeline();
+
+        if (!_pipeline) {
+            _pipeline = oldPipeline;
+            return false;
+        }
+
+        _context.AddDelayedDeletionTasks([&context = _context, pipeline = oldPipeline]() {
+            context.GetVkDevice().destroyPipeline(pipeline, nullptr);
+        });
+
+        return true;
+    }
+
+    void VkGraphicsPipeline::UpdateShaderStages() {
+        const auto& shaderStages = std::static_pointer_cast<VkGraphicsShader>(_shader)->GetShaderStages();
+
         _shaderStages.resize(shaderStages.size());
         for (size_t i = 0; i < shaderStages.size(); ++i) {
             const auto& stage = shaderStages[i];
@@ -4,10 +4,17 @@
 #ifdef SUPPORT_VULKAN
 
 #include "VkContext.h"
-#include "Platform/FileSystem.h"
+#include "Utils/AssetPack.h"
 #include "Log/Log.h"
 
 namespace flaw {
+    static std::string GetCanonicalShaderPath(const std::string& filePath) {
+        std::error_code ec;
+        std::filesystem::path path = std::filesystem::weakly_canonical(filePath, ec);
+
+        return ec ? std::filesystem::path(filePath).lexically_normal().generic_string() : path.generic_string();
+    }
+
     VkGraphicsShader::VkGraphicsShader(VkContext& context, const Descriptor& descriptor) 
         : _context(context)
     {
@@ -34,29 +41,65 @@ namespace flaw {
 
     void VkGraphicsShader::CreateShader(const std::string& filePath, const std::string& entryPoint, ShaderStage compileFlag) {
         std::vector<int8_t> sourceCode;
-        if (!FileSystem::ReadFile(filePath.c_str(), sourceCode)) {
+        if (!AssetFiles::Read(filePath.c_str(), sourceCode)) {
             Log::Error("Failed to read shader file: %s", filePath.c_str());
             return;
         }
 
-        vk::ShaderModuleCreateInfo createInfo;
-        createInfo.codeSize = sourceCode.size();
-        createInfo.pCode = reinterpret_cast<const uint32_t*>(sourceCode.data());
-
-        auto moduleWrapper = _context.GetVkDevice().createShaderModule(createInfo, nullptr);
-        if (moduleWrapper.result != vk::Result::eSuccess) {
+        Stage stage;
+        if (!CreateShaderModule(sourceCode, stage.module)) {
             Log::Error("Failed to create shader module: %s", filePath.c_str());
             return;
         }
 
-        Stage stage;
-        stage.module = moduleWrapper.value;
         stage.entryPoint = entryPoint;
         stage.stage = ConvertToVkShaderStage(compileFlag);
+        stage.filePath = GetCanonicalShaderPath(filePath);
 
         _shaderStages.push_back(stage);
     }
 
+    bool VkGraphicsShader::CreateShaderModule(const std::vector<int8_t>& code, vk::ShaderModule& outModule) const {
+        vk::ShaderModuleCreateInfo createInfo;
+        createInfo.codeSize = code.size();
+        createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+
+        auto moduleWrapper = _context.GetVkDevice().createShaderModule(createInfo, nullptr);
+        if (moduleWrapper.result != vk::Result::eSuccess) {
+            return false;
+        }
+
+        outModule = moduleWrapper.value;
+
+        return true;
+    }
+
+    bool VkGraphicsShader::ReloadStages(const std::string& filePath, const std::vector<int8_t>& code) {
+        const std::string canonicalPath = GetCanonicalShaderPath(filePath);
+
+        bool reloaded = false;
+        for (auto& stage : _shaderStages) {
+            if (stage.filePath != canonicalPath) {
+                continue;
+            }
+
+            vk::ShaderModule shaderModule;
+            if (!CreateShaderModule(code, shaderModule)) {
+                Log::Error("Failed to create shader module: %s", filePath.c_str());
+                continue;
+            }
+
+            _context.AddDelayedDeletionTasks([&context = _context, oldModule = stage.module]() {
+                context.GetVkDevice().destroyShaderModule(oldModule, nullptr);
+            });
+
+            stage.module = shaderModule;
+            reloaded = true;
+        }
+
+        return reloaded;
+    }
+
     VkGraphicsShader::~VkGraphicsShader() {
         for (const auto& shaderStage : _shaderStages) {
             if (!shaderStage.module) {
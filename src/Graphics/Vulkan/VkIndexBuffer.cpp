@@ -85,6 +85,29 @@ namespace flaw {
             Log::Error("Index buffer is not mapped for updating.");
         }
     }
+
+    void VkIndexBuffer::CopyTo(Ref<IndexBuffer> dstBuffer, uint32_t srcOffset, uint32_t dstOffset) {
+        auto vkDstBuffer = std::dynamic_pointer_cast<VkIndexBuffer>(dstBuffer);
+        FASSERT(vkDstBuffer, "Invalid index buffer type for Vulkan command queue");
+
+        if (dstOffset + _size - srcOffset > vkDstBuffer->_size) {
+            Log::Error("Copy exceeds destination index buffer size.");
+            return;
+        }
+
+        auto& vkCommandQueue = static_cast<VkCommandQueue&>(_context.GetCommandQueue());
+
+        vk::CommandBuffer commandBuffer = vkCommandQueue.BeginOneTimeCommands();
+
+        vk::BufferCopy copyRegion;
+        copyRegion.size = _size - srcOffset;
+        copyRegion.srcOffset = srcOffset;
+        copyRegion.dstOffset = dstOffset;
+
+        commandBuffer.copyBuffer(_nativeBuffer.buffer, vkDstBuffer->_nativeBuffer.buffer, 1, &copyRegion);
+
+        vkCommandQueue.EndOneTimeCommands(commandBuffer);
+    }
 }
 
 #endif
\ No newline at end of file
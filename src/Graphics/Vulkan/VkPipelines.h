@@ -51,6 +51,10 @@ namespace flaw {
 
         void SetPushConstantRanges(const std::vector<VkPushConstantRange>& pushConstants);
 
+        // NOTE: Picks up the current stages of the shader. A pipeline already created is rebuilt right away and kept if that fails.
+        bool ReloadShader();
+        inline const Ref<GraphicsShader>& GetShader() const { return _shader; }
+
         vk::Pipeline GetNativeVkGraphicsPipeline();
         inline vk::PipelineLayout GetVkPipelineLayout() const { return _pipelineLayout; }
         inline const std::vector<vk::PushConstantRange>& GetVkPushConstantRanges() const { return _pushConstantRanges; }
@@ -59,6 +63,8 @@ namespace flaw {
         inline const vk::Rect2D& GetVkScissor() const { return _scissor; }
 
     private:
+        void UpdateShaderStages();
+
         void CreatePipeline();
         void DestroyPipeline();
 
@@ -63,6 +63,7 @@ namespace flaw {
 			vk::ShaderModule module;
 			vk::ShaderStageFlagBits stage;
 			std::string entryPoint;
+			std::string filePath; // canonical
 		};
 
 		VkGraphicsShader(VkContext& context, const Descriptor& descriptor);
@@ -70,8 +71,12 @@ namespace flaw {
 
 		const std::vector<Stage>& GetShaderStages() const { return _shaderStages; }
 
+		// NOTE: Recreates the stages loaded from filePath out of code. False if none was, a stage whose module fails keeps the old one.
+		bool ReloadStages(const std::string& filePath, const std::vector<int8_t>& code);
+
 	private:
 		void CreateShader(const std::string& filePath, const std::string& entryPoint, ShaderStage complileFlag);
+		bool CreateShaderModule(const std::vector<int8_t>& code, vk::ShaderModule& outModule) const;
 
 	private:
 		VkContext& _context;
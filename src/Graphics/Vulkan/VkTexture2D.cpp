@@ -25,6 +25,14 @@ namespace flaw {
 		, _wrapModeU(descriptor.wrapModeU)
 		, _wrapModeV(descriptor.wrapModeV)
     {
+        const uint32_t dataMipLevels = std::max(1u, std::min(descriptor.dataMipLevels, _mipLevels));
+
+        // NOTE: Block compressed images can not be blit targets, their mip chain has to come with the data
+        if (IsBlockCompressedFormat(_format) && descriptor.data && dataMipLevels < _mipLevels) {
+            Log::Warn("Block compressed texture provides %u of %u mip levels, the rest are dropped", dataMipLevels, _mipLevels);
+            _mipLevels = dataMipLevels;
+        }
+
         vk::ImageCreateInfo imageInfo;
         imageInfo.imageType = vk::ImageType::e2D;
         imageInfo.format = ConvertToVkFormat(_format);
@@ -57,12 +65,12 @@ namespace flaw {
         vk::CommandBuffer commandBuffer = vkCmdQueue.BeginOneTimeCommands();
 
         if (descriptor.data) {
-            if (!PullMemory(commandBuffer, descriptor.data)) {
+            if (!PullMemory(commandBuffer, descriptor.data, dataMipLevels)) {
                 return;
             }
 
-            if (descriptor.mipLevels > 1) {
-                if (!GenerateMipmaps(commandBuffer)) {
+            if (_mipLevels > dataMipLevels) {
+                if (!GenerateMipmaps(commandBuffer, dataMipLevels - 1)) {
                     return;
                 }
             }
@@ -114,8 +122,9 @@ namespace flaw {
         });
     }
 
-    bool VkTexture2D::PullMemory(vk::CommandBuffer& commandBuffer, const uint8_t* data) {
-        int32_t bufferSize = _width * _height * GetSizePerPixel(_format);
+    bool VkTexture2D::PullMemory(vk::CommandBuffer& commandBuffer, const uint8_t* data, uint32_t dataMipLevels) {
+        std::vector<vk::BufferImageCopy> copyRegions;
+        uint64_t bufferSize = GetVkBufferImageCopies(_format, _width, _height, 1, dataMipLevels, copyRegions);
 
 		VkNativeBuffer stagingBuffer = VkNativeBuffer::CreateAsStaging(_context, bufferSize, data);
 
@@ -135,18 +144,7 @@ namespace flaw {
 
         commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), nullptr, nullptr, barrier);
 
-		vk::BufferImageCopy copyRegion;
-		copyRegion.bufferOffset = 0;
-		copyRegion.bufferRowLength = 0;
-		copyRegion.bufferImageHeight = 0;
-		copyRegion.imageSubresource.aspectMask = GetVkImageAspectFlags(_format);
-        copyRegion.imageSubresource.mipLevel = 0;
-		copyRegion.imageSubresource.baseArrayLayer = 0;
-        copyRegion.imageSubresource.layerCount = 1;
-		copyRegion.imageOffset = vk::Offset3D{ 0, 0, 0 };
-		copyRegion.imageExtent = vk::Extent3D{ _width, _height, 1 };
-
-		commandBuffer.copyBufferToImage(stagingBuffer.buffer, _nativeTexture.image, vk::ImageLayout::eTransferDstOptimal, 1, &copyRegion);
+		commandBuffer.copyBufferToImage(stagingBuffer.buffer, _nativeTexture.image, vk::ImageLayout::eTransferDstOptimal, static_cast<uint32_t>(copyRegions.size()), copyRegions.data());
 
         _context.AddDelayedDeletionTasks([&context = _context, stagingBuffer]() {
             context.GetVkDevice().destroyBuffer(stagingBuffer.buffer);
@@ -156,7 +154,7 @@ namespace flaw {
         return true;
     }
 
-    bool VkTexture2D::GenerateMipmaps(vk::CommandBuffer& commandBuffer) {
+    bool VkTexture2D::GenerateMipmaps(vk::CommandBuffer& commandBuffer, uint32_t baseMipLevel) {
         vk::FormatProperties formatProperties;
         _context.GetVkPhysicalDevice().getFormatProperties(ConvertToVkFormat(_format), &formatProperties);
         if (!(formatProperties.optimalTilingFeatures & vk::FormatFeatureFlagBits::eSampledImageFilterLinear)) {
@@ -175,16 +173,16 @@ namespace flaw {
 
         // ʱ :   0 TRANSFER_DST_OPTIMAL TRANSFER_SRC_OPTIMAL ȯ
         //  ´   0 ù °  ҽ Ǳ Դϴ.
-        barrier.subresourceRange.baseMipLevel = 0;
+        barrier.subresourceRange.baseMipLevel = baseMipLevel;
         barrier.subresourceRange.levelCount = 1;
         barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
         barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
         commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, barrier);
 
-        int32_t mipWidth = _width;
-        int32_t mipHeight = _height;
+        int32_t mipWidth = std::max(1u, _width >> baseMipLevel);
+        int32_t mipHeight = std::max(1u, _height >> baseMipLevel);
 
-        for (uint32_t i = 1; i < _mipLevels; ++i) {
+        for (uint32_t i = baseMipLevel + 1; i < _mipLevels; ++i) {
             vk::ImageBlit blitRegion;
             blitRegion.srcOffsets[0] = vk::Offset3D{ 0, 0, 0 };
             blitRegion.srcOffsets[1] = vk::Offset3D{ mipWidth, mipHeight, 1 };
@@ -300,7 +298,7 @@ namespace flaw {
             return;
         }
 
-        uint32_t copySize = min(size, _width * _height * GetSizePerPixel(_format));
+        uint32_t copySize = min(size, static_cast<uint32_t>(GetTextureSize(_format, _width, _height)));
 
         return;
     }
@@ -25,6 +25,14 @@ namespace flaw {
 		, _wrapModeU(descriptor.wrapModeU)
 		, _wrapModeV(descriptor.wrapModeV)
     {
+        const uint32_t dataMipLevels = std::max(1u, std::min(descriptor.dataMipLevels, _mipLevels));
+
+        // NOTE: Block compressed images can not be blit targets, their mip chain has to come with the data
+        if (IsBlockCompressedFormat(_format) && descriptor.data && dataMipLevels < _mipLevels) {
+            Log::Warn("Block compressed texture provides %u of %u mip levels, the rest are dropped", dataMipLevels, _mipLevels);
+            _mipLevels = dataMipLevels;
+        }
+
         vk::ImageCreateInfo imageInfo;
         imageInfo.imageType = vk::ImageType::e2D;
         imageInfo.format = ConvertToVkFormat(_format);
@@ -57,14 +65,14 @@ namespace flaw {
 		vk::CommandBuffer commandBuffer = vkCmdQueue.BeginOneTimeCommands();
 
         if (descriptor.data) {
-            if (!PullMemory(commandBuffer, descriptor.data)) {
+            if (!PullMemory(commandBuffer, descriptor.data, dataMipLevels)) {
                 return;
             }
-        }
 
-        if (descriptor.mipLevels > 1) {
-            if (!GenerateMipmaps(commandBuffer)) {
-                return;
+            if (_mipLevels > dataMipLevels) {
+                if (!GenerateMipmaps(commandBuffer)) {
+                    return;
+                }
             }
         }
 
@@ -84,9 +92,9 @@ namespace flaw {
         });
     }
 
-    bool VkTexture2DArray::PullMemory(vk::CommandBuffer& commandBuffer, const uint8_t* data) {
-        uint32_t bufferSizePerImage = _width * _height * GetSizePerPixel(_format);
-        uint32_t bufferSize = bufferSizePerImage * _layers;
+    bool VkTexture2DArray::PullMemory(vk::CommandBuffer& commandBuffer, const uint8_t* data, uint32_t dataMipLevels) {
+        std::vector<vk::BufferImageCopy> copyRegions;
+        uint64_t bufferSize = GetVkBufferImageCopies(_format, _width, _height, _layers, dataMipLevels, copyRegions);
 
 		auto stagingBuffer = VkNativeBuffer::CreateAsStaging(_context, bufferSize, data);
 
@@ -106,18 +114,7 @@ namespace flaw {
 
         commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), nullptr, nullptr, barrier);
 
-        vk::BufferImageCopy copyRegion;
-        copyRegion.bufferOffset = 0;
-        copyRegion.bufferRowLength = 0;
-        copyRegion.bufferImageHeight = 0;
-        copyRegion.imageSubresource.aspectMask = GetVkImageAspectFlags(_format);
-        copyRegion.imageSubresource.mipLevel = 0;
-        copyRegion.imageSubresource.baseArrayLayer = 0;
-		copyRegion.imageSubresource.layerCount = _layers;
-        copyRegion.imageOffset = vk::Offset3D{ 0, 0, 0 };
-        copyRegion.imageExtent = vk::Extent3D{ _width, _height, 1 };
-
-        commandBuffer.copyBufferToImage(stagingBuffer.buffer, _nativeTexture.image, vk::ImageLayout::eTransferDstOptimal, 1, &copyRegion);
+        commandBuffer.copyBufferToImage(stagingBuffer.buffer, _nativeTexture.image, vk::ImageLayout::eTransferDstOptimal, static_cast<uint32_t>(copyRegions.size()), copyRegions.data());
 
         _context.AddDelayedDeletionTasks([&context = _context, stagingBuffer]() {
             context.GetVkDevice().destroyBuffer(stagingBuffer.buffer);
@@ -25,6 +25,14 @@ namespace flaw {
 		, _wrapModeV(descriptor.wrapModeV)
 		, _wrapModeW(descriptor.wrapModeW)
     {
+        const uint32_t dataMipLevels = std::max(1u, std::min(descriptor.dataMipLevels, _mipLevels));
+
+        // NOTE: Block compressed images can not be blit targets, their mip chain has to come with the data
+        if (IsBlockCompressedFormat(_format) && descriptor.data && dataMipLevels < _mipLevels) {
+            Log::Warn("Block compressed texture provides %u of %u mip levels, the rest are dropped", dataMipLevels, _mipLevels);
+            _mipLevels = dataMipLevels;
+        }
+
         vk::ImageCreateInfo imageInfo;
         imageInfo.flags = vk::ImageCreateFlagBits::eCubeCompatible;
         imageInfo.imageType = vk::ImageType::e2D;
@@ -58,11 +66,11 @@ namespace flaw {
 		vk::CommandBuffer commandBuffer = vkCmdQueue.BeginOneTimeCommands();
 
         if (descriptor.data) {
-            if (!PullMemory(commandBuffer, descriptor.data)) {
+            if (!PullMemory(commandBuffer, descriptor.data, dataMipLevels)) {
                 return;
             }
 
-            if (descriptor.mipLevels > 1) {
+            if (_mipLevels > dataMipLevels) {
                 if (!GenerateMipmaps(commandBuffer)) {
                     return;
                 }
@@ -85,9 +93,9 @@ namespace flaw {
         });
     }
 
-    bool VkTextureCube::PullMemory(vk::CommandBuffer& commandBuffer, const uint8_t* data) {
-        uint32_t bufferSizePerImage = _width * _height * GetSizePerPixel(_format);
-        uint32_t bufferSize = bufferSizePerImage * 6;
+    bool VkTextureCube::PullMemory(vk::CommandBuffer& commandBuffer, const uint8_t* data, uint32_t dataMipLevels) {
+        std::vector<vk::BufferImageCopy> copyRegions;
+        uint64_t bufferSize = GetVkBufferImageCopies(_format, _width, _height, 6, dataMipLevels, copyRegions);
 
 		auto stagingBuffer = VkNativeBuffer::CreateAsStaging(_context, bufferSize, data);
 
@@ -107,18 +115,7 @@ namespace flaw {
 
         commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlags(), nullptr, nullptr, barrier);
 
-        vk::BufferImageCopy copyRegion;
-        copyRegion.bufferOffset = 0;
-        copyRegion.bufferRowLength = 0;
-        copyRegion.bufferImageHeight = 0;
-        copyRegion.imageSubresource.aspectMask = GetVkImageAspectFlags(_format);
-        copyRegion.imageSubresource.mipLevel = 0;
-        copyRegion.imageSubresource.baseArrayLayer = 0;
-        copyRegion.imageSubresource.layerCount = 6;
-        copyRegion.imageOffset = vk::Offset3D{ 0, 0, 0 };
-        copyRegion.imageExtent = vk::Extent3D{ _width, _height, 1 };
-
-        commandBuffer.copyBufferToImage(stagingBuffer.buffer, _nativeTexture.image, vk::ImageLayout::eTransferDstOptimal, 1, &copyRegion);
+        commandBuffer.copyBufferToImage(stagingBuffer.buffer, _nativeTexture.image, vk::ImageLayout::eTransferDstOptimal, static_cast<uint32_t>(copyRegions.size()), copyRegions.data());
 
         _context.AddDelayedDeletionTasks([&context = _context, stagingBuffer]() {
             context.GetVkDevice().destroyBuffer(stagingBuffer.buffer);
@@ -45,8 +45,8 @@ namespace flaw {
 		inline vk::Sampler GetVkSampler() const { return _sampler; }
 
 	private:
-		bool PullMemory(vk::CommandBuffer& commandBuffer, const uint8_t* data);
-		bool GenerateMipmaps(vk::CommandBuffer& commandBuffer);
+		bool PullMemory(vk::CommandBuffer& commandBuffer, const uint8_t* data, uint32_t dataMipLevels);
+		bool GenerateMipmaps(vk::CommandBuffer& commandBuffer, uint32_t baseMipLevel);
 		bool TransitionFinalImageLayout(vk::CommandBuffer& commandBuffer, TextureLayout layout);
 
 		bool CreateImageView();
@@ -99,7 +99,7 @@ namespace flaw {
 		inline vk::Sampler GetVkSampler() const { return _sampler; }
 
 	private:
-		bool PullMemory(vk::CommandBuffer& commandBuffer, const uint8_t* data);
+		bool PullMemory(vk::CommandBuffer& commandBuffer, const uint8_t* data, uint32_t dataMipLevels);
 		bool GenerateMipmaps(vk::CommandBuffer& commandBuffer);
 		bool TransitionFinalImageLayout(vk::CommandBuffer& commandBuffer, TextureLayout layout);
 
@@ -148,7 +148,7 @@ namespace flaw {
 		inline vk::Sampler GetVkSampler() const { return _sampler; }
 
 	private:
-		bool PullMemory(vk::CommandBuffer& commandBuffer, const uint8_t* data);
+		bool PullMemory(vk::CommandBuffer& commandBuffer, const uint8_t* data, uint32_t dataMipLevels);
 		bool GenerateMipmaps(vk::CommandBuffer& commandBuffer);
 		bool TransitionFinalImageLayout(vk::CommandBuffer& commandBuffer, TextureLayout layout);
 
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "Image.h"
 #include "Log/Log.h"
+#include "Utils/AssetPack.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -64,38 +65,18 @@ namespace flaw {
 			_data.resize(_width * _height * desiredChannels * sizeof(float));
 			memcpy(_data.data(), data.data(), _data.size());
 		}
-		else if (_type == Image::Type::Hdr) {
-			float* data = stbi_loadf(filePath, &_width, &_height, &_channels, desiredChannels);
-			if (data == nullptr) {
-				Log::Error("Failed to load HDR image : %s", filePath);
+		else {
+			// NOTE: Read through AssetFiles, from the mounted pack when it has the file, and decoded from memory
+			std::vector<int8_t> fileData;
+			if (!AssetFiles::Read(filePath, fileData)) {
+				Log::Error("Failed to read image : %s", filePath);
 				return;
 			}
 
-			if (desiredChannels != 0) {
-				_channels = desiredChannels;
-			}
-
-			_data.resize(_width * _height * _channels * sizeof(float));
-			memcpy(_data.data(), data, _data.size());
-
-			stbi_image_free(data);
-		}
-		else {
-			uint8_t* data = stbi_load(filePath, &_width, &_height, &_channels, desiredChannels);
-	
-			if (data == nullptr) {
+			*this = Image(_type, reinterpret_cast<const char*>(fileData.data()), fileData.size(), desiredChannels);
+			if (!IsValid()) {
 				Log::Error("Failed to load image : %s", filePath);
-				return;
-			}
-	
-			if (desiredChannels != 0) {
-				_channels = desiredChannels;
 			}
-	
-			_data.resize(_width * _height * _channels);
-			memcpy(_data.data(), data, _data.size());
-	
-			stbi_image_free(data);
 		}
 	}
 
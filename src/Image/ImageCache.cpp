@@ -0,0 +1,216 @@
+#include "pch.h"
+#include "ImageCache.h"
+#include "Log/Log.h"
+#include "Utils/AssetPack.h"
+#include "Utils/ThreadPool.h"
+
+#include <future>
+#include <deque>
+
+namespace flaw {
+	static std::mutex g_imageCacheMutex;
+	static std::unordered_map<std::string, std::shared_future<Ref<Image>>> g_imageCache;
+
+	static std::string MakeImageCacheKey(const std::string& filePath, uint32_t desiredChannels) {
+		std::error_code ec;
+		std::filesystem::path path = std::filesystem::weakly_canonical(filePath, ec);
+
+		std::string key = ec ? std::filesystem::path(filePath).lexically_normal().generic_string() : path.generic_string();
+		key += '#';
+		key += std::to_string(desiredChannels);
+
+		return key;
+	}
+
+	// NOTE: fileData is the file read ahead of the decode, nullptr reads it here
+	static Ref<Image> GetOrDecode(const std::string& filePath, uint32_t desiredChannels, const std::vector<int8_t>* fileData) {
+		const std::string key = MakeImageCacheKey(filePath, desiredChannels);
+
+		std::promise<Ref<Image>> promise;
+		std::shared_future<Ref<Image>> future;
+		bool decodeHere = false;
+
+		{
+			std::lock_guard<std::mutex> lock(g_imageCacheMutex);
+
+			auto it = g_imageCache.find(key);
+			if (it != g_imageCache.end()) {
+				future = it->second;
+			}
+			else {
+				future = promise.get_future().share();
+				g_imageCache[key] = future;
+				decodeHere = true;
+			}
+		}
+
+		if (!decodeHere) {
+			return future.get();
+		}
+
+		// NOTE: Waiters block on the future, so it must be fulfilled even if the decoder throws
+		Ref<Image> image;
+		try {
+			if (fileData) {
+				image = CreateRef<Image>(Image::GetImageTypeFromExtension(filePath.c_str()), reinterpret_cast<const char*>(fileData->data()), fileData->size(), desiredChannels);
+				if (!image->IsValid()) {
+					Log::Error("Failed to load image : %s", filePath.c_str());
+				}
+			}
+			else {
+				image = CreateRef<Image>(filePath.c_str(), desiredChannels);
+			}
+		}
+		catch (const std::exception& e) {
+			Log::Error("Failed to decode image %s: %s", filePath.c_str(), e.what());
+		}
+
+		if (image && !image->IsValid()) {
+			image.reset();
+		}
+
+		promise.set_value(image);
+
+		return image;
+	}
+
+	Ref<Image> ImageCache::GetOrLoad(const std::string& filePath, uint32_t desiredChannels) {
+		return GetOrDecode(filePath, desiredChannels, nullptr);
+	}
+
+	struct PendingImageDecode {
+		std::string filePath;
+		std::vector<int8_t> data;
+		bool read = false;
+	};
+
+	// NOTE: Shared with the pool tasks, which may only start after LoadAll has returned
+	struct ImageDecodeBatch {
+		uint32_t desiredChannels = 0;
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::deque<PendingImageDecode> pending;
+		int32_t activeDecodes = 0;
+		bool readsDone = false;
+	};
+
+	// NOTE: Decodes until the batch is drained, waitForReads keeps it waiting on reads still in flight
+	static void DecodeBatch(ImageDecodeBatch& batch, bool waitForReads) {
+		while (true) {
+			PendingImageDecode decode;
+			{
+				std::unique_lock<std::mutex> lock(batch.mutex);
+				if (waitForReads) {
+					batch.condition.wait(lock, [&]() { return batch.readsDone || !batch.pending.empty(); });
+				}
+
+				if (batch.pending.empty()) {
+					return;
+				}
+
+				decode = std::move(batch.pending.front());
+				batch.pending.pop_front();
+				batch.activeDecodes++;
+			}
+
+			// NOTE: A failed read decodes from the path, which reports why
+			GetOrDecode(decode.filePath, batch.desiredChannels, decode.read ? &decode.data : nullptr);
+
+			{
+				std::lock_guard<std::mutex> lock(batch.mutex);
+				batch.activeDecodes--;
+			}
+			batch.condition.notify_all();
+		}
+	}
+
+	void ImageCache::LoadAll(const std::vector<std::string>& filePaths, uint32_t desiredChannels, ThreadPool* pool) {
+		auto batch = CreateRef<ImageDecodeBatch>();
+		batch->desiredChannels = desiredChannels;
+
+		// NOTE: Only files not cached yet are read, each once. EXR files are decoded from their path by the decoders.
+		std::vector<std::string> readPaths;
+		{
+			std::lock_guard<std::mutex> lock(g_imageCacheMutex);
+
+			std::unordered_set<std::string> keys;
+			for (const auto& filePath : filePaths) {
+				const std::string key = MakeImageCacheKey(filePath, desiredChannels);
+				if (g_imageCache.find(key) != g_imageCache.end() || !keys.insert(key).second) {
+					continue;
+				}
+
+				if (Image::GetImageTypeFromExtension(filePath.c_str()) == Image::Type::Exr) {
+					batch->pending.push_back({ filePath });
+				}
+				else {
+					readPaths.push_back(filePath);
+				}
+			}
+		}
+
+		const int32_t decodeCount = static_cast<int32_t>(batch->pending.size() + readPaths.size());
+		if (decodeCount == 0) {
+			return;
+		}
+
+		// NOTE: The pool only helps, the calling thread decodes as well and never waits on a task that has not started.
+		// Model loads run on the same pool, so waiting on queued tasks from one of its workers could deadlock it.
+		if (pool) {
+			const int32_t helperCount = std::min(pool->GetThreadCount(), decodeCount - 1);
+			for (int32_t i = 0; i < helperCount; ++i) {
+				pool->EnqueueTask([batch]() { DecodeBatch(*batch, true); });
+			}
+		}
+
+		// NOTE: The files are read in one batch and each is decoded as soon as its read completes
+		AssetFiles::ReadBatch(readPaths, [&](size_t index, std::vector<int8_t>& data, bool read) {
+			{
+				std::lock_guard<std::mutex> lock(batch->mutex);
+				batch->pending.push_back({ readPaths[index], std::move(data), read });
+			}
+			batch->condition.notify_one();
+		});
+
+		{
+			std::lock_guard<std::mutex> lock(batch->mutex);
+			batch->readsDone = true;
+		}
+		batch->condition.notify_all();
+
+		DecodeBatch(*batch, false);
+
+		// NOTE: Decodes the helpers already took are finished before returning, every file is cached by then
+		std::unique_lock<std::mutex> lock(batch->mutex);
+		batch->condition.wait(lock, [&]() { return batch->activeDecodes == 0; });
+	}
+
+	void ImageCache::Invalidate(const std::string& filePath) {
+		std::lock_guard<std::mutex> lock(g_imageCacheMutex);
+		for (uint32_t desiredChannels = 0; desiredChannels <= 4; ++desiredChannels) {
+			g_imageCache.erase(MakeImageCacheKey(filePath, desiredChannels));
+		}
+	}
+
+	void ImageCache::Clear() {
+		std::lock_guard<std::mutex> lock(g_imageCacheMutex);
+		g_imageCache.clear();
+	}
+
+	uint64_t ImageCache::GetMemoryUsage() {
+		std::lock_guard<std::mutex> lock(g_imageCacheMutex);
+
+		uint64_t size = 0;
+		for (const auto& [key, future] : g_imageCache) {
+			if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+				continue;
+			}
+
+			if (const Ref<Image>& image = future.get()) {
+				size += image->Data().size();
+			}
+		}
+
+		return size;
+	}
+}
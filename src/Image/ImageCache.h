@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Core.h"
+#include "Image.h"
+
+#include <string>
+
+namespace flaw {
+	class ThreadPool;
+
+	// NOTE: Process-wide cache of decoded images keyed by file path and channel count.
+	// Concurrent requests for the same file wait for the first decode instead of decoding it again.
+	class ImageCache {
+	public:
+		// NOTE: Returns nullptr if the file could not be decoded, the failure is cached as well
+		static Ref<Image> GetOrLoad(const std::string& filePath, uint32_t desiredChannels);
+
+		// NOTE: Reads the given files in one batch through AssetFiles and decodes them as their reads complete, on the calling
+		// thread and on the workers of pool when one is given. Safe to call from a worker of pool.
+		static void LoadAll(const std::vector<std::string>& filePaths, uint32_t desiredChannels, ThreadPool* pool = nullptr);
+
+		// NOTE: Drops every cached decode of the file so the next GetOrLoad reads it again
+		static void Invalidate(const std::string& filePath);
+
+		static void Clear();
+
+		static uint64_t GetMemoryUsage();
+	};
+}
@@ -0,0 +1,450 @@
+#include "pch.h"
+#include "MipGenerator.h"
+#include "Graphics/GraphicsFunc.h"
+#include "Log/Log.h"
+#include "Utils/ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAW_MIPGEN_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace flaw {
+	constexpr float KaiserAlpha = 4.0f;
+	constexpr float KaiserHalfWidth = 1.5f; // in destination texels
+	constexpr int32_t KaiserTapCount = 6;
+	constexpr uint32_t SrgbEncodeTableSize = 65536;
+
+	// NOTE: Source rows or columns feeding one destination texel, offsets are relative to 2 * x
+	struct MipKernel {
+		int32_t tapCount = 0;
+		int32_t firstOffset = 0;
+		float weights[KaiserTapCount] = {};
+	};
+
+#if FLAW_MIPGEN_SSE2
+	using Texel = __m128;
+
+	static inline Texel TexelZero() { return _mm_setzero_ps(); }
+	static inline Texel TexelLoad(const float* p) { return _mm_loadu_ps(p); }
+	static inline void TexelStore(float* p, Texel v) { _mm_storeu_ps(p, v); }
+	static inline Texel TexelMulAdd(Texel acc, Texel v, float w) { return _mm_add_ps(acc, _mm_mul_ps(v, _mm_set1_ps(w))); }
+	static inline Texel TexelClamp01(Texel v) { return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f)); }
+#else
+	struct Texel { float v[4]; };
+
+	static inline Texel TexelZero() { return Texel{ { 0.0f, 0.0f, 0.0f, 0.0f } }; }
+	static inline Texel TexelLoad(const float* p) { return Texel{ { p[0], p[1], p[2], p[3] } }; }
+	static inline void TexelStore(float* p, Texel v) { std::memcpy(p, v.v, sizeof(v.v)); }
+	static inline Texel TexelMulAdd(Texel acc, Texel v, float w) {
+		for (int32_t c = 0; c < 4; ++c) {
+			acc.v[c] += v.v[c] * w;
+		}
+		return acc;
+	}
+	static inline Texel TexelClamp01(Texel v) {
+		for (int32_t c = 0; c < 4; ++c) {
+			v.v[c] = std::min(std::max(v.v[c], 0.0f), 1.0f);
+		}
+		return v;
+	}
+#endif
+
+	static float SrgbToLinear(float value) {
+		return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+	}
+
+	static const float* GetSrgbDecodeTable() {
+		static const std::vector<float> table = []() {
+			std::vector<float> result(256);
+			for (uint32_t i = 0; i < 256; ++i) {
+				result[i] = SrgbToLinear(i / 255.0f);
+			}
+			return result;
+		}();
+
+		return table.data();
+	}
+
+	// NOTE: Indexed by linear * (SrgbEncodeTableSize - 1). Built from the decision points between neighbouring sRGB codes,
+	// so a lookup rounds to the nearest code in linear space.
+	static const uint8_t* GetSrgbEncodeTable() {
+		static const std::vector<uint8_t> table = []() {
+			std::vector<uint8_t> result(SrgbEncodeTableSize);
+
+			uint32_t code = 0;
+			for (uint32_t i = 0; i < SrgbEncodeTableSize; ++i) {
+				const float linear = i / static_cast<float>(SrgbEncodeTableSize - 1);
+				while (code < 255 && linear > 0.5f * (SrgbToLinear(code / 255.0f) + SrgbToLinear((code + 1) / 255.0f))) {
+					code++;
+				}
+				result[i] = static_cast<uint8_t>(code);
+			}
+
+			return result;
+		}();
+
+		return table.data();
+	}
+
+	static double BesselI0(double x) {
+		double sum = 1.0, term = 1.0;
+		for (int32_t k = 1; k < 32; ++k) {
+			term *= (x / (2.0 * k)) * (x / (2.0 * k));
+			sum += term;
+			if (term < sum * 1e-12) {
+				break;
+			}
+		}
+		return sum;
+	}
+
+	static MipKernel CreateKernel(MipFilter filter) {
+		MipKernel kernel;
+
+		if (filter == MipFilter::Box) {
+			kernel.tapCount = 2;
+			kernel.firstOffset = 0;
+			kernel.weights[0] = kernel.weights[1] = 0.5f;
+			return kernel;
+		}
+
+		// NOTE: Destination texel x is centered on source coordinate 2x + 1, taps sit at source texel centers 2x - 2 .. 2x + 3
+		kernel.tapCount = KaiserTapCount;
+		kernel.firstOffset = -2;
+
+		const double pi = 3.14159265358979323846;
+		const double normalization = BesselI0(KaiserAlpha);
+
+		double sum = 0.0;
+		double weights[KaiserTapCount];
+		for (int32_t i = 0; i < KaiserTapCount; ++i) {
+			const double t = (kernel.firstOffset + i + 0.5 - 1.0) * 0.5;
+			const double sinc = t == 0.0 ? 1.0 : std::sin(pi * t) / (pi * t);
+			const double x = t / KaiserHalfWidth;
+			const double window = BesselI0(KaiserAlpha * std::sqrt(std::max(0.0, 1.0 - x * x))) / normalization;
+
+			weights[i] = sinc * window;
+			sum += weights[i];
+		}
+
+		for (int32_t i = 0; i < KaiserTapCount; ++i) {
+			kernel.weights[i] = static_cast<float>(weights[i] / sum);
+		}
+
+		return kernel;
+	}
+
+	// NOTE: Source index of every tap for every destination index, edges resolved once here instead of in the inner loops
+	static void BuildTapIndices(const MipKernel& kernel, uint32_t sourceSize, uint32_t destSize, bool wrap, std::vector<uint32_t>& outIndices) {
+		outIndices.resize(static_cast<size_t>(destSize) * kernel.tapCount);
+
+		const int32_t size = static_cast<int32_t>(sourceSize);
+		for (uint32_t x = 0; x < destSize; ++x) {
+			for (int32_t tap = 0; tap < kernel.tapCount; ++tap) {
+				int32_t index = static_cast<int32_t>(x * 2) + kernel.firstOffset + tap;
+				index = wrap ? ((index % size) + size) % size : std::min(std::max(index, 0), size - 1);
+				outIndices[x * kernel.tapCount + tap] = static_cast<uint32_t>(index);
+			}
+		}
+	}
+
+	// NOTE: Level 0 is read straight from the 8 bit source and linearized row by row, later levels are float
+	struct MipSourceLevel {
+		const uint8_t* rgba = nullptr;
+		const float* texels = nullptr;
+		uint32_t width = 0;
+		uint32_t height = 0;
+	};
+
+	struct MipLevelParams {
+		const MipKernel* kernel = nullptr;
+		bool wrap = true;
+		bool srgb = false;
+		bool normalMap = false;
+		ThreadPool* pool = nullptr;
+		uint8_t* quantizedOutput = nullptr; // written while filtering unless alpha still has to be rescaled
+	};
+
+	static const float* LoadSourceRow(const MipSourceLevel& source, uint32_t y, bool srgb, float* scratch) {
+		if (source.texels) {
+			return source.texels + static_cast<size_t>(y) * source.width * 4;
+		}
+
+		const float* decodeTable = GetSrgbDecodeTable();
+		const uint8_t* row = source.rgba + static_cast<size_t>(y) * source.width * 4;
+
+		for (uint32_t i = 0; i < source.width * 4; i += 4) {
+			for (uint32_t c = 0; c < 3; ++c) {
+				scratch[i + c] = srgb ? decodeTable[row[i + c]] : row[i + c] * (1.0f / 255.0f);
+			}
+			scratch[i + 3] = row[i + 3] * (1.0f / 255.0f);
+		}
+
+		return scratch;
+	}
+
+	static void FilterRow(const float* row, uint32_t width, uint32_t destWidth, const MipKernel& kernel, const std::vector<uint32_t>& taps, float* outRow) {
+		if (width == destWidth) {
+			std::memcpy(outRow, row, static_cast<size_t>(width) * 4 * sizeof(float));
+			return;
+		}
+
+		for (uint32_t x = 0; x < destWidth; ++x) {
+			const uint32_t* texelTaps = taps.data() + x * kernel.tapCount;
+
+			Texel sum = TexelZero();
+			for (int32_t tap = 0; tap < kernel.tapCount; ++tap) {
+				sum = TexelMulAdd(sum, TexelLoad(row + texelTaps[tap] * 4), kernel.weights[tap]);
+			}
+
+			TexelStore(outRow + x * 4, sum);
+		}
+	}
+
+	static void RenormalizeNormals(float* texels, uint32_t count) {
+		for (uint32_t i = 0; i < count * 4; i += 4) {
+			float* texel = texels + i;
+
+			const float x = texel[0] * 2.0f - 1.0f;
+			const float y = texel[1] * 2.0f - 1.0f;
+			const float z = texel[2] * 2.0f - 1.0f;
+			const float lengthSq = x * x + y * y + z * z;
+
+			// NOTE: Opposing normals can cancel out completely, such texels fall back to the surface normal
+			if (lengthSq < 1e-12f) {
+				texel[0] = 0.5f;
+				texel[1] = 0.5f;
+				texel[2] = 1.0f;
+				continue;
+			}
+
+			const float invLength = 1.0f / std::sqrt(lengthSq);
+			texel[0] = x * invLength * 0.5f + 0.5f;
+			texel[1] = y * invLength * 0.5f + 0.5f;
+			texel[2] = z * invLength * 0.5f + 0.5f;
+		}
+	}
+
+	static void QuantizeRow(const float* texels, uint32_t count, bool srgb, float alphaScale, uint8_t* outRgba) {
+		const uint8_t* encodeTable = GetSrgbEncodeTable();
+
+		for (uint32_t i = 0; i < count * 4; i += 4) {
+			for (uint32_t c = 0; c < 3; ++c) {
+				const float value = texels[i + c];
+				outRgba[i + c] = srgb
+					? encodeTable[static_cast<uint32_t>(value * (SrgbEncodeTableSize - 1) + 0.5f)]
+					: static_cast<uint8_t>(value * 255.0f + 0.5f);
+			}
+
+			const float alpha = std::min(texels[i + 3] * alphaScale, 1.0f);
+			outRgba[i + 3] = static_cast<uint8_t>(alpha * 255.0f + 0.5f);
+		}
+	}
+
+	// NOTE: Separable downsample in bands of destination rows. Each band filters the source rows it needs horizontally into
+	// a small buffer and then vertically into the destination, so no full size intermediate image is ever written and level 0
+	// is never expanded to float as a whole. Rows shared by two bands are filtered twice, a few percent of the work.
+	static void DownsampleLevel(const MipSourceLevel& source, const MipLevelParams& params, std::vector<float>& outLevel) {
+		constexpr uint32_t BandRows = 16;
+
+		const MipKernel& kernel = *params.kernel;
+
+		const uint32_t width = source.width;
+		const uint32_t height = source.height;
+		const uint32_t destWidth = std::max(1u, width / 2);
+		const uint32_t destHeight = std::max(1u, height / 2);
+
+		std::vector<uint32_t> columnTaps, rowTaps;
+		BuildTapIndices(kernel, width, destWidth, params.wrap, columnTaps);
+		BuildTapIndices(kernel, height, destHeight, params.wrap, rowTaps);
+
+		outLevel.resize(static_cast<size_t>(destWidth) * destHeight * 4);
+
+		const uint32_t bandCount = (destHeight + BandRows - 1) / BandRows;
+
+		ThreadPool::ParallelFor(params.pool, bandCount, [&](uint32_t band) {
+			const uint32_t firstRow = band * BandRows;
+			const uint32_t lastRow = std::min(firstRow + BandRows, destHeight);
+
+			// NOTE: Source rows referenced by this band, in first use order. With wrapping they are not one contiguous range.
+			std::vector<uint32_t> sourceRows;
+			if (height == destHeight) {
+				for (uint32_t y = firstRow; y < lastRow; ++y) {
+					sourceRows.push_back(y);
+				}
+			}
+			else {
+				for (uint32_t y = firstRow; y < lastRow; ++y) {
+					for (int32_t tap = 0; tap < kernel.tapCount; ++tap) {
+						const uint32_t row = rowTaps[y * kernel.tapCount + tap];
+						if (std::find(sourceRows.begin(), sourceRows.end(), row) == sourceRows.end()) {
+							sourceRows.push_back(row);
+						}
+					}
+				}
+			}
+
+			std::vector<float> scratch(source.texels ? 0 : static_cast<size_t>(width) * 4);
+			std::vector<float> filteredRows(sourceRows.size() * destWidth * 4);
+
+			for (size_t i = 0; i < sourceRows.size(); ++i) {
+				const float* row = LoadSourceRow(source, sourceRows[i], params.srgb, scratch.data());
+				FilterRow(row, width, destWidth, kernel, columnTaps, filteredRows.data() + i * destWidth * 4);
+			}
+
+			auto getFilteredRow = [&](uint32_t row) {
+				const size_t slot = std::find(sourceRows.begin(), sourceRows.end(), row) - sourceRows.begin();
+				return filteredRows.data() + slot * destWidth * 4;
+			};
+
+			for (uint32_t y = firstRow; y < lastRow; ++y) {
+				float* destRow = outLevel.data() + static_cast<size_t>(y) * destWidth * 4;
+
+				if (height == destHeight) {
+					const float* row = getFilteredRow(y);
+					for (uint32_t x = 0; x < destWidth; ++x) {
+						TexelStore(destRow + x * 4, TexelClamp01(TexelLoad(row + x * 4)));
+					}
+				}
+				else {
+					const float* rows[KaiserTapCount];
+					for (int32_t tap = 0; tap < kernel.tapCount; ++tap) {
+						rows[tap] = getFilteredRow(rowTaps[y * kernel.tapCount + tap]);
+					}
+
+					for (uint32_t x = 0; x < destWidth; ++x) {
+						Texel sum = TexelZero();
+						for (int32_t tap = 0; tap < kernel.tapCount; ++tap) {
+							sum = TexelMulAdd(sum, TexelLoad(rows[tap] + x * 4), kernel.weights[tap]);
+						}
+
+						TexelStore(destRow + x * 4, TexelClamp01(sum));
+					}
+				}
+
+				if (params.normalMap) {
+					RenormalizeNormals(destRow, destWidth);
+				}
+
+				if (params.quantizedOutput) {
+					QuantizeRow(destRow, destWidth, params.srgb, 1.0f, params.quantizedOutput + static_cast<size_t>(y) * destWidth * 4);
+				}
+			}
+		});
+	}
+
+	// NOTE: Scale that makes the same fraction of texels pass the alpha test as in level 0. The texel at the target rank
+	// is mapped onto the cutoff, so the scaled coverage matches up to ties.
+	static float FindAlphaScale(const std::vector<float>& level, float alphaCutoff, float targetCoverage) {
+		const size_t texelCount = level.size() / 4;
+		const size_t passCount = static_cast<size_t>(std::lround(targetCoverage * texelCount));
+
+		if (passCount == 0 || passCount >= texelCount) {
+			return 1.0f;
+		}
+
+		std::vector<float> alphas(texelCount);
+		for (size_t i = 0; i < texelCount; ++i) {
+			alphas[i] = level[i * 4 + 3];
+		}
+
+		// NOTE: passCount texels have an alpha of at least the one at rank passCount - 1 in descending order
+		std::nth_element(alphas.begin(), alphas.begin() + (passCount - 1), alphas.end(), std::greater<float>());
+		const float threshold = alphas[passCount - 1];
+
+		if (threshold <= 0.0f) {
+			return 1.0f;
+		}
+
+		return alphaCutoff / threshold;
+	}
+
+	uint32_t MipGenerator::GetFullMipLevels(uint32_t width, uint32_t height) {
+		return GetMaxMipLevels(width, height) + 1;
+	}
+
+	bool MipGenerator::Generate(const uint8_t* rgba, uint32_t width, uint32_t height, const MipGenerationDesc& desc, MipChain& outChain) {
+		if (!rgba || width == 0 || height == 0) {
+			Log::Error("MipGenerator: empty source image");
+			return false;
+		}
+
+		const uint32_t fullMipLevels = GetFullMipLevels(width, height);
+		const size_t baseSize = static_cast<size_t>(width) * height * 4;
+
+		outChain.width = width;
+		outChain.height = height;
+		outChain.mipLevels = desc.maxMipLevels == 0 ? fullMipLevels : std::min(desc.maxMipLevels, fullMipLevels);
+
+		// NOTE: Level 0 is copied as is
+		outChain.data.assign(rgba, rgba + baseSize);
+		outChain.data.resize(GetMipChainSize(PixelFormat::RGBA8Unorm, width, height, outChain.mipLevels));
+
+		const MipKernel kernel = CreateKernel(desc.filter);
+		const float coverage = desc.preserveAlphaCoverage ? ComputeAlphaCoverage(rgba, width, height, desc.alphaCutoff) : 0.0f;
+
+		MipLevelParams params;
+		params.kernel = &kernel;
+		params.wrap = desc.wrap;
+		params.srgb = desc.srgb && !desc.normalMap;
+		params.normalMap = desc.normalMap;
+		params.pool = desc.pool;
+
+		MipSourceLevel source;
+		source.rgba = outChain.data.data();
+		source.width = width;
+		source.height = height;
+
+		std::vector<float> level, nextLevel;
+		size_t outputOffset = baseSize;
+
+		for (uint32_t mip = 1; mip < outChain.mipLevels; ++mip) {
+			const uint32_t levelWidth = std::max(1u, source.width / 2);
+			const uint32_t levelHeight = std::max(1u, source.height / 2);
+			uint8_t* output = outChain.data.data() + outputOffset;
+
+			params.quantizedOutput = desc.preserveAlphaCoverage ? nullptr : output;
+			DownsampleLevel(source, params, nextLevel);
+			level.swap(nextLevel);
+
+			// NOTE: The scale only touches the stored level, the next level is filtered from unscaled alpha
+			if (desc.preserveAlphaCoverage) {
+				const float alphaScale = FindAlphaScale(level, desc.alphaCutoff, coverage);
+				ThreadPool::ParallelFor(desc.pool, levelHeight, [&](uint32_t y) {
+					const size_t offset = static_cast<size_t>(y) * levelWidth * 4;
+					QuantizeRow(level.data() + offset, levelWidth, params.srgb, alphaScale, output + offset);
+				});
+			}
+
+			source.rgba = nullptr;
+			source.texels = level.data();
+			source.width = levelWidth;
+			source.height = levelHeight;
+
+			outputOffset += static_cast<size_t>(levelWidth) * levelHeight * 4;
+		}
+
+		return true;
+	}
+
+	float MipGenerator::ComputeAlphaCoverage(const uint8_t* rgba, uint32_t width, uint32_t height, float alphaCutoff, float alphaScale) {
+		const uint64_t texelCount = static_cast<uint64_t>(width) * height;
+		if (texelCount == 0) {
+			return 0.0f;
+		}
+
+		uint64_t passCount = 0;
+		for (uint64_t i = 0; i < texelCount; ++i) {
+			if (rgba[i * 4 + 3] / 255.0f * alphaScale >= alphaCutoff) {
+				passCount++;
+			}
+		}
+
+		return static_cast<float>(static_cast<double>(passCount) / texelCount);
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Core.h"
+
+#include <vector>
+
+namespace flaw {
+	class ThreadPool;
+
+	enum class MipFilter {
+		Box,    // 2x2 average
+		Kaiser, // 6 tap windowed sinc, sharper distant mips at a small ringing cost
+	};
+
+	struct MipGenerationDesc {
+		MipFilter filter = MipFilter::Kaiser;
+		bool srgb = false;          // RGB is filtered in linear space, alpha is always linear
+		bool normalMap = false;     // RGB holds a [0, 1] encoded unit vector, renormalized on every level
+		bool wrap = true;           // filter taps wrap around the edges for tiling textures, clamp otherwise
+		bool preserveAlphaCoverage = false;
+		float alphaCutoff = 0.5f;   // alpha test reference the coverage of level 0 is measured at
+		uint32_t maxMipLevels = 0;  // 0 means the full chain down to 1x1
+		ThreadPool* pool = nullptr; // helps filter the rows, nullptr or a call from a pool worker filters on the calling thread
+	};
+
+	struct MipChain {
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipLevels = 0;
+		std::vector<uint8_t> data; // 8 bit RGBA, levels packed back to back from level 0
+	};
+
+	// NOTE: CPU mip chain generator for 8 bit RGBA images. Levels are filtered from the previous level in 32 bit float,
+	// one texel per SSE register, and quantized once, so rounding does not accumulate down the chain.
+	class MipGenerator {
+	public:
+		static bool Generate(const uint8_t* rgba, uint32_t width, uint32_t height, const MipGenerationDesc& desc, MipChain& outChain);
+
+		// NOTE: Fraction of texels whose alpha, scaled by alphaScale, passes an alpha test against alphaCutoff
+		static float ComputeAlphaCoverage(const uint8_t* rgba, uint32_t width, uint32_t height, float alphaCutoff, float alphaScale = 1.0f);
+
+		static uint32_t GetFullMipLevels(uint32_t width, uint32_t height);
+	};
+}
@@ -0,0 +1,785 @@
+#include "pch.h"
+#include "TextureCompressor.h"
+#include "MipGenerator.h"
+#include "Graphics/GraphicsFunc.h"
+#include "Log/Log.h"
+#include "Utils/ThreadPool.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace flaw {
+	using BlockTexels = uint8_t[16][4];
+
+	constexpr uint32_t BC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	struct BlockBitWriter {
+		uint8_t* bytes;
+		uint32_t position = 0;
+
+		void Write(uint32_t value, uint32_t count) {
+			for (uint32_t i = 0; i < count; ++i, ++position) {
+				if ((value >> i) & 1) {
+					bytes[position >> 3] |= static_cast<uint8_t>(1 << (position & 7));
+				}
+			}
+		}
+	};
+
+	struct BlockBitReader {
+		const uint8_t* bytes;
+		uint32_t position = 0;
+
+		uint32_t Read(uint32_t count) {
+			uint32_t value = 0;
+			for (uint32_t i = 0; i < count; ++i, ++position) {
+				value |= static_cast<uint32_t>((bytes[position >> 3] >> (position & 7)) & 1) << i;
+			}
+			return value;
+		}
+	};
+
+	// NOTE: Texels outside the image repeat the last row and column, so partial blocks do not pull the endpoints toward black
+	static void LoadBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, BlockTexels& outTexels) {
+		for (uint32_t y = 0; y < 4; ++y) {
+			const uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+			for (uint32_t x = 0; x < 4; ++x) {
+				const uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+				std::memcpy(outTexels[y * 4 + x], rgba + (static_cast<uint64_t>(sourceY) * width + sourceX) * 4, 4);
+			}
+		}
+	}
+
+	static void StoreBlock(const BlockTexels& texels, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, uint8_t* rgba) {
+		for (uint32_t y = 0; y < 4 && blockY * 4 + y < height; ++y) {
+			for (uint32_t x = 0; x < 4 && blockX * 4 + x < width; ++x) {
+				std::memcpy(rgba + (static_cast<uint64_t>(blockY * 4 + y) * width + blockX * 4 + x) * 4, texels[y * 4 + x], 4);
+			}
+		}
+	}
+
+	// NOTE: Principal axis of the first N channels by power iteration, started from the covariance row with the largest variance
+	template <uint32_t N>
+	static void ComputePrincipalAxis(const BlockTexels& texels, float (&outMean)[N], float (&outAxis)[N]) {
+		for (uint32_t c = 0; c < N; ++c) {
+			float sum = 0.0f;
+			for (uint32_t i = 0; i < 16; ++i) {
+				sum += texels[i][c];
+			}
+			outMean[c] = sum / 16.0f;
+		}
+
+		float covariance[N][N] = {};
+		for (uint32_t i = 0; i < 16; ++i) {
+			float delta[N];
+			for (uint32_t c = 0; c < N; ++c) {
+				delta[c] = texels[i][c] - outMean[c];
+			}
+
+			for (uint32_t r = 0; r < N; ++r) {
+				for (uint32_t c = 0; c < N; ++c) {
+					covariance[r][c] += delta[r] * delta[c];
+				}
+			}
+		}
+
+		uint32_t largest = 0;
+		for (uint32_t c = 1; c < N; ++c) {
+			if (covariance[c][c] > covariance[largest][largest]) {
+				largest = c;
+			}
+		}
+
+		for (uint32_t c = 0; c < N; ++c) {
+			outAxis[c] = covariance[largest][c];
+		}
+
+		for (uint32_t iteration = 0; iteration < 8; ++iteration) {
+			float next[N] = {};
+			for (uint32_t r = 0; r < N; ++r) {
+				for (uint32_t c = 0; c < N; ++c) {
+					next[r] += covariance[r][c] * outAxis[c];
+				}
+			}
+
+			float maxComponent = 0.0f;
+			for (uint32_t c = 0; c < N; ++c) {
+				maxComponent = std::max(maxComponent, std::abs(next[c]));
+			}
+
+			if (maxComponent == 0.0f) {
+				break;
+			}
+
+			for (uint32_t c = 0; c < N; ++c) {
+				outAxis[c] = next[c] / maxComponent;
+			}
+		}
+
+		float length = 0.0f;
+		for (uint32_t c = 0; c < N; ++c) {
+			length += outAxis[c] * outAxis[c];
+		}
+
+		length = std::sqrt(length);
+		for (uint32_t c = 0; c < N; ++c) {
+			outAxis[c] = length > 0.0f ? outAxis[c] / length : 0.0f;
+		}
+	}
+
+	// NOTE: Block colors projected onto the principal axis, the extremes become the endpoints
+	template <uint32_t N>
+	static void ComputeAxisEndpoints(const BlockTexels& texels, float (&outLow)[N], float (&outHigh)[N]) {
+		float mean[N], axis[N];
+		ComputePrincipalAxis<N>(texels, mean, axis);
+
+		float minT = std::numeric_limits<float>::max();
+		float maxT = std::numeric_limits<float>::lowest();
+
+		for (uint32_t i = 0; i < 16; ++i) {
+			float t = 0.0f;
+			for (uint32_t c = 0; c < N; ++c) {
+				t += (texels[i][c] - mean[c]) * axis[c];
+			}
+
+			minT = std::min(minT, t);
+			maxT = std::max(maxT, t);
+		}
+
+		for (uint32_t c = 0; c < N; ++c) {
+			outLow[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+			outHigh[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+		}
+	}
+
+	// NOTE: Least squares endpoints for fixed per texel weights of the first endpoint, false if the system is degenerate
+	template <uint32_t N>
+	static bool SolveEndpoints(const BlockTexels& texels, const float (&weights)[16], float (&outFirst)[N], float (&outSecond)[N]) {
+		float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+		float ax[N] = {}, bx[N] = {};
+
+		for (uint32_t i = 0; i < 16; ++i) {
+			const float a = weights[i];
+			const float b = 1.0f - a;
+
+			aa += a * a;
+			bb += b * b;
+			ab += a * b;
+
+			for (uint32_t c = 0; c < N; ++c) {
+				ax[c] += a * texels[i][c];
+				bx[c] += b * texels[i][c];
+			}
+		}
+
+		const float determinant = aa * bb - ab * ab;
+		if (std::abs(determinant) < 1e-6f) {
+			return false;
+		}
+
+		for (uint32_t c = 0; c < N; ++c) {
+			outFirst[c] = std::clamp((ax[c] * bb - bx[c] * ab) / determinant, 0.0f, 255.0f);
+			outSecond[c] = std::clamp((bx[c] * aa - ax[c] * ab) / determinant, 0.0f, 255.0f);
+		}
+
+		return true;
+	}
+
+	static uint16_t PackRGB565(const float (&color)[3]) {
+		const uint32_t r = static_cast<uint32_t>(color[0] * 31.0f / 255.0f + 0.5f);
+		const uint32_t g = static_cast<uint32_t>(color[1] * 63.0f / 255.0f + 0.5f);
+		const uint32_t b = static_cast<uint32_t>(color[2] * 31.0f / 255.0f + 0.5f);
+		return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+	}
+
+	static void UnpackRGB565(uint16_t packed, int32_t* outColor) {
+		const int32_t r = (packed >> 11) & 31;
+		const int32_t g = (packed >> 5) & 63;
+		const int32_t b = packed & 31;
+		outColor[0] = (r << 3) | (r >> 2);
+		outColor[1] = (g << 2) | (g >> 4);
+		outColor[2] = (b << 3) | (b >> 2);
+	}
+
+	// NOTE: Always the 4 color mode (color0 > color1), which is also the only mode inside BC3
+	static uint32_t FitBC1Indices(const BlockTexels& texels, uint16_t& color0, uint16_t& color1, uint32_t& outIndices) {
+		if (color0 < color1) {
+			std::swap(color0, color1);
+		}
+
+		int32_t palette[4][3];
+		UnpackRGB565(color0, palette[0]);
+		UnpackRGB565(color1, palette[1]);
+		for (uint32_t c = 0; c < 3; ++c) {
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		const uint32_t paletteSize = color0 == color1 ? 1 : 4;
+
+		uint32_t error = 0;
+		outIndices = 0;
+
+		for (uint32_t i = 0; i < 16; ++i) {
+			uint32_t bestIndex = 0;
+			uint32_t bestError = std::numeric_limits<uint32_t>::max();
+
+			for (uint32_t p = 0; p < paletteSize; ++p) {
+				uint32_t distance = 0;
+				for (uint32_t c = 0; c < 3; ++c) {
+					const int32_t delta = texels[i][c] - palette[p][c];
+					distance += delta * delta;
+				}
+
+				if (distance < bestError) {
+					bestError = distance;
+					bestIndex = p;
+				}
+			}
+
+			outIndices |= bestIndex << (i * 2);
+			error += bestError;
+		}
+
+		return error;
+	}
+
+	static void EncodeBC1Block(const BlockTexels& texels, bool refine, uint8_t* outBlock) {
+		float low[3], high[3];
+		ComputeAxisEndpoints<3>(texels, low, high);
+
+		uint16_t color0 = PackRGB565(high);
+		uint16_t color1 = PackRGB565(low);
+		uint32_t indices;
+		uint32_t error = FitBC1Indices(texels, color0, color1, indices);
+
+		if (refine && error > 0 && color0 != color1) {
+			constexpr float IndexWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+			float weights[16];
+			for (uint32_t i = 0; i < 16; ++i) {
+				weights[i] = IndexWeights[(indices >> (i * 2)) & 3];
+			}
+
+			float first[3], second[3];
+			if (SolveEndpoints<3>(texels, weights, first, second)) {
+				uint16_t refinedColor0 = PackRGB565(first);
+				uint16_t refinedColor1 = PackRGB565(second);
+				uint32_t refinedIndices;
+				const uint32_t refinedError = FitBC1Indices(texels, refinedColor0, refinedColor1, refinedIndices);
+
+				if (refinedError < error) {
+					color0 = refinedColor0;
+					color1 = refinedColor1;
+					indices = refinedIndices;
+				}
+			}
+		}
+
+		std::memcpy(outBlock, &color0, sizeof(uint16_t));
+		std::memcpy(outBlock + 2, &color1, sizeof(uint16_t));
+		std::memcpy(outBlock + 4, &indices, sizeof(uint32_t));
+	}
+
+	static void DecodeBC1Block(const uint8_t* block, bool forceFourColors, BlockTexels& outTexels) {
+		uint16_t color0, color1;
+		uint32_t indices;
+		std::memcpy(&color0, block, sizeof(uint16_t));
+		std::memcpy(&color1, block + 2, sizeof(uint16_t));
+		std::memcpy(&indices, block + 4, sizeof(uint32_t));
+
+		int32_t palette[4][4];
+		UnpackRGB565(color0, palette[0]);
+		UnpackRGB565(color1, palette[1]);
+		palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+
+		if (color0 > color1 || forceFourColors) {
+			for (uint32_t c = 0; c < 3; ++c) {
+				palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+				palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+			}
+		}
+		else {
+			for (uint32_t c = 0; c < 3; ++c) {
+				palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+				palette[3][c] = 0;
+			}
+			palette[3][3] = 0;
+		}
+
+		for (uint32_t i = 0; i < 16; ++i) {
+			const uint32_t index = (indices >> (i * 2)) & 3;
+			for (uint32_t c = 0; c < 4; ++c) {
+				outTexels[i][c] = static_cast<uint8_t>(palette[index][c]);
+			}
+		}
+	}
+
+	static void GetBC4Palette(uint8_t value0, uint8_t value1, int32_t (&outPalette)[8]) {
+		outPalette[0] = value0;
+		outPalette[1] = value1;
+
+		if (value0 > value1) {
+			for (int32_t i = 2; i < 8; ++i) {
+				outPalette[i] = ((8 - i) * value0 + (i - 1) * value1) / 7;
+			}
+		}
+		else {
+			for (int32_t i = 2; i < 6; ++i) {
+				outPalette[i] = ((6 - i) * value0 + (i - 1) * value1) / 5;
+			}
+			outPalette[6] = 0;
+			outPalette[7] = 255;
+		}
+	}
+
+	static void EncodeBC4Block(const BlockTexels& texels, uint32_t channel, uint8_t* outBlock) {
+		uint8_t minValue = 255, maxValue = 0;
+		for (uint32_t i = 0; i < 16; ++i) {
+			minValue = std::min(minValue, texels[i][channel]);
+			maxValue = std::max(maxValue, texels[i][channel]);
+		}
+
+		outBlock[0] = maxValue;
+		outBlock[1] = minValue;
+
+		int32_t palette[8];
+		GetBC4Palette(maxValue, minValue, palette);
+
+		const uint32_t paletteSize = maxValue == minValue ? 1 : 8;
+
+		uint64_t indices = 0;
+		for (uint32_t i = 0; i < 16; ++i) {
+			uint32_t bestIndex = 0;
+			int32_t bestError = std::numeric_limits<int32_t>::max();
+
+			for (uint32_t p = 0; p < paletteSize; ++p) {
+				const int32_t error = std::abs(texels[i][channel] - palette[p]);
+				if (error < bestError) {
+					bestError = error;
+					bestIndex = p;
+				}
+			}
+
+			indices |= static_cast<uint64_t>(bestIndex) << (i * 3);
+		}
+
+		for (uint32_t i = 0; i < 6; ++i) {
+			outBlock[2 + i] = static_cast<uint8_t>(indices >> (i * 8));
+		}
+	}
+
+	static void DecodeBC4Block(const uint8_t* block, uint32_t channel, BlockTexels& outTexels) {
+		int32_t palette[8];
+		GetBC4Palette(block[0], block[1], palette);
+
+		uint64_t indices = 0;
+		for (uint32_t i = 0; i < 6; ++i) {
+			indices |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+		}
+
+		for (uint32_t i = 0; i < 16; ++i) {
+			outTexels[i][channel] = static_cast<uint8_t>(palette[(indices >> (i * 3)) & 7]);
+		}
+	}
+
+	static uint32_t FitBC7Mode6Indices(const BlockTexels& texels, const int32_t (&endpoint0)[4], const int32_t (&endpoint1)[4], uint8_t (&outIndices)[16]) {
+		int32_t palette[16][4];
+		for (uint32_t i = 0; i < 16; ++i) {
+			for (uint32_t c = 0; c < 4; ++c) {
+				palette[i][c] = ((64 - BC7Weights4[i]) * endpoint0[c] + BC7Weights4[i] * endpoint1[c] + 32) >> 6;
+			}
+		}
+
+		int32_t direction[4];
+		int32_t lengthSq = 0;
+		for (uint32_t c = 0; c < 4; ++c) {
+			direction[c] = endpoint1[c] - endpoint0[c];
+			lengthSq += direction[c] * direction[c];
+		}
+
+		uint32_t error = 0;
+		for (uint32_t i = 0; i < 16; ++i) {
+			// NOTE: The palette lies on a line, so only the projected index and its neighbours need an exact test
+			int32_t guess = 0;
+			if (lengthSq > 0) {
+				int32_t dot = 0;
+				for (uint32_t c = 0; c < 4; ++c) {
+					dot += (texels[i][c] - endpoint0[c]) * direction[c];
+				}
+				guess = std::clamp(static_cast<int32_t>(std::lround(15.0f * dot / lengthSq)), 0, 15);
+			}
+
+			uint32_t bestIndex = 0;
+			uint32_t bestError = std::numeric_limits<uint32_t>::max();
+
+			for (int32_t index = std::max(0, guess - 1); index <= std::min(15, guess + 1); ++index) {
+				uint32_t distance = 0;
+				for (uint32_t c = 0; c < 4; ++c) {
+					const int32_t delta = texels[i][c] - palette[index][c];
+					distance += delta * delta;
+				}
+
+				if (distance < bestError) {
+					bestError = distance;
+					bestIndex = index;
+				}
+			}
+
+			outIndices[i] = static_cast<uint8_t>(bestIndex);
+			error += bestError;
+		}
+
+		return error;
+	}
+
+	struct BC7Mode6Fit {
+		int32_t endpoints[2][4];
+		uint32_t pbits[2];
+		uint8_t indices[16];
+		uint32_t error = std::numeric_limits<uint32_t>::max();
+	};
+
+	// NOTE: Quantizes both endpoints to 7 bits plus a shared p-bit, trying all four p-bit combinations
+	static void FitBC7Mode6(const BlockTexels& texels, const float (&endpoint0)[4], const float (&endpoint1)[4], BC7Mode6Fit& bestFit) {
+		for (uint32_t pbit0 = 0; pbit0 < 2; ++pbit0) {
+			for (uint32_t pbit1 = 0; pbit1 < 2; ++pbit1) {
+				BC7Mode6Fit fit;
+				fit.pbits[0] = pbit0;
+				fit.pbits[1] = pbit1;
+
+				for (uint32_t c = 0; c < 4; ++c) {
+					const int32_t q0 = std::clamp(static_cast<int32_t>(std::lround((endpoint0[c] - pbit0) * 0.5f)), 0, 127);
+					const int32_t q1 = std::clamp(static_cast<int32_t>(std::lround((endpoint1[c] - pbit1) * 0.5f)), 0, 127);
+					fit.endpoints[0][c] = (q0 << 1) | pbit0;
+					fit.endpoints[1][c] = (q1 << 1) | pbit1;
+				}
+
+				fit.error = FitBC7Mode6Indices(texels, fit.endpoints[0], fit.endpoints[1], fit.indices);
+				if (fit.error < bestFit.error) {
+					bestFit = fit;
+				}
+			}
+		}
+	}
+
+	static void EncodeBC7Block(const BlockTexels& texels, bool refine, uint8_t* outBlock) {
+		float low[4], high[4];
+		ComputeAxisEndpoints<4>(texels, low, high);
+
+		BC7Mode6Fit fit;
+		FitBC7Mode6(texels, low, high, fit);
+
+		if (refine && fit.error > 0) {
+			float weights[16];
+			for (uint32_t i = 0; i < 16; ++i) {
+				weights[i] = (64 - BC7Weights4[fit.indices[i]]) / 64.0f;
+			}
+
+			float first[4], second[4];
+			if (SolveEndpoints<4>(texels, weights, first, second)) {
+				FitBC7Mode6(texels, first, second, fit);
+			}
+		}
+
+		// NOTE: The anchor texel stores only 3 index bits, so its index must be below 8
+		if (fit.indices[0] & 8) {
+			std::swap(fit.endpoints[0], fit.endpoints[1]);
+			std::swap(fit.pbits[0], fit.pbits[1]);
+			for (uint32_t i = 0; i < 16; ++i) {
+				fit.indices[i] = 15 - fit.indices[i];
+			}
+		}
+
+		std::memset(outBlock, 0, 16);
+
+		BlockBitWriter writer{ outBlock };
+		writer.Write(1 << 6, 7);
+		for (uint32_t c = 0; c < 4; ++c) {
+			writer.Write(fit.endpoints[0][c] >> 1, 7);
+			writer.Write(fit.endpoints[1][c] >> 1, 7);
+		}
+		writer.Write(fit.pbits[0], 1);
+		writer.Write(fit.pbits[1], 1);
+		writer.Write(fit.indices[0], 3);
+		for (uint32_t i = 1; i < 16; ++i) {
+			writer.Write(fit.indices[i], 4);
+		}
+	}
+
+	static bool DecodeBC7Block(const uint8_t* block, BlockTexels& outTexels) {
+		BlockBitReader reader{ block };
+		if (reader.Read(7) != (1 << 6)) {
+			return false;
+		}
+
+		int32_t endpoints[2][4];
+		for (uint32_t c = 0; c < 4; ++c) {
+			endpoints[0][c] = reader.Read(7) << 1;
+			endpoints[1][c] = reader.Read(7) << 1;
+		}
+
+		const uint32_t pbit0 = reader.Read(1);
+		const uint32_t pbit1 = reader.Read(1);
+		for (uint32_t c = 0; c < 4; ++c) {
+			endpoints[0][c] |= pbit0;
+			endpoints[1][c] |= pbit1;
+		}
+
+		for (uint32_t i = 0; i < 16; ++i) {
+			const uint32_t weight = BC7Weights4[reader.Read(i == 0 ? 3 : 4)];
+			for (uint32_t c = 0; c < 4; ++c) {
+				outTexels[i][c] = static_cast<uint8_t>(((64 - weight) * endpoints[0][c] + weight * endpoints[1][c] + 32) >> 6);
+			}
+		}
+
+		return true;
+	}
+
+	static void EncodeBlock(const BlockTexels& texels, PixelFormat format, bool refine, uint8_t* outBlock) {
+		switch (format) {
+		case PixelFormat::BC1Unorm:
+		case PixelFormat::BC1Srgb:
+			EncodeBC1Block(texels, refine, outBlock);
+			break;
+		case PixelFormat::BC3Unorm:
+		case PixelFormat::BC3Srgb:
+			EncodeBC4Block(texels, 3, outBlock);
+			EncodeBC1Block(texels, refine, outBlock + 8);
+			break;
+		case PixelFormat::BC4Unorm:
+			EncodeBC4Block(texels, 0, outBlock);
+			break;
+		case PixelFormat::BC5Unorm:
+			EncodeBC4Block(texels, 0, outBlock);
+			EncodeBC4Block(texels, 1, outBlock + 8);
+			break;
+		case PixelFormat::BC7Unorm:
+		case PixelFormat::BC7Srgb:
+			EncodeBC7Block(texels, refine, outBlock);
+			break;
+		default:
+			break;
+		}
+	}
+
+	static bool DecodeBlock(const uint8_t* block, PixelFormat format, BlockTexels& outTexels) {
+		switch (format) {
+		case PixelFormat::BC1Unorm:
+		case PixelFormat::BC1Srgb:
+			DecodeBC1Block(block, false, outTexels);
+			return true;
+		case PixelFormat::BC3Unorm:
+		case PixelFormat::BC3Srgb:
+			DecodeBC1Block(block + 8, true, outTexels);
+			DecodeBC4Block(block, 3, outTexels);
+			return true;
+		case PixelFormat::BC4Unorm:
+			std::memset(outTexels, 0, sizeof(BlockTexels));
+			DecodeBC4Block(block, 0, outTexels);
+			for (uint32_t i = 0; i < 16; ++i) {
+				outTexels[i][3] = 255;
+			}
+			return true;
+		case PixelFormat::BC5Unorm:
+			std::memset(outTexels, 0, sizeof(BlockTexels));
+			DecodeBC4Block(block, 0, outTexels);
+			DecodeBC4Block(block + 8, 1, outTexels);
+			for (uint32_t i = 0; i < 16; ++i) {
+				outTexels[i][3] = 255;
+			}
+			return true;
+		case PixelFormat::BC7Unorm:
+		case PixelFormat::BC7Srgb:
+			return DecodeBC7Block(block, outTexels);
+		default:
+			return false;
+		}
+	}
+
+	static uint32_t GetCompressedChannelCount(PixelFormat format) {
+		switch (format) {
+		case PixelFormat::BC4Unorm:
+			return 1;
+		case PixelFormat::BC5Unorm:
+			return 2;
+		case PixelFormat::BC1Unorm:
+		case PixelFormat::BC1Srgb:
+			return 3;
+		default:
+			return 4;
+		}
+	}
+
+	PixelFormat TextureCompressor::SelectFormat(TextureRole role, bool srgb, bool hasAlpha, TextureCompressionQuality quality) {
+		switch (role) {
+		case TextureRole::Normal:
+			return PixelFormat::BC5Unorm;
+		case TextureRole::Mask:
+			return PixelFormat::BC4Unorm;
+		default:
+			break;
+		}
+
+		if (quality == TextureCompressionQuality::High) {
+			return srgb ? PixelFormat::BC7Srgb : PixelFormat::BC7Unorm;
+		}
+
+		if (hasAlpha) {
+			return srgb ? PixelFormat::BC3Srgb : PixelFormat::BC3Unorm;
+		}
+
+		return srgb ? PixelFormat::BC1Srgb : PixelFormat::BC1Unorm;
+	}
+
+	bool TextureCompressor::Compress(const uint8_t* rgba, uint32_t width, uint32_t height, PixelFormat format, TextureCompressionQuality quality, std::vector<uint8_t>& outBlocks, ThreadPool* pool) {
+		if (!IsBlockCompressedFormat(format) || width == 0 || height == 0) {
+			Log::Error("TextureCompressor: unsupported target format %d", static_cast<int32_t>(format));
+			return false;
+		}
+
+		const uint32_t blocksX = (width + 3) / 4;
+		const uint32_t blocksY = (height + 3) / 4;
+		const uint32_t blockSize = GetBlockSize(format);
+		const bool refine = quality == TextureCompressionQuality::High;
+
+		outBlocks.resize(static_cast<uint64_t>(blocksX) * blocksY * blockSize);
+
+		auto encodeRow = [&](uint32_t blockY) {
+			BlockTexels texels;
+			uint8_t* row = outBlocks.data() + static_cast<uint64_t>(blockY) * blocksX * blockSize;
+
+			for (uint32_t blockX = 0; blockX < blocksX; ++blockX) {
+				LoadBlock(rgba, width, height, blockX, blockY, texels);
+				EncodeBlock(texels, format, refine, row + blockX * blockSize);
+			}
+		};
+
+		ThreadPool::ParallelFor(pool, blocksY, encodeRow);
+
+		return true;
+	}
+
+	bool TextureCompressor::Decompress(const uint8_t* blocks, uint32_t width, uint32_t height, PixelFormat format, std::vector<uint8_t>& outRgba) {
+		if (!IsBlockCompressedFormat(format)) {
+			return false;
+		}
+
+		const uint32_t blocksX = (width + 3) / 4;
+		const uint32_t blocksY = (height + 3) / 4;
+		const uint32_t blockSize = GetBlockSize(format);
+
+		outRgba.resize(static_cast<uint64_t>(width) * height * 4);
+
+		BlockTexels texels;
+		for (uint32_t blockY = 0; blockY < blocksY; ++blockY) {
+			for (uint32_t blockX = 0; blockX < blocksX; ++blockX) {
+				if (!DecodeBlock(blocks + (static_cast<uint64_t>(blockY) * blocksX + blockX) * blockSize, format, texels)) {
+					return false;
+				}
+
+				StoreBlock(texels, width, height, blockX, blockY, outRgba.data());
+			}
+		}
+
+		return true;
+	}
+
+	bool TextureCompressor::CompressImage(const Image& image, TextureRole role, bool srgb, TextureCompressionQuality quality, CompressedTexture& outTexture, TextureCompressionStats* outStats, ThreadPool* pool) {
+		if (!image.IsValid() || image.Channels() != 4) {
+			Log::Error("TextureCompressor: expected a 4 channel image");
+			return false;
+		}
+
+		const uint32_t width = image.Width();
+		const uint32_t height = image.Height();
+
+		const bool hasAlpha = role == TextureRole::Color && HasAlpha(image);
+
+		MipGenerationDesc mipDesc;
+		mipDesc.srgb = srgb;
+		mipDesc.normalMap = role == TextureRole::Normal;
+		mipDesc.preserveAlphaCoverage = hasAlpha;
+		mipDesc.pool = pool;
+
+		MipChain mipChain;
+		if (!MipGenerator::Generate(image.Data().data(), width, height, mipDesc, mipChain)) {
+			return false;
+		}
+
+		outTexture.format = SelectFormat(role, srgb, hasAlpha, quality);
+		outTexture.width = width;
+		outTexture.height = height;
+		outTexture.mipLevels = mipChain.mipLevels;
+		outTexture.data.clear();
+		outTexture.data.reserve(GetMipChainSize(outTexture.format, width, height, outTexture.mipLevels));
+
+		std::chrono::duration<double, std::milli> encodeTime(0.0);
+		uint64_t texelCount = 0;
+
+		const uint8_t* level = mipChain.data.data();
+		std::vector<uint8_t> blocks;
+
+		for (uint32_t mip = 0; mip < outTexture.mipLevels; ++mip) {
+			const uint32_t mipWidth = std::max(1u, width >> mip);
+			const uint32_t mipHeight = std::max(1u, height >> mip);
+
+			auto startTime = std::chrono::steady_clock::now();
+			Compress(level, mipWidth, mipHeight, outTexture.format, quality, blocks, pool);
+			encodeTime += std::chrono::steady_clock::now() - startTime;
+
+			texelCount += static_cast<uint64_t>(mipWidth) * mipHeight;
+			outTexture.data.insert(outTexture.data.end(), blocks.begin(), blocks.end());
+
+			if (mip == 0 && outStats) {
+				std::vector<uint8_t> decoded;
+				if (Decompress(blocks.data(), mipWidth, mipHeight, outTexture.format, decoded)) {
+					outStats->psnr = ComputePSNR(level, decoded.data(), mipWidth, mipHeight, GetCompressedChannelCount(outTexture.format));
+				}
+			}
+
+			level += static_cast<uint64_t>(mipWidth) * mipHeight * 4;
+		}
+
+		if (outStats) {
+			outStats->encodeMs = encodeTime.count();
+			outStats->megapixelsPerSecond = encodeTime.count() > 0.0 ? texelCount / (encodeTime.count() * 1000.0) : 0.0;
+		}
+
+		return true;
+	}
+
+	double TextureCompressor::ComputePSNR(const uint8_t* referenceRgba, const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t channelCount) {
+		const uint64_t texelCount = static_cast<uint64_t>(width) * height;
+
+		uint64_t squaredError = 0;
+		for (uint64_t i = 0; i < texelCount; ++i) {
+			for (uint32_t c = 0; c < channelCount; ++c) {
+				const int32_t delta = referenceRgba[i * 4 + c] - rgba[i * 4 + c];
+				squaredError += delta * delta;
+			}
+		}
+
+		if (squaredError == 0) {
+			return std::numeric_limits<double>::infinity();
+		}
+
+		const double meanSquaredError = static_cast<double>(squaredError) / (texelCount * channelCount);
+		return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+	}
+
+	bool TextureCompressor::HasAlpha(const Image& image) {
+		if (image.Channels() != 4) {
+			return false;
+		}
+
+		const std::vector<uint8_t>& data = image.Data();
+		for (size_t i = 3; i < data.size(); i += 4) {
+			if (data[i] != 255) {
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Core.h"
+#include "Image.h"
+#include "Graphics/GraphicsType.h"
+
+#include <vector>
+
+namespace flaw {
+	class ThreadPool;
+
+	enum class TextureRole {
+		Color,  // BC1/BC3 or BC7
+		Normal, // BC5, z is reconstructed in the shader
+		Mask,   // BC4, red channel only (ao, specular, height)
+	};
+
+	enum class TextureCompressionQuality {
+		Fast, // BC1/BC3 for color, single pass endpoint fit
+		High, // BC7 for color, least squares endpoint refinement
+	};
+
+	struct CompressedTexture {
+		PixelFormat format = PixelFormat::Undefined;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipLevels = 0;
+		std::vector<uint8_t> data; // mip levels packed back to back from level 0
+	};
+
+	struct TextureCompressionStats {
+		double psnr = 0.0; // dB on mip level 0, over the channels the format keeps
+		double encodeMs = 0.0;
+		double megapixelsPerSecond = 0.0;
+	};
+
+	// NOTE: CPU block compressor. BC7 output uses mode 6 only (one subset, RGBA 7.7.7.7 endpoints with p-bits, 4 bit indices).
+	class TextureCompressor {
+	public:
+		constexpr static uint32_t Version = 1;
+
+		static PixelFormat SelectFormat(TextureRole role, bool srgb, bool hasAlpha, TextureCompressionQuality quality);
+
+		// NOTE: rgba is tightly packed 8 bit RGBA, rows of blocks are spread over pool as ThreadPool::ParallelFor does
+		static bool Compress(const uint8_t* rgba, uint32_t width, uint32_t height, PixelFormat format, TextureCompressionQuality quality, std::vector<uint8_t>& outBlocks, ThreadPool* pool = nullptr);
+		static bool Decompress(const uint8_t* blocks, uint32_t width, uint32_t height, PixelFormat format, std::vector<uint8_t>& outRgba);
+
+		// NOTE: Compresses a 4 channel image and its mip chain down to 1x1, mips come from MipGenerator with the role's settings
+		static bool CompressImage(const Image& image, TextureRole role, bool srgb, TextureCompressionQuality quality, CompressedTexture& outTexture, TextureCompressionStats* outStats = nullptr, ThreadPool* pool = nullptr);
+
+		// NOTE: Compares the first channelCount channels of two RGBA images
+		static double ComputePSNR(const uint8_t* referenceRgba, const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t channelCount);
+
+		static bool HasAlpha(const Image& image);
+	};
+}
@@ -0,0 +1,538 @@
+#include "pch.h"
+#include "TextureContainer.h"
+#include "Graphics/GraphicsFunc.h"
+#include "Log/Log.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace flaw {
+	struct DDSPixelFormat {
+		uint32_t size;
+		uint32_t flags;
+		uint32_t fourCC;
+		uint32_t rgbBitCount;
+		uint32_t rBitMask;
+		uint32_t gBitMask;
+		uint32_t bBitMask;
+		uint32_t aBitMask;
+	};
+
+	struct DDSHeader {
+		uint32_t size;
+		uint32_t flags;
+		uint32_t height;
+		uint32_t width;
+		uint32_t pitchOrLinearSize;
+		uint32_t depth;
+		uint32_t mipMapCount;
+		uint32_t reserved1[11];
+		DDSPixelFormat pixelFormat;
+		uint32_t caps;
+		uint32_t caps2;
+		uint32_t caps3;
+		uint32_t caps4;
+		uint32_t reserved2;
+	};
+
+	struct DDSHeaderDX10 {
+		uint32_t dxgiFormat;
+		uint32_t resourceDimension;
+		uint32_t miscFlag;
+		uint32_t arraySize;
+		uint32_t miscFlags2;
+	};
+
+	struct KTX2Header {
+		uint8_t identifier[12];
+		uint32_t vkFormat;
+		uint32_t typeSize;
+		uint32_t pixelWidth;
+		uint32_t pixelHeight;
+		uint32_t pixelDepth;
+		uint32_t layerCount;
+		uint32_t faceCount;
+		uint32_t levelCount;
+		uint32_t supercompressionScheme;
+		uint32_t dfdByteOffset;
+		uint32_t dfdByteLength;
+		uint32_t kvdByteOffset;
+		uint32_t kvdByteLength;
+		uint64_t sgdByteOffset;
+		uint64_t sgdByteLength;
+	};
+
+	struct KTX2LevelIndex {
+		uint64_t byteOffset;
+		uint64_t byteLength;
+		uint64_t uncompressedByteLength;
+	};
+
+	static_assert(sizeof(DDSHeader) == 124, "DDS header must be 124 bytes");
+	static_assert(sizeof(DDSHeaderDX10) == 20, "DDS DX10 header must be 20 bytes");
+	static_assert(sizeof(KTX2Header) == 80, "KTX2 header must be 80 bytes");
+	static_assert(sizeof(KTX2LevelIndex) == 24, "KTX2 level index entry must be 24 bytes");
+
+	static constexpr uint8_t KTX2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+	static constexpr uint32_t DDSPixelFormatAlphaPixels = 0x1;
+	static constexpr uint32_t DDSPixelFormatFourCC = 0x4;
+	static constexpr uint32_t DDSPixelFormatRGB = 0x40;
+	static constexpr uint32_t DDSPixelFormatLuminance = 0x20000;
+
+	static constexpr uint32_t DDSCaps2Cubemap = 0x200;
+	static constexpr uint32_t DDSCaps2CubemapAllFaces = 0xFC00;
+	static constexpr uint32_t DDSCaps2Volume = 0x200000;
+
+	static constexpr uint32_t DDSDimensionTexture2D = 3;
+	static constexpr uint32_t DDSMiscTextureCube = 0x4;
+
+	static constexpr uint32_t MakeFourCC(char a, char b, char c, char d) {
+		return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+	}
+
+	static PixelFormat ConvertFromDXGIFormat(uint32_t dxgiFormat) {
+		switch (dxgiFormat) {
+		case 2: return PixelFormat::RGBA32F;   // R32G32B32A32_FLOAT
+		case 10: return PixelFormat::RGBA16F;  // R16G16B16A16_FLOAT
+		case 28: return PixelFormat::RGBA8Unorm;
+		case 29: return PixelFormat::RGBA8Srgb;
+		case 41: return PixelFormat::R32F;
+		case 49: return PixelFormat::RG8;
+		case 61: return PixelFormat::R8Unorm;
+		case 71: return PixelFormat::BC1Unorm;
+		case 72: return PixelFormat::BC1Srgb;
+		case 77: return PixelFormat::BC3Unorm;
+		case 78: return PixelFormat::BC3Srgb;
+		case 80: return PixelFormat::BC4Unorm;
+		case 83: return PixelFormat::BC5Unorm;
+		case 87: return PixelFormat::BGRA8;
+		case 88: return PixelFormat::BGRX8Unorm;
+		case 98: return PixelFormat::BC7Unorm;
+		case 99: return PixelFormat::BC7Srgb;
+		default: return PixelFormat::Undefined;
+		}
+	}
+
+	static uint32_t ConvertToDXGIFormat(PixelFormat format) {
+		switch (format) {
+		case PixelFormat::RGBA32F: return 2;
+		case PixelFormat::RGBA16F: return 10;
+		case PixelFormat::RGBA8Unorm: return 28;
+		case PixelFormat::RGBA8Srgb: return 29;
+		case PixelFormat::R32F: return 41;
+		case PixelFormat::RG8: return 49;
+		case PixelFormat::R8Unorm: return 61;
+		case PixelFormat::BC1Unorm: return 71;
+		case PixelFormat::BC1Srgb: return 72;
+		case PixelFormat::BC3Unorm: return 77;
+		case PixelFormat::BC3Srgb: return 78;
+		case PixelFormat::BC4Unorm: return 80;
+		case PixelFormat::BC5Unorm: return 83;
+		case PixelFormat::BGRA8: return 87;
+		case PixelFormat::BGRX8Unorm: return 88;
+		case PixelFormat::BC7Unorm: return 98;
+		case PixelFormat::BC7Srgb: return 99;
+		default: return 0;
+		}
+	}
+
+	static PixelFormat ConvertFromDDSPixelFormat(const DDSPixelFormat& pf) {
+		if (pf.flags & DDSPixelFormatFourCC) {
+			switch (pf.fourCC) {
+			case MakeFourCC('D', 'X', 'T', '1'): return PixelFormat::BC1Unorm;
+			case MakeFourCC('D', 'X', 'T', '5'): return PixelFormat::BC3Unorm;
+			case MakeFourCC('A', 'T', 'I', '1'):
+			case MakeFourCC('B', 'C', '4', 'U'): return PixelFormat::BC4Unorm;
+			case MakeFourCC('A', 'T', 'I', '2'):
+			case MakeFourCC('B', 'C', '5', 'U'): return PixelFormat::BC5Unorm;
+			case 113: return PixelFormat::RGBA16F; // D3DFMT_A16B16G16R16F
+			case 114: return PixelFormat::R32F;    // D3DFMT_R32F
+			case 116: return PixelFormat::RGBA32F; // D3DFMT_A32B32G32R32F
+			default: return PixelFormat::Undefined;
+			}
+		}
+
+		if ((pf.flags & DDSPixelFormatRGB) && pf.rgbBitCount == 32) {
+			const bool hasAlpha = (pf.flags & DDSPixelFormatAlphaPixels) && pf.aBitMask == 0xFF000000;
+
+			if (pf.rBitMask == 0x000000FF && pf.gBitMask == 0x0000FF00 && pf.bBitMask == 0x00FF0000) {
+				return PixelFormat::RGBA8Unorm;
+			}
+			if (pf.rBitMask == 0x00FF0000 && pf.gBitMask == 0x0000FF00 && pf.bBitMask == 0x000000FF) {
+				return hasAlpha ? PixelFormat::BGRA8 : PixelFormat::BGRX8Unorm;
+			}
+		}
+
+		if ((pf.flags & DDSPixelFormatLuminance) && pf.rgbBitCount == 8) {
+			return PixelFormat::R8Unorm;
+		}
+
+		return PixelFormat::Undefined;
+	}
+
+	static PixelFormat ConvertFromKTX2VkFormat(uint32_t vkFormat) {
+		switch (vkFormat) {
+		case 9: return PixelFormat::R8Unorm;    // VK_FORMAT_R8_UNORM
+		case 16: return PixelFormat::RG8;       // VK_FORMAT_R8G8_UNORM
+		case 37: return PixelFormat::RGBA8Unorm;
+		case 43: return PixelFormat::RGBA8Srgb;
+		case 44: return PixelFormat::BGRA8;
+		case 97: return PixelFormat::RGBA16F;
+		case 100: return PixelFormat::R32F;
+		case 109: return PixelFormat::RGBA32F;
+		case 131: // VK_FORMAT_BC1_RGB_UNORM_BLOCK, decodes the same as the RGBA variant without punch-through alpha
+		case 133: return PixelFormat::BC1Unorm;
+		case 132:
+		case 134: return PixelFormat::BC1Srgb;
+		case 137: return PixelFormat::BC3Unorm;
+		case 138: return PixelFormat::BC3Srgb;
+		case 139: return PixelFormat::BC4Unorm;
+		case 141: return PixelFormat::BC5Unorm;
+		case 145: return PixelFormat::BC7Unorm;
+		case 146: return PixelFormat::BC7Srgb;
+		default: return PixelFormat::Undefined;
+		}
+	}
+
+	bool TextureContainer::Load(const char* path) {
+		Reset();
+
+		if (!_file.Open(path)) {
+			Log::Error("Failed to open texture container: %s", path);
+			return false;
+		}
+
+		if (!Parse(_file.GetData(), _file.GetSize())) {
+			Log::Error("Failed to parse texture container: %s", path);
+			Reset();
+			return false;
+		}
+
+		// NOTE: Nothing left refers to the file when the data was reordered into _ownedData
+		if (!_ownedData.empty()) {
+			_file.Close();
+		}
+
+		return true;
+	}
+
+	bool TextureContainer::Load(const uint8_t* data, uint64_t size) {
+		Reset();
+
+		if (!Parse(data, size)) {
+			Reset();
+			return false;
+		}
+
+		// NOTE: The caller's buffer is not owned, keep a copy of the images
+		if (_ownedData.empty()) {
+			_ownedData.assign(_data, _data + _dataSize);
+			_data = _ownedData.data();
+		}
+
+		return true;
+	}
+
+	void TextureContainer::Reset() {
+		_file.Close();
+		_ownedData.clear();
+		_ownedData.shrink_to_fit();
+
+		_format = PixelFormat::Undefined;
+		_width = _height = 0;
+		_mipLevels = _layers = _faces = 0;
+
+		_data = nullptr;
+		_dataSize = 0;
+		_imageSize = 0;
+	}
+
+	bool TextureContainer::WriteDDS(const char* path, PixelFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, const uint8_t* data, uint64_t size) {
+		const uint32_t dxgiFormat = ConvertToDXGIFormat(format);
+		if (dxgiFormat == 0 || width == 0 || height == 0 || mipLevels == 0 || size != GetMipChainSize(format, width, height, mipLevels)) {
+			Log::Error("Cannot write DDS %s: %ux%u, %u mips, %llu bytes", path, width, height, mipLevels, static_cast<unsigned long long>(size));
+			return false;
+		}
+
+		DDSHeader header = {};
+		header.size = sizeof(DDSHeader);
+		header.flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000; // caps, height, width, pixel format, mip count, linear size
+		header.height = height;
+		header.width = width;
+		header.pitchOrLinearSize = static_cast<uint32_t>(GetTextureSize(format, width, height));
+		header.mipMapCount = mipLevels;
+		header.pixelFormat.size = sizeof(DDSPixelFormat);
+		header.pixelFormat.flags = DDSPixelFormatFourCC;
+		header.pixelFormat.fourCC = MakeFourCC('D', 'X', '1', '0');
+		header.caps = 0x1000 | (mipLevels > 1 ? 0x400000 | 0x8 : 0); // texture, mip map and complex
+
+		DDSHeaderDX10 headerDX10 = {};
+		headerDX10.dxgiFormat = dxgiFormat;
+		headerDX10.resourceDimension = DDSDimensionTexture2D;
+		headerDX10.arraySize = 1;
+
+		std::filesystem::path filePath(path);
+		if (filePath.has_parent_path()) {
+			std::error_code ec;
+			std::filesystem::create_directories(filePath.parent_path(), ec);
+		}
+
+		// NOTE: Written to a temporary file and renamed, so a reader never maps a half written file
+		std::filesystem::path tempPath = filePath;
+		tempPath += ".tmp";
+
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+
+		const uint32_t magic = DDSMagic;
+		file.write(reinterpret_cast<const char*>(&magic), sizeof(magic));
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(&headerDX10), sizeof(headerDX10));
+		file.write(reinterpret_cast<const char*>(data), size);
+		file.close();
+
+		if (!file) {
+			return false;
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tempPath, filePath, ec);
+		if (ec) {
+			std::filesystem::remove(tempPath, ec);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool TextureContainer::IsContainerFile(const char* path) {
+		std::string extension = std::filesystem::path(path).extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+
+		return extension == ".dds" || extension == ".ktx2";
+	}
+
+	const uint8_t* TextureContainer::GetMipData(uint32_t layer, uint32_t face, uint32_t mip) const {
+		if (!_data || layer >= _layers || face >= _faces || mip >= _mipLevels) {
+			return nullptr;
+		}
+
+		return _data + (static_cast<uint64_t>(layer) * _faces + face) * _imageSize + GetMipChainSize(_format, _width, _height, mip);
+	}
+
+	bool TextureContainer::Parse(const uint8_t* data, uint64_t size) {
+		if (size >= sizeof(uint32_t)) {
+			uint32_t magic;
+			std::memcpy(&magic, data, sizeof(magic));
+
+			if (magic == DDSMagic) {
+				return ParseDDS(data, size);
+			}
+		}
+
+		if (size >= sizeof(KTX2Identifier) && std::memcmp(data, KTX2Identifier, sizeof(KTX2Identifier)) == 0) {
+			return ParseKTX2(data, size);
+		}
+
+		Log::Error("Texture container is neither DDS nor KTX2");
+		return false;
+	}
+
+	bool TextureContainer::SetLayout(PixelFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layers, uint32_t faces) {
+		if (format == PixelFormat::Undefined) {
+			Log::Error("Texture container has an unsupported pixel format");
+			return false;
+		}
+
+		if (width == 0 || height == 0 || layers == 0) {
+			Log::Error("Texture container has an empty extent: %ux%u, %u layers", width, height, layers);
+			return false;
+		}
+
+		// NOTE: GetMaxMipLevels counts the halvings, a full chain down to 1x1 has one level more
+		if (mipLevels == 0 || mipLevels > GetMaxMipLevels(width, height) + 1) {
+			Log::Error("Texture container has %u mip levels for %ux%u", mipLevels, width, height);
+			return false;
+		}
+
+		if (faces == 6 && width != height) {
+			Log::Error("Cube texture faces are not square: %ux%u", width, height);
+			return false;
+		}
+
+		_format = format;
+		_width = width;
+		_height = height;
+		_mipLevels = mipLevels;
+		_layers = layers;
+		_faces = faces;
+
+		_imageSize = GetMipChainSize(format, width, height, mipLevels);
+		_dataSize = _imageSize * layers * faces;
+
+		return true;
+	}
+
+	bool TextureContainer::ParseDDS(const uint8_t* data, uint64_t size) {
+		uint64_t offset = sizeof(uint32_t);
+
+		DDSHeader header;
+		if (size < offset + sizeof(header)) {
+			Log::Error("DDS file is truncated");
+			return false;
+		}
+
+		std::memcpy(&header, data + offset, sizeof(header));
+		offset += sizeof(header);
+
+		if (header.size != sizeof(DDSHeader) || header.pixelFormat.size != sizeof(DDSPixelFormat)) {
+			Log::Error("DDS header size mismatch");
+			return false;
+		}
+
+		PixelFormat format = PixelFormat::Undefined;
+		uint32_t layers = 1;
+		uint32_t faces = 1;
+
+		if ((header.pixelFormat.flags & DDSPixelFormatFourCC) && header.pixelFormat.fourCC == MakeFourCC('D', 'X', '1', '0')) {
+			DDSHeaderDX10 headerDX10;
+			if (size < offset + sizeof(headerDX10)) {
+				Log::Error("DDS file is truncated");
+				return false;
+			}
+
+			std::memcpy(&headerDX10, data + offset, sizeof(headerDX10));
+			offset += sizeof(headerDX10);
+
+			if (headerDX10.resourceDimension != DDSDimensionTexture2D) {
+				Log::Error("DDS resource dimension %u is not supported, only 2D textures are", headerDX10.resourceDimension);
+				return false;
+			}
+
+			format = ConvertFromDXGIFormat(headerDX10.dxgiFormat);
+			if (format == PixelFormat::Undefined) {
+				Log::Error("DDS DXGI format %u is not supported", headerDX10.dxgiFormat);
+				return false;
+			}
+
+			// NOTE: For cube maps arraySize counts cubes, not faces
+			layers = std::max(1u, headerDX10.arraySize);
+			faces = (headerDX10.miscFlag & DDSMiscTextureCube) ? 6 : 1;
+		}
+		else {
+			if (header.caps2 & DDSCaps2Volume) {
+				Log::Error("DDS volume textures are not supported");
+				return false;
+			}
+
+			if (header.caps2 & DDSCaps2Cubemap) {
+				if ((header.caps2 & DDSCaps2CubemapAllFaces) != DDSCaps2CubemapAllFaces) {
+					Log::Error("DDS cube map is missing faces");
+					return false;
+				}
+				faces = 6;
+			}
+
+			format = ConvertFromDDSPixelFormat(header.pixelFormat);
+			if (format == PixelFormat::Undefined) {
+				Log::Error("DDS pixel format (flags 0x%x, fourCC 0x%x, %u bits) is not supported", header.pixelFormat.flags, header.pixelFormat.fourCC, header.pixelFormat.rgbBitCount);
+				return false;
+			}
+		}
+
+		if (!SetLayout(format, header.width, header.height, std::max(1u, header.mipMapCount), layers, faces)) {
+			return false;
+		}
+
+		if (size - offset < _dataSize) {
+			Log::Error("DDS file is truncated, %llu of %llu image bytes", static_cast<unsigned long long>(size - offset), static_cast<unsigned long long>(_dataSize));
+			return false;
+		}
+
+		_data = data + offset;
+
+		return true;
+	}
+
+	bool TextureContainer::ParseKTX2(const uint8_t* data, uint64_t size) {
+		uint64_t offset = 0;
+
+		KTX2Header header;
+		if (size < offset + sizeof(header)) {
+			Log::Error("KTX2 file is truncated");
+			return false;
+		}
+
+		std::memcpy(&header, data + offset, sizeof(header));
+		offset += sizeof(header);
+
+		if (header.supercompressionScheme != 0) {
+			Log::Error("KTX2 supercompression scheme %u is not supported", header.supercompressionScheme);
+			return false;
+		}
+
+		if (header.pixelDepth > 1 || header.pixelHeight == 0) {
+			Log::Error("KTX2 volume and 1D textures are not supported");
+			return false;
+		}
+
+		if (header.faceCount != 1 && header.faceCount != 6) {
+			Log::Error("KTX2 face count %u is invalid", header.faceCount);
+			return false;
+		}
+
+		const PixelFormat format = ConvertFromKTX2VkFormat(header.vkFormat);
+		if (format == PixelFormat::Undefined) {
+			Log::Error("KTX2 vkFormat %u is not supported", header.vkFormat);
+			return false;
+		}
+
+		// NOTE: A level count of 0 asks the loader to generate the mip chain, only the base level is stored
+		const uint32_t levelCount = std::max(1u, header.levelCount);
+
+		if (!SetLayout(format, header.pixelWidth, header.pixelHeight, levelCount, std::max(1u, header.layerCount), header.faceCount)) {
+			return false;
+		}
+
+		if (size - offset < static_cast<uint64_t>(levelCount) * sizeof(KTX2LevelIndex)) {
+			Log::Error("KTX2 level index is truncated");
+			return false;
+		}
+
+		// NOTE: Levels are stored one after another, each holding all layers and faces of that level. Reorder to [layer][face][mip].
+		_ownedData.resize(_dataSize);
+
+		uint64_t mipOffset = 0;
+		for (uint32_t mip = 0; mip < levelCount; ++mip) {
+			KTX2LevelIndex level;
+			std::memcpy(&level, data + offset + mip * sizeof(KTX2LevelIndex), sizeof(level));
+
+			const uint64_t imageSize = GetTextureSize(_format, std::max(1u, _width >> mip), std::max(1u, _height >> mip));
+			const uint64_t levelSize = imageSize * _layers * _faces;
+
+			if (level.byteLength < levelSize || level.byteOffset > size || size - level.byteOffset < levelSize) {
+				Log::Error("KTX2 level %u is out of bounds", mip);
+				return false;
+			}
+
+			const uint8_t* src = data + level.byteOffset;
+			for (uint32_t layer = 0; layer < _layers; ++layer) {
+				for (uint32_t face = 0; face < _faces; ++face) {
+					const uint64_t dstOffset = (static_cast<uint64_t>(layer) * _faces + face) * _imageSize + mipOffset;
+					std::memcpy(_ownedData.data() + dstOffset, src, imageSize);
+					src += imageSize;
+				}
+			}
+
+			mipOffset += imageSize;
+		}
+
+		_data = _ownedData.data();
+
+		return true;
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Core.h"
+#include "Graphics/GraphicsType.h"
+#include "Platform/MappedFile.h"
+
+#include <vector>
+
+namespace flaw {
+	// NOTE: DDS (legacy and DX10 headers) or KTX2 file holding GPU ready images. The data is ordered [layer][face][mip] with each
+	// mip chain packed back to back, so one face (or one layer of a non cube texture) matches Texture2D::Descriptor::dataMipLevels and
+	// the faces or layers follow each other the way TextureCube and Texture2DArray take them.
+	// DDS files already use this order and are used straight from the mapped file, KTX2 files are reordered once on load.
+	class TextureContainer {
+	public:
+		constexpr static uint32_t DDSMagic = 0x20534444; // "DDS "
+
+		TextureContainer() = default;
+
+		TextureContainer(const TextureContainer&) = delete;
+		TextureContainer& operator=(const TextureContainer&) = delete;
+
+		// NOTE: The format is detected from the file contents, not the extension
+		bool Load(const char* path);
+		bool Load(const uint8_t* data, uint64_t size);
+
+		void Reset();
+
+		// NOTE: One 2D texture with its mip chain packed back to back from level 0, always with the DX10 header
+		static bool WriteDDS(const char* path, PixelFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, const uint8_t* data, uint64_t size);
+
+		// NOTE: True for .dds and .ktx2 paths
+		static bool IsContainerFile(const char* path);
+
+		bool IsValid() const { return _data != nullptr; }
+		bool IsCube() const { return _faces == 6; }
+		bool IsArray() const { return _layers > 1; }
+
+		PixelFormat GetFormat() const { return _format; }
+		uint32_t GetWidth() const { return _width; }
+		uint32_t GetHeight() const { return _height; }
+		uint32_t GetMipLevels() const { return _mipLevels; }
+		uint32_t GetLayers() const { return _layers; }
+		uint32_t GetFaces() const { return _faces; }
+
+		const uint8_t* GetData() const { return _data; }
+		uint64_t GetDataSize() const { return _dataSize; }
+
+		// NOTE: Size of one face's mip chain
+		uint64_t GetImageSize() const { return _imageSize; }
+		const uint8_t* GetMipData(uint32_t layer, uint32_t face, uint32_t mip) const;
+
+	private:
+		bool Parse(const uint8_t* data, uint64_t size);
+		bool ParseDDS(const uint8_t* data, uint64_t size);
+		bool ParseKTX2(const uint8_t* data, uint64_t size);
+
+		bool SetLayout(PixelFormat format, uint32_t width, uint32_t height, uint32_t mipLevels, uint32_t layers, uint32_t faces);
+
+	private:
+		MappedFile _file;
+		std::vector<uint8_t> _ownedData;
+
+		PixelFormat _format = PixelFormat::Undefined;
+		uint32_t _width = 0;
+		uint32_t _height = 0;
+		uint32_t _mipLevels = 0;
+		uint32_t _layers = 0;
+		uint32_t _faces = 0;
+
+		const uint8_t* _data = nullptr;
+		uint64_t _dataSize = 0;
+		uint64_t _imageSize = 0;
+	};
+}
@@ -0,0 +1,354 @@
+#include "pch.h"
+#include "CookedMesh.h"
+#include "MeshCodec.h"
+#include "Utils/Hash.h"
+#include "Log/Log.h"
+
+#include <fstream>
+#include <cstring>
+
+namespace flaw {
+	static_assert(std::is_trivially_copyable_v<CookedMeshHeader>, "CookedMeshHeader must be trivially copyable to be mapped from a file");
+	static_assert(std::is_trivially_copyable_v<CookedMaterial>, "CookedMaterial must be trivially copyable to be mapped from a file");
+
+	static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	static bool HashFile(const std::filesystem::path& path, Hasher64& hasher) {
+		std::ifstream file(path, std::ios::binary);
+		if (!file.is_open()) {
+			return false;
+		}
+
+		std::vector<char> chunk(1 << 20);
+		while (file) {
+			file.read(chunk.data(), chunk.size());
+			hasher.Update(chunk.data(), static_cast<uint64_t>(file.gcount()));
+		}
+
+		return true;
+	}
+
+	uint64_t CookedMesh::ComputeSourceKey(const char* sourcePath) {
+		std::filesystem::path path(sourcePath);
+
+		Hasher64 hasher;
+		if (!HashFile(path, hasher)) {
+			return 0;
+		}
+
+		// NOTE: Companion files (gltf buffers, obj material libraries) change the import result as well
+		std::vector<std::filesystem::path> companions;
+
+		std::error_code ec;
+		for (const auto& entry : std::filesystem::directory_iterator(path.parent_path().empty() ? "." : path.parent_path(), ec)) {
+			if (!entry.is_regular_file() || entry.path() == path) {
+				continue;
+			}
+
+			if (entry.path().stem() == path.stem()) {
+				companions.push_back(entry.path());
+			}
+		}
+
+		std::sort(companions.begin(), companions.end());
+
+		for (const auto& companion : companions) {
+			const std::string name = companion.filename().generic_string();
+			hasher.Update(name.data(), name.size());
+			HashFile(companion, hasher);
+		}
+
+		return hasher.Digest();
+	}
+
+	void CookedMesh::Serialize(const CookedMeshDesc& desc, std::vector<uint8_t>& outBuffer) {
+		std::string stringTable;
+		std::vector<CookedMaterial> materials(desc.materials.size());
+
+		for (size_t i = 0; i < desc.materials.size(); ++i) {
+			materials[i].baseColor = desc.materials[i].baseColor;
+
+			for (uint32_t slot = 0; slot < CookedTextureSlotCount; ++slot) {
+				const std::string& texturePath = desc.materials[i].texturePaths[slot];
+				if (texturePath.empty()) {
+					materials[i].texturePaths[slot] = CookedInvalidString;
+					continue;
+				}
+
+				materials[i].texturePaths[slot] = static_cast<uint32_t>(stringTable.size());
+				stringTable.append(texturePath);
+				stringTable.push_back('\0');
+			}
+		}
+
+		std::vector<uint8_t> encodedVertices;
+		std::vector<uint8_t> encodedIndices;
+
+		const uint8_t* vertexData = static_cast<const uint8_t*>(desc.vertices);
+		const uint8_t* indexData = reinterpret_cast<const uint8_t*>(desc.indices);
+
+		uint64_t vertexDataSize = static_cast<uint64_t>(desc.vertexStride) * desc.vertexCount;
+		uint64_t indexDataSize = sizeof(uint32_t) * static_cast<uint64_t>(desc.indexCount);
+
+		uint32_t flags = 0;
+		if (desc.compressGeometry && MeshCodec::EncodeVertexBuffer(desc.vertices, desc.vertexCount, desc.vertexStride, encodedVertices)) {
+			MeshCodec::EncodeIndexBuffer(desc.indices, desc.indexCount, encodedIndices);
+
+			vertexData = encodedVertices.data();
+			vertexDataSize = encodedVertices.size();
+			indexData = encodedIndices.data();
+			indexDataSize = encodedIndices.size();
+
+			flags |= CookedMeshFlag_CompressedGeometry;
+		}
+
+		CookedMeshHeader header;
+		header.magic = Magic;
+		header.version = Version;
+		header.sourceKey = desc.sourceKey;
+		header.importKey = desc.importKey;
+		header.boundsMin = desc.boundsMin;
+		header.boundsMax = desc.boundsMax;
+		header.vertexStride = desc.vertexStride;
+		header.vertexCount = desc.vertexCount;
+		header.indexCount = desc.indexCount;
+		header.segmentCount = static_cast<uint32_t>(desc.segments.size());
+		header.materialCount = static_cast<uint32_t>(materials.size());
+		header.stringTableSize = static_cast<uint32_t>(stringTable.size());
+		header.flags = flags;
+		header.meshletCount = static_cast<uint32_t>(desc.meshlets.size());
+		header.vertexDataSize = vertexDataSize;
+		header.indexDataSize = indexDataSize;
+
+		header.vertexOffset = AlignUp(sizeof(CookedMeshHeader), Alignment);
+		header.indexOffset = AlignUp(header.vertexOffset + vertexDataSize, Alignment);
+		header.segmentOffset = AlignUp(header.indexOffset + indexDataSize, Alignment);
+		header.meshletOffset = AlignUp(header.segmentOffset + sizeof(CookedMeshSegment) * desc.segments.size(), Alignment);
+		header.materialOffset = AlignUp(header.meshletOffset + sizeof(Meshlet) * desc.meshlets.size(), Alignment);
+		header.stringTableOffset = header.materialOffset + sizeof(CookedMaterial) * materials.size();
+		header.fileSize = header.stringTableOffset + stringTable.size();
+
+		outBuffer.assign(header.fileSize, 0);
+
+		std::memcpy(outBuffer.data(), &header, sizeof(CookedMeshHeader));
+		std::memcpy(outBuffer.data() + header.vertexOffset, vertexData, vertexDataSize);
+		std::memcpy(outBuffer.data() + header.indexOffset, indexData, indexDataSize);
+		std::memcpy(outBuffer.data() + header.segmentOffset, desc.segments.data(), sizeof(CookedMeshSegment) * desc.segments.size());
+		std::memcpy(outBuffer.data() + header.meshletOffset, desc.meshlets.data(), sizeof(Meshlet) * desc.meshlets.size());
+		std::memcpy(outBuffer.data() + header.materialOffset, materials.data(), sizeof(CookedMaterial) * materials.size());
+		std::memcpy(outBuffer.data() + header.stringTableOffset, stringTable.data(), stringTable.size());
+	}
+
+	bool CookedMesh::Write(const char* path, const std::vector<uint8_t>& buffer) {
+		std::filesystem::path filePath(path);
+		if (filePath.has_parent_path()) {
+			std::error_code ec;
+			std::filesystem::create_directories(filePath.parent_path(), ec);
+		}
+
+		// NOTE: Write to a temporary file and rename it, so a reader never maps a half written file
+		std::filesystem::path tempPath = filePath;
+		tempPath += ".tmp";
+
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+
+		file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+		file.close();
+
+		if (!file) {
+			return false;
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tempPath, filePath, ec);
+		if (ec) {
+			std::filesystem::remove(tempPath, ec);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool CookedMesh::Open(const char* path, uint64_t sourceKey, uint64_t importKey) {
+		Close();
+
+		if (!_file.Open(path)) {
+			return false;
+		}
+
+		_data = _file.GetData();
+
+		if (!Validate(_file.GetSize())) {
+			Log::Warn("CookedMesh: %s is corrupted or from an older version, recooking", path);
+			Close();
+			return false;
+		}
+
+		if (_header->sourceKey != sourceKey || _header->importKey != importKey) {
+			Log::Info("CookedMesh: %s is stale, recooking", path);
+			Close();
+			return false;
+		}
+
+		if (!DecodeGeometry() || !ValidateIndices()) {
+			Log::Warn("CookedMesh: %s has corrupted geometry, recooking", path);
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool CookedMesh::Open(std::vector<uint8_t>&& buffer) {
+		Close();
+
+		_buffer = std::move(buffer);
+		_data = _buffer.data();
+
+		if (!Validate(_buffer.size()) || !DecodeGeometry() || !ValidateIndices()) {
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void CookedMesh::Close() {
+		_file.Close();
+		_buffer.clear();
+		_data = nullptr;
+		_header = nullptr;
+
+		_decodedVertices.clear();
+		_decodedIndices.clear();
+		_vertexData = nullptr;
+		_indexData = nullptr;
+	}
+
+	bool CookedMesh::Validate(uint64_t size) {
+		if (size < sizeof(CookedMeshHeader)) {
+			return false;
+		}
+
+		const CookedMeshHeader* header = reinterpret_cast<const CookedMeshHeader*>(_data);
+		if (header->magic != Magic || header->version != Version || header->fileSize != size) {
+			return false;
+		}
+
+		auto inRange = [size](uint64_t offset, uint64_t bytes, uint64_t alignment) {
+			return offset % alignment == 0 && offset <= size && bytes <= size - offset;
+		};
+
+		if ((header->flags & CookedMeshFlag_CompressedGeometry) == 0
+			&& (header->vertexDataSize != static_cast<uint64_t>(header->vertexStride) * header->vertexCount
+				|| header->indexDataSize != sizeof(uint32_t) * static_cast<uint64_t>(header->indexCount)))
+		{
+			return false;
+		}
+
+		if (!inRange(header->vertexOffset, header->vertexDataSize, 4)
+			|| !inRange(header->indexOffset, header->indexDataSize, alignof(uint32_t))
+			|| !inRange(header->segmentOffset, sizeof(CookedMeshSegment) * static_cast<uint64_t>(header->segmentCount), alignof(CookedMeshSegment))
+			|| !inRange(header->meshletOffset, sizeof(Meshlet) * static_cast<uint64_t>(header->meshletCount), alignof(Meshlet))
+			|| !inRange(header->materialOffset, sizeof(CookedMaterial) * static_cast<uint64_t>(header->materialCount), alignof(CookedMaterial))
+			|| !inRange(header->stringTableOffset, header->stringTableSize, 1))
+		{
+			return false;
+		}
+
+		// NOTE: Every string must be terminated inside the table so GetTexturePath can hand out raw pointers
+		if (header->stringTableSize != 0 && _data[header->stringTableOffset + header->stringTableSize - 1] != '\0') {
+			return false;
+		}
+
+		const CookedMaterial* materials = reinterpret_cast<const CookedMaterial*>(_data + header->materialOffset);
+		for (uint32_t i = 0; i < header->materialCount; ++i) {
+			for (uint32_t slot = 0; slot < CookedTextureSlotCount; ++slot) {
+				const uint32_t offset = materials[i].texturePaths[slot];
+				if (offset != CookedInvalidString && offset >= header->stringTableSize) {
+					return false;
+				}
+			}
+		}
+
+		const CookedMeshSegment* segments = reinterpret_cast<const CookedMeshSegment*>(_data + header->segmentOffset);
+		const Meshlet* meshlets = reinterpret_cast<const Meshlet*>(_data + header->meshletOffset);
+		for (uint32_t i = 0; i < header->segmentCount; ++i) {
+			const CookedMeshSegment& segment = segments[i];
+			if (static_cast<uint64_t>(segment.indexOffset) + segment.indexCount > header->indexCount
+				|| segment.materialIndex >= static_cast<int32_t>(header->materialCount)
+				|| static_cast<uint64_t>(segment.meshletOffset) + segment.meshletCount > header->meshletCount)
+			{
+				return false;
+			}
+
+			// NOTE: Meshlets are drawn as index ranges without further checks, so they must stay inside their segment
+			for (uint32_t j = segment.meshletOffset; j < segment.meshletOffset + segment.meshletCount; ++j) {
+				if (static_cast<uint64_t>(meshlets[j].indexOffset) + meshlets[j].indexCount > segment.indexCount) {
+					return false;
+				}
+			}
+		}
+
+		_header = header;
+
+		return true;
+	}
+
+	bool CookedMesh::DecodeGeometry() {
+		if (!IsCompressed()) {
+			_vertexData = _data + _header->vertexOffset;
+			_indexData = reinterpret_cast<const uint32_t*>(_data + _header->indexOffset);
+			return true;
+		}
+
+		_decodedVertices.resize(static_cast<uint64_t>(_header->vertexStride) * _header->vertexCount);
+		_decodedIndices.resize(_header->indexCount);
+
+		if (!MeshCodec::DecodeVertexBuffer(_data + _header->vertexOffset, _header->vertexDataSize, _decodedVertices.data(), _header->vertexCount, _header->vertexStride)
+			|| !MeshCodec::DecodeIndexBuffer(_data + _header->indexOffset, _header->indexDataSize, _decodedIndices.data(), _header->indexCount))
+		{
+			return false;
+		}
+
+		_vertexData = _decodedVertices.data();
+		_indexData = _decodedIndices.data();
+
+		return true;
+	}
+
+	// NOTE: Runs on the decoded indices, so it covers compressed files as well. Segment indices are relative to the segment's
+	// first vertex, an index past the vertex count would read outside the vertex buffer on the GPU and in CPU side queries.
+	bool CookedMesh::ValidateIndices() const {
+		const CookedMeshSegment* segments = GetSegments();
+		for (uint32_t i = 0; i < _header->segmentCount; ++i) {
+			const CookedMeshSegment& segment = segments[i];
+
+			uint32_t maxIndex = 0;
+			const uint32_t* indices = _indexData + segment.indexOffset;
+			for (uint32_t j = 0; j < segment.indexCount; ++j) {
+				maxIndex = std::max(maxIndex, indices[j]);
+			}
+
+			if (segment.indexCount != 0 && static_cast<uint64_t>(segment.vertexOffset) + maxIndex >= _header->vertexCount) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	const char* CookedMesh::GetTexturePath(uint32_t materialIndex, CookedTextureSlot slot) const {
+		const uint32_t offset = GetMaterials()[materialIndex].texturePaths[static_cast<uint32_t>(slot)];
+		if (offset == CookedInvalidString) {
+			return nullptr;
+		}
+
+		return reinterpret_cast<const char*>(_data + _header->stringTableOffset + offset);
+	}
+}
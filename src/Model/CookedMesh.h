@@ -0,0 +1,170 @@
+#pragma once
+
+#include "Core.h"
+#include "Math/Math.h"
+#include "Platform/MappedFile.h"
+#include "Meshlet.h"
+
+#include <vector>
+#include <string>
+
+namespace flaw {
+	enum class CookedTextureSlot : uint32_t {
+		Diffuse,
+		Specular,
+		Normal,
+		Displacement,
+		AmbientOcclusion,
+		Count
+	};
+
+	constexpr uint32_t CookedTextureSlotCount = static_cast<uint32_t>(CookedTextureSlot::Count);
+	constexpr uint32_t CookedInvalidString = 0xFFFFFFFFu;
+
+	enum CookedMeshFlags : uint32_t {
+		CookedMeshFlag_CompressedGeometry = 1 << 0, // vertex and index blobs are MeshCodec streams
+	};
+
+	struct CookedMeshHeader {
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint64_t sourceKey = 0;
+		uint64_t importKey = 0;
+		uint64_t fileSize = 0;
+
+		vec3 boundsMin = vec3(0.0f);
+		vec3 boundsMax = vec3(0.0f);
+
+		uint32_t vertexStride = 0;
+		uint32_t vertexCount = 0;
+		uint32_t indexCount = 0;
+		uint32_t segmentCount = 0;
+		uint32_t materialCount = 0;
+		uint32_t stringTableSize = 0;
+		uint32_t flags = 0;
+		uint32_t meshletCount = 0;
+
+		uint64_t vertexDataSize = 0;
+		uint64_t indexDataSize = 0;
+
+		uint64_t vertexOffset = 0;
+		uint64_t indexOffset = 0;
+		uint64_t segmentOffset = 0;
+		uint64_t materialOffset = 0;
+		uint64_t stringTableOffset = 0;
+		uint64_t meshletOffset = 0;
+	};
+
+	struct CookedMeshSegment {
+		uint32_t vertexOffset = 0;
+		uint32_t indexOffset = 0;
+		uint32_t indexCount = 0;
+		int32_t materialIndex = -1;
+		uint32_t meshletOffset = 0; // into the meshlet table, meshlet index offsets are relative to the segment's indexOffset
+		uint32_t meshletCount = 0;
+	};
+
+	struct CookedMaterial {
+		vec3 baseColor = vec3(0.0f);
+		uint32_t texturePaths[CookedTextureSlotCount]; // offsets into the string table, CookedInvalidString if unused
+	};
+
+	struct CookedMaterialDesc {
+		vec3 baseColor = vec3(0.0f);
+		std::string texturePaths[CookedTextureSlotCount];
+	};
+
+	struct CookedMeshDesc {
+		uint64_t sourceKey = 0;
+		uint64_t importKey = 0;
+
+		const void* vertices = nullptr;
+		uint32_t vertexStride = 0;
+		uint32_t vertexCount = 0;
+
+		const uint32_t* indices = nullptr;
+		uint32_t indexCount = 0;
+
+		vec3 boundsMin = vec3(0.0f);
+		vec3 boundsMax = vec3(0.0f);
+
+		std::vector<CookedMeshSegment> segments;
+		std::vector<CookedMaterialDesc> materials;
+		std::vector<Meshlet> meshlets;
+
+		// NOTE: Smaller files at the cost of a decode on open, the blobs can no longer be uploaded from the mapped range
+		bool compressGeometry = false;
+	};
+
+	// NOTE: Import result laid out as header, vertex blob, index blob, segment table, meshlet table, material table and string table,
+	// each found by an offset from the start of the file. A mapped file is read in place and its blobs can be uploaded directly,
+	// unless the geometry is compressed, then it is decoded into memory owned by the CookedMesh.
+	class CookedMesh {
+	public:
+		constexpr static uint32_t Magic = 0x4D4B4346; // "FCKM"
+		constexpr static uint32_t Version = 3;
+		constexpr static uint64_t Alignment = 16;
+
+		CookedMesh() = default;
+
+		CookedMesh(const CookedMesh&) = delete;
+		CookedMesh& operator=(const CookedMesh&) = delete;
+
+		// NOTE: Hash of the source file and its companions sharing the same stem (.bin, .mtl)
+		static uint64_t ComputeSourceKey(const char* sourcePath);
+
+		static void Serialize(const CookedMeshDesc& desc, std::vector<uint8_t>& outBuffer);
+		static bool Write(const char* path, const std::vector<uint8_t>& buffer);
+
+		// NOTE: Fails if the file is missing, corrupted or was cooked from a different source or with different import settings
+		bool Open(const char* path, uint64_t sourceKey, uint64_t importKey);
+		// NOTE: Takes ownership of a buffer produced by Serialize, for results that could not be written to disk
+		bool Open(std::vector<uint8_t>&& buffer);
+
+		void Close();
+
+		bool IsOpen() const { return _header != nullptr; }
+		bool IsMapped() const { return _file.IsOpen(); }
+		bool IsCompressed() const { return (_header->flags & CookedMeshFlag_CompressedGeometry) != 0; }
+
+		const void* GetVertexData() const { return _vertexData; }
+		uint32_t GetVertexStride() const { return _header->vertexStride; }
+		uint32_t GetVertexCount() const { return _header->vertexCount; }
+
+		const uint32_t* GetIndexData() const { return _indexData; }
+		uint32_t GetIndexCount() const { return _header->indexCount; }
+
+		const CookedMeshSegment* GetSegments() const { return reinterpret_cast<const CookedMeshSegment*>(_data + _header->segmentOffset); }
+		uint32_t GetSegmentCount() const { return _header->segmentCount; }
+
+		const Meshlet* GetMeshlets() const { return reinterpret_cast<const Meshlet*>(_data + _header->meshletOffset); }
+		uint32_t GetMeshletCount() const { return _header->meshletCount; }
+
+		const CookedMaterial* GetMaterials() const { return reinterpret_cast<const CookedMaterial*>(_data + _header->materialOffset); }
+		uint32_t GetMaterialCount() const { return _header->materialCount; }
+
+		// NOTE: nullptr if the slot has no texture
+		const char* GetTexturePath(uint32_t materialIndex, CookedTextureSlot slot) const;
+
+		const vec3& GetBoundsMin() const { return _header->boundsMin; }
+		const vec3& GetBoundsMax() const { return _header->boundsMax; }
+
+	private:
+		bool Validate(uint64_t size);
+		bool DecodeGeometry();
+		bool ValidateIndices() const;
+
+	private:
+		MappedFile _file;
+		std::vector<uint8_t> _buffer;
+
+		const uint8_t* _data = nullptr;
+		const CookedMeshHeader* _header = nullptr;
+
+		std::vector<uint8_t> _decodedVertices;
+		std::vector<uint32_t> _decodedIndices;
+
+		const void* _vertexData = nullptr;
+		const uint32_t* _indexData = nullptr;
+	};
+}
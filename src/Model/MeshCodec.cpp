@@ -0,0 +1,407 @@
+#include "pch.h"
+#include "MeshCodec.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FLAW_MESHCODEC_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace flaw {
+	constexpr uint8_t IndexCodeNext = 0;
+	constexpr uint8_t IndexCodeLiteral = 15;
+
+	constexpr uint32_t VertexGroupSize = 16;
+	constexpr uint32_t MaxVertexWords = MeshCodec::MaxVertexStride / 4;
+
+	static_assert(MeshCodec::IndexFifoSize + 2 <= 16, "Index codes must fit in 4 bits");
+	static_assert(MeshCodec::VertexBlockSize % VertexGroupSize == 0, "Vertex blocks must be made of whole groups");
+
+	static uint32_t EncodeZigZag(uint32_t value) {
+		return (value << 1) ^ static_cast<uint32_t>(static_cast<int32_t>(value) >> 31);
+	}
+
+	static uint32_t DecodeZigZag(uint32_t value) {
+		return (value >> 1) ^ (0u - (value & 1));
+	}
+
+	static void WriteVarint(uint32_t value, std::vector<uint8_t>& outBuffer) {
+		while (value >= 0x80) {
+			outBuffer.push_back(static_cast<uint8_t>(value | 0x80));
+			value >>= 7;
+		}
+
+		outBuffer.push_back(static_cast<uint8_t>(value));
+	}
+
+	static const uint8_t* ReadVarint(const uint8_t* data, const uint8_t* end, uint32_t& outValue) {
+		uint32_t value = 0;
+		for (uint32_t shift = 0; shift < 35; shift += 7) {
+			if (data == end) {
+				return nullptr;
+			}
+
+			const uint8_t byte = *data++;
+			value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+
+			if ((byte & 0x80) == 0) {
+				outValue = value;
+				return data;
+			}
+		}
+
+		return nullptr;
+	}
+
+	// NOTE: Ring buffer of the last emitted vertices, position 0 is the most recent one
+	struct IndexFifo {
+		uint32_t entries[16];
+		uint32_t head = 0;
+
+		uint32_t Size() const { return std::min(head, MeshCodec::IndexFifoSize); }
+		uint32_t At(uint32_t position) const { return entries[(head - 1 - position) & 15]; }
+		void Push(uint32_t index) { entries[head++ & 15] = index; }
+
+		int32_t Find(uint32_t index) const {
+			const uint32_t size = Size();
+			for (uint32_t i = 0; i < size; ++i) {
+				if (At(i) == index) {
+					return static_cast<int32_t>(i);
+				}
+			}
+
+			return -1;
+		}
+	};
+
+	void MeshCodec::EncodeIndexBuffer(const uint32_t* indices, uint32_t indexCount, std::vector<uint8_t>& outBuffer) {
+		outBuffer.clear();
+		outBuffer.push_back(IndexCodecVersion);
+
+		const uint64_t codeOffset = outBuffer.size();
+		outBuffer.resize(codeOffset + (static_cast<uint64_t>(indexCount) + 1) / 2, 0);
+
+		IndexFifo fifo;
+		uint32_t next = 0;
+
+		for (uint32_t i = 0; i < indexCount; ++i) {
+			const uint32_t index = indices[i];
+
+			uint8_t code;
+			if (index == next) {
+				code = IndexCodeNext;
+				next++;
+				fifo.Push(index);
+			}
+			else if (int32_t position = fifo.Find(index); position != -1) {
+				code = static_cast<uint8_t>(position + 1);
+			}
+			else {
+				code = IndexCodeLiteral;
+				WriteVarint(EncodeZigZag(index - next), outBuffer);
+
+				if (index >= next) {
+					next = index + 1;
+				}
+
+				fifo.Push(index);
+			}
+
+			outBuffer[codeOffset + i / 2] |= static_cast<uint8_t>(code << ((i & 1) * 4));
+		}
+	}
+
+	bool MeshCodec::DecodeIndexBuffer(const uint8_t* buffer, uint64_t bufferSize, uint32_t* outIndices, uint32_t indexCount) {
+		const uint64_t codeSize = (static_cast<uint64_t>(indexCount) + 1) / 2;
+		if (bufferSize < 1 + codeSize || buffer[0] != IndexCodecVersion) {
+			return false;
+		}
+
+		const uint8_t* codes = buffer + 1;
+		const uint8_t* data = codes + codeSize;
+		const uint8_t* end = buffer + bufferSize;
+
+		IndexFifo fifo;
+		uint32_t next = 0;
+
+		for (uint32_t i = 0; i < indexCount; ++i) {
+			const uint8_t code = (codes[i / 2] >> ((i & 1) * 4)) & 0x0F;
+
+			uint32_t index;
+			if (code == IndexCodeNext) {
+				index = next++;
+				fifo.Push(index);
+			}
+			else if (code != IndexCodeLiteral) {
+				if (code > fifo.Size()) {
+					return false;
+				}
+
+				index = fifo.At(code - 1);
+			}
+			else {
+				uint32_t delta;
+				data = ReadVarint(data, end, delta);
+				if (!data) {
+					return false;
+				}
+
+				index = next + DecodeZigZag(delta);
+				if (index >= next) {
+					next = index + 1;
+				}
+
+				fifo.Push(index);
+			}
+
+			outIndices[i] = index;
+		}
+
+		return data == end;
+	}
+
+	// NOTE: Group widths in bits, indexed by the 2 bit mode stored in the plane header
+	static uint32_t GetGroupDataSize(uint32_t mode) {
+		return mode == 0 ? 0 : 2u << mode;
+	}
+
+	static void EncodeBytePlane(const uint8_t* bytes, uint32_t groupCount, std::vector<uint8_t>& outBuffer) {
+		const uint64_t headerOffset = outBuffer.size();
+		outBuffer.resize(headerOffset + (groupCount + 3) / 4, 0);
+
+		for (uint32_t group = 0; group < groupCount; ++group) {
+			const uint8_t* values = bytes + group * VertexGroupSize;
+
+			uint8_t maxValue = 0;
+			for (uint32_t i = 0; i < VertexGroupSize; ++i) {
+				maxValue = std::max(maxValue, values[i]);
+			}
+
+			uint32_t mode = 3;
+			if (maxValue == 0) {
+				mode = 0;
+			}
+			else if (maxValue < 4) {
+				mode = 1;
+			}
+			else if (maxValue < 16) {
+				mode = 2;
+			}
+
+			outBuffer[headerOffset + group / 4] |= static_cast<uint8_t>(mode << ((group & 3) * 2));
+
+			const uint32_t bits = mode == 3 ? 8 : mode * 2;
+			const uint32_t valuesPerByte = 8 / std::max(bits, 1u);
+
+			for (uint32_t i = 0; i < GetGroupDataSize(mode); ++i) {
+				uint8_t packed = 0;
+				for (uint32_t j = 0; j < valuesPerByte; ++j) {
+					packed |= static_cast<uint8_t>(values[i * valuesPerByte + j] << (j * bits));
+				}
+
+				outBuffer.push_back(packed);
+			}
+		}
+	}
+
+	static void DecodeGroup(uint32_t mode, const uint8_t* data, uint8_t* outValues) {
+		switch (mode) {
+		case 0:
+			std::memset(outValues, 0, VertexGroupSize);
+			break;
+		case 3:
+			std::memcpy(outValues, data, VertexGroupSize);
+			break;
+#if FLAW_MESHCODEC_SSE2
+		case 1: {
+			int32_t word;
+			std::memcpy(&word, data, sizeof(word));
+
+			const __m128i packed = _mm_cvtsi32_si128(word);
+			const __m128i mask = _mm_set1_epi8(3);
+
+			const __m128i v0 = _mm_and_si128(packed, mask);
+			const __m128i v1 = _mm_and_si128(_mm_srli_epi16(packed, 2), mask);
+			const __m128i v2 = _mm_and_si128(_mm_srli_epi16(packed, 4), mask);
+			const __m128i v3 = _mm_and_si128(_mm_srli_epi16(packed, 6), mask);
+
+			const __m128i values = _mm_unpacklo_epi16(_mm_unpacklo_epi8(v0, v1), _mm_unpacklo_epi8(v2, v3));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(outValues), values);
+			break;
+		}
+		case 2: {
+			const __m128i packed = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(data));
+			const __m128i mask = _mm_set1_epi8(15);
+
+			const __m128i low = _mm_and_si128(packed, mask);
+			const __m128i high = _mm_and_si128(_mm_srli_epi16(packed, 4), mask);
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(outValues), _mm_unpacklo_epi8(low, high));
+			break;
+		}
+#else
+		case 1:
+			for (uint32_t i = 0; i < VertexGroupSize; ++i) {
+				outValues[i] = (data[i / 4] >> ((i & 3) * 2)) & 3;
+			}
+			break;
+		case 2:
+			for (uint32_t i = 0; i < VertexGroupSize; ++i) {
+				outValues[i] = (data[i / 2] >> ((i & 1) * 4)) & 15;
+			}
+			break;
+#endif
+		}
+	}
+
+	static const uint8_t* DecodeBytePlane(const uint8_t* data, const uint8_t* end, uint32_t groupCount, uint8_t* outBytes) {
+		const uint32_t headerSize = (groupCount + 3) / 4;
+		if (static_cast<uint64_t>(end - data) < headerSize) {
+			return nullptr;
+		}
+
+		const uint8_t* header = data;
+		data += headerSize;
+
+		for (uint32_t group = 0; group < groupCount; ++group) {
+			const uint32_t mode = (header[group / 4] >> ((group & 3) * 2)) & 3;
+			const uint32_t size = GetGroupDataSize(mode);
+
+			if (static_cast<uint64_t>(end - data) < size) {
+				return nullptr;
+			}
+
+			DecodeGroup(mode, data, outBytes + group * VertexGroupSize);
+			data += size;
+		}
+
+		return data;
+	}
+
+	bool MeshCodec::EncodeVertexBuffer(const void* vertices, uint32_t vertexCount, uint32_t vertexStride, std::vector<uint8_t>& outBuffer) {
+		if (vertexStride == 0 || vertexStride % 4 != 0 || vertexStride > MaxVertexStride) {
+			return false;
+		}
+
+		outBuffer.clear();
+		outBuffer.push_back(VertexCodecVersion);
+
+		const uint8_t* source = static_cast<const uint8_t*>(vertices);
+		const uint32_t wordCount = vertexStride / 4;
+
+		uint32_t previous[MaxVertexWords] = {};
+		uint32_t deltas[VertexBlockSize];
+		uint8_t plane[VertexBlockSize];
+
+		for (uint32_t blockStart = 0; blockStart < vertexCount; blockStart += VertexBlockSize) {
+			const uint32_t blockSize = std::min(VertexBlockSize, vertexCount - blockStart);
+			const uint32_t groupCount = (blockSize + VertexGroupSize - 1) / VertexGroupSize;
+
+			for (uint32_t word = 0; word < wordCount; ++word) {
+				for (uint32_t i = 0; i < blockSize; ++i) {
+					uint32_t value;
+					std::memcpy(&value, source + static_cast<uint64_t>(blockStart + i) * vertexStride + word * 4, sizeof(value));
+
+					deltas[i] = EncodeZigZag(value - previous[word]);
+					previous[word] = value;
+				}
+
+				std::fill(deltas + blockSize, deltas + groupCount * VertexGroupSize, 0u);
+
+				for (uint32_t byte = 0; byte < 4; ++byte) {
+					for (uint32_t i = 0; i < groupCount * VertexGroupSize; ++i) {
+						plane[i] = static_cast<uint8_t>(deltas[i] >> (byte * 8));
+					}
+
+					EncodeBytePlane(plane, groupCount, outBuffer);
+				}
+			}
+		}
+
+		return true;
+	}
+
+	// NOTE: Rebuilds one word of every vertex in the block from its byte planes and writes it with the vertex stride
+	static void ReconstructWord(const uint8_t (&planes)[4][MeshCodec::VertexBlockSize], uint32_t blockSize, uint32_t& previous, uint8_t* destination, uint32_t vertexStride) {
+		uint32_t i = 0;
+
+#if FLAW_MESHCODEC_SSE2
+		__m128i last = _mm_set1_epi32(static_cast<int32_t>(previous));
+		const __m128i one = _mm_set1_epi32(1);
+
+		for (; i + 4 <= blockSize; i += 4) {
+			int32_t bytes[4];
+			for (uint32_t byte = 0; byte < 4; ++byte) {
+				std::memcpy(&bytes[byte], planes[byte] + i, sizeof(int32_t));
+			}
+
+			const __m128i low = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes[0]), _mm_cvtsi32_si128(bytes[1]));
+			const __m128i high = _mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes[2]), _mm_cvtsi32_si128(bytes[3]));
+			__m128i value = _mm_unpacklo_epi16(low, high);
+
+			value = _mm_xor_si128(_mm_srli_epi32(value, 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(value, one)));
+
+			// NOTE: Prefix sum of the 4 deltas, then offset by the last decoded value
+			value = _mm_add_epi32(value, _mm_slli_si128(value, 4));
+			value = _mm_add_epi32(value, _mm_slli_si128(value, 8));
+			value = _mm_add_epi32(value, last);
+
+			last = _mm_shuffle_epi32(value, _MM_SHUFFLE(3, 3, 3, 3));
+
+			alignas(16) uint32_t words[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(words), value);
+
+			for (uint32_t j = 0; j < 4; ++j) {
+				std::memcpy(destination + static_cast<uint64_t>(i + j) * vertexStride, &words[j], sizeof(uint32_t));
+			}
+		}
+
+		previous = static_cast<uint32_t>(_mm_cvtsi128_si32(last));
+#endif
+
+		for (; i < blockSize; ++i) {
+			const uint32_t delta = planes[0][i] | (planes[1][i] << 8) | (planes[2][i] << 16) | (static_cast<uint32_t>(planes[3][i]) << 24);
+			previous += DecodeZigZag(delta);
+
+			std::memcpy(destination + static_cast<uint64_t>(i) * vertexStride, &previous, sizeof(uint32_t));
+		}
+	}
+
+	bool MeshCodec::DecodeVertexBuffer(const uint8_t* buffer, uint64_t bufferSize, void* outVertices, uint32_t vertexCount, uint32_t vertexStride) {
+		if (vertexStride == 0 || vertexStride % 4 != 0 || vertexStride > MaxVertexStride) {
+			return false;
+		}
+
+		if (bufferSize < 1 || buffer[0] != VertexCodecVersion) {
+			return false;
+		}
+
+		const uint8_t* data = buffer + 1;
+		const uint8_t* end = buffer + bufferSize;
+
+		uint8_t* destination = static_cast<uint8_t*>(outVertices);
+		const uint32_t wordCount = vertexStride / 4;
+
+		uint32_t previous[MaxVertexWords] = {};
+		alignas(16) uint8_t planes[4][VertexBlockSize];
+
+		for (uint32_t blockStart = 0; blockStart < vertexCount; blockStart += VertexBlockSize) {
+			const uint32_t blockSize = std::min(VertexBlockSize, vertexCount - blockStart);
+			const uint32_t groupCount = (blockSize + VertexGroupSize - 1) / VertexGroupSize;
+
+			for (uint32_t word = 0; word < wordCount; ++word) {
+				for (uint32_t byte = 0; byte < 4; ++byte) {
+					data = DecodeBytePlane(data, end, groupCount, planes[byte]);
+					if (!data) {
+						return false;
+					}
+				}
+
+				ReconstructWord(planes, blockSize, previous[word], destination + static_cast<uint64_t>(blockStart) * vertexStride + word * 4, vertexStride);
+			}
+		}
+
+		return data == end;
+	}
+}
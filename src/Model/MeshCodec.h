@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Core.h"
+
+#include <vector>
+
+namespace flaw {
+	// NOTE: Lossless codec for cooked geometry, decoding reproduces the input bit for bit.
+	//
+	// Index buffers: every index gets a 4 bit code. 0 means the next unseen vertex, 1-14 a position in a FIFO of recently
+	// emitted vertices and 15 a literal stored as a zigzag varint delta. Strip-like, vertex cache optimized orders hit the
+	// first two cases almost every time, so most triangles cost 12 bits.
+	//
+	// Vertex buffers: each 32 bit word of the vertex is delta coded against the same word of the previous vertex, the zigzag
+	// deltas are split into 4 byte planes and each plane is bit-packed in groups of 16 bytes with a width of 0, 2, 4 or 8 bits
+	// chosen per group. Groups decode with a fixed shuffle per width, which maps directly onto SIMD registers.
+	class MeshCodec {
+	public:
+		constexpr static uint8_t IndexCodecVersion = 1;
+		constexpr static uint8_t VertexCodecVersion = 1;
+
+		constexpr static uint32_t IndexFifoSize = 14;
+		constexpr static uint32_t VertexBlockSize = 256;
+		constexpr static uint32_t MaxVertexStride = 256;
+
+		static void EncodeIndexBuffer(const uint32_t* indices, uint32_t indexCount, std::vector<uint8_t>& outBuffer);
+		static bool DecodeIndexBuffer(const uint8_t* buffer, uint64_t bufferSize, uint32_t* outIndices, uint32_t indexCount);
+
+		// NOTE: vertexStride must be a multiple of 4 and at most MaxVertexStride
+		static bool EncodeVertexBuffer(const void* vertices, uint32_t vertexCount, uint32_t vertexStride, std::vector<uint8_t>& outBuffer);
+		static bool DecodeVertexBuffer(const uint8_t* buffer, uint64_t bufferSize, void* outVertices, uint32_t vertexCount, uint32_t vertexStride);
+	};
+}
@@ -0,0 +1,370 @@
+#include "pch.h"
+#include "MeshOptimizer.h"
+#include "Math/Math.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace flaw {
+	constexpr float CacheDecayPower = 1.5f;
+	constexpr float LastTriangleScore = 0.75f;
+	constexpr float ValenceBoostScale = 2.0f;
+	constexpr float ValenceBoostPower = 0.5f;
+
+	constexpr uint32_t InvalidIndex = ~0u;
+
+	// NOTE: Triangles around each vertex, packed per vertex. Emitted triangles are swapped out of the live part of each list.
+	struct TriangleAdjacency {
+		std::vector<uint32_t> counts;
+		std::vector<uint32_t> offsets;
+		std::vector<uint32_t> triangles;
+
+		void Build(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount) {
+			counts.assign(vertexCount, 0);
+			offsets.assign(vertexCount, 0);
+			triangles.resize(indexCount);
+
+			for (uint32_t i = 0; i < indexCount; ++i) {
+				counts[indices[i]]++;
+			}
+
+			uint32_t offset = 0;
+			for (uint32_t i = 0; i < vertexCount; ++i) {
+				offsets[i] = offset;
+				offset += counts[i];
+			}
+
+			std::vector<uint32_t> fill(vertexCount, 0);
+			for (uint32_t i = 0; i < indexCount; ++i) {
+				const uint32_t vertex = indices[i];
+				triangles[offsets[vertex] + fill[vertex]++] = i / 3;
+			}
+		}
+
+		void Remove(uint32_t vertex, uint32_t triangle) {
+			uint32_t* begin = triangles.data() + offsets[vertex];
+			for (uint32_t i = 0; i < counts[vertex]; ++i) {
+				if (begin[i] == triangle) {
+					begin[i] = begin[counts[vertex] - 1];
+					counts[vertex]--;
+					return;
+				}
+			}
+		}
+	};
+
+	static float GetVertexScore(int32_t cachePosition, uint32_t liveTriangles) {
+		if (liveTriangles == 0) {
+			return -1.0f;
+		}
+
+		float score = 0.0f;
+		if (cachePosition >= 0) {
+			if (cachePosition < 3) {
+				score = LastTriangleScore;
+			}
+			else {
+				const float scaler = 1.0f / (MeshOptimizer::VertexCacheSize - 3);
+				score = std::pow(1.0f - (cachePosition - 3) * scaler, CacheDecayPower);
+			}
+		}
+
+		return score + ValenceBoostScale * std::pow(static_cast<float>(liveTriangles), -ValenceBoostPower);
+	}
+
+	// NOTE: FIFO cache stamped with the time each vertex entered it, a vertex is a hit while it is less than cacheSize misses old
+	struct FifoCache {
+		std::vector<uint32_t> timestamps;
+		uint32_t time;
+		uint32_t cacheSize;
+
+		FifoCache(uint32_t vertexCount, uint32_t size)
+			: timestamps(vertexCount, 0)
+			, time(size + 1)
+			, cacheSize(size)
+		{
+		}
+
+		bool Access(uint32_t vertex) {
+			if (time - timestamps[vertex] > cacheSize) {
+				timestamps[vertex] = time++;
+				return false;
+			}
+			return true;
+		}
+
+		void Reset() {
+			time += cacheSize + 1;
+		}
+	};
+
+	MeshOptimizer::VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize) {
+		VertexCacheStats stats;
+		stats.triangleCount = indexCount / 3;
+
+		FifoCache cache(vertexCount, cacheSize);
+		std::vector<bool> used(vertexCount, false);
+
+		for (uint32_t i = 0; i < indexCount; ++i) {
+			const uint32_t vertex = indices[i];
+			if (!cache.Access(vertex)) {
+				stats.transformedVertices++;
+			}
+
+			if (!used[vertex]) {
+				used[vertex] = true;
+				stats.vertexCount++;
+			}
+		}
+
+		return stats;
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount) {
+		const uint32_t triangleCount = indexCount / 3;
+		if (triangleCount == 0) {
+			return;
+		}
+
+		const std::vector<uint32_t> source(indices, indices + triangleCount * 3);
+
+		TriangleAdjacency adjacency;
+		adjacency.Build(source.data(), triangleCount * 3, vertexCount);
+
+		std::vector<float> vertexScores(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; ++i) {
+			vertexScores[i] = GetVertexScore(-1, adjacency.counts[i]);
+		}
+
+		std::vector<float> triangleScores(triangleCount);
+		for (uint32_t i = 0; i < triangleCount; ++i) {
+			triangleScores[i] = vertexScores[source[i * 3]] + vertexScores[source[i * 3 + 1]] + vertexScores[source[i * 3 + 2]];
+		}
+
+		std::vector<bool> emitted(triangleCount, false);
+
+		uint32_t cache[VertexCacheSize + 3];
+		uint32_t cacheCount = 0;
+
+		uint32_t bestTriangle = InvalidIndex;
+		uint32_t inputCursor = 0;
+
+		for (uint32_t outputTriangle = 0; outputTriangle < triangleCount; ++outputTriangle) {
+			// NOTE: Dead end, nothing around the cache is left so continue with the next triangle in input order
+			if (bestTriangle == InvalidIndex) {
+				while (emitted[inputCursor]) {
+					inputCursor++;
+				}
+				bestTriangle = inputCursor;
+			}
+
+			const uint32_t a = source[bestTriangle * 3];
+			const uint32_t b = source[bestTriangle * 3 + 1];
+			const uint32_t c = source[bestTriangle * 3 + 2];
+
+			indices[outputTriangle * 3] = a;
+			indices[outputTriangle * 3 + 1] = b;
+			indices[outputTriangle * 3 + 2] = c;
+
+			emitted[bestTriangle] = true;
+			adjacency.Remove(a, bestTriangle);
+			adjacency.Remove(b, bestTriangle);
+			adjacency.Remove(c, bestTriangle);
+
+			// NOTE: The triangle's vertices move to the front, entries pushed past the cache size are evicted but still rescored
+			uint32_t newCache[VertexCacheSize + 3];
+			uint32_t newCacheCount = 0;
+			newCache[newCacheCount++] = a;
+			newCache[newCacheCount++] = b;
+			newCache[newCacheCount++] = c;
+
+			for (uint32_t i = 0; i < cacheCount; ++i) {
+				const uint32_t vertex = cache[i];
+				if (vertex != a && vertex != b && vertex != c) {
+					newCache[newCacheCount++] = vertex;
+				}
+			}
+
+			std::memcpy(cache, newCache, sizeof(uint32_t) * newCacheCount);
+			cacheCount = std::min(newCacheCount, VertexCacheSize);
+
+			for (uint32_t i = 0; i < newCacheCount; ++i) {
+				const uint32_t vertex = newCache[i];
+				const int32_t position = i < VertexCacheSize ? static_cast<int32_t>(i) : -1;
+				const float score = GetVertexScore(position, adjacency.counts[vertex]);
+				const float delta = score - vertexScores[vertex];
+				vertexScores[vertex] = score;
+
+				const uint32_t* triangles = adjacency.triangles.data() + adjacency.offsets[vertex];
+				for (uint32_t j = 0; j < adjacency.counts[vertex]; ++j) {
+					triangleScores[triangles[j]] += delta;
+				}
+			}
+
+			bestTriangle = InvalidIndex;
+			float bestScore = 0.0f;
+			for (uint32_t i = 0; i < cacheCount; ++i) {
+				const uint32_t vertex = cache[i];
+				const uint32_t* triangles = adjacency.triangles.data() + adjacency.offsets[vertex];
+				for (uint32_t j = 0; j < adjacency.counts[vertex]; ++j) {
+					if (bestTriangle == InvalidIndex || triangleScores[triangles[j]] > bestScore) {
+						bestTriangle = triangles[j];
+						bestScore = triangleScores[triangles[j]];
+					}
+				}
+			}
+		}
+	}
+
+	void MeshOptimizer::OptimizeOverdraw(uint32_t* indices, uint32_t indexCount, const void* vertices, uint32_t vertexCount, uint32_t vertexStride, float threshold) {
+		const uint32_t triangleCount = indexCount / 3;
+		if (triangleCount < 2) {
+			return;
+		}
+
+		auto getPosition = [&](uint32_t vertex) {
+			float position[3];
+			std::memcpy(position, static_cast<const uint8_t*>(vertices) + static_cast<size_t>(vertex) * vertexStride, sizeof(position));
+			return vec3(position[0], position[1], position[2]);
+		};
+
+		auto getTriangleMisses = [&](FifoCache& cache, uint32_t triangle) {
+			return static_cast<uint32_t>(!cache.Access(indices[triangle * 3])) + !cache.Access(indices[triangle * 3 + 1]) + !cache.Access(indices[triangle * 3 + 2]);
+		};
+
+		// NOTE: Hard boundaries are where all three vertices of a triangle miss, the cache optimized order restarts there anyway
+		std::vector<uint32_t> hardStarts = { 0 };
+
+		FifoCache cache(vertexCount, AnalyzeCacheSize);
+		for (uint32_t i = 0; i < triangleCount; ++i) {
+			if (getTriangleMisses(cache, i) == 3 && i > 0) {
+				hardStarts.push_back(i);
+			}
+		}
+
+		// NOTE: Inside a hard cluster a soft boundary is cut as soon as the piece so far, starting from a cold cache, is within
+		// threshold of the ACMR of the whole hard cluster
+		std::vector<uint32_t> clusterStarts;
+
+		for (uint32_t hard = 0; hard < hardStarts.size(); ++hard) {
+			const uint32_t begin = hardStarts[hard];
+			const uint32_t end = hard + 1 < hardStarts.size() ? hardStarts[hard + 1] : triangleCount;
+
+			cache.Reset();
+			uint32_t hardMisses = 0;
+			for (uint32_t i = begin; i < end; ++i) {
+				hardMisses += getTriangleMisses(cache, i);
+			}
+
+			const float targetACMR = threshold * hardMisses / (end - begin);
+
+			clusterStarts.push_back(begin);
+			cache.Reset();
+
+			uint32_t clusterStart = begin;
+			uint32_t clusterMisses = 0;
+			for (uint32_t i = begin; i + 1 < end; ++i) {
+				clusterMisses += getTriangleMisses(cache, i);
+
+				if (static_cast<float>(clusterMisses) / (i - clusterStart + 1) <= targetACMR) {
+					clusterStart = i + 1;
+					clusterStarts.push_back(clusterStart);
+					clusterMisses = 0;
+					cache.Reset();
+				}
+			}
+		}
+
+		const uint32_t clusterCount = static_cast<uint32_t>(clusterStarts.size());
+
+		vec3 meshCentroid(0.0f);
+		float meshArea = 0.0f;
+
+		std::vector<vec3> clusterCentroids(clusterCount, vec3(0.0f));
+		std::vector<vec3> clusterNormals(clusterCount, vec3(0.0f));
+
+		for (uint32_t cluster = 0; cluster < clusterCount; ++cluster) {
+			const uint32_t begin = clusterStarts[cluster];
+			const uint32_t end = cluster + 1 < clusterCount ? clusterStarts[cluster + 1] : triangleCount;
+
+			float clusterArea = 0.0f;
+			for (uint32_t i = begin; i < end; ++i) {
+				const vec3 p0 = getPosition(indices[i * 3]);
+				const vec3 p1 = getPosition(indices[i * 3 + 1]);
+				const vec3 p2 = getPosition(indices[i * 3 + 2]);
+
+				const vec3 normal = glm::cross(p1 - p0, p2 - p0);
+				const float area = glm::length(normal);
+
+				clusterCentroids[cluster] += (p0 + p1 + p2) * (area / 3.0f);
+				clusterNormals[cluster] += normal;
+				clusterArea += area;
+			}
+
+			meshCentroid += clusterCentroids[cluster];
+			meshArea += clusterArea;
+
+			clusterCentroids[cluster] = clusterArea > 0.0f ? clusterCentroids[cluster] / clusterArea : getPosition(indices[begin * 3]);
+		}
+
+		if (meshArea > 0.0f) {
+			meshCentroid /= meshArea;
+		}
+
+		// NOTE: Clusters far out along their own normal are likely in front of the rest from any direction they are visible
+		std::vector<float> sortKeys(clusterCount);
+		for (uint32_t cluster = 0; cluster < clusterCount; ++cluster) {
+			const float normalLength = glm::length(clusterNormals[cluster]);
+			const vec3 normal = normalLength > 0.0f ? clusterNormals[cluster] / normalLength : vec3(0.0f);
+			sortKeys[cluster] = glm::dot(clusterCentroids[cluster] - meshCentroid, normal);
+		}
+
+		std::vector<uint32_t> order(clusterCount);
+		for (uint32_t i = 0; i < clusterCount; ++i) {
+			order[i] = i;
+		}
+
+		std::stable_sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) { return sortKeys[lhs] > sortKeys[rhs]; });
+
+		const std::vector<uint32_t> source(indices, indices + triangleCount * 3);
+
+		uint32_t output = 0;
+		for (uint32_t cluster : order) {
+			const uint32_t begin = clusterStarts[cluster];
+			const uint32_t end = cluster + 1 < clusterCount ? clusterStarts[cluster + 1] : triangleCount;
+
+			std::memcpy(indices + output, source.data() + begin * 3, sizeof(uint32_t) * (end - begin) * 3);
+			output += (end - begin) * 3;
+		}
+	}
+
+	uint32_t MeshOptimizer::OptimizeVertexFetch(void* vertices, uint32_t vertexCount, uint32_t vertexStride, uint32_t* indices, uint32_t indexCount) {
+		std::vector<uint32_t> remap(vertexCount, InvalidIndex);
+
+		uint32_t usedCount = 0;
+		for (uint32_t i = 0; i < indexCount; ++i) {
+			uint32_t& target = remap[indices[i]];
+			if (target == InvalidIndex) {
+				target = usedCount++;
+			}
+			indices[i] = target;
+		}
+
+		uint32_t unusedCount = usedCount;
+		for (uint32_t i = 0; i < vertexCount; ++i) {
+			if (remap[i] == InvalidIndex) {
+				remap[i] = unusedCount++;
+			}
+		}
+
+		uint8_t* bytes = static_cast<uint8_t*>(vertices);
+		const std::vector<uint8_t> source(bytes, bytes + static_cast<size_t>(vertexCount) * vertexStride);
+
+		for (uint32_t i = 0; i < vertexCount; ++i) {
+			std::memcpy(bytes + static_cast<size_t>(remap[i]) * vertexStride, source.data() + static_cast<size_t>(i) * vertexStride, vertexStride);
+		}
+
+		return usedCount;
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Core.h"
+
+namespace flaw {
+	// NOTE: Import time reordering of indexed triangle lists, indices are local to the vertex range they index.
+	//
+	// Vertex cache: Forsyth's greedy ordering, each step emits the best scored triangle around the vertices of a simulated
+	// LRU cache, scores favor recently used vertices and vertices with few triangles left.
+	// Overdraw: the cache optimized order is cut into clusters where the cache restarts anyway, or where the running ACMR is
+	// within the threshold, and clusters facing away from the mesh center are drawn first so they occlude the inner ones.
+	// Vertex fetch: vertices are rewritten in the order the indices first use them, unused ones are moved to the end.
+	class MeshOptimizer {
+	public:
+		constexpr static uint32_t Version = 1;
+
+		constexpr static uint32_t VertexCacheSize = 32;
+		constexpr static uint32_t AnalyzeCacheSize = 16;
+
+		struct VertexCacheStats {
+			uint32_t transformedVertices = 0;
+			uint32_t triangleCount = 0;
+			uint32_t vertexCount = 0;
+
+			// NOTE: Average cache miss ratio, transformed vertices per triangle. 0.5 is the limit for regular grids, 3 means no reuse.
+			float GetACMR() const { return triangleCount ? static_cast<float>(transformedVertices) / triangleCount : 0.0f; }
+
+			// NOTE: Average transformed vertex ratio, transformed vertices per vertex. 1 is optimal.
+			float GetATVR() const { return vertexCount ? static_cast<float>(transformedVertices) / vertexCount : 0.0f; }
+
+			void Add(const VertexCacheStats& other) {
+				transformedVertices += other.transformedVertices;
+				triangleCount += other.triangleCount;
+				vertexCount += other.vertexCount;
+			}
+		};
+
+		// NOTE: Simulates a FIFO post transform cache of cacheSize entries, vertexCount counts only the vertices the indices use
+		static VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, uint32_t indexCount, uint32_t vertexCount, uint32_t cacheSize = AnalyzeCacheSize);
+
+		static void OptimizeVertexCache(uint32_t* indices, uint32_t indexCount, uint32_t vertexCount);
+
+		// NOTE: Run after OptimizeVertexCache. Positions are read as three floats at the start of each vertex, threshold is how much
+		// worse than the input ACMR a cluster may be, 1.05 keeps it within 5%.
+		static void OptimizeOverdraw(uint32_t* indices, uint32_t indexCount, const void* vertices, uint32_t vertexCount, uint32_t vertexStride, float threshold = 1.05f);
+
+		// NOTE: Returns the number of vertices the indices use, the first ones of the rewritten range
+		static uint32_t OptimizeVertexFetch(void* vertices, uint32_t vertexCount, uint32_t vertexStride, uint32_t* indices, uint32_t indexCount);
+	};
+}
@@ -0,0 +1,275 @@
+#include "pch.h"
+#include "Meshlet.h"
+
+#include <cstring>
+#include <limits>
+
+namespace flaw {
+	static_assert(std::is_trivially_copyable_v<Meshlet>, "Meshlet must be trivially copyable to be mapped from a file");
+
+	// NOTE: How many new vertices a triangle fully bending the cone away is worth when picking the next one
+	constexpr float ConeWeight = 0.5f;
+
+	// NOTE: Below this the triangles spread over more than a hemisphere and the cone cannot reject anything useful
+	constexpr float MinConeSpread = 0.1f;
+
+	// NOTE: Unassigned triangles looked at, in input order, when nothing around the meshlet fits
+	constexpr uint32_t FallbackWindow = 64;
+
+	constexpr uint32_t InvalidIndex = ~0u;
+
+	static vec3 ReadVec3(const void* vertices, uint32_t vertexStride, uint32_t vertex, uint32_t offset) {
+		float value[3];
+		std::memcpy(value, static_cast<const uint8_t*>(vertices) + static_cast<size_t>(vertex) * vertexStride + offset, sizeof(value));
+		return vec3(value[0], value[1], value[2]);
+	}
+
+	static void ComputeMeshletBounds(const uint32_t* indices, const std::vector<vec3>& faceNormals, const uint32_t* triangles, uint32_t triangleCount,
+		const void* vertices, uint32_t vertexStride, Meshlet& meshlet)
+	{
+		vec3 minPos = ReadVec3(vertices, vertexStride, indices[triangles[0] * 3], 0);
+		vec3 maxPos = minPos;
+		for (uint32_t i = 0; i < triangleCount * 3; ++i) {
+			const vec3 position = ReadVec3(vertices, vertexStride, indices[triangles[i / 3] * 3 + i % 3], 0);
+			minPos = glm::min(minPos, position);
+			maxPos = glm::max(maxPos, position);
+		}
+
+		meshlet.center = (minPos + maxPos) * 0.5f;
+		meshlet.radius = 0.0f;
+		for (uint32_t i = 0; i < triangleCount * 3; ++i) {
+			const vec3 position = ReadVec3(vertices, vertexStride, indices[triangles[i / 3] * 3 + i % 3], 0);
+			meshlet.radius = std::max(meshlet.radius, glm::length(position - meshlet.center));
+		}
+
+		vec3 normalSum(0.0f);
+		for (uint32_t i = 0; i < triangleCount; ++i) {
+			normalSum += faceNormals[triangles[i]];
+		}
+
+		meshlet.coneCutoff = 1.0f;
+
+		const float normalLength = glm::length(normalSum);
+		if (normalLength <= 0.0f) {
+			return;
+		}
+
+		const vec3 axis = normalSum / normalLength;
+
+		float minDot = 1.0f;
+		for (uint32_t i = 0; i < triangleCount; ++i) {
+			const vec3& normal = faceNormals[triangles[i]];
+			if (normal != vec3(0.0f)) {
+				minDot = std::min(minDot, glm::dot(normal, axis));
+			}
+		}
+
+		if (minDot <= MinConeSpread) {
+			return;
+		}
+
+		// NOTE: The apex is pulled back along the axis until every triangle plane passes in front of it
+		float maxT = 0.0f;
+		for (uint32_t i = 0; i < triangleCount; ++i) {
+			const vec3& normal = faceNormals[triangles[i]];
+			if (normal == vec3(0.0f)) {
+				continue;
+			}
+
+			const vec3 corner = ReadVec3(vertices, vertexStride, indices[triangles[i] * 3], 0);
+			maxT = std::max(maxT, glm::dot(meshlet.center - corner, normal) / glm::dot(axis, normal));
+		}
+
+		meshlet.coneAxis = axis;
+		meshlet.coneApex = meshlet.center - axis * maxT;
+		meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+	}
+
+	void MeshletBuilder::Build(uint32_t* indices, uint32_t indexCount, const void* vertices, uint32_t vertexCount, uint32_t vertexStride, uint32_t normalOffset, std::vector<Meshlet>& outMeshlets) {
+		const uint32_t triangleCount = indexCount / 3;
+		if (triangleCount == 0) {
+			return;
+		}
+
+		const std::vector<uint32_t> source(indices, indices + triangleCount * 3);
+
+		// NOTE: Winding is decided once for the whole range by which side most vertex normals are on
+		std::vector<vec3> faceNormals(triangleCount);
+		float windingVote = 0.0f;
+
+		for (uint32_t i = 0; i < triangleCount; ++i) {
+			const vec3 p0 = ReadVec3(vertices, vertexStride, source[i * 3], 0);
+			const vec3 p1 = ReadVec3(vertices, vertexStride, source[i * 3 + 1], 0);
+			const vec3 p2 = ReadVec3(vertices, vertexStride, source[i * 3 + 2], 0);
+
+			const vec3 normal = glm::cross(p1 - p0, p2 - p0);
+			const float normalLength = glm::length(normal);
+			faceNormals[i] = normalLength > 0.0f ? normal / normalLength : vec3(0.0f);
+
+			const vec3 vertexNormals = ReadVec3(vertices, vertexStride, source[i * 3], normalOffset)
+				+ ReadVec3(vertices, vertexStride, source[i * 3 + 1], normalOffset)
+				+ ReadVec3(vertices, vertexStride, source[i * 3 + 2], normalOffset);
+
+			windingVote += glm::dot(faceNormals[i], vertexNormals) >= 0.0f ? 1.0f : -1.0f;
+		}
+
+		if (windingVote < 0.0f) {
+			for (vec3& normal : faceNormals) {
+				normal = -normal;
+			}
+		}
+
+		std::vector<uint32_t> adjacencyCounts(vertexCount, 0);
+		for (uint32_t index : source) {
+			adjacencyCounts[index]++;
+		}
+
+		std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+		for (uint32_t i = 0; i < vertexCount; ++i) {
+			adjacencyOffsets[i + 1] = adjacencyOffsets[i] + adjacencyCounts[i];
+		}
+
+		std::vector<uint32_t> adjacency(source.size());
+		std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (uint32_t i = 0; i < source.size(); ++i) {
+			adjacency[fill[source[i]]++] = i / 3;
+		}
+
+		std::vector<bool> assigned(triangleCount, false);
+		std::vector<uint32_t> vertexMeshlet(vertexCount, InvalidIndex);
+
+		std::vector<uint32_t> meshletTriangles;
+		std::vector<uint32_t> meshletVertices;
+		meshletTriangles.reserve(MaxTriangles);
+		meshletVertices.reserve(MaxVertices);
+
+		uint32_t outputIndex = 0;
+		uint32_t seedCursor = 0;
+		uint32_t meshletId = 0;
+
+		while (outputIndex < triangleCount * 3) {
+			while (assigned[seedCursor]) {
+				seedCursor++;
+			}
+
+			meshletTriangles.clear();
+			meshletVertices.clear();
+			vec3 normalSum(0.0f);
+			vec3 positionSum(0.0f);
+
+			auto addTriangle = [&](uint32_t triangle) {
+				assigned[triangle] = true;
+				meshletTriangles.push_back(triangle);
+				normalSum += faceNormals[triangle];
+
+				for (uint32_t corner = 0; corner < 3; ++corner) {
+					const uint32_t vertex = source[triangle * 3 + corner];
+					positionSum += ReadVec3(vertices, vertexStride, vertex, 0);
+					if (vertexMeshlet[vertex] != meshletId) {
+						vertexMeshlet[vertex] = meshletId;
+						meshletVertices.push_back(vertex);
+					}
+				}
+			};
+
+			addTriangle(seedCursor);
+
+			while (meshletTriangles.size() < MaxTriangles) {
+				const float normalLength = glm::length(normalSum);
+				const vec3 coneAxis = normalLength > 0.0f ? normalSum / normalLength : vec3(0.0f);
+
+				uint32_t bestTriangle = InvalidIndex;
+				float bestScore = std::numeric_limits<float>::max();
+
+				for (uint32_t vertex : meshletVertices) {
+					for (uint32_t i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; ++i) {
+						const uint32_t triangle = adjacency[i];
+						if (assigned[triangle]) {
+							continue;
+						}
+
+						uint32_t newVertices = 0;
+						for (uint32_t corner = 0; corner < 3; ++corner) {
+							newVertices += vertexMeshlet[source[triangle * 3 + corner]] != meshletId;
+						}
+
+						if (meshletVertices.size() + newVertices > MaxVertices) {
+							continue;
+						}
+
+						const float score = newVertices + (1.0f - glm::dot(faceNormals[triangle], coneAxis)) * ConeWeight;
+						if (score < bestScore) {
+							bestScore = score;
+							bestTriangle = triangle;
+						}
+					}
+				}
+
+				// NOTE: Seams split the vertices, so the meshlet continues with the closest of the next triangles in input order
+				if (bestTriangle == InvalidIndex) {
+					const vec3 centroid = positionSum / static_cast<float>(meshletTriangles.size() * 3);
+
+					uint32_t looked = 0;
+					for (uint32_t triangle = seedCursor; triangle < triangleCount && looked < FallbackWindow; ++triangle) {
+						if (assigned[triangle]) {
+							continue;
+						}
+						looked++;
+
+						uint32_t newVertices = 0;
+						vec3 triangleCenter(0.0f);
+						for (uint32_t corner = 0; corner < 3; ++corner) {
+							newVertices += vertexMeshlet[source[triangle * 3 + corner]] != meshletId;
+							triangleCenter += ReadVec3(vertices, vertexStride, source[triangle * 3 + corner], 0) / 3.0f;
+						}
+
+						if (meshletVertices.size() + newVertices > MaxVertices) {
+							continue;
+						}
+
+						const float score = glm::length(triangleCenter - centroid) * (2.0f - glm::dot(faceNormals[triangle], coneAxis));
+						if (score < bestScore) {
+							bestScore = score;
+							bestTriangle = triangle;
+						}
+					}
+				}
+
+				if (bestTriangle == InvalidIndex) {
+					break;
+				}
+
+				addTriangle(bestTriangle);
+			}
+
+			Meshlet meshlet;
+			ComputeMeshletBounds(source.data(), faceNormals, meshletTriangles.data(), static_cast<uint32_t>(meshletTriangles.size()), vertices, vertexStride, meshlet);
+			meshlet.indexOffset = outputIndex;
+			meshlet.indexCount = static_cast<uint32_t>(meshletTriangles.size()) * 3;
+			meshlet.vertexCount = static_cast<uint32_t>(meshletVertices.size());
+
+			for (uint32_t triangle : meshletTriangles) {
+				indices[outputIndex++] = source[triangle * 3];
+				indices[outputIndex++] = source[triangle * 3 + 1];
+				indices[outputIndex++] = source[triangle * 3 + 2];
+			}
+
+			outMeshlets.push_back(meshlet);
+			meshletId++;
+		}
+	}
+
+	bool MeshletBuilder::IsBackfacing(const Meshlet& meshlet, const vec3& cameraPosition) {
+		if (meshlet.coneCutoff >= 1.0f) {
+			return false;
+		}
+
+		const vec3 toApex = meshlet.coneApex - cameraPosition;
+		const float distance = glm::length(toApex);
+		if (distance <= 0.0f) {
+			return false;
+		}
+
+		return glm::dot(toApex / distance, meshlet.coneAxis) >= meshlet.coneCutoff;
+	}
+}
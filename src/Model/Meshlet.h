@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Core.h"
+#include "Math/Math.h"
+
+#include <vector>
+
+namespace flaw {
+	// NOTE: Run of triangles drawn as one contiguous index range, with the bounds to cull it before it is submitted
+	struct Meshlet {
+		vec3 center = vec3(0.0f); // bounding sphere, object space
+		float radius = 0.0f;
+
+		vec3 coneApex = vec3(0.0f);
+		float coneCutoff = 1.0f; // 1 disables the cone test
+
+		vec3 coneAxis = vec3(0.0f, 0.0f, 1.0f);
+		uint32_t indexOffset = 0; // relative to the indices the meshlet was built from
+
+		uint32_t indexCount = 0;
+		uint32_t vertexCount = 0;
+		uint32_t padding[2] = { 0, 0 };
+	};
+
+	// NOTE: Greedy clustering, a meshlet grows from the first unassigned triangle by adding the triangle around its vertices that
+	// brings the fewest new vertices and bends its normal cone the least, until either limit is reached. When nothing around it
+	// fits, as on split seams, the closest of the next unassigned triangles is taken instead.
+	// Front faces are the side the vertex normals point to. The cone test only drops back faces, so it is only valid for
+	// pipelines that cull back faces, double sided geometry must skip it.
+	class MeshletBuilder {
+	public:
+		constexpr static uint32_t Version = 1;
+
+		constexpr static uint32_t MaxVertices = 64;
+		constexpr static uint32_t MaxTriangles = 124;
+
+		// NOTE: Reorders the triangles of indices so each meshlet's are contiguous, appending the meshlets to outMeshlets.
+		// Positions and normals are read as three floats at offset 0 and normalOffset of each vertex.
+		static void Build(uint32_t* indices, uint32_t indexCount, const void* vertices, uint32_t vertexCount, uint32_t vertexStride, uint32_t normalOffset, std::vector<Meshlet>& outMeshlets);
+
+		// NOTE: cameraPosition in the object space the meshlet was built in. True only if every triangle faces away from it.
+		static bool IsBackfacing(const Meshlet& meshlet, const vec3& cameraPosition);
+	};
+}
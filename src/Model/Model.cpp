@@ -1,6 +1,7 @@
 #include "pch.h"
 #include "Model.h"
 #include "Log/Log.h"
+#include "Image/ImageCache.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -21,6 +22,26 @@ namespace flaw {
 		aiProcess_FixInfacingNormals | 
 		aiProcess_SortByPType;
 
+	// NOTE: Every texture slot ParseMaterial reads, used to gather image paths up front
+	constexpr aiTextureType MaterialTextureTypes[] = {
+		aiTextureType_DIFFUSE,
+		aiTextureType_NORMALS,
+		aiTextureType_SPECULAR,
+		aiTextureType_SHININESS,
+		aiTextureType_EMISSIVE,
+		aiTextureType_HEIGHT,
+		aiTextureType_BASE_COLOR,
+		aiTextureType_OPACITY,
+		aiTextureType_REFLECTION,
+		aiTextureType_AMBIENT,
+		aiTextureType_AMBIENT_OCCLUSION,
+		aiTextureType_DISPLACEMENT,
+		aiTextureType_LIGHTMAP,
+		aiTextureType_METALNESS,
+		aiTextureType_DIFFUSE_ROUGHNESS,
+		aiTextureType_NORMAL_CAMERA,
+	};
+
 	class CustomProgressHandler : public Assimp::ProgressHandler {
 	public:
 		CustomProgressHandler(const std::function<bool(float)>& progressHandler) : _progressHandler(progressHandler) {}
@@ -52,6 +73,10 @@ namespace flaw {
 		return loadOpFlags;
 	}
 
+	uint32_t Model::GetImportFlags() {
+		return GetLoadOpFlags();
+	}
+
 	Model::Model(const char* filePath, float scale, const std::function<bool(float)>& progressHandler) 
 		: _loaded(false)
 		, _scale(scale)
@@ -66,6 +91,8 @@ namespace flaw {
 			_type = ModelType::Fbx;
 		}
 
+		auto startTime = std::chrono::steady_clock::now();
+
 		Assimp::Importer importer;
 		Scope<CustomProgressHandler> userProgressHandler;
 
@@ -90,6 +117,9 @@ namespace flaw {
 		importer.SetProgressHandler(nullptr);
 
 		_loaded = true;
+
+		std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+		Log::Info("[Model] %s imported in %.1f ms", filePath, elapsed.count());
 	}
 
 	Model::Model(ModelType type, const char* basePath, const char* memory, size_t size, float scale) 
@@ -114,6 +144,20 @@ namespace flaw {
 
 		ParseSkeleton(_skeleton, scene->mRootNode, -1);
 
+		PreloadImages(scene, basePath);
+
+		// NOTE: Sized once from the counts of every mesh, growing per mesh moved the whole model once for each of them
+		uint64_t vertexCount = 0;
+		uint64_t indexCount = 0;
+		for (uint32_t i = 0; i < scene->mNumMeshes; ++i) {
+			vertexCount += scene->mMeshes[i]->mNumVertices;
+			indexCount += static_cast<uint64_t>(scene->mMeshes[i]->mNumFaces) * 3;
+		}
+
+		_vertices.reserve(_vertices.size() + vertexCount);
+		_vertexBoneData.reserve(_vertexBoneData.size() + vertexCount);
+		_indices.reserve(_indices.size() + indexCount);
+
 		_meshes.resize(scene->mNumMeshes);
 		for (uint32_t i = 0; i < scene->mNumMeshes; ++i) {
 			const aiMesh* mesh = scene->mMeshes[i];
@@ -215,6 +259,44 @@ namespace flaw {
 		}
 	}
 
+	void Model::PreloadImages(const aiScene* scene, const std::filesystem::path& basePath) {
+		std::vector<std::string> filePaths;
+		std::unordered_set<std::string> visited;
+
+		for (uint32_t i = 0; i < scene->mNumMaterials; ++i) {
+			const aiMaterial* material = scene->mMaterials[i];
+
+			for (aiTextureType type : MaterialTextureTypes) {
+				aiString path;
+				if (material->GetTexture(type, 0, &path) != AI_SUCCESS) {
+					continue;
+				}
+
+				const std::string filePath = (basePath / path.C_Str()).generic_string();
+
+				// NOTE: Embedded textures are decoded from memory on first use and are never shared between models
+				if (scene->GetEmbeddedTexture(filePath.c_str())) {
+					continue;
+				}
+
+				if (visited.insert(filePath).second) {
+					filePaths.push_back(filePath);
+				}
+			}
+		}
+
+		if (filePaths.empty()) {
+			return;
+		}
+
+		auto startTime = std::chrono::steady_clock::now();
+
+		ImageCache::LoadAll(filePaths, 4, ModelParams::ImageDecodePool);
+
+		std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+		Log::Info("[Model] %d images ready in %.1f ms", static_cast<int32_t>(filePaths.size()), elapsed.count());
+	}
+
 	Ref<Image> Model::GetImageOrCreate(const aiScene* scene, const std::filesystem::path& path) {
 		auto it = _images.find(path);
 		if (it != _images.end()) {
@@ -228,7 +310,7 @@ namespace flaw {
 			img = CreateRef<Image>(Image::GetImageTypeFromExtension(path.generic_string().c_str()), (const char*)embeddedTexture->pcData, embeddedTexture->mWidth, 4);
 		}
 		else {
-			img = CreateRef<Image>(path.generic_string().c_str(), 4);
+			img = ImageCache::GetOrLoad(path.generic_string(), 4);
 		}
 
 		if (img && img->IsValid()) {
@@ -248,7 +330,6 @@ namespace flaw {
 		modelMesh.indexCount = mesh->mNumFaces * 3;
 		modelMesh.materialIndex = mesh->mMaterialIndex;
 
-		_vertices.reserve(_vertices.size() + mesh->mNumVertices);
 		_vertexBoneData.resize(_vertexBoneData.size() + mesh->mNumVertices);
 		for (int32_t i = 0; i < mesh->mNumVertices; ++i) {
 			ModelVertex vertex;
@@ -261,7 +342,6 @@ namespace flaw {
 			_vertices.push_back(vertex);
 		}
 
-		_indices.reserve(_indices.size() + mesh->mNumFaces * 3);
 		for (int32_t i = 0; i < mesh->mNumFaces; ++i) {
 			const aiFace& face = mesh->mFaces[i];
 			for (int32_t j = 0; j < face.mNumIndices; ++j) {
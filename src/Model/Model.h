@@ -18,9 +18,12 @@ struct aiAnimation;
 struct aiNodeAnim;
 
 namespace flaw {
+	class ThreadPool;
+
 	struct ModelParams {
 		constexpr static int32_t MaxInfluenceBoneCount = 4;
 		inline static bool LeftHanded = true;
+		inline static ThreadPool* ImageDecodePool = nullptr; // helps decode the images of a model, nullptr decodes them on the loading thread
 	};
 
 	enum class ModelType {
@@ -144,6 +147,7 @@ namespace flaw {
 		const std::vector<uint32_t>& GetIndices() const { return _indices; }
 		const std::vector<ModelMesh>& GetMeshs() const { return _meshes; }
 		const std::vector<ModelSkeletalAnimation>& GetSkeletalAnimations() const { return _skeletalAnimations; }
+		const std::unordered_map<std::filesystem::path, Ref<Image>>& GetImages() const { return _images; }
 
 		const mat4& GetGlobalInvMatrix() const { return _globalInvMatrix; }
 
@@ -152,6 +156,9 @@ namespace flaw {
 
 		bool IsValid() const { return _loaded; }
 
+		// NOTE: Post-processing flags the importer runs with, part of the key for cooked import results
+		static uint32_t GetImportFlags();
+
 	private:
 		void ParseScene(std::filesystem::path basePath, const aiScene* scene);
 		void ParseSkeleton(ModelSkeleton& result, const aiNode* current, int32_t parentIndex);
@@ -160,6 +167,7 @@ namespace flaw {
 		void ParseBones(const aiScene* scene, const aiMesh* mesh, ModelMesh& modelMesh);
 		void ParseAnimation(const aiScene* scene, const aiAnimation* animation, ModelSkeletalAnimation& skeletalAnim);
 
+		void PreloadImages(const aiScene* scene, const std::filesystem::path& basePath);
 		Ref<Image> GetImageOrCreate(const aiScene* scene, const std::filesystem::path& path);
 
 	private: 
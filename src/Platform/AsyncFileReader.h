@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Core.h"
+
+#include <functional>
+#include <string>
+
+namespace flaw {
+	struct FileReadRequest {
+		std::string path;
+		uint64_t offset = 0;
+		uint64_t size = 0; // bytes to read into buffer
+		void* buffer = nullptr; // provided by the caller, at least size bytes
+		uint64_t userData = 0;
+
+		// NOTE: Set when the read completes, bytesRead is short only when the file ends first
+		bool succeeded = false;
+		uint64_t bytesRead = 0;
+	};
+
+	// NOTE: Batched reads into caller provided buffers, completed asynchronously. On Linux the reads go through io_uring, up to
+	// queueDepth of them in flight on one submission thread. Where io_uring is unavailable (old kernels, containers that filter
+	// it out) and on the other platforms, threadCount threads issue positioned reads instead.
+	class AsyncFileReader {
+	public:
+		using ReadCallback = std::function<void(FileReadRequest& request)>;
+
+		AsyncFileReader(uint32_t queueDepth = 64, uint32_t threadCount = 8);
+		~AsyncFileReader(); // waits for the submitted reads
+
+		AsyncFileReader(const AsyncFileReader&) = delete;
+		AsyncFileReader& operator=(const AsyncFileReader&) = delete;
+
+		// NOTE: Returns at once. The requests and their buffers must stay valid until their onRead, which runs on a thread of the
+		// reader once per request and should only hand the data on.
+		void Submit(FileReadRequest* requests, uint32_t count, const ReadCallback& onRead);
+
+		// NOTE: Returns once every request completed, onRead is optional
+		void Read(FileReadRequest* requests, uint32_t count, const ReadCallback& onRead = nullptr);
+
+		const char* GetBackendName() const;
+
+	private:
+		void* _internalData;
+	};
+}
@@ -20,6 +20,9 @@
 //	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 //	SOFTWARE.
 
+// NOTE: Local change to the upstream header: the inotify watch also listens for IN_MOVED_TO and reports it as renamed_new,
+// so files saved through a temporary file and a rename are seen on Linux.
+
 #ifndef FILEWATCHER_H
 #define FILEWATCHER_H
 
@@ -606,7 +609,7 @@ namespace filewatch {
                 }
                 }();
 
-            const auto watch = inotify_add_watch(folder, watch_path.c_str(), IN_MODIFY | IN_CREATE | IN_DELETE);
+            const auto watch = inotify_add_watch(folder, watch_path.c_str(), IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_TO);
             if (watch < 0)
             {
                 throw std::system_error(errno, std::system_category());
@@ -646,6 +649,10 @@ namespace filewatch {
                                 {
                                     parsed_information.emplace_back(StringType{ changed_file }, Event::modified);
                                 }
+                                else if (event->mask & IN_MOVED_TO)
+                                {
+                                    parsed_information.emplace_back(StringType{ changed_file }, Event::renamed_new);
+                                }
                             }
                         }
                         i += event_size + event->len;
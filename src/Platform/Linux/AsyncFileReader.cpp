@@ -0,0 +1,398 @@
+#include "pch.h"
+
+#ifdef __linux__
+
+#include "Platform/AsyncFileReader.h"
+#include "Log/Log.h"
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+
+namespace flaw {
+	// NOTE: A single read returns at most about 2 GB on Linux, larger requests continue where the last read stopped
+	constexpr uint64_t MaxReadSize = 1ull << 30;
+
+	struct FileRead {
+		FileReadRequest* request = nullptr;
+		Ref<AsyncFileReader::ReadCallback> onRead;
+		int fd = -1;
+		struct iovec iov = {};
+	};
+
+	struct AsyncFileReaderData {
+		uint32_t queueDepth = 0;
+
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::deque<Scope<FileRead>> pending;
+		bool stop = false;
+		std::vector<std::thread> threads;
+
+		// NOTE: Only the submission thread touches the rings after setup
+		bool useRing = false;
+		int ringFd = -1;
+		void* sqRing = nullptr;
+		void* cqRing = nullptr;
+		uint64_t sqRingSize = 0;
+		uint64_t cqRingSize = 0;
+		io_uring_sqe* sqes = nullptr;
+		uint64_t sqesSize = 0;
+
+		uint32_t* sqTail = nullptr;
+		uint32_t sqMask = 0;
+		uint32_t* sqArray = nullptr;
+		uint32_t* cqHead = nullptr;
+		uint32_t* cqTail = nullptr;
+		uint32_t cqMask = 0;
+		io_uring_cqe* cqes = nullptr;
+	};
+
+	static void CompleteRead(FileRead& read, bool succeeded) {
+		if (read.fd >= 0) {
+			close(read.fd);
+			read.fd = -1;
+		}
+
+		read.request->succeeded = succeeded;
+		if (*read.onRead) {
+			(*read.onRead)(*read.request);
+		}
+	}
+
+	static bool OpenRead(FileRead& read) {
+		if (read.fd < 0) {
+			read.fd = open(read.request->path.c_str(), O_RDONLY | O_CLOEXEC);
+		}
+		return read.fd >= 0;
+	}
+
+	static void ReadWithPread(FileRead& read) {
+		if (!OpenRead(read)) {
+			CompleteRead(read, false);
+			return;
+		}
+
+		FileReadRequest& request = *read.request;
+		uint8_t* buffer = static_cast<uint8_t*>(request.buffer);
+
+		while (request.bytesRead < request.size) {
+			const uint64_t readSize = std::min(request.size - request.bytesRead, MaxReadSize);
+			const ssize_t result = pread(read.fd, buffer + request.bytesRead, readSize, request.offset + request.bytesRead);
+			if (result < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+
+				CompleteRead(read, false);
+				return;
+			}
+
+			if (result == 0) {
+				break;
+			}
+
+			request.bytesRead += result;
+		}
+
+		CompleteRead(read, true);
+	}
+
+	static void PoolThread(AsyncFileReaderData* data) {
+		while (true) {
+			Scope<FileRead> read;
+			{
+				std::unique_lock<std::mutex> lock(data->mutex);
+				data->condition.wait(lock, [data]() { return data->stop || !data->pending.empty(); });
+
+				if (data->pending.empty()) {
+					return;
+				}
+
+				read = std::move(data->pending.front());
+				data->pending.pop_front();
+			}
+
+			ReadWithPread(*read);
+		}
+	}
+
+#ifdef __NR_io_uring_setup
+	static bool SetupRing(AsyncFileReaderData& data) {
+		io_uring_params params;
+		std::memset(&params, 0, sizeof(params));
+
+		const int ringFd = static_cast<int>(syscall(__NR_io_uring_setup, data.queueDepth, &params));
+		if (ringFd < 0) {
+			return false;
+		}
+
+		data.ringFd = ringFd;
+		data.sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+		data.cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+		const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (singleMap) {
+			data.sqRingSize = data.cqRingSize = std::max(data.sqRingSize, data.cqRingSize);
+		}
+
+		void* sqRing = mmap(nullptr, data.sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+		data.sqRing = sqRing == MAP_FAILED ? nullptr : sqRing;
+
+		void* cqRing = singleMap ? sqRing : mmap(nullptr, data.cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+		data.cqRing = cqRing == MAP_FAILED ? nullptr : cqRing;
+
+		data.sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		void* sqes = mmap(nullptr, data.sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+		data.sqes = sqes == MAP_FAILED ? nullptr : static_cast<io_uring_sqe*>(sqes);
+
+		if (!data.sqRing || !data.cqRing || !data.sqes) {
+			return false;
+		}
+
+		uint8_t* sq = static_cast<uint8_t*>(data.sqRing);
+		data.sqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+		data.sqMask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+		data.sqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+
+		uint8_t* cq = static_cast<uint8_t*>(data.cqRing);
+		data.cqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+		data.cqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+		data.cqMask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+		data.cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+		// NOTE: The completion ring is twice the submission ring, keeping at most sq_entries in flight means it never overflows
+		data.queueDepth = std::min(data.queueDepth, params.sq_entries);
+
+		return true;
+	}
+
+	static void DestroyRing(AsyncFileReaderData& data) {
+		if (data.sqes) {
+			munmap(data.sqes, data.sqesSize);
+		}
+
+		if (data.cqRing && data.cqRing != data.sqRing) {
+			munmap(data.cqRing, data.cqRingSize);
+		}
+
+		if (data.sqRing) {
+			munmap(data.sqRing, data.sqRingSize);
+		}
+
+		if (data.ringFd >= 0) {
+			close(data.ringFd);
+		}
+
+		data.sqes = nullptr;
+		data.sqRing = nullptr;
+		data.cqRing = nullptr;
+		data.ringFd = -1;
+	}
+
+	// NOTE: The tail is only written by this thread, the release store publishes the entry to the kernel
+	static void PushReadEntry(AsyncFileReaderData& data, FileRead* read) {
+		FileReadRequest& request = *read->request;
+
+		read->iov.iov_base = static_cast<uint8_t*>(request.buffer) + request.bytesRead;
+		read->iov.iov_len = std::min(request.size - request.bytesRead, MaxReadSize);
+
+		const uint32_t tail = *data.sqTail;
+		const uint32_t index = tail & data.sqMask;
+
+		io_uring_sqe& sqe = data.sqes[index];
+		std::memset(&sqe, 0, sizeof(io_uring_sqe));
+		sqe.opcode = IORING_OP_READV;
+		sqe.fd = read->fd;
+		sqe.addr = reinterpret_cast<uint64_t>(&read->iov);
+		sqe.len = 1;
+		sqe.off = request.offset + request.bytesRead;
+		sqe.user_data = reinterpret_cast<uint64_t>(read);
+
+		data.sqArray[index] = index;
+		__atomic_store_n(data.sqTail, tail + 1, __ATOMIC_RELEASE);
+	}
+
+	// NOTE: Keeps up to queueDepth reads in flight, files are opened when their read is queued to the ring
+	static void RingThread(AsyncFileReaderData* data) {
+		std::deque<Scope<FileRead>> queued;
+		uint32_t inFlight = 0;
+		uint32_t unsubmitted = 0;
+
+		while (true) {
+			{
+				std::unique_lock<std::mutex> lock(data->mutex);
+				if (inFlight == 0 && queued.empty()) {
+					data->condition.wait(lock, [data]() { return data->stop || !data->pending.empty(); });
+
+					if (data->pending.empty()) {
+						return;
+					}
+				}
+
+				while (!data->pending.empty()) {
+					queued.push_back(std::move(data->pending.front()));
+					data->pending.pop_front();
+				}
+			}
+
+			while (!queued.empty() && inFlight < data->queueDepth) {
+				Scope<FileRead> read = std::move(queued.front());
+				queued.pop_front();
+
+				if (!OpenRead(*read)) {
+					CompleteRead(*read, false);
+					continue;
+				}
+
+				if (read->request->bytesRead >= read->request->size) {
+					CompleteRead(*read, true);
+					continue;
+				}
+
+				PushReadEntry(*data, read.release());
+				inFlight++;
+				unsubmitted++;
+			}
+
+			if (inFlight == 0) {
+				continue;
+			}
+
+			const int result = static_cast<int>(syscall(__NR_io_uring_enter, data->ringFd, unsubmitted, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+			if (result >= 0) {
+				unsubmitted -= std::min(unsubmitted, static_cast<uint32_t>(result));
+			}
+			else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+				Log::Error("io_uring_enter failed: %s", strerror(errno));
+			}
+
+			uint32_t head = *data->cqHead;
+			while (head != __atomic_load_n(data->cqTail, __ATOMIC_ACQUIRE)) {
+				const io_uring_cqe& cqe = data->cqes[head & data->cqMask];
+				head++;
+				inFlight--;
+
+				Scope<FileRead> read(reinterpret_cast<FileRead*>(cqe.user_data));
+				FileReadRequest& request = *read->request;
+
+				if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+					queued.push_front(std::move(read));
+				}
+				else if (cqe.res < 0) {
+					CompleteRead(*read, false);
+				}
+				else if (cqe.res == 0) {
+					CompleteRead(*read, true);
+				}
+				else {
+					request.bytesRead += cqe.res;
+					if (request.bytesRead < request.size) {
+						queued.push_front(std::move(read));
+					}
+					else {
+						CompleteRead(*read, true);
+					}
+				}
+			}
+
+			__atomic_store_n(data->cqHead, head, __ATOMIC_RELEASE);
+		}
+	}
+#endif
+
+	AsyncFileReader::AsyncFileReader(uint32_t queueDepth, uint32_t threadCount) {
+		AsyncFileReaderData* data = new AsyncFileReaderData();
+		data->queueDepth = std::max(1u, queueDepth);
+		_internalData = data;
+
+#ifdef __NR_io_uring_setup
+		data->useRing = SetupRing(*data);
+		if (data->useRing) {
+			data->threads.emplace_back(RingThread, data);
+			return;
+		}
+
+		Log::Info("io_uring is unavailable (%s), reading files with %u threads", strerror(errno), std::max(1u, threadCount));
+		DestroyRing(*data);
+#endif
+
+		for (uint32_t i = 0; i < std::max(1u, threadCount); ++i) {
+			data->threads.emplace_back(PoolThread, data);
+		}
+	}
+
+	AsyncFileReader::~AsyncFileReader() {
+		AsyncFileReaderData* data = static_cast<AsyncFileReaderData*>(_internalData);
+
+		{
+			std::lock_guard<std::mutex> lock(data->mutex);
+			data->stop = true;
+		}
+		data->condition.notify_all();
+
+		for (auto& thread : data->threads) {
+			thread.join();
+		}
+
+#ifdef __NR_io_uring_setup
+		DestroyRing(*data);
+#endif
+
+		delete data;
+	}
+
+	void AsyncFileReader::Submit(FileReadRequest* requests, uint32_t count, const ReadCallback& onRead) {
+		AsyncFileReaderData* data = static_cast<AsyncFileReaderData*>(_internalData);
+
+		auto sharedOnRead = CreateRef<ReadCallback>(onRead);
+
+		{
+			std::lock_guard<std::mutex> lock(data->mutex);
+			for (uint32_t i = 0; i < count; ++i) {
+				requests[i].succeeded = false;
+				requests[i].bytesRead = 0;
+
+				auto read = CreateScope<FileRead>();
+				read->request = &requests[i];
+				read->onRead = sharedOnRead;
+
+				data->pending.push_back(std::move(read));
+			}
+		}
+
+		data->condition.notify_all();
+	}
+
+	void AsyncFileReader::Read(FileReadRequest* requests, uint32_t count, const ReadCallback& onRead) {
+		std::mutex mutex;
+		std::condition_variable condition;
+		uint32_t remaining = count;
+
+		Submit(requests, count, [&](FileReadRequest& request) {
+			if (onRead) {
+				onRead(request);
+			}
+
+			// NOTE: Notified under the lock, the waiter may return and destroy the condition as soon as it sees zero
+			std::lock_guard<std::mutex> lock(mutex);
+			remaining--;
+			condition.notify_all();
+		});
+
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [&]() { return remaining == 0; });
+	}
+
+	const char* AsyncFileReader::GetBackendName() const {
+		return static_cast<const AsyncFileReaderData*>(_internalData)->useRing ? "io_uring" : "pread";
+	}
+}
+
+#endif
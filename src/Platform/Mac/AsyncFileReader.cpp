@@ -0,0 +1,150 @@
+#include "pch.h"
+
+#ifdef __APPLE__
+
+#include "Platform/AsyncFileReader.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <deque>
+
+namespace flaw {
+	// NOTE: read and pread fail with EINVAL above INT_MAX bytes on macOS
+	constexpr uint64_t MaxReadSize = 1ull << 30;
+
+	struct FileRead {
+		FileReadRequest* request = nullptr;
+		Ref<AsyncFileReader::ReadCallback> onRead;
+	};
+
+	struct AsyncFileReaderData {
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::deque<FileRead> pending;
+		bool stop = false;
+		std::vector<std::thread> threads;
+	};
+
+	static bool ReadWithPread(FileReadRequest& request) {
+		int fd = open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) {
+			return false;
+		}
+
+		uint8_t* buffer = static_cast<uint8_t*>(request.buffer);
+
+		while (request.bytesRead < request.size) {
+			const uint64_t readSize = std::min(request.size - request.bytesRead, MaxReadSize);
+			const ssize_t result = pread(fd, buffer + request.bytesRead, readSize, request.offset + request.bytesRead);
+			if (result < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+
+				close(fd);
+				return false;
+			}
+
+			if (result == 0) {
+				break;
+			}
+
+			request.bytesRead += result;
+		}
+
+		close(fd);
+
+		return true;
+	}
+
+	static void PoolThread(AsyncFileReaderData* data) {
+		while (true) {
+			FileRead read;
+			{
+				std::unique_lock<std::mutex> lock(data->mutex);
+				data->condition.wait(lock, [data]() { return data->stop || !data->pending.empty(); });
+
+				if (data->pending.empty()) {
+					return;
+				}
+
+				read = std::move(data->pending.front());
+				data->pending.pop_front();
+			}
+
+			read.request->succeeded = ReadWithPread(*read.request);
+			if (*read.onRead) {
+				(*read.onRead)(*read.request);
+			}
+		}
+	}
+
+	AsyncFileReader::AsyncFileReader(uint32_t queueDepth, uint32_t threadCount) {
+		AsyncFileReaderData* data = new AsyncFileReaderData();
+		_internalData = data;
+
+		for (uint32_t i = 0; i < std::max(1u, threadCount); ++i) {
+			data->threads.emplace_back(PoolThread, data);
+		}
+	}
+
+	AsyncFileReader::~AsyncFileReader() {
+		AsyncFileReaderData* data = static_cast<AsyncFileReaderData*>(_internalData);
+
+		{
+			std::lock_guard<std::mutex> lock(data->mutex);
+			data->stop = true;
+		}
+		data->condition.notify_all();
+
+		for (auto& thread : data->threads) {
+			thread.join();
+		}
+
+		delete data;
+	}
+
+	void AsyncFileReader::Submit(FileReadRequest* requests, uint32_t count, const ReadCallback& onRead) {
+		AsyncFileReaderData* data = static_cast<AsyncFileReaderData*>(_internalData);
+
+		auto sharedOnRead = CreateRef<ReadCallback>(onRead);
+
+		{
+			std::lock_guard<std::mutex> lock(data->mutex);
+			for (uint32_t i = 0; i < count; ++i) {
+				requests[i].succeeded = false;
+				requests[i].bytesRead = 0;
+				data->pending.push_back({ &requests[i], sharedOnRead });
+			}
+		}
+
+		data->condition.notify_all();
+	}
+
+	void AsyncFileReader::Read(FileReadRequest* requests, uint32_t count, const ReadCallback& onRead) {
+		std::mutex mutex;
+		std::condition_variable condition;
+		uint32_t remaining = count;
+
+		Submit(requests, count, [&](FileReadRequest& request) {
+			if (onRead) {
+				onRead(request);
+			}
+
+			// NOTE: Notified under the lock, the waiter may return and destroy the condition as soon as it sees zero
+			std::lock_guard<std::mutex> lock(mutex);
+			remaining--;
+			condition.notify_all();
+		});
+
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [&]() { return remaining == 0; });
+	}
+
+	const char* AsyncFileReader::GetBackendName() const {
+		return "pread";
+	}
+}
+
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "Core.h"
+
+namespace flaw {
+	// NOTE: Read-only memory mapping of a whole file, unmapped on Close or destruction
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const char* path);
+		void Close();
+
+		bool IsOpen() const { return _data != nullptr; }
+
+		const uint8_t* GetData() const { return _data; }
+		uint64_t GetSize() const { return _size; }
+
+	private:
+		const uint8_t* _data = nullptr;
+		uint64_t _size = 0;
+
+#ifdef _WIN32
+		void* _file = nullptr;
+		void* _mapping = nullptr;
+#endif
+	};
+}
@@ -0,0 +1,56 @@
+#include "pch.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#include "Platform/MappedFile.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace flaw {
+	MappedFile::~MappedFile() {
+		Close();
+	}
+
+	bool MappedFile::Open(const char* path) {
+		Close();
+
+		int fd = open(path, O_RDONLY);
+		if (fd < 0) {
+			return false;
+		}
+
+		struct stat fileStat;
+		if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+			close(fd);
+			return false;
+		}
+
+		void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+		// NOTE: The mapping stays valid after the descriptor is closed
+		close(fd);
+
+		if (data == MAP_FAILED) {
+			return false;
+		}
+
+		_data = static_cast<const uint8_t*>(data);
+		_size = static_cast<uint64_t>(fileStat.st_size);
+
+		return true;
+	}
+
+	void MappedFile::Close() {
+		if (_data) {
+			munmap(const_cast<uint8_t*>(_data), _size);
+		}
+
+		_data = nullptr;
+		_size = 0;
+	}
+}
+
+#endif
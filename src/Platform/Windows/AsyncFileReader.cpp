@@ -0,0 +1,158 @@
+#include "pch.h"
+
+#ifdef _WIN32
+
+#include "Platform/AsyncFileReader.h"
+
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#include <deque>
+
+namespace flaw {
+	// NOTE: ReadFile takes a 32 bit size
+	constexpr uint64_t MaxReadSize = 1ull << 30;
+
+	struct FileRead {
+		FileReadRequest* request = nullptr;
+		Ref<AsyncFileReader::ReadCallback> onRead;
+	};
+
+	struct AsyncFileReaderData {
+		std::mutex mutex;
+		std::condition_variable condition;
+		std::deque<FileRead> pending;
+		bool stop = false;
+		std::vector<std::thread> threads;
+	};
+
+	// NOTE: The offset of a synchronous ReadFile is taken from the OVERLAPPED, the same as pread
+	static bool ReadPositioned(FileReadRequest& request) {
+		HANDLE file = CreateFileA(request.path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+
+		uint8_t* buffer = static_cast<uint8_t*>(request.buffer);
+
+		while (request.bytesRead < request.size) {
+			const uint64_t offset = request.offset + request.bytesRead;
+
+			OVERLAPPED overlapped = {};
+			overlapped.Offset = static_cast<DWORD>(offset);
+			overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+			DWORD bytesRead = 0;
+			const DWORD readSize = static_cast<DWORD>(std::min(request.size - request.bytesRead, MaxReadSize));
+			if (!ReadFile(file, buffer + request.bytesRead, readSize, &bytesRead, &overlapped)) {
+				if (GetLastError() == ERROR_HANDLE_EOF) {
+					break;
+				}
+
+				CloseHandle(file);
+				return false;
+			}
+
+			if (bytesRead == 0) {
+				break;
+			}
+
+			request.bytesRead += bytesRead;
+		}
+
+		CloseHandle(file);
+
+		return true;
+	}
+
+	static void PoolThread(AsyncFileReaderData* data) {
+		while (true) {
+			FileRead read;
+			{
+				std::unique_lock<std::mutex> lock(data->mutex);
+				data->condition.wait(lock, [data]() { return data->stop || !data->pending.empty(); });
+
+				if (data->pending.empty()) {
+					return;
+				}
+
+				read = std::move(data->pending.front());
+				data->pending.pop_front();
+			}
+
+			read.request->succeeded = ReadPositioned(*read.request);
+			if (*read.onRead) {
+				(*read.onRead)(*read.request);
+			}
+		}
+	}
+
+	AsyncFileReader::AsyncFileReader(uint32_t queueDepth, uint32_t threadCount) {
+		AsyncFileReaderData* data = new AsyncFileReaderData();
+		_internalData = data;
+
+		for (uint32_t i = 0; i < std::max(1u, threadCount); ++i) {
+			data->threads.emplace_back(PoolThread, data);
+		}
+	}
+
+	AsyncFileReader::~AsyncFileReader() {
+		AsyncFileReaderData* data = static_cast<AsyncFileReaderData*>(_internalData);
+
+		{
+			std::lock_guard<std::mutex> lock(data->mutex);
+			data->stop = true;
+		}
+		data->condition.notify_all();
+
+		for (auto& thread : data->threads) {
+			thread.join();
+		}
+
+		delete data;
+	}
+
+	void AsyncFileReader::Submit(FileReadRequest* requests, uint32_t count, const ReadCallback& onRead) {
+		AsyncFileReaderData* data = static_cast<AsyncFileReaderData*>(_internalData);
+
+		auto sharedOnRead = CreateRef<ReadCallback>(onRead);
+
+		{
+			std::lock_guard<std::mutex> lock(data->mutex);
+			for (uint32_t i = 0; i < count; ++i) {
+				requests[i].succeeded = false;
+				requests[i].bytesRead = 0;
+				data->pending.push_back({ &requests[i], sharedOnRead });
+			}
+		}
+
+		data->condition.notify_all();
+	}
+
+	void AsyncFileReader::Read(FileReadRequest* requests, uint32_t count, const ReadCallback& onRead) {
+		std::mutex mutex;
+		std::condition_variable condition;
+		uint32_t remaining = count;
+
+		Submit(requests, count, [&](FileReadRequest& request) {
+			if (onRead) {
+				onRead(request);
+			}
+
+			// NOTE: Notified under the lock, the waiter may return and destroy the condition as soon as it sees zero
+			std::lock_guard<std::mutex> lock(mutex);
+			remaining--;
+			condition.notify_all();
+		});
+
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait(lock, [&]() { return remaining == 0; });
+	}
+
+	const char* AsyncFileReader::GetBackendName() const {
+		return "ReadFile";
+	}
+}
+
+#endif
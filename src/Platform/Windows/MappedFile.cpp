@@ -0,0 +1,69 @@
+#include "pch.h"
+
+#ifdef _WIN32
+
+#include "Platform/MappedFile.h"
+
+#include <Windows.h>
+
+namespace flaw {
+	MappedFile::~MappedFile() {
+		Close();
+	}
+
+	bool MappedFile::Open(const char* path) {
+		Close();
+
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+			CloseHandle(file);
+			return false;
+		}
+
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mapping) {
+			CloseHandle(file);
+			return false;
+		}
+
+		void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (!data) {
+			CloseHandle(mapping);
+			CloseHandle(file);
+			return false;
+		}
+
+		_file = file;
+		_mapping = mapping;
+		_data = static_cast<const uint8_t*>(data);
+		_size = static_cast<uint64_t>(fileSize.QuadPart);
+
+		return true;
+	}
+
+	void MappedFile::Close() {
+		if (_data) {
+			UnmapViewOfFile(_data);
+		}
+
+		if (_mapping) {
+			CloseHandle(_mapping);
+		}
+
+		if (_file) {
+			CloseHandle(_file);
+		}
+
+		_data = nullptr;
+		_size = 0;
+		_file = nullptr;
+		_mapping = nullptr;
+	}
+}
+
+#endif
@@ -72,8 +72,9 @@ void RenderQueue::Push(const Ref<Mesh>& mesh, int segmentIndex, const mat4& worl
 		instanceIndex = instancingIndexIt->second;
 	}
 
+	// NOTE: Packed meshes decode their positions through the model matrix, normals still use the object's own inverse
 	auto& instance = entry.instancingObjects[instanceIndex];
-	instance.instanceDatas.emplace_back(InstanceData{ worldMat, inverse(worldMat) });
+	instance.instanceDatas.emplace_back(InstanceData{ worldMat * mesh->positionDecode, inverse(worldMat) });
 	instance.instanceCount++;
 }
 
@@ -101,7 +102,7 @@ void RenderQueue::Push(const Ref<Mesh>& mesh, int segmentIndex, const mat4& worl
 	}
 
 	auto& instance = entry.skeletalInstancingObjects[instanceIndex];
-	instance.instanceDatas.emplace_back(InstanceData{ worldMat, inverse(worldMat) });
+	instance.instanceDatas.emplace_back(InstanceData{ worldMat * mesh->positionDecode, inverse(worldMat) });
 	instance.instanceCount++;
 }
 
@@ -45,6 +45,11 @@ struct InstanceData {
 	mat4 inv_model_matrix;
 };
 
+struct IndexRange {
+	uint32_t indexOffset;
+	uint32_t indexCount;
+};
+
 struct InstancingObject {
 	Ref<Mesh> mesh;
 	int32_t segmentIndex;
@@ -52,7 +57,13 @@ struct InstancingObject {
 	std::vector<InstanceData> instanceDatas;
 	uint32_t instanceCount;
 
+	// NOTE: Meshlets left after culling against the main camera, relative to the segment's indexOffset and merged where contiguous
+	std::vector<IndexRange> visibleRanges;
+
 	inline bool HasSegment() const { return segmentIndex != -1; }
+
+	// NOTE: Null when the mesh was reloaded with fewer segments after this was queued, until the queue is rebuilt
+	inline const MeshSegment* GetSegment() const { return segmentIndex >= 0 && segmentIndex < static_cast<int32_t>(mesh->segments.size()) ? &mesh->segments[segmentIndex] : nullptr; }
 };
 
 struct SkeletalInstancingObject {
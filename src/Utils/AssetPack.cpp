@@ -0,0 +1,736 @@
+#include "pch.h"
+#include "AssetPack.h"
+#include "Platform/FileSystem.h"
+#include "Log/Log.h"
+
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+
+namespace flaw {
+	constexpr uint32_t LzMinMatch = 4;
+	constexpr uint32_t LzHashBits = 16;
+	constexpr uint64_t LzMaxOffset = 0xFFFF;
+	constexpr uint64_t LzNoPosition = ~0ull;
+
+	static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+
+	static void WriteLzLength(std::vector<uint8_t>& out, uint64_t length) {
+		while (length >= 255) {
+			out.push_back(255);
+			length -= 255;
+		}
+		out.push_back(static_cast<uint8_t>(length));
+	}
+
+	static bool ReadLzLength(const uint8_t*& ip, const uint8_t* end, uint64_t& length) {
+		uint8_t byte;
+		do {
+			if (ip == end) {
+				return false;
+			}
+			byte = *ip++;
+			length += byte;
+		} while (byte == 255);
+
+		return true;
+	}
+
+	// NOTE: A token holds the literal count in the high nibble and the match length minus LzMinMatch in the low one, 15 means more
+	// length bytes follow. The literals come next, then a 2 byte offset back into the output. The last sequence has no match.
+	static void WriteLzSequence(std::vector<uint8_t>& out, const uint8_t* literals, uint64_t literalCount, uint64_t offset, uint64_t matchLength) {
+		const uint64_t matchCode = matchLength ? matchLength - LzMinMatch : 0;
+
+		out.push_back(static_cast<uint8_t>((std::min<uint64_t>(literalCount, 15) << 4) | std::min<uint64_t>(matchCode, 15)));
+		if (literalCount >= 15) {
+			WriteLzLength(out, literalCount - 15);
+		}
+
+		out.insert(out.end(), literals, literals + literalCount);
+
+		if (matchLength == 0) {
+			return;
+		}
+
+		out.push_back(static_cast<uint8_t>(offset & 0xFF));
+		out.push_back(static_cast<uint8_t>(offset >> 8));
+		if (matchCode >= 15) {
+			WriteLzLength(out, matchCode - 15);
+		}
+	}
+
+	void AssetPack::Compress(const uint8_t* data, uint64_t size, std::vector<uint8_t>& out) {
+		out.clear();
+		out.reserve(size / 2);
+
+		std::vector<uint64_t> table(1ull << LzHashBits, LzNoPosition);
+
+		uint64_t anchor = 0;
+		uint64_t position = 0;
+		while (position + LzMinMatch <= size) {
+			uint32_t sequence;
+			std::memcpy(&sequence, data + position, sizeof(uint32_t));
+
+			const uint32_t hash = (sequence * 2654435761u) >> (32 - LzHashBits);
+			const uint64_t candidate = table[hash];
+			table[hash] = position;
+
+			if (candidate == LzNoPosition || position - candidate > LzMaxOffset || std::memcmp(data + candidate, data + position, LzMinMatch) != 0) {
+				position++;
+				continue;
+			}
+
+			uint64_t matchLength = LzMinMatch;
+			while (position + matchLength < size && data[candidate + matchLength] == data[position + matchLength]) {
+				matchLength++;
+			}
+
+			WriteLzSequence(out, data + anchor, position - anchor, position - candidate, matchLength);
+
+			position += matchLength;
+			anchor = position;
+		}
+
+		WriteLzSequence(out, data + anchor, size - anchor, 0, 0);
+	}
+
+	bool AssetPack::Decompress(const uint8_t* data, uint64_t size, uint8_t* out, uint64_t outSize) {
+		const uint8_t* ip = data;
+		const uint8_t* end = data + size;
+		uint64_t op = 0;
+
+		while (ip < end) {
+			const uint8_t token = *ip++;
+
+			uint64_t literalCount = token >> 4;
+			if (literalCount == 15 && !ReadLzLength(ip, end, literalCount)) {
+				return false;
+			}
+
+			if (literalCount > static_cast<uint64_t>(end - ip) || literalCount > outSize - op) {
+				return false;
+			}
+
+			std::memcpy(out + op, ip, literalCount);
+			ip += literalCount;
+			op += literalCount;
+
+			if (ip == end) {
+				break;
+			}
+
+			if (end - ip < 2) {
+				return false;
+			}
+
+			const uint64_t offset = ip[0] | (static_cast<uint64_t>(ip[1]) << 8);
+			ip += 2;
+
+			uint64_t matchLength = token & 0xF;
+			if (matchLength == 15 && !ReadLzLength(ip, end, matchLength)) {
+				return false;
+			}
+			matchLength += LzMinMatch;
+
+			if (offset == 0 || offset > op || matchLength > outSize - op) {
+				return false;
+			}
+
+			// NOTE: Byte by byte, a match may overlap the bytes it produces
+			for (uint64_t i = 0; i < matchLength; ++i) {
+				out[op + i] = out[op - offset + i];
+			}
+			op += matchLength;
+		}
+
+		return op == outSize;
+	}
+
+	std::string AssetPack::NormalizePath(const char* path) {
+		return std::filesystem::path(path).lexically_normal().generic_string();
+	}
+
+	AssetPack::~AssetPack() {
+		Close();
+	}
+
+	bool AssetPack::Open(const char* path, AssetPackReadMode mode) {
+		Close();
+
+		if (mode == AssetPackReadMode::Mapped) {
+			if (!_file.Open(path) || _file.GetSize() < sizeof(AssetPackHeader)) {
+				Close();
+				return false;
+			}
+
+			std::memcpy(&_header, _file.GetData(), sizeof(AssetPackHeader));
+			if (_header.fileSize != _file.GetSize() || _header.tocOffset > _header.fileSize || !ParseTable(_file.GetData() + _header.tocOffset, _header.fileSize - _header.tocOffset)) {
+				Log::Error("AssetPack: %s is corrupted or from another version", path);
+				Close();
+				return false;
+			}
+
+			return true;
+		}
+
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file.is_open()) {
+			return false;
+		}
+
+		const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+		file.seekg(0, std::ios::beg);
+
+		std::vector<uint8_t> table;
+		bool valid = fileSize >= sizeof(AssetPackHeader) && file.read(reinterpret_cast<char*>(&_header), sizeof(AssetPackHeader));
+		valid = valid && _header.fileSize == fileSize && _header.tocOffset <= fileSize;
+		if (valid) {
+			table.resize(fileSize - _header.tocOffset);
+			file.seekg(_header.tocOffset, std::ios::beg);
+			valid = file.read(reinterpret_cast<char*>(table.data()), table.size()) && ParseTable(table.data(), table.size());
+		}
+
+		if (!valid) {
+			Log::Error("AssetPack: %s is corrupted or from another version", path);
+			Close();
+			return false;
+		}
+
+		_path = path;
+		_readahead.resize(_header.tocOffset - _header.dataOffset);
+		_readaheadThread = std::thread(&AssetPack::Readahead, this);
+
+		return true;
+	}
+
+	bool AssetPack::ParseTable(const uint8_t* table, uint64_t tableSize) {
+		const uint64_t tocSize = sizeof(AssetPackEntry) * static_cast<uint64_t>(_header.entryCount);
+
+		if (_header.magic != Magic || _header.version != Version || _header.dataOffset < sizeof(AssetPackHeader) || _header.dataOffset > _header.tocOffset ||
+			_header.nameTableOffset != _header.tocOffset + tocSize || _header.nameTableOffset + _header.nameTableSize != _header.fileSize ||
+			tableSize != tocSize + _header.nameTableSize) {
+			return false;
+		}
+
+		_entries.resize(_header.entryCount);
+		std::memcpy(_entries.data(), table, tocSize);
+		_nameTable.assign(reinterpret_cast<const char*>(table + tocSize), _header.nameTableSize);
+
+		for (uint32_t i = 0; i < _header.entryCount; ++i) {
+			const AssetPackEntry& entry = _entries[i];
+			if (entry.offset < _header.dataOffset || entry.offset > _header.tocOffset || entry.storedSize > _header.tocOffset - entry.offset ||
+				static_cast<uint64_t>(entry.nameOffset) + entry.nameLength > _header.nameTableSize ||
+				(entry.compression != AssetPackCompression::None && entry.compression != AssetPackCompression::Lz) ||
+				(entry.compression == AssetPackCompression::None && entry.storedSize != entry.size)) {
+				return false;
+			}
+
+			_entryIndices[GetEntryName(i)] = i;
+		}
+
+		return true;
+	}
+
+	void AssetPack::Close() {
+		if (_readaheadThread.joinable()) {
+			_readaheadStop = true;
+			_readaheadThread.join();
+		}
+
+		_header = AssetPackHeader();
+		_entries.clear();
+		_nameTable.clear();
+		_entryIndices.clear();
+		_file.Close();
+
+		_path.clear();
+		_readahead.clear();
+		_readahead.shrink_to_fit();
+		_readaheadEnd = 0;
+		_readaheadStop = false;
+		_readaheadFailed = false;
+	}
+
+	// NOTE: Readahead thread. Blocks go out in file order, which is load order, and are published through _readaheadEnd
+	void AssetPack::Readahead() {
+		std::ifstream file(_path, std::ios::binary);
+		file.seekg(_header.dataOffset, std::ios::beg);
+
+		uint64_t end = 0;
+		while (end < _readahead.size() && !_readaheadStop) {
+			const uint64_t blockSize = std::min<uint64_t>(ReadaheadBlockSize, _readahead.size() - end);
+			if (!file.read(reinterpret_cast<char*>(_readahead.data() + end), blockSize)) {
+				break;
+			}
+
+			end += blockSize;
+
+			std::lock_guard<std::mutex> lock(_readaheadMutex);
+			_readaheadEnd = end;
+			_readaheadCondition.notify_all();
+		}
+
+		std::lock_guard<std::mutex> lock(_readaheadMutex);
+		_readaheadFailed = end < _readahead.size();
+		if (_readaheadFailed && !_readaheadStop) {
+			Log::Error("AssetPack: failed to read %s past %llu bytes", _path.c_str(), static_cast<unsigned long long>(_header.dataOffset + end));
+		}
+		_readaheadCondition.notify_all();
+	}
+
+	const uint8_t* AssetPack::WaitForRange(uint64_t offset, uint64_t size) {
+		if (_file.IsOpen()) {
+			return _file.GetData() + offset;
+		}
+
+		const uint64_t begin = offset - _header.dataOffset;
+		if (_readaheadEnd < begin + size) {
+			std::unique_lock<std::mutex> lock(_readaheadMutex);
+			_readaheadCondition.wait(lock, [&]() { return _readaheadEnd >= begin + size || _readaheadFailed; });
+
+			if (_readaheadEnd < begin + size) {
+				return nullptr;
+			}
+		}
+
+		return _readahead.data() + begin;
+	}
+
+	bool AssetPack::Contains(const char* path) const {
+		return _entryIndices.find(NormalizePath(path)) != _entryIndices.end();
+	}
+
+	bool AssetPack::Read(const char* path, std::vector<int8_t>& out) {
+		auto it = _entryIndices.find(NormalizePath(path));
+		if (it == _entryIndices.end()) {
+			return false;
+		}
+
+		const AssetPackEntry& entry = _entries[it->second];
+
+		const uint8_t* data = WaitForRange(entry.offset, entry.storedSize);
+		if (!data) {
+			return false;
+		}
+
+		out.resize(entry.size);
+
+		if (entry.compression == AssetPackCompression::None) {
+			std::memcpy(out.data(), data, entry.size);
+			return true;
+		}
+
+		if (!Decompress(data, entry.storedSize, reinterpret_cast<uint8_t*>(out.data()), entry.size)) {
+			Log::Error("AssetPack: %s is corrupted", path);
+			out.clear();
+			return false;
+		}
+
+		return true;
+	}
+
+	std::string AssetPack::GetEntryName(uint32_t index) const {
+		return _nameTable.substr(_entries[index].nameOffset, _entries[index].nameLength);
+	}
+
+	AssetPackBuilder::AssetPackBuilder(uint32_t alignment, bool compress)
+		: _alignment(std::max(1u, alignment))
+		, _compress(compress)
+	{
+	}
+
+	bool AssetPackBuilder::AddFile(const std::string& name, const std::string& filePath) {
+		File file;
+		file.name = AssetPack::NormalizePath(name.c_str());
+
+		if (!_names.insert(file.name).second) {
+			return false;
+		}
+
+		std::ifstream stream(filePath, std::ios::binary | std::ios::ate);
+		if (!stream.is_open()) {
+			_names.erase(file.name);
+			return false;
+		}
+
+		file.size = static_cast<uint64_t>(stream.tellg());
+		stream.seekg(0, std::ios::beg);
+
+		file.data.resize(file.size);
+		if (!stream.read(reinterpret_cast<char*>(file.data.data()), file.size)) {
+			_names.erase(file.name);
+			return false;
+		}
+
+		// NOTE: Already compressed formats like png and jpg gain nothing and stay as they are
+		if (_compress && file.size > 0) {
+			std::vector<uint8_t> compressed;
+			AssetPack::Compress(file.data.data(), file.size, compressed);
+
+			if (compressed.size() <= file.size - file.size / 10) {
+				file.data = std::move(compressed);
+				file.compression = AssetPackCompression::Lz;
+			}
+		}
+
+		_sourceSize += file.size;
+		_storedSize += file.data.size();
+
+		_files.push_back(std::move(file));
+
+		return true;
+	}
+
+	bool AssetPackBuilder::Write(const char* path) {
+		std::string nameTable;
+		std::vector<AssetPackEntry> entries(_files.size());
+
+		AssetPackHeader header;
+		header.magic = AssetPack::Magic;
+		header.version = AssetPack::Version;
+		header.entryCount = static_cast<uint32_t>(_files.size());
+		header.alignment = _alignment;
+		header.dataOffset = AlignUp(sizeof(AssetPackHeader), _alignment);
+
+		uint64_t offset = header.dataOffset;
+		for (size_t i = 0; i < _files.size(); ++i) {
+			const File& file = _files[i];
+
+			entries[i].offset = AlignUp(offset, _alignment);
+			entries[i].storedSize = file.data.size();
+			entries[i].size = file.size;
+			entries[i].nameOffset = static_cast<uint32_t>(nameTable.size());
+			entries[i].nameLength = static_cast<uint32_t>(file.name.size());
+			entries[i].compression = file.compression;
+
+			nameTable += file.name;
+			offset = entries[i].offset + entries[i].storedSize;
+		}
+
+		header.tocOffset = AlignUp(offset, alignof(AssetPackEntry));
+		header.nameTableOffset = header.tocOffset + sizeof(AssetPackEntry) * entries.size();
+		header.nameTableSize = nameTable.size();
+		header.fileSize = header.nameTableOffset + header.nameTableSize;
+
+		std::filesystem::path filePath(path);
+		if (filePath.has_parent_path()) {
+			std::error_code ec;
+			std::filesystem::create_directories(filePath.parent_path(), ec);
+		}
+
+		// NOTE: Write to a temporary file and rename it, so a running reader never maps a half written pack
+		std::filesystem::path tempPath = filePath;
+		tempPath += ".tmp";
+
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+
+		const std::vector<char> padding(std::max<uint64_t>(_alignment, alignof(AssetPackEntry)), 0);
+		auto writePadding = [&](uint64_t from, uint64_t to) {
+			file.write(padding.data(), to - from);
+		};
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(AssetPackHeader));
+		offset = sizeof(AssetPackHeader);
+
+		for (size_t i = 0; i < _files.size(); ++i) {
+			writePadding(offset, entries[i].offset);
+			file.write(reinterpret_cast<const char*>(_files[i].data.data()), _files[i].data.size());
+			offset = entries[i].offset + entries[i].storedSize;
+		}
+
+		writePadding(offset, header.tocOffset);
+		file.write(reinterpret_cast<const char*>(entries.data()), sizeof(AssetPackEntry) * entries.size());
+		file.write(nameTable.data(), nameTable.size());
+		file.close();
+
+		std::error_code ec;
+		if (!file) {
+			std::filesystem::remove(tempPath, ec);
+			return false;
+		}
+
+		std::filesystem::rename(tempPath, filePath, ec);
+		if (ec) {
+			std::filesystem::remove(tempPath, ec);
+			return false;
+		}
+
+		return true;
+	}
+
+	struct AssetFileTrace {
+		std::string path;
+		bool packed = false;
+		uint64_t bytes = 0;
+		double ms = 0.0;
+	};
+
+	static std::mutex g_assetFilesMutex;
+	static Scope<AssetPack> g_mountedPack;
+	static std::unordered_set<std::string> g_excludedAssetFiles;
+	static AssetFileStats g_assetFileStats;
+	static std::vector<AssetFileTrace> g_assetFileTrace;
+	static std::unordered_set<std::string> g_tracedAssetFiles;
+	static Scope<AsyncFileReader> g_assetFileReader;
+
+	// NOTE: Queue depth of the batch reader and threads of its fallback, loose asset files are small and mostly cold
+	constexpr uint32_t AssetFileReadQueueDepth = 64;
+	constexpr uint32_t AssetFileReadThreadCount = 16;
+
+	static bool IsPackedAssetFile(const std::string& name) {
+		return g_mountedPack && g_excludedAssetFiles.find(name) == g_excludedAssetFiles.end() && g_mountedPack->Contains(name.c_str());
+	}
+
+	// NOTE: Called under g_assetFilesMutex, only the first read of a file is traced
+	static void TraceAssetFileRead(const std::string& name, bool packed, uint64_t bytes, double ms) {
+		if (g_tracedAssetFiles.insert(name).second) {
+			g_assetFileTrace.push_back({ name, packed, bytes, ms });
+		}
+	}
+
+	// NOTE: Mount and Unmount while no reads are in flight, the pack is used outside the lock
+	bool AssetFiles::Mount(const char* packPath, AssetPackReadMode mode) {
+		auto pack = CreateScope<AssetPack>();
+		if (!pack->Open(packPath, mode)) {
+			return false;
+		}
+
+		Log::Info("Mounted %s, %u files (%s)", packPath, pack->GetEntryCount(), mode == AssetPackReadMode::Mapped ? "mapped" : "sequential");
+
+		std::lock_guard<std::mutex> lock(g_assetFilesMutex);
+		g_mountedPack = std::move(pack);
+		g_excludedAssetFiles.clear();
+
+		return true;
+	}
+
+	void AssetFiles::Unmount() {
+		std::lock_guard<std::mutex> lock(g_assetFilesMutex);
+		g_mountedPack.reset();
+		g_excludedAssetFiles.clear();
+	}
+
+	void AssetFiles::Cleanup() {
+		Unmount();
+
+		// NOTE: Destroyed outside the lock, the reader waits for its callbacks and they take it
+		Scope<AsyncFileReader> reader;
+		{
+			std::lock_guard<std::mutex> lock(g_assetFilesMutex);
+			reader = std::move(g_assetFileReader);
+		}
+	}
+
+	bool AssetFiles::Read(const char* path, std::vector<int8_t>& out) {
+		const std::string name = AssetPack::NormalizePath(path);
+
+		AssetPack* pack = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(g_assetFilesMutex);
+			if (IsPackedAssetFile(name)) {
+				pack = g_mountedPack.get();
+			}
+		}
+
+		auto startTime = std::chrono::steady_clock::now();
+
+		const bool packed = pack != nullptr;
+		const bool read = packed ? pack->Read(name.c_str(), out) : FileSystem::ReadFile(path, out);
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+
+		std::lock_guard<std::mutex> lock(g_assetFilesMutex);
+		if (!read) {
+			return false;
+		}
+
+		if (packed) {
+			g_assetFileStats.packReads++;
+			g_assetFileStats.packBytes += out.size();
+			g_assetFileStats.packMs += elapsed.count();
+		}
+		else {
+			g_assetFileStats.looseReads++;
+			g_assetFileStats.looseBytes += out.size();
+			g_assetFileStats.looseMs += elapsed.count();
+		}
+
+		TraceAssetFileRead(name, packed, out.size(), elapsed.count());
+
+		return true;
+	}
+
+	void AssetFiles::ReadBatch(const std::vector<std::string>& paths, const std::function<void(size_t index, std::vector<int8_t>& data, bool read)>& onRead) {
+		if (paths.empty()) {
+			return;
+		}
+
+		std::vector<std::string> names(paths.size());
+		std::vector<size_t> packedIndices;
+		std::vector<size_t> missingIndices;
+		std::vector<std::vector<int8_t>> looseData(paths.size());
+		std::vector<FileReadRequest> requests;
+
+		AssetPack* pack = nullptr;
+		AsyncFileReader* reader = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(g_assetFilesMutex);
+
+			for (size_t i = 0; i < paths.size(); ++i) {
+				names[i] = AssetPack::NormalizePath(paths[i].c_str());
+				if (IsPackedAssetFile(names[i])) {
+					packedIndices.push_back(i);
+				}
+			}
+
+			if (!packedIndices.empty()) {
+				pack = g_mountedPack.get();
+			}
+
+			if (packedIndices.size() < paths.size()) {
+				if (!g_assetFileReader) {
+					g_assetFileReader = CreateScope<AsyncFileReader>(AssetFileReadQueueDepth, AssetFileReadThreadCount);
+					Log::Info("Reading loose asset files with %s", g_assetFileReader->GetBackendName());
+				}
+				reader = g_assetFileReader.get();
+			}
+		}
+
+		// NOTE: Buffers are sized up front, a file that grows before it is read is cut at its old size
+		size_t packedIndex = 0;
+		for (size_t i = 0; i < paths.size(); ++i) {
+			if (packedIndex < packedIndices.size() && packedIndices[packedIndex] == i) {
+				packedIndex++;
+				continue;
+			}
+
+			std::error_code ec;
+			const uint64_t size = std::filesystem::file_size(paths[i], ec);
+			if (ec) {
+				missingIndices.push_back(i);
+				continue;
+			}
+
+			looseData[i].resize(size);
+
+			FileReadRequest request;
+			request.path = paths[i];
+			request.size = size;
+			request.buffer = looseData[i].data();
+			request.userData = i;
+			requests.push_back(std::move(request));
+		}
+
+		std::mutex batchMutex;
+		std::condition_variable batchCondition;
+		size_t remaining = requests.size();
+		double looseMs = 0.0;
+
+		auto startTime = std::chrono::steady_clock::now();
+
+		if (!requests.empty()) {
+			reader->Submit(requests.data(), static_cast<uint32_t>(requests.size()), [&](FileReadRequest& request) {
+				const size_t index = static_cast<size_t>(request.userData);
+				std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+
+				std::vector<int8_t>& data = looseData[index];
+				data.resize(request.bytesRead);
+
+				if (request.succeeded) {
+					std::lock_guard<std::mutex> lock(g_assetFilesMutex);
+					g_assetFileStats.looseReads++;
+					g_assetFileStats.looseBytes += data.size();
+					TraceAssetFileRead(names[index], false, data.size(), elapsed.count());
+				}
+
+				onRead(index, data, request.succeeded);
+
+				std::lock_guard<std::mutex> lock(batchMutex);
+				looseMs = std::max(looseMs, elapsed.count());
+				remaining--;
+				batchCondition.notify_all();
+			});
+		}
+
+		for (size_t index : missingIndices) {
+			onRead(index, looseData[index], false);
+		}
+
+		for (size_t index : packedIndices) {
+			auto readStartTime = std::chrono::steady_clock::now();
+
+			std::vector<int8_t> data;
+			const bool read = pack->Read(names[index].c_str(), data);
+
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - readStartTime;
+
+			if (read) {
+				std::lock_guard<std::mutex> lock(g_assetFilesMutex);
+				g_assetFileStats.packReads++;
+				g_assetFileStats.packBytes += data.size();
+				g_assetFileStats.packMs += elapsed.count();
+				TraceAssetFileRead(names[index], true, data.size(), elapsed.count());
+			}
+
+			onRead(index, data, read);
+		}
+
+		{
+			std::unique_lock<std::mutex> batchLock(batchMutex);
+			batchCondition.wait(batchLock, [&]() { return remaining == 0; });
+		}
+
+		// NOTE: The loose reads overlap, the batch counts the time until its last read completed rather than the sum
+		std::lock_guard<std::mutex> lock(g_assetFilesMutex);
+		g_assetFileStats.looseMs += looseMs;
+	}
+
+	void AssetFiles::Exclude(const char* path) {
+		std::error_code ec;
+		std::filesystem::path relativePath = std::filesystem::relative(path, ec);
+
+		std::lock_guard<std::mutex> lock(g_assetFilesMutex);
+		g_excludedAssetFiles.insert(AssetPack::NormalizePath(ec || relativePath.empty() ? path : relativePath.generic_string().c_str()));
+	}
+
+	AssetFileStats AssetFiles::GetStats() {
+		std::lock_guard<std::mutex> lock(g_assetFilesMutex);
+		return g_assetFileStats;
+	}
+
+	void AssetFiles::LogReport(const char* label) {
+		constexpr double MB = 1024.0 * 1024.0;
+
+		const AssetFileStats stats = GetStats();
+		Log::Info("%s I/O: %u files from the pack, %.1f MB in %.1f ms | %u loose files, %.1f MB in %.1f ms", label,
+			stats.packReads, stats.packBytes / MB, stats.packMs, stats.looseReads, stats.looseBytes / MB, stats.looseMs);
+	}
+
+	bool AssetFiles::WriteTrace(const char* path) {
+		std::filesystem::path filePath(path);
+		if (filePath.has_parent_path()) {
+			std::error_code ec;
+			std::filesystem::create_directories(filePath.parent_path(), ec);
+		}
+
+		std::ofstream file(filePath, std::ios::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+
+		std::lock_guard<std::mutex> lock(g_assetFilesMutex);
+
+		file << "order,path,source,bytes,ms\n";
+		for (size_t i = 0; i < g_assetFileTrace.size(); ++i) {
+			const AssetFileTrace& trace = g_assetFileTrace[i];
+			file << i << ',' << trace.path << ',' << (trace.packed ? "pack" : "file") << ',' << trace.bytes << ',' << trace.ms << '\n';
+		}
+
+		return static_cast<bool>(file);
+	}
+}
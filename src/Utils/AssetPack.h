@@ -0,0 +1,171 @@
+#pragma once
+
+#include "Core.h"
+#include "Platform/MappedFile.h"
+#include "Platform/AsyncFileReader.h"
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <functional>
+
+namespace flaw {
+	enum class AssetPackCompression : uint32_t {
+		None,
+		Lz, // byte oriented LZ77, literal runs and matches of at least 4 bytes within 64 KB
+	};
+
+	enum class AssetPackReadMode {
+		Mapped, // entries are read from a mapping of the pack
+		Sequential, // a thread reads the whole data section front to back in large blocks, entries wait for their range
+	};
+
+	struct AssetPackHeader {
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint32_t entryCount = 0;
+		uint32_t alignment = 0;
+		uint64_t dataOffset = 0;
+		uint64_t tocOffset = 0;
+		uint64_t nameTableOffset = 0;
+		uint64_t nameTableSize = 0;
+		uint64_t fileSize = 0;
+	};
+
+	struct AssetPackEntry {
+		uint64_t offset = 0;
+		uint64_t storedSize = 0; // in the pack
+		uint64_t size = 0; // after decompression
+		uint32_t nameOffset = 0; // into the name table
+		uint32_t nameLength = 0;
+		AssetPackCompression compression = AssetPackCompression::None;
+		uint32_t reserved = 0;
+	};
+
+	// NOTE: Loose asset files packed into one file laid out as header, entry data, table of contents and name table. Entries keep
+	// the order they were added in, which is meant to be the order they are loaded in, so a cold start reads the pack front to back.
+	// Each entry starts on the alignment of the pack, names are relative paths with forward slashes as the files are opened with.
+	class AssetPack {
+	public:
+		constexpr static uint32_t Magic = 0x4B415046; // "FPAK"
+		constexpr static uint32_t Version = 1;
+		constexpr static uint64_t ReadaheadBlockSize = 4 * 1024 * 1024;
+
+		AssetPack() = default;
+		~AssetPack();
+
+		AssetPack(const AssetPack&) = delete;
+		AssetPack& operator=(const AssetPack&) = delete;
+
+		bool Open(const char* path, AssetPackReadMode mode);
+		void Close();
+
+		bool IsOpen() const { return _header.magic == Magic; }
+
+		// NOTE: path is normalized before the lookup, "./assets/a/../b.png" finds "assets/b.png"
+		bool Contains(const char* path) const;
+		bool Read(const char* path, std::vector<int8_t>& out);
+
+		uint32_t GetEntryCount() const { return _header.entryCount; }
+		const AssetPackEntry& GetEntry(uint32_t index) const { return _entries[index]; }
+		std::string GetEntryName(uint32_t index) const;
+
+		static std::string NormalizePath(const char* path);
+
+		static void Compress(const uint8_t* data, uint64_t size, std::vector<uint8_t>& out);
+		static bool Decompress(const uint8_t* data, uint64_t size, uint8_t* out, uint64_t outSize);
+
+	private:
+		bool ParseTable(const uint8_t* table, uint64_t tableSize);
+		const uint8_t* WaitForRange(uint64_t offset, uint64_t size);
+		void Readahead();
+
+	private:
+		AssetPackHeader _header;
+		std::vector<AssetPackEntry> _entries;
+		std::string _nameTable;
+		std::unordered_map<std::string, uint32_t> _entryIndices;
+
+		MappedFile _file;
+
+		// NOTE: Sequential mode keeps the data section in memory, filled up to _readaheadEnd by _readaheadThread
+		std::string _path;
+		std::vector<uint8_t> _readahead;
+		std::atomic<uint64_t> _readaheadEnd = 0;
+		std::atomic<bool> _readaheadStop = false;
+		bool _readaheadFailed = false;
+		std::mutex _readaheadMutex;
+		std::condition_variable _readaheadCondition;
+		std::thread _readaheadThread;
+	};
+
+	// NOTE: Writes a pack from files in the order they are added, entries are compressed only when that saves a tenth or more
+	class AssetPackBuilder {
+	public:
+		AssetPackBuilder(uint32_t alignment = 4096, bool compress = true);
+
+		// NOTE: name is what the file is looked up by, filePath where it is read from now
+		bool AddFile(const std::string& name, const std::string& filePath);
+		bool Write(const char* path);
+
+		uint32_t GetEntryCount() const { return static_cast<uint32_t>(_files.size()); }
+		uint64_t GetSourceSize() const { return _sourceSize; }
+		uint64_t GetStoredSize() const { return _storedSize; }
+
+	private:
+		struct File {
+			std::string name;
+			AssetPackCompression compression = AssetPackCompression::None;
+			uint64_t size = 0;
+			std::vector<uint8_t> data; // as stored
+		};
+
+		uint32_t _alignment;
+		bool _compress;
+		std::vector<File> _files;
+		std::unordered_set<std::string> _names;
+		uint64_t _sourceSize = 0;
+		uint64_t _storedSize = 0;
+	};
+
+	struct AssetFileStats {
+		uint32_t packReads = 0;
+		uint64_t packBytes = 0;
+		double packMs = 0.0;
+
+		uint32_t looseReads = 0;
+		uint64_t looseBytes = 0;
+		double looseMs = 0.0;
+	};
+
+	// NOTE: Process-wide reads of asset files. A file in the mounted pack is read from it, any other from disk. Every read is timed,
+	// the first read of each file goes into the trace, which is the load order the pack builder lays the entries out in.
+	class AssetFiles {
+	public:
+		static bool Mount(const char* packPath, AssetPackReadMode mode);
+		static void Unmount();
+
+		// NOTE: Unmounts and stops the batch reader, while no reads are in flight
+		static void Cleanup();
+
+		static bool Read(const char* path, std::vector<int8_t>& out);
+
+		// NOTE: Loose files are read asynchronously in one batch while the packed ones are read on the calling thread. onRead runs
+		// once per path on either thread, concurrently, and may take the data. Returns once every onRead returned.
+		static void ReadBatch(const std::vector<std::string>& paths, const std::function<void(size_t index, std::vector<int8_t>& data, bool read)>& onRead);
+
+		// NOTE: The loose file is read from then on, for sources edited after the pack was built
+		static void Exclude(const char* path);
+
+		static AssetFileStats GetStats();
+		static void LogReport(const char* label);
+
+		// NOTE: CSV of order, path, source, bytes and milliseconds
+		static bool WriteTrace(const char* path);
+	};
+}
@@ -0,0 +1,170 @@
+#include "pch.h"
+#include "BVHCache.h"
+
+#include <fstream>
+
+namespace flaw {
+	static_assert(std::is_trivially_copyable_v<BVHNode>, "BVHNode must be trivially copyable to be mapped from a file");
+	static_assert(std::is_trivially_copyable_v<BVHTriangle>, "BVHTriangle must be trivially copyable to be mapped from a file");
+
+	static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+		return (value + alignment - 1) & ~(alignment - 1);
+	}
+
+	// NOTE: Links only point forward, as the builder writes them, so a traversal of a file that passes always ends. Every triangle
+	// range must lie inside the triangle array.
+	static bool ValidateNodes(const BVHNode* nodes, uint32_t nodeCount, uint32_t triangleCount) {
+		for (uint32_t i = 0; i < nodeCount; ++i) {
+			const BVHNode& node = nodes[i];
+
+			if (node.triangleCount < 0 || (node.triangleCount > 0 && (node.triangleStart < 0 || static_cast<int64_t>(node.triangleStart) + node.triangleCount > triangleCount))) {
+				return false;
+			}
+
+			if (node.IsLeaf()) {
+				continue;
+			}
+
+			if (node.childA <= static_cast<int32_t>(i) || node.childB <= static_cast<int32_t>(i)
+				|| static_cast<uint32_t>(node.childA) >= nodeCount || static_cast<uint32_t>(node.childB) >= nodeCount)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	uint64_t BVHCache::ComputeBuilderKey() {
+		Hasher64 hasher;
+
+		hasher.Update(Version);
+		hasher.Update(MaxBVHDepth);
+		hasher.Update(static_cast<uint32_t>(sizeof(BVHNode)));
+		hasher.Update(static_cast<uint32_t>(sizeof(BVHTriangle)));
+		hasher.Update(static_cast<uint32_t>(alignof(BVHNode)));
+		hasher.Update(static_cast<uint32_t>(alignof(BVHTriangle)));
+
+		return hasher.Digest();
+	}
+
+	bool BVHCache::Load(const char* path, uint64_t sourceKey) {
+		Reset();
+
+		if (!_file.Open(path)) {
+			return false;
+		}
+
+		const uint8_t* data = _file.GetData();
+		const uint64_t size = _file.GetSize();
+
+		BVHCacheHeader header;
+		if (size < sizeof(BVHCacheHeader)) {
+			Log::Warn("BVHCache: %s is truncated, rebuilding", path);
+			Reset();
+			return false;
+		}
+
+		std::memcpy(&header, data, sizeof(BVHCacheHeader));
+
+		if (header.magic != Magic || header.version != Version || header.builderKey != ComputeBuilderKey()) {
+			Log::Warn("BVHCache: %s was written by a different builder, rebuilding", path);
+			Reset();
+			return false;
+		}
+
+		if (header.sourceKey != sourceKey) {
+			Log::Info("BVHCache: %s is stale, rebuilding", path);
+			Reset();
+			return false;
+		}
+
+		const uint64_t nodesEnd = header.nodesOffset + static_cast<uint64_t>(header.nodeCount) * sizeof(BVHNode);
+		const uint64_t trianglesEnd = header.trianglesOffset + static_cast<uint64_t>(header.triangleCount) * sizeof(BVHTriangle);
+
+		if (header.fileSize != size
+			|| header.nodeCount == 0
+			|| header.nodeCount > INT32_MAX
+			|| header.triangleCount > INT32_MAX
+			|| header.nodesOffset % alignof(BVHNode) != 0
+			|| header.trianglesOffset % alignof(BVHTriangle) != 0
+			|| header.nodesOffset < sizeof(BVHCacheHeader)
+			|| nodesEnd > size
+			|| header.trianglesOffset < nodesEnd
+			|| trianglesEnd > size)
+		{
+			Log::Warn("BVHCache: %s is corrupted, rebuilding", path);
+			Reset();
+			return false;
+		}
+
+		if (!ValidateNodes(reinterpret_cast<const BVHNode*>(data + header.nodesOffset), header.nodeCount, header.triangleCount)) {
+			Log::Warn("BVHCache: %s has node links or triangle ranges out of bounds, rebuilding", path);
+			Reset();
+			return false;
+		}
+
+		_view = BVHView(
+			reinterpret_cast<const BVHNode*>(data + header.nodesOffset), header.nodeCount,
+			reinterpret_cast<const BVHTriangle*>(data + header.trianglesOffset), header.triangleCount
+		);
+
+		return true;
+	}
+
+	bool BVHCache::Write(const char* path, uint64_t sourceKey, const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles) {
+		BVHCacheHeader header;
+		header.magic = Magic;
+		header.version = Version;
+		header.sourceKey = sourceKey;
+		header.builderKey = ComputeBuilderKey();
+		header.nodeCount = static_cast<uint32_t>(nodes.size());
+		header.triangleCount = static_cast<uint32_t>(triangles.size());
+		header.nodesOffset = AlignUp(sizeof(BVHCacheHeader), Alignment);
+		header.trianglesOffset = AlignUp(header.nodesOffset + nodes.size() * sizeof(BVHNode), Alignment);
+		header.fileSize = header.trianglesOffset + triangles.size() * sizeof(BVHTriangle);
+
+		std::vector<uint8_t> buffer(header.fileSize, 0);
+		std::memcpy(buffer.data(), &header, sizeof(BVHCacheHeader));
+		std::memcpy(buffer.data() + header.nodesOffset, nodes.data(), nodes.size() * sizeof(BVHNode));
+		std::memcpy(buffer.data() + header.trianglesOffset, triangles.data(), triangles.size() * sizeof(BVHTriangle));
+
+		std::filesystem::path filePath(path);
+		if (filePath.has_parent_path()) {
+			std::error_code ec;
+			std::filesystem::create_directories(filePath.parent_path(), ec);
+		}
+
+		// NOTE: Write to a temporary file and rename it, so a reader never maps a half written cache
+		std::filesystem::path tempPath = filePath;
+		tempPath += ".tmp";
+
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			return false;
+		}
+
+		file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+		file.close();
+
+		if (!file) {
+			return false;
+		}
+
+		std::error_code ec;
+		std::filesystem::rename(tempPath, filePath, ec);
+		if (ec) {
+			std::filesystem::remove(tempPath, ec);
+			return false;
+		}
+
+		return true;
+	}
+
+	void BVHCache::Reset() {
+		_file.Close();
+		_nodes.clear();
+		_triangles.clear();
+		_view = BVHView();
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Core.h"
+#include "Raycast.h"
+#include "Hash.h"
+#include "Platform/MappedFile.h"
+#include "Log/Log.h"
+
+#include <vector>
+
+namespace flaw {
+	struct BVHCacheHeader {
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint64_t sourceKey = 0;
+		uint64_t builderKey = 0;
+		uint64_t fileSize = 0;
+		uint64_t nodesOffset = 0;
+		uint64_t trianglesOffset = 0;
+		uint32_t nodeCount = 0;
+		uint32_t triangleCount = 0;
+	};
+
+	// NOTE: A serialized BVH is the header followed by the node and triangle arrays, located by offsets from the start of the file.
+	// Node links are already indices, so a mapped file is used in place without any parsing or pointer fix-up.
+	class BVHCache {
+	public:
+		constexpr static uint32_t Magic = 0x48564246; // "FBVH"
+		constexpr static uint32_t Version = 1;
+		constexpr static uint64_t Alignment = 16;
+
+		BVHCache() = default;
+
+		BVHCache(const BVHCache&) = delete;
+		BVHCache& operator=(const BVHCache&) = delete;
+
+		// NOTE: Hash of the triangle positions, cheaper than a build since it skips the split pass
+		template <typename TTriangleSource>
+		static uint64_t ComputeSourceKey(const TTriangleSource& source);
+
+		// NOTE: Hash of everything that changes the builder output or the file layout
+		static uint64_t ComputeBuilderKey();
+
+		template <typename TTriangleSource>
+		bool LoadOrBuild(const char* path, const TTriangleSource& source) { return LoadOrBuild(path, ComputeSourceKey(source), source); }
+
+		// NOTE: sourceKey can be any hash that identifies the mesh data, e.g. of the raw vertex and index buffers
+		template <typename TTriangleSource>
+		bool LoadOrBuild(const char* path, uint64_t sourceKey, const TTriangleSource& source);
+
+		bool Load(const char* path, uint64_t sourceKey);
+
+		static bool Write(const char* path, uint64_t sourceKey, const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles);
+
+		void Reset();
+
+		bool IsLoaded() const { return _view.nodeCount != 0; }
+		bool IsFromCache() const { return _file.IsOpen(); }
+
+		const BVHView& GetView() const { return _view; }
+
+	private:
+		MappedFile _file;
+
+		// NOTE: Only used when the cache could not be loaded and the BVH was built in memory
+		std::vector<BVHNode> _nodes;
+		std::vector<BVHTriangle> _triangles;
+
+		BVHView _view;
+	};
+
+	template <typename TTriangleSource>
+	uint64_t BVHCache::ComputeSourceKey(const TTriangleSource& source) {
+		Hasher64 hasher;
+
+		const int32_t triangleCount = source.TriangleCount();
+		hasher.Update(triangleCount);
+
+		for (int32_t i = 0; i < triangleCount; ++i) {
+			vec3 positions[3];
+			source.GetTriangle(i, positions[0], positions[1], positions[2]);
+			hasher.Update(positions, sizeof(positions));
+		}
+
+		return hasher.Digest();
+	}
+
+	template <typename TTriangleSource>
+	bool BVHCache::LoadOrBuild(const char* path, uint64_t sourceKey, const TTriangleSource& source) {
+		if (Load(path, sourceKey)) {
+			return true;
+		}
+
+		Reset();
+
+		Raycast::BuildBVH(source, _nodes, _triangles);
+
+		if (!Write(path, sourceKey, _nodes, _triangles)) {
+			Log::Warn("BVHCache: failed to write %s", path);
+		}
+
+		_view = BVHView(_nodes, _triangles);
+
+		return !_nodes.empty();
+	}
+}
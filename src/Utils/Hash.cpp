@@ -0,0 +1,141 @@
+#include "pch.h"
+#include "Hash.h"
+
+#include <cstring>
+
+namespace flaw {
+	constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+	constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+	constexpr uint64_t Prime3 = 0x165667B19E3779F9ull;
+	constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ull;
+	constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ull;
+
+	static inline uint64_t RotateLeft(uint64_t value, int32_t bits) {
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	static inline uint64_t Read64(const uint8_t* ptr) {
+		uint64_t value;
+		std::memcpy(&value, ptr, sizeof(value));
+		return value;
+	}
+
+	static inline uint32_t Read32(const uint8_t* ptr) {
+		uint32_t value;
+		std::memcpy(&value, ptr, sizeof(value));
+		return value;
+	}
+
+	static inline uint64_t Round(uint64_t acc, uint64_t input) {
+		acc += input * Prime2;
+		acc = RotateLeft(acc, 31);
+		return acc * Prime1;
+	}
+
+	static inline uint64_t MergeRound(uint64_t acc, uint64_t value) {
+		acc ^= Round(0, value);
+		return acc * Prime1 + Prime4;
+	}
+
+	Hasher64::Hasher64(uint64_t seed)
+		: _seed(seed)
+		, _bufferSize(0)
+		, _totalSize(0)
+	{
+		_state[0] = seed + Prime1 + Prime2;
+		_state[1] = seed + Prime2;
+		_state[2] = seed;
+		_state[3] = seed - Prime1;
+	}
+
+	void Hasher64::Update(const void* data, uint64_t size) {
+		const uint8_t* ptr = static_cast<const uint8_t*>(data);
+		const uint8_t* end = ptr + size;
+
+		_totalSize += size;
+
+		if (_bufferSize + size < 32) {
+			std::memcpy(_buffer + _bufferSize, ptr, size);
+			_bufferSize += static_cast<uint32_t>(size);
+			return;
+		}
+
+		if (_bufferSize) {
+			const uint32_t fill = 32 - _bufferSize;
+			std::memcpy(_buffer + _bufferSize, ptr, fill);
+			ptr += fill;
+
+			_state[0] = Round(_state[0], Read64(_buffer));
+			_state[1] = Round(_state[1], Read64(_buffer + 8));
+			_state[2] = Round(_state[2], Read64(_buffer + 16));
+			_state[3] = Round(_state[3], Read64(_buffer + 24));
+
+			_bufferSize = 0;
+		}
+
+		while (ptr + 32 <= end) {
+			_state[0] = Round(_state[0], Read64(ptr));
+			_state[1] = Round(_state[1], Read64(ptr + 8));
+			_state[2] = Round(_state[2], Read64(ptr + 16));
+			_state[3] = Round(_state[3], Read64(ptr + 24));
+			ptr += 32;
+		}
+
+		if (ptr < end) {
+			_bufferSize = static_cast<uint32_t>(end - ptr);
+			std::memcpy(_buffer, ptr, _bufferSize);
+		}
+	}
+
+	uint64_t Hasher64::Digest() const {
+		uint64_t hash;
+
+		if (_totalSize >= 32) {
+			hash = RotateLeft(_state[0], 1) + RotateLeft(_state[1], 7) + RotateLeft(_state[2], 12) + RotateLeft(_state[3], 18);
+			hash = MergeRound(hash, _state[0]);
+			hash = MergeRound(hash, _state[1]);
+			hash = MergeRound(hash, _state[2]);
+			hash = MergeRound(hash, _state[3]);
+		}
+		else {
+			hash = _seed + Prime5;
+		}
+
+		hash += _totalSize;
+
+		const uint8_t* ptr = _buffer;
+		const uint8_t* end = _buffer + _bufferSize;
+
+		while (ptr + 8 <= end) {
+			hash ^= Round(0, Read64(ptr));
+			hash = RotateLeft(hash, 27) * Prime1 + Prime4;
+			ptr += 8;
+		}
+
+		if (ptr + 4 <= end) {
+			hash ^= static_cast<uint64_t>(Read32(ptr)) * Prime1;
+			hash = RotateLeft(hash, 23) * Prime2 + Prime3;
+			ptr += 4;
+		}
+
+		while (ptr < end) {
+			hash ^= static_cast<uint64_t>(*ptr) * Prime5;
+			hash = RotateLeft(hash, 11) * Prime1;
+			ptr++;
+		}
+
+		hash ^= hash >> 33;
+		hash *= Prime2;
+		hash ^= hash >> 29;
+		hash *= Prime3;
+		hash ^= hash >> 32;
+
+		return hash;
+	}
+
+	uint64_t Hash64(const void* data, uint64_t size, uint64_t seed) {
+		Hasher64 hasher(seed);
+		hasher.Update(data, size);
+		return hasher.Digest();
+	}
+}
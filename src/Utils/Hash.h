@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Core.h"
+
+namespace flaw {
+	// NOTE: 64-bit xxHash, used to key on-disk caches by their source data
+	class Hasher64 {
+	public:
+		Hasher64(uint64_t seed = 0);
+
+		void Update(const void* data, uint64_t size);
+
+		template <typename T>
+		void Update(const T& value) {
+			static_assert(std::is_trivially_copyable_v<T>, "Hasher64::Update expects a trivially copyable type");
+			Update(&value, sizeof(T));
+		}
+
+		uint64_t Digest() const;
+
+	private:
+		uint64_t _seed;
+		uint64_t _state[4];
+		uint8_t _buffer[32];
+		uint32_t _bufferSize;
+		uint64_t _totalSize;
+	};
+
+	uint64_t Hash64(const void* data, uint64_t size, uint64_t seed = 0);
+}
@@ -0,0 +1,81 @@
+#include "pch.h"
+#include "OffsetAllocator.h"
+
+namespace flaw {
+	OffsetAllocator::OffsetAllocator(uint32_t capacity)
+		: _capacity(capacity)
+	{
+		if (capacity != 0) {
+			InsertFree(0, capacity);
+		}
+	}
+
+	uint32_t OffsetAllocator::Allocate(uint32_t size) {
+		if (size == 0) {
+			return InvalidOffset;
+		}
+
+		auto sizeIt = _freeBySize.lower_bound(size);
+		if (sizeIt == _freeBySize.end()) {
+			return InvalidOffset;
+		}
+
+		const uint32_t offset = sizeIt->second;
+		const uint32_t freeSize = sizeIt->first;
+
+		EraseFree(_freeByOffset.find(offset));
+
+		if (freeSize > size) {
+			InsertFree(offset + size, freeSize - size);
+		}
+
+		_used += size;
+
+		return offset;
+	}
+
+	void OffsetAllocator::Free(uint32_t offset, uint32_t size) {
+		if (size == 0) {
+			return;
+		}
+
+		uint32_t start = offset;
+		uint32_t end = offset + size;
+
+		auto next = _freeByOffset.lower_bound(offset);
+		if (next != _freeByOffset.end() && next->first == end) {
+			end += next->second;
+			next = std::next(next);
+			EraseFree(std::prev(next));
+		}
+
+		if (next != _freeByOffset.begin()) {
+			auto prev = std::prev(next);
+			if (prev->first + prev->second == start) {
+				start = prev->first;
+				EraseFree(prev);
+			}
+		}
+
+		InsertFree(start, end - start);
+
+		_used -= size;
+	}
+
+	void OffsetAllocator::InsertFree(uint32_t offset, uint32_t size) {
+		_freeByOffset.emplace(offset, size);
+		_freeBySize.emplace(size, offset);
+	}
+
+	void OffsetAllocator::EraseFree(std::map<uint32_t, uint32_t>::iterator it) {
+		auto range = _freeBySize.equal_range(it->second);
+		for (auto sizeIt = range.first; sizeIt != range.second; ++sizeIt) {
+			if (sizeIt->second == it->first) {
+				_freeBySize.erase(sizeIt);
+				break;
+			}
+		}
+
+		_freeByOffset.erase(it);
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Core.h"
+
+#include <map>
+
+namespace flaw {
+	// NOTE: Hands out ranges of [0, capacity) in whatever unit the caller counts in, vertices or indices for the geometry pool.
+	// Best fit over the free ranges, freed ranges merge with their free neighbors so the space does not fragment over time.
+	class OffsetAllocator {
+	public:
+		constexpr static uint32_t InvalidOffset = 0xFFFFFFFFu;
+
+		OffsetAllocator() = default;
+		OffsetAllocator(uint32_t capacity);
+
+		// NOTE: InvalidOffset if no free range is large enough, size must not be 0
+		uint32_t Allocate(uint32_t size);
+		void Free(uint32_t offset, uint32_t size);
+
+		uint32_t GetCapacity() const { return _capacity; }
+		uint32_t GetUsed() const { return _used; }
+		uint32_t GetLargestFree() const { return _freeBySize.empty() ? 0 : _freeBySize.rbegin()->first; }
+		uint32_t GetFreeRangeCount() const { return static_cast<uint32_t>(_freeByOffset.size()); }
+
+	private:
+		void InsertFree(uint32_t offset, uint32_t size);
+		void EraseFree(std::map<uint32_t, uint32_t>::iterator it);
+
+	private:
+		uint32_t _capacity = 0;
+		uint32_t _used = 0;
+
+		std::map<uint32_t, uint32_t> _freeByOffset; // offset -> size
+		std::multimap<uint32_t, uint32_t> _freeBySize; // size -> offset
+	};
+}
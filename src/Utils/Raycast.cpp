@@ -26,7 +26,7 @@ namespace flaw {
 		IncludePoint(triangle.p2);
 	}
 
-	void Split(std::vector<BVHNode>& nodes, std::vector<BVHTriangle>& triangles, int32_t parent, int32_t depth) {
+	void Raycast::Split(std::vector<BVHNode>& nodes, std::vector<BVHTriangle>& triangles, int32_t parent, int32_t depth) {
 		if (depth >= MaxBVHDepth || nodes[parent].triangleCount <= 1) {
 			return;
 		}
@@ -83,25 +83,21 @@ namespace flaw {
 		Split(nodes, triangles, nodes[parent].childB, depth + 1);
 	}
 
-	void Raycast::BuildBVH(const std::function<vec3(int32_t)>& getVertex, int32_t vertexCount, std::vector<BVHNode>& nodes, std::vector<BVHTriangle>& triangles) {
-		BVHNode rootNode;
+	struct CallbackTriangleSource {
+		const std::function<vec3(int32_t)>& getVertex;
+		int32_t vertexCount;
 
-		triangles.reserve(vertexCount / 3);
-		for (size_t i = 0; i < vertexCount; i += 3) {
-			const auto& v0 = getVertex(i);
-			const auto& v1 = getVertex(i + 1);
-			const auto& v2 = getVertex(i + 2);
+		int32_t TriangleCount() const { return vertexCount / 3; }
 
-			triangles.emplace_back(v0, v1, v2);
-			rootNode.boundingBox.IncludeTriangle(triangles.back());
-			rootNode.triangleCount++;
+		void GetTriangle(int32_t index, vec3& p0, vec3& p1, vec3& p2) const {
+			p0 = getVertex(index * 3);
+			p1 = getVertex(index * 3 + 1);
+			p2 = getVertex(index * 3 + 2);
 		}
+	};
 
-		rootNode.triangleStart = 0;
-
-		nodes.push_back(rootNode);
-
-		Split(nodes, triangles, 0, 0);
+	void Raycast::BuildBVH(const std::function<vec3(int32_t)>& getVertex, int32_t vertexCount, std::vector<BVHNode>& nodes, std::vector<BVHTriangle>& triangles) {
+		BuildBVH(CallbackTriangleSource{ getVertex, vertexCount }, nodes, triangles);
 	}
 
 	bool Raycast::BVHBoundingBoxLineIntersect(const BVHBoundingBox& box, const Ray& ray) {
@@ -168,57 +164,422 @@ namespace flaw {
 		return true;
 	}
 
-	bool Raycast::RayCastBVHImpl(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const int32_t current, const Ray& ray, RayHit& hit) {
-		const auto& node = nodes[current];
+	bool Raycast::BVHBoundingBoxRayIntersect(const BVHBoundingBox& box, const Ray& ray, const vec3& invDirection, float tMax, float& outTNear) {
+		const vec3 t0 = (box.min - ray.origin) * invDirection;
+		const vec3 t1 = (box.max - ray.origin) * invDirection;
 
-		if (!BVHBoundingBoxLineIntersect(node.boundingBox, ray)) {
+		const float tEnter = std::max(std::max(std::min(t0.x, t1.x), std::min(t0.y, t1.y)), std::max(std::min(t0.z, t1.z), 0.0f));
+		const float tExit = std::min(std::min(std::max(t0.x, t1.x), std::max(t0.y, t1.y)), std::min(std::max(t0.z, t1.z), tMax));
+
+		if (tEnter > tExit) {
 			return false;
 		}
 
+		outTNear = tEnter;
+		return true;
+	}
+
+	constexpr int32_t MaxBVHStackSize = 64;
+
+	bool Raycast::RaycastBVH(const BVHView& bvh, const Ray& ray, RayHit& hit) {
+		if (bvh.nodeCount == 0) {
+			return false;
+		}
+
+		struct StackEntry {
+			int32_t nodeIndex;
+			float tNear;
+		};
+
+		const vec3 invDirection = 1.0f / ray.direction;
+
+		// NOTE: tMax shrinks to the closest hit so far, anything entered beyond it is skipped
+		float tMax = std::min(ray.length, hit.distance);
+
+		float tRoot;
+		if (!BVHBoundingBoxRayIntersect(bvh.nodes[0].boundingBox, ray, invDirection, tMax, tRoot)) {
+			return false;
+		}
+
+		StackEntry stack[MaxBVHStackSize];
+		int32_t stackSize = 0;
+
+		stack[stackSize++] = { 0, tRoot };
+
 		bool result = false;
 
-		if (node.IsLeaf()) {
-			for (int32_t i = 0; i < node.triangleCount; ++i) {
-				auto& tri = triangles[node.triangleStart + i];
+		while (stackSize > 0) {
+			const StackEntry entry = stack[--stackSize];
+			if (entry.tNear > tMax) {
+				continue;
+			}
 
-				vec3 hitPoint;
-				float t;
-				if (BVHTriangleLineIntersect(tri, ray, hitPoint, t)) {
-					if (t < hit.distance) {
+			const BVHNode* node = &bvh.nodes[entry.nodeIndex];
+
+			if (node->IsLeaf()) {
+				const BVHTriangle* tri = &bvh.triangles[node->triangleStart];
+				for (int32_t i = 0; i < node->triangleCount; ++i, ++tri) {
+					vec3 hitPoint;
+					float t;
+					if (BVHTriangleLineIntersect(*tri, ray, hitPoint, t) && t < tMax) {
 						hit.position = hitPoint;
-						hit.normal = tri.normal;
+						hit.normal = tri->normal;
 						hit.distance = t;
+						tMax = t;
 						result = true;
 					}
 				}
+				continue;
+			}
+
+			float tA, tB;
+			const bool hitA = node->childA != -1 && BVHBoundingBoxRayIntersect(bvh.nodes[node->childA].boundingBox, ray, invDirection, tMax, tA);
+			const bool hitB = node->childB != -1 && BVHBoundingBoxRayIntersect(bvh.nodes[node->childB].boundingBox, ray, invDirection, tMax, tB);
+
+			FASSERT(stackSize + 2 <= MaxBVHStackSize, "BVH traversal stack overflow");
+
+			// NOTE: Push the farther child first so the nearer one is popped next
+			if (hitA && hitB) {
+				if (tA <= tB) {
+					stack[stackSize++] = { node->childB, tB };
+					stack[stackSize++] = { node->childA, tA };
+				}
+				else {
+					stack[stackSize++] = { node->childA, tA };
+					stack[stackSize++] = { node->childB, tB };
+				}
+			}
+			else if (hitA) {
+				stack[stackSize++] = { node->childA, tA };
+			}
+			else if (hitB) {
+				stack[stackSize++] = { node->childB, tB };
 			}
 		}
-		else {
-			RayHit leftHit = hit;
-			RayHit rightHit = hit;
 
-			bool leftResult = node.childA != -1 && RayCastBVHImpl(nodes, triangles, node.childA, ray, leftHit);
-			bool rightResult = node.childB != -1 && RayCastBVHImpl(nodes, triangles, node.childB, ray, rightHit);
+		return result;
+	}
+
+	bool Raycast::Occluded(const BVHView& bvh, const Ray& ray) {
+		if (bvh.nodeCount == 0) {
+			return false;
+		}
+
+		const vec3 invDirection = 1.0f / ray.direction;
+
+		int32_t stack[MaxBVHStackSize];
+		int32_t stackSize = 0;
+
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0) {
+			const BVHNode* node = &bvh.nodes[stack[--stackSize]];
+
+			float tNear;
+			if (!BVHBoundingBoxRayIntersect(node->boundingBox, ray, invDirection, ray.length, tNear)) {
+				continue;
+			}
+
+			if (node->IsLeaf()) {
+				const BVHTriangle* tri = &bvh.triangles[node->triangleStart];
+				for (int32_t i = 0; i < node->triangleCount; ++i, ++tri) {
+					vec3 hitPoint;
+					float t;
+					if (BVHTriangleLineIntersect(*tri, ray, hitPoint, t)) {
+						return true;
+					}
+				}
+				continue;
+			}
+
+			FASSERT(stackSize + 2 <= MaxBVHStackSize, "BVH traversal stack overflow");
+
+			if (node->childB != -1) {
+				stack[stackSize++] = node->childB;
+			}
+			if (node->childA != -1) {
+				stack[stackSize++] = node->childA;
+			}
+		}
+
+		return false;
+	}
+
+	float Raycast::BVHBoundingBoxDistanceSq(const BVHBoundingBox& box, const vec3& point) {
+		const vec3 d = max(max(box.min - point, point - box.max), vec3(0.0f));
+		return dot(d, d);
+	}
+
+	bool Raycast::BVHBoundingBoxOverlap(const BVHBoundingBox& a, const BVHBoundingBox& b) {
+		return a.min.x <= b.max.x && a.max.x >= b.min.x
+			&& a.min.y <= b.max.y && a.max.y >= b.min.y
+			&& a.min.z <= b.max.z && a.max.z >= b.min.z;
+	}
+
+	vec3 Raycast::BVHClosestPointOnTriangle(const BVHTriangle& tri, const vec3& point) {
+		// NOTE: Voronoi region test, Real-Time Collision Detection 5.1.5
+		const vec3 ab = tri.p1 - tri.p0;
+		const vec3 ac = tri.p2 - tri.p0;
+		const vec3 ap = point - tri.p0;
+
+		const float d1 = dot(ab, ap);
+		const float d2 = dot(ac, ap);
+		if (d1 <= 0.0f && d2 <= 0.0f) {
+			return tri.p0;
+		}
+
+		const vec3 bp = point - tri.p1;
+		const float d3 = dot(ab, bp);
+		const float d4 = dot(ac, bp);
+		if (d3 >= 0.0f && d4 <= d3) {
+			return tri.p1;
+		}
+
+		const float vc = d1 * d4 - d3 * d2;
+		if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+			return tri.p0 + ab * (d1 / (d1 - d3));
+		}
+
+		const vec3 cp = point - tri.p2;
+		const float d5 = dot(ab, cp);
+		const float d6 = dot(ac, cp);
+		if (d6 >= 0.0f && d5 <= d6) {
+			return tri.p2;
+		}
+
+		const float vb = d5 * d2 - d1 * d6;
+		if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+			return tri.p0 + ac * (d2 / (d2 - d6));
+		}
+
+		const float va = d3 * d6 - d5 * d4;
+		if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+			return tri.p1 + (tri.p2 - tri.p1) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+		}
+
+		const float denom = 1.0f / (va + vb + vc);
+		return tri.p0 + ab * (vb * denom) + ac * (vc * denom);
+	}
+
+	bool Raycast::BVHTriangleBoxOverlap(const BVHTriangle& tri, const BVHBoundingBox& box) {
+		// NOTE: Separating axis test, box axes, triangle normal and the 9 edge cross products
+		const vec3 center = (box.min + box.max) * 0.5f;
+		const vec3 extent = (box.max - box.min) * 0.5f;
+
+		const vec3 v[3] = { tri.p0 - center, tri.p1 - center, tri.p2 - center };
+
+		for (int32_t axis = 0; axis < 3; ++axis) {
+			const float minValue = std::min(std::min(v[0][axis], v[1][axis]), v[2][axis]);
+			const float maxValue = std::max(std::max(v[0][axis], v[1][axis]), v[2][axis]);
+			if (minValue > extent[axis] || maxValue < -extent[axis]) {
+				return false;
+			}
+		}
+
+		const vec3 edges[3] = { v[1] - v[0], v[2] - v[1], v[0] - v[2] };
+
+		for (int32_t i = 0; i < 3; ++i) {
+			for (int32_t axis = 0; axis < 3; ++axis) {
+				vec3 unit(0.0f);
+				unit[axis] = 1.0f;
+
+				const vec3 testAxis = cross(unit, edges[i]);
 
-			if (leftResult && rightResult) {
-				hit = (leftHit.distance < rightHit.distance) ? leftHit : rightHit;
-				result = true;
+				const float p0 = dot(v[0], testAxis);
+				const float p1 = dot(v[1], testAxis);
+				const float p2 = dot(v[2], testAxis);
+				const float r = extent.x * std::abs(testAxis.x) + extent.y * std::abs(testAxis.y) + extent.z * std::abs(testAxis.z);
+
+				if (std::min(std::min(p0, p1), p2) > r || std::max(std::max(p0, p1), p2) < -r) {
+					return false;
+				}
 			}
-			else if (leftResult) {
-				hit = leftHit;
-				result = true;
+		}
+
+		const vec3 normal = cross(edges[0], edges[1]);
+		const float d = dot(normal, v[0]);
+		const float r = extent.x * std::abs(normal.x) + extent.y * std::abs(normal.y) + extent.z * std::abs(normal.z);
+
+		return std::abs(d) <= r;
+	}
+
+	bool Raycast::ClosestPointBVH(const BVHView& bvh, const vec3& point, float maxDistance, PointQueryHit& hit) {
+		if (bvh.nodeCount == 0) {
+			return false;
+		}
+
+		struct StackEntry {
+			int32_t nodeIndex;
+			float distanceSq;
+		};
+
+		// NOTE: Bound shrinks to the best distance found so far, nodes farther than it are pruned
+		float bestDistanceSq = maxDistance * maxDistance;
+
+		const float rootDistanceSq = BVHBoundingBoxDistanceSq(bvh.nodes[0].boundingBox, point);
+		if (rootDistanceSq > bestDistanceSq) {
+			return false;
+		}
+
+		StackEntry stack[MaxBVHStackSize];
+		int32_t stackSize = 0;
+
+		stack[stackSize++] = { 0, rootDistanceSq };
+
+		bool result = false;
+
+		while (stackSize > 0) {
+			const StackEntry entry = stack[--stackSize];
+			if (entry.distanceSq > bestDistanceSq) {
+				continue;
+			}
+
+			const BVHNode* node = &bvh.nodes[entry.nodeIndex];
+
+			if (node->IsLeaf()) {
+				for (int32_t i = 0; i < node->triangleCount; ++i) {
+					const int32_t triangleIndex = node->triangleStart + i;
+					const BVHTriangle& tri = bvh.triangles[triangleIndex];
+
+					const vec3 closest = BVHClosestPointOnTriangle(tri, point);
+					const vec3 diff = closest - point;
+					const float distanceSq = dot(diff, diff);
+
+					if (distanceSq <= bestDistanceSq) {
+						bestDistanceSq = distanceSq;
+						hit.position = closest;
+						hit.normal = tri.normal;
+						hit.triangleIndex = triangleIndex;
+						result = true;
+					}
+				}
+				continue;
 			}
-			else if (rightResult) {
-				hit = rightHit;
-				result = true;
+
+			const float dA = node->childA != -1 ? BVHBoundingBoxDistanceSq(bvh.nodes[node->childA].boundingBox, point) : std::numeric_limits<float>::max();
+			const float dB = node->childB != -1 ? BVHBoundingBoxDistanceSq(bvh.nodes[node->childB].boundingBox, point) : std::numeric_limits<float>::max();
+
+			FASSERT(stackSize + 2 <= MaxBVHStackSize, "BVH traversal stack overflow");
+
+			// NOTE: Push the farther child first so the nearer one is searched first and tightens the bound
+			const bool aFirst = dA <= dB;
+			const int32_t nearChild = aFirst ? node->childA : node->childB;
+			const int32_t farChild = aFirst ? node->childB : node->childA;
+			const float nearDistanceSq = aFirst ? dA : dB;
+			const float farDistanceSq = aFirst ? dB : dA;
+
+			if (farChild != -1 && farDistanceSq <= bestDistanceSq) {
+				stack[stackSize++] = { farChild, farDistanceSq };
+			}
+			if (nearChild != -1 && nearDistanceSq <= bestDistanceSq) {
+				stack[stackSize++] = { nearChild, nearDistanceSq };
 			}
 		}
 
+		if (result) {
+			hit.distance = std::sqrt(bestDistanceSq);
+		}
+
 		return result;
 	}
 
-	bool Raycast::RaycastBVH(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const Ray& ray, RayHit& hit) {
-		return RayCastBVHImpl(nodes, triangles, 0, ray, hit);
+	int32_t Raycast::OverlapSphereBVH(const BVHView& bvh, const vec3& center, float radius, int32_t* outTriangles, int32_t maxCount) {
+		if (bvh.nodeCount == 0 || maxCount <= 0) {
+			return 0;
+		}
+
+		const float radiusSq = radius * radius;
+
+		int32_t stack[MaxBVHStackSize];
+		int32_t stackSize = 0;
+
+		stack[stackSize++] = 0;
+
+		int32_t count = 0;
+
+		while (stackSize > 0) {
+			const BVHNode* node = &bvh.nodes[stack[--stackSize]];
+
+			if (BVHBoundingBoxDistanceSq(node->boundingBox, center) > radiusSq) {
+				continue;
+			}
+
+			if (node->IsLeaf()) {
+				for (int32_t i = 0; i < node->triangleCount; ++i) {
+					const int32_t triangleIndex = node->triangleStart + i;
+
+					const vec3 diff = BVHClosestPointOnTriangle(bvh.triangles[triangleIndex], center) - center;
+					if (dot(diff, diff) > radiusSq) {
+						continue;
+					}
+
+					outTriangles[count++] = triangleIndex;
+					if (count == maxCount) {
+						return count;
+					}
+				}
+				continue;
+			}
+
+			FASSERT(stackSize + 2 <= MaxBVHStackSize, "BVH traversal stack overflow");
+
+			if (node->childB != -1) {
+				stack[stackSize++] = node->childB;
+			}
+			if (node->childA != -1) {
+				stack[stackSize++] = node->childA;
+			}
+		}
+
+		return count;
+	}
+
+	int32_t Raycast::OverlapBoxBVH(const BVHView& bvh, const BVHBoundingBox& box, int32_t* outTriangles, int32_t maxCount) {
+		if (bvh.nodeCount == 0 || maxCount <= 0) {
+			return 0;
+		}
+
+		int32_t stack[MaxBVHStackSize];
+		int32_t stackSize = 0;
+
+		stack[stackSize++] = 0;
+
+		int32_t count = 0;
+
+		while (stackSize > 0) {
+			const BVHNode* node = &bvh.nodes[stack[--stackSize]];
+
+			if (!BVHBoundingBoxOverlap(node->boundingBox, box)) {
+				continue;
+			}
+
+			if (node->IsLeaf()) {
+				for (int32_t i = 0; i < node->triangleCount; ++i) {
+					const int32_t triangleIndex = node->triangleStart + i;
+
+					if (!BVHTriangleBoxOverlap(bvh.triangles[triangleIndex], box)) {
+						continue;
+					}
+
+					outTriangles[count++] = triangleIndex;
+					if (count == maxCount) {
+						return count;
+					}
+				}
+				continue;
+			}
+
+			FASSERT(stackSize + 2 <= MaxBVHStackSize, "BVH traversal stack overflow");
+
+			if (node->childB != -1) {
+				stack[stackSize++] = node->childB;
+			}
+			if (node->childA != -1) {
+				stack[stackSize++] = node->childA;
+			}
+		}
+
+		return count;
 	}
 
 	void Raycast::GetCandidateBVHTrianglesImpl(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const Ray& ray, int32_t current, const std::function<void(int32_t, int32_t)>& callback) {
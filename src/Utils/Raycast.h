@@ -3,6 +3,7 @@
 #include "Math/Math.h"
 
 #include <functional>
+#include <cstring>
 
 namespace flaw {
 	constexpr int32_t MaxBVHDepth = 3;
@@ -19,6 +20,13 @@ namespace flaw {
 		float distance = std::numeric_limits<float>::max();
 	};
 
+	struct PointQueryHit {
+		vec3 position;
+		vec3 normal;
+		float distance = std::numeric_limits<float>::max();
+		int32_t triangleIndex = -1;
+	};
+
 	struct BVHTriangle {
 		vec3 p0, p1, p2;
 		vec3 center;
@@ -46,20 +54,197 @@ namespace flaw {
 		bool IsLeaf() const { return childA == -1 && childB == -1; }
 	};
 
+	// NOTE: Non-owning view over BVH data, either from vectors or from a mapped cache file
+	struct BVHView {
+		const BVHNode* nodes = nullptr;
+		int32_t nodeCount = 0;
+		const BVHTriangle* triangles = nullptr;
+		int32_t triangleCount = 0;
+
+		BVHView() = default;
+		BVHView(const BVHNode* nodes, int32_t nodeCount, const BVHTriangle* triangles, int32_t triangleCount)
+			: nodes(nodes), nodeCount(nodeCount), triangles(triangles), triangleCount(triangleCount) {}
+		BVHView(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles)
+			: nodes(nodes.data()), nodeCount(static_cast<int32_t>(nodes.size())), triangles(triangles.data()), triangleCount(static_cast<int32_t>(triangles.size())) {}
+	};
+
+	// NOTE: A triangle source is any type that provides
+	//   int32_t TriangleCount() const;
+	//   void GetTriangle(int32_t index, vec3& p0, vec3& p1, vec3& p2) const;
+	// so BuildBVH can be instantiated for it and vertex access inlined.
+
+	// Indexed vertices with a 'position' member, e.g. TexturedVertex
+	template <typename TVertex>
+	struct IndexedVertexTriangleSource {
+		const TVertex* vertices = nullptr;
+		const uint32_t* indices = nullptr;
+		int32_t indexCount = 0;
+
+		IndexedVertexTriangleSource(const TVertex* vertices, const uint32_t* indices, int32_t indexCount)
+			: vertices(vertices), indices(indices), indexCount(indexCount) {}
+
+		int32_t TriangleCount() const { return indexCount / 3; }
+
+		void GetTriangle(int32_t index, vec3& p0, vec3& p1, vec3& p2) const {
+			const uint32_t* tri = indices + index * 3;
+			p0 = vertices[tri[0]].position;
+			p1 = vertices[tri[1]].position;
+			p2 = vertices[tri[2]].position;
+		}
+	};
+
+	// Non-indexed triangle list of positions
+	struct PositionArrayTriangleSource {
+		const vec3* positions = nullptr;
+		int32_t vertexCount = 0;
+
+		PositionArrayTriangleSource(const vec3* positions, int32_t vertexCount)
+			: positions(positions), vertexCount(vertexCount) {}
+
+		int32_t TriangleCount() const { return vertexCount / 3; }
+
+		void GetTriangle(int32_t index, vec3& p0, vec3& p1, vec3& p2) const {
+			const vec3* tri = positions + index * 3;
+			p0 = tri[0];
+			p1 = tri[1];
+			p2 = tri[2];
+		}
+	};
+
+	// Positions read from an interleaved buffer, optionally indexed
+	struct StridedPositionTriangleSource {
+		const uint8_t* data = nullptr;
+		uint32_t stride = sizeof(vec3);
+		const uint32_t* indices = nullptr;
+		int32_t count = 0; // index count when indexed, vertex count otherwise
+
+		StridedPositionTriangleSource(const void* positions, uint32_t stride, int32_t vertexCount)
+			: data(static_cast<const uint8_t*>(positions)), stride(stride), count(vertexCount) {}
+
+		StridedPositionTriangleSource(const void* positions, uint32_t stride, const uint32_t* indices, int32_t indexCount)
+			: data(static_cast<const uint8_t*>(positions)), stride(stride), indices(indices), count(indexCount) {}
+
+		int32_t TriangleCount() const { return count / 3; }
+
+		void GetTriangle(int32_t index, vec3& p0, vec3& p1, vec3& p2) const {
+			const int32_t first = index * 3;
+			p0 = GetPosition(first);
+			p1 = GetPosition(first + 1);
+			p2 = GetPosition(first + 2);
+		}
+
+	private:
+		vec3 GetPosition(int32_t i) const {
+			const uint32_t vertex = indices ? indices[i] : static_cast<uint32_t>(i);
+
+			vec3 position;
+			std::memcpy(&position, data + static_cast<size_t>(vertex) * stride, sizeof(vec3));
+			return position;
+		}
+	};
+
 	class Raycast {
 	public:
 		static void BuildBVH(const std::function<vec3(int32_t)>& getVertex, int32_t vertexCount, std::vector<BVHNode>& nodes, std::vector<BVHTriangle>& triangles);
+
+		// NOTE: nodes and triangles are cleared first
+		template <typename TTriangleSource>
+		static void BuildBVH(const TTriangleSource& source, std::vector<BVHNode>& nodes, std::vector<BVHTriangle>& triangles);
 	
 		static bool BVHBoundingBoxLineIntersect(const BVHBoundingBox& box, const Ray& ray);
 		static bool BVHTriangleLineIntersect(const BVHTriangle& tri, const Ray& ray, vec3& outPos, float& outT);
 
-		static bool RaycastBVH(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const Ray& ray, RayHit& hit);
+		// NOTE: Closest hit, nearer child visited first and the search range clipped to the closest hit so far
+		static bool RaycastBVH(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const Ray& ray, RayHit& hit) { return RaycastBVH(BVHView(nodes, triangles), ray, hit); }
+		static bool RaycastBVH(const BVHView& bvh, const Ray& ray, RayHit& hit);
+
+		// NOTE: Any hit within ray.length, returns at the first intersection. Use for shadow and visibility rays.
+		static bool Occluded(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const Ray& ray) { return Occluded(BVHView(nodes, triangles), ray); }
+		static bool Occluded(const BVHView& bvh, const Ray& ray);
 
 		static void GetCandidateBVHTriangles(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const Ray& ray, const std::function<void(int32_t, int32_t)>& callback);
-	
+
+		static vec3 BVHClosestPointOnTriangle(const BVHTriangle& tri, const vec3& point);
+		static bool BVHTriangleBoxOverlap(const BVHTriangle& tri, const BVHBoundingBox& box);
+
+		// NOTE: Nearest surface point within maxDistance, returns false if nothing is that close.
+		// triangleIndex refers to the BVH's own (reordered) triangle array.
+		static bool ClosestPointBVH(const BVHView& bvh, const vec3& point, float maxDistance, PointQueryHit& hit);
+
+		// NOTE: Overlap queries write triangle indices into the caller's buffer and return how many were written.
+		// The search stops once maxCount indices have been written.
+		static int32_t OverlapSphereBVH(const BVHView& bvh, const vec3& center, float radius, int32_t* outTriangles, int32_t maxCount);
+		static int32_t OverlapBoxBVH(const BVHView& bvh, const BVHBoundingBox& box, int32_t* outTriangles, int32_t maxCount);
+
+		template <typename TCallback>
+		static void GetCandidateBVHTriangles(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const Ray& ray, TCallback&& callback);
+
 	private:
-		static bool RayCastBVHImpl(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const int32_t current, const Ray& ray, RayHit& hit);
+		static void Split(std::vector<BVHNode>& nodes, std::vector<BVHTriangle>& triangles, int32_t parent, int32_t depth);
+
+		static float BVHBoundingBoxDistanceSq(const BVHBoundingBox& box, const vec3& point);
+		static bool BVHBoundingBoxOverlap(const BVHBoundingBox& a, const BVHBoundingBox& b);
+
+		static bool BVHBoundingBoxRayIntersect(const BVHBoundingBox& box, const Ray& ray, const vec3& invDirection, float tMax, float& outTNear);
 	
 		static void GetCandidateBVHTrianglesImpl(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const Ray& ray, int32_t current, const std::function<void(int32_t, int32_t)>& callback);
 	};
+
+	template <typename TTriangleSource>
+	void Raycast::BuildBVH(const TTriangleSource& source, std::vector<BVHNode>& nodes, std::vector<BVHTriangle>& triangles) {
+		BVHNode rootNode;
+
+		const int32_t triangleCount = source.TriangleCount();
+
+		// NOTE: The root is node 0 and its range starts at triangle 0, a previous tree in the outputs is replaced
+		nodes.clear();
+		triangles.clear();
+		triangles.reserve(triangleCount);
+		for (int32_t i = 0; i < triangleCount; ++i) {
+			vec3 p0, p1, p2;
+			source.GetTriangle(i, p0, p1, p2);
+
+			triangles.emplace_back(p0, p1, p2);
+			rootNode.boundingBox.IncludeTriangle(triangles.back());
+			rootNode.triangleCount++;
+		}
+
+		rootNode.triangleStart = 0;
+
+		nodes.push_back(rootNode);
+
+		Split(nodes, triangles, 0, 0);
+	}
+
+	template <typename TCallback>
+	void Raycast::GetCandidateBVHTriangles(const std::vector<BVHNode>& nodes, const std::vector<BVHTriangle>& triangles, const Ray& ray, TCallback&& callback) {
+		if (nodes.empty()) {
+			return;
+		}
+
+		int32_t stack[MaxBVHDepth * 2 + 2];
+		int32_t stackSize = 0;
+
+		stack[stackSize++] = 0;
+
+		while (stackSize > 0) {
+			const auto& node = nodes[stack[--stackSize]];
+
+			if (!BVHBoundingBoxLineIntersect(node.boundingBox, ray)) {
+				continue;
+			}
+
+			if (node.IsLeaf()) {
+				callback(node.triangleStart, node.triangleCount);
+			}
+			else {
+				if (node.childB != -1) {
+					stack[stackSize++] = node.childB;
+				}
+				if (node.childA != -1) {
+					stack[stackSize++] = node.childA;
+				}
+			}
+		}
+	}
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 #include "ThreadPool.h"
 
 namespace flaw {
+	static thread_local bool t_isWorkerThread = false;
+
 	ThreadPool::ThreadPool(int32_t threadCount) 
 		: _stopSignal(false)
 	{
@@ -32,7 +34,13 @@ namespace flaw {
 		_conditionVariable.notify_one();
 	}
 
+	bool ThreadPool::IsWorkerThread() {
+		return t_isWorkerThread;
+	}
+
 	void ThreadPool::WorkerThread(ThreadPool* pool) {
+		t_isWorkerThread = true;
+
 		while (true) {
 			std::function<void()> task;
 
@@ -8,6 +8,9 @@
 #include <queue>
 #include <vector>
 #include <functional>
+#include <future>
+#include <atomic>
+#include <memory>
 #include <iostream>
 
 namespace flaw {
@@ -17,6 +20,29 @@ namespace flaw {
       ~ThreadPool();
 
       void EnqueueTask(std::function<void()> task);
+
+      template <typename TFunc>
+      auto Submit(TFunc&& func) -> std::future<std::invoke_result_t<TFunc>> {
+        using TResult = std::invoke_result_t<TFunc>;
+
+        // NOTE: packaged_task is move-only, std::function needs a copyable callable
+        auto task = std::make_shared<std::packaged_task<TResult()>>(std::forward<TFunc>(func));
+        std::future<TResult> future = task->get_future();
+
+        EnqueueTask([task]() { (*task)(); });
+
+        return future;
+      }
+
+      // NOTE: Runs func(i) for every i below count on the calling thread, idle workers of pool help when one is given. Runs on the
+      // calling thread alone when it is a worker of any pool, where the other workers are busy with jobs of their own. Only
+      // iterations already started are waited on, a queued helper that starts late finds nothing left and returns.
+      template <typename TFunc>
+      static void ParallelFor(ThreadPool* pool, uint32_t count, TFunc&& func);
+
+      int32_t GetThreadCount() const { return static_cast<int32_t>(_threads.size()); }
+
+      static bool IsWorkerThread();
 		
     private:
 		  static void WorkerThread(ThreadPool* pool);
@@ -30,5 +56,61 @@ namespace flaw {
 
       bool _stopSignal;
     };
+
+    template <typename TFunc>
+    void ThreadPool::ParallelFor(ThreadPool* pool, uint32_t count, TFunc&& func) {
+      const int32_t helperCount = (pool && !IsWorkerThread()) ? std::min(pool->GetThreadCount(), static_cast<int32_t>(count) - 1) : 0;
+      if (helperCount <= 0) {
+        for (uint32_t i = 0; i < count; ++i) {
+          func(i);
+        }
+        return;
+      }
+
+      struct Loop {
+        std::function<void(uint32_t)> func;
+        uint32_t count = 0;
+        std::atomic<uint32_t> next = 0;
+        std::mutex mutex;
+        std::condition_variable condition;
+        int32_t activeHelpers = 0;
+
+        void Run() {
+          uint32_t i;
+          while ((i = next++) < count) {
+            func(i);
+          }
+        }
+      };
+
+      auto loop = std::make_shared<Loop>();
+      loop->func = [&func](uint32_t i) { func(i); };
+      loop->count = count;
+
+      for (int32_t i = 0; i < helperCount; ++i) {
+        pool->EnqueueTask([loop]() {
+          {
+            std::lock_guard<std::mutex> lock(loop->mutex);
+            if (loop->next >= loop->count) {
+              return;
+            }
+            loop->activeHelpers++;
+          }
+
+          loop->Run();
+
+          {
+            std::lock_guard<std::mutex> lock(loop->mutex);
+            loop->activeHelpers--;
+          }
+          loop->condition.notify_all();
+        });
+      }
+
+      loop->Run();
+
+      std::unique_lock<std::mutex> lock(loop->mutex);
+      loop->condition.wait(lock, [&]() { return loop->activeHelpers == 0; });
+    }
 }
 
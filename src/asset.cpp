@@ -1,17 +1,159 @@
 #include "pch.h"
 #include "asset.h"
+#include "assetload.h"
+#include "hotreload.h"
 #include "world.h"
+#include "streaming.h"
+#include "meshpool.h"
+#include "texturecache.h"
+#include "residency.h"
 #include "Image/Image.h"
+#include "Image/ImageCache.h"
+#include "Image/TextureCompressor.h"
+#include "Image/TextureContainer.h"
+#include "Image/MipGenerator.h"
 #include "Model/Model.h"
+#include "Model/CookedMesh.h"
+#include "Model/MeshOptimizer.h"
+#include "Model/Meshlet.h"
+#include "Utils/Hash.h"
+#include "Utils/BVHCache.h"
 #include "Graphics/GraphicsFunc.h"
+#include "Graphics/VertexPacking.h"
 #include "Log/Log.h"
+#include "Utils/ThreadPool.h"
 
-static std::unordered_map<std::string, Ref<Texture2D>> g_textures;
-static std::unordered_map<std::string, Ref<TextureCube>> g_textureCubes;
-static std::unordered_map<std::string, Ref<Mesh>> g_meshes;
-static std::unordered_map<std::string, Ref<Material>> g_materials;
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
+
+// NOTE: Freed slots are reused with their generation bumped, so handles to what was there before stop resolving
+template<typename T>
+struct AssetTable {
+    struct Slot {
+        Ref<T> asset;
+        std::string key;
+        uint32_t generation = 0;
+        uint32_t refCount = 0;
+    };
+
+    const char* typeName;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<std::string, AssetHandle<T>> names;
+};
+
+static AssetTable<Texture2D> g_textures = { "Texture2D" };
+static AssetTable<TextureCube> g_textureCubes = { "TextureCube" };
+static AssetTable<Texture2DArray> g_textureArrays = { "Texture2DArray" };
+static AssetTable<Mesh> g_meshes = { "Mesh" };
+static AssetTable<Material> g_materials = { "Material" };
+
+Texture2DHandle g_dummyTexture;
+MeshHandle g_quadMesh;
+MeshHandle g_cubeMesh;
+MeshHandle g_sphereMesh;
+MaterialHandle g_defaultMaterial;
+
+template<typename T>
+static AssetTable<T>& GetAssetTable();
+
+template<> AssetTable<Texture2D>& GetAssetTable<Texture2D>() { return g_textures; }
+template<> AssetTable<TextureCube>& GetAssetTable<TextureCube>() { return g_textureCubes; }
+template<> AssetTable<Texture2DArray>& GetAssetTable<Texture2DArray>() { return g_textureArrays; }
+template<> AssetTable<Mesh>& GetAssetTable<Mesh>() { return g_meshes; }
+template<> AssetTable<Material>& GetAssetTable<Material>() { return g_materials; }
+
+template<typename T>
+static AssetHandle<T> RegisterAsset(AssetTable<T>& table, const std::string& key, const Ref<T>& asset) {
+    auto it = table.names.find(key);
+    if (it != table.names.end()) {
+        table.slots[it->second.index].asset = asset;
+        return it->second;
+    }
+
+    AssetHandle<T> handle;
+    if (!table.freeSlots.empty()) {
+        handle.index = table.freeSlots.back();
+        table.freeSlots.pop_back();
+    }
+    else {
+        handle.index = static_cast<uint32_t>(table.slots.size());
+        table.slots.emplace_back();
+    }
+
+    auto& slot = table.slots[handle.index];
+    slot.asset = asset;
+    slot.key = key;
+    slot.refCount = 0;
+    handle.generation = slot.generation;
+
+    table.names[key] = handle;
+
+    return handle;
+}
+
+template<typename T>
+static typename AssetTable<T>::Slot* GetAssetSlot(AssetTable<T>& table, AssetHandle<T> handle) {
+    if (handle.index >= table.slots.size() || table.slots[handle.index].generation != handle.generation) {
+        return nullptr;
+    }
+    return &table.slots[handle.index];
+}
+
+template<typename T>
+static const Ref<T>& ResolveAsset(AssetTable<T>& table, AssetHandle<T> handle) {
+    static const Ref<T> null;
+
+    auto slot = GetAssetSlot(table, handle);
+    return slot ? slot->asset : null;
+}
+
+template<typename T>
+static AssetHandle<T> FindAsset(AssetTable<T>& table, const char* key) {
+    auto it = table.names.find(key);
+    if (it != table.names.end()) {
+        return it->second;
+    }
+    Log::Error("%s with key '%s' not found.", table.typeName, key);
+    return AssetHandle<T>();
+}
+
+template<typename T>
+static void UnloadAsset(AssetTable<T>& table, AssetHandle<T> handle) {
+    auto& slot = table.slots[handle.index];
+
+    table.names.erase(slot.key);
+
+    slot.asset.reset();
+    slot.key.clear();
+    slot.generation++;
+
+    table.freeSlots.push_back(handle.index);
+}
+
+template<typename T>
+static void ClearAssetTable(AssetTable<T>& table) {
+    // NOTE: Generations carry over so handles kept past a cleanup still read as stale
+    for (uint32_t i = 0; i < table.slots.size(); ++i) {
+        if (table.slots[i].asset) {
+            UnloadAsset(table, AssetHandle<T>{ i, table.slots[i].generation });
+        }
+    }
+}
+
+// NOTE: Workers decode and parse, GPU resources are created on the main thread by draining g_finalizeTasks
+Scope<ThreadPool> g_assetThreadPool;
+static std::mutex g_finalizeMutex;
+static std::condition_variable g_finalizeCondition;
+static std::queue<std::function<void()>> g_finalizeTasks;
+std::atomic<int32_t> g_pendingLoadCount = 0;
 
 void Asset_Init() {
+    g_assetThreadPool = CreateScope<ThreadPool>(std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()) - 1));
+    ModelParams::ImageDecodePool = g_assetThreadPool.get();
+
     Texture2D::Descriptor textureDesc;
     textureDesc.width = 1;
     textureDesc.height = 1;
@@ -21,14 +163,14 @@ void Asset_Init() {
     textureDesc.mipLevels = 1;
     textureDesc.initialLayout = TextureLayout::ShaderReadOnly;
 
-    g_textures["dummy"] = g_graphicsContext->CreateTexture2D(textureDesc);
+    g_dummyTexture = RegisterAsset(g_textures, "dummy", g_graphicsContext->CreateTexture2D(textureDesc));
 
     Ref<Material> defaultMaterial = CreateRef<Material>();
     defaultMaterial->diffuseColor = glm::vec3(0.5f, 0.5f, 0.5f);
     defaultMaterial->specular = 0.3f;
     defaultMaterial->shininess = 16.0f;
 
-    g_materials["default"] = defaultMaterial;
+    g_defaultMaterial = RegisterAsset(g_materials, "default", defaultMaterial);
 
     std::vector<TexturedVertex> quadVertices;
     std::vector<uint32_t> quadIndices;
@@ -99,23 +241,99 @@ void Asset_Init() {
     LoadPrimitiveModel(quadVertices, quadIndices, "quad");
     LoadPrimitiveModel(cubeVertices, cubeIndices, "cube");
     LoadPrimitiveModel(sphereVertices, sphereIndices, "sphere");
+
+    g_quadMesh = FindMesh("quad");
+    g_cubeMesh = FindMesh("cube");
+    g_sphereMesh = FindMesh("sphere");
 }
 
 void Asset_Cleanup() {
-    g_meshes.clear();
-    g_textureCubes.clear();
-    g_textures.clear();
-    g_materials.clear();
+    // NOTE: Joining the watchers and workers first guarantees nothing is pushed to the queues after they are cleared
+    HotReload_Cleanup();
+    ModelParams::ImageDecodePool = nullptr;
+    g_assetThreadPool.reset();
+
+    {
+        std::lock_guard<std::mutex> lock(g_finalizeMutex);
+        g_finalizeTasks = {};
+    }
+    g_pendingLoadCount = 0;
+
+    ImageCache::Clear();
+    TextureCache_Cleanup();
+
+    ClearAssetTable(g_meshes);
+    ClearAssetTable(g_textureCubes);
+    ClearAssetTable(g_textureArrays);
+    ClearAssetTable(g_textures);
+    ClearAssetTable(g_materials);
 }
 
-void LoadTexture(const char* filePath, PixelFormat pixelFormat, const char* key) {
-    Image image(filePath, 4);
+// NOTE: Mips are filtered on the CPU for 8 bit RGBA textures, gamma correct for sRGB formats and keeping the alpha test
+// coverage of cutouts. Other formats fall back to GPU blits.
+bool GenerateTextureMips(const Image& image, PixelFormat pixelFormat, MipChain& outChain) {
+    if (!image.IsValid() || image.Channels() != 4 || (pixelFormat != PixelFormat::RGBA8Unorm && pixelFormat != PixelFormat::RGBA8Srgb)) {
+        return false;
+    }
 
-    if (!image.IsValid()) {
-        Log::Error("Failed to load texture: %s", filePath);
-        return;
+    MipGenerationDesc mipDesc;
+    mipDesc.srgb = IsSrgbFormat(pixelFormat);
+    mipDesc.preserveAlphaCoverage = TextureCompressor::HasAlpha(image);
+    mipDesc.pool = g_assetThreadPool.get();
+
+    return MipGenerator::Generate(image.Data().data(), image.Width(), image.Height(), mipDesc, outChain);
+}
+
+// NOTE: The last level of a generated chain is the average of the image. Without one sRGB textures are evicted to grey and
+// linear ones to a flat normal, most of them being normal maps.
+uint32_t GetPlaceholderColor(PixelFormat pixelFormat, const MipChain* mipChain) {
+    if (mipChain && mipChain->mipLevels > 0 && mipChain->data.size() >= sizeof(uint32_t)
+        && (mipChain->width >> (mipChain->mipLevels - 1)) <= 1 && (mipChain->height >> (mipChain->mipLevels - 1)) <= 1) {
+        uint32_t color;
+        memcpy(&color, mipChain->data.data() + mipChain->data.size() - sizeof(uint32_t), sizeof(uint32_t));
+        return color;
+    }
+
+    return IsSrgbFormat(pixelFormat) ? 0xFF808080 : 0xFFFF8080;
+}
+
+static Ref<Texture2D> CreatePlaceholderTexture(PixelFormat pixelFormat, uint32_t color) {
+    Texture2D::Descriptor textureDesc;
+    textureDesc.width = 1;
+    textureDesc.height = 1;
+    textureDesc.data = reinterpret_cast<const uint8_t*>(&color);
+    textureDesc.memProperty = MemoryProperty::Static;
+    textureDesc.texUsages = TextureUsage::ShaderResource;
+    textureDesc.format = IsSrgbFormat(pixelFormat) ? PixelFormat::RGBA8Srgb : PixelFormat::RGBA8Unorm;
+    textureDesc.mipLevels = 1;
+    textureDesc.initialLayout = TextureLayout::ShaderReadOnly;
+
+    return g_graphicsContext->CreateTexture2D(textureDesc);
+}
+
+// NOTE: Textures loaded from files carry a full chain, containers storing fewer levels are counted a little high
+uint64_t GetResidentTextureSize(const Texture2D& texture) {
+    return GetMipChainSize(texture.GetPixelFormat(), texture.GetWidth(), texture.GetHeight(), GetMaxMipLevels(texture.GetWidth(), texture.GetHeight()));
+}
+
+uint64_t GetResidentMeshSize(const Mesh& mesh) {
+    uint64_t size = 0;
+
+    if (mesh.poolAllocation) {
+        size += MeshPool_GetAllocationSize(*mesh.poolAllocation);
+    }
+    else if (mesh.vertexBuffer && mesh.indexBuffer) {
+        size += mesh.vertexBuffer->Size() + static_cast<uint64_t>(mesh.indexBuffer->IndexCount()) * sizeof(uint32_t);
+
+        if (mesh.colorBuffer) {
+            size += mesh.colorBuffer->Size();
+        }
     }
 
+    return size;
+}
+
+Ref<Texture2D> CreateTexture(const Image& image, PixelFormat pixelFormat, const MipChain* mipChain) {
     Texture2D::Descriptor textureDesc;
     textureDesc.width = image.Width();
     textureDesc.height = image.Height();
@@ -126,7 +344,73 @@ void LoadTexture(const char* filePath, PixelFormat pixelFormat, const char* key)
     textureDesc.mipLevels = GetMaxMipLevels(textureDesc.width, textureDesc.height);
 	textureDesc.initialLayout = TextureLayout::ShaderReadOnly;
 
-    g_textures[key] = g_graphicsContext->CreateTexture2D(textureDesc);
+    if (mipChain) {
+        textureDesc.data = mipChain->data.data();
+        textureDesc.mipLevels = mipChain->mipLevels;
+        textureDesc.dataMipLevels = mipChain->mipLevels;
+    }
+
+    return g_graphicsContext->CreateTexture2D(textureDesc);
+}
+
+// NOTE: Container formats keep their own format, pixelFormat only decides whether it is sampled as sRGB
+static PixelFormat GetContainerTextureFormat(const TextureContainer& container, PixelFormat pixelFormat) {
+    return IsSrgbFormat(pixelFormat) ? GetSrgbFormat(container.GetFormat()) : container.GetFormat();
+}
+
+// NOTE: Mips stored in the file are uploaded as they are, a single level uncompressed image gets its chain generated
+static uint32_t GetContainerMipLevels(const TextureContainer& container) {
+    if (container.GetMipLevels() == 1 && !IsBlockCompressedFormat(container.GetFormat())) {
+        return GetMaxMipLevels(container.GetWidth(), container.GetHeight());
+    }
+
+    return container.GetMipLevels();
+}
+
+Ref<Texture2D> CreateContainerTexture(const TextureContainer& container, PixelFormat pixelFormat) {
+    if (container.IsCube() || container.IsArray()) {
+        Log::Warn("Texture container holds %u layers and %u faces, only the first image is used as a 2D texture", container.GetLayers(), container.GetFaces());
+    }
+
+    Texture2D::Descriptor textureDesc;
+    textureDesc.width = container.GetWidth();
+    textureDesc.height = container.GetHeight();
+    textureDesc.data = container.GetData();
+    textureDesc.memProperty = MemoryProperty::Static;
+    textureDesc.texUsages = TextureUsage::ShaderResource;
+    textureDesc.format = GetContainerTextureFormat(container, pixelFormat);
+    textureDesc.mipLevels = GetContainerMipLevels(container);
+    textureDesc.dataMipLevels = container.GetMipLevels();
+	textureDesc.initialLayout = TextureLayout::ShaderReadOnly;
+
+    return g_graphicsContext->CreateTexture2D(textureDesc);
+}
+
+void LoadTexture(const char* filePath, PixelFormat pixelFormat, const char* key) {
+    if (TextureContainer::IsContainerFile(filePath)) {
+        TextureContainer container;
+        if (!container.Load(filePath)) {
+            Log::Error("Failed to load texture: %s", filePath);
+            return;
+        }
+
+        RegisterAsset(g_textures, key, CreateContainerTexture(container, pixelFormat));
+        HotReload_WatchTexture(filePath, pixelFormat, key, GetPlaceholderColor(pixelFormat, nullptr));
+        return;
+    }
+
+    Image image(filePath, 4);
+
+    if (!image.IsValid()) {
+        Log::Error("Failed to load texture: %s", filePath);
+        return;
+    }
+
+    MipChain mipChain;
+    const bool hasMips = GenerateTextureMips(image, pixelFormat, mipChain);
+
+    RegisterAsset(g_textures, key, CreateTexture(image, pixelFormat, hasMips ? &mipChain : nullptr));
+    HotReload_WatchTexture(filePath, pixelFormat, key, GetPlaceholderColor(pixelFormat, hasMips ? &mipChain : nullptr));
 }
 
 void LoadTextureCube(const std::array<const char*, 6>& faceFilePaths, const char* key) {
@@ -150,44 +434,305 @@ void LoadTextureCube(const std::array<const char*, 6>& faceFilePaths, const char
 	textureDesc.texUsages = TextureUsage::ShaderResource;
 	textureDesc.initialLayout = TextureLayout::ShaderReadOnly;
 
-	g_textureCubes[key] = g_graphicsContext->CreateTextureCube(textureDesc);
+	Ref<TextureCube> texture = g_graphicsContext->CreateTextureCube(textureDesc);
+	RegisterAsset(g_textureCubes, key, texture);
+	Residency_Track(ResidencyCategory::Textures, key, texture, 6 * GetMipChainSize(textureDesc.format, textureDesc.width, textureDesc.height, textureDesc.mipLevels));
 }
 
-void LoadPrimitiveModel(const std::vector<TexturedVertex>& vertices, const std::vector<uint32_t>& indices, const char* key) {
-    Ref<Mesh> mesh = CreateRef<Mesh>();
+void LoadTextureCube(const char* filePath, const char* key) {
+    TextureContainer container;
+    if (!container.Load(filePath)) {
+        Log::Error("Failed to load texture cube: %s", filePath);
+        return;
+    }
+
+    if (!container.IsCube() || container.IsArray()) {
+        Log::Error("Texture container is not a single cube map: %s", filePath);
+        return;
+    }
+
+    TextureCube::Descriptor textureDesc = {};
+    textureDesc.width = container.GetWidth();
+    textureDesc.height = container.GetHeight();
+    textureDesc.data = container.GetData();
+    textureDesc.format = GetContainerTextureFormat(container, PixelFormat::RGBA8Srgb);
+    textureDesc.mipLevels = container.GetMipLevels();
+    textureDesc.dataMipLevels = container.GetMipLevels();
+    textureDesc.memProperty = MemoryProperty::Static;
+    textureDesc.texUsages = TextureUsage::ShaderResource;
+    textureDesc.initialLayout = TextureLayout::ShaderReadOnly;
+
+    Ref<TextureCube> texture = g_graphicsContext->CreateTextureCube(textureDesc);
+    RegisterAsset(g_textureCubes, key, texture);
+    Residency_Track(ResidencyCategory::Textures, filePath, texture, 6 * GetMipChainSize(textureDesc.format, textureDesc.width, textureDesc.height, textureDesc.mipLevels));
+}
+
+void LoadTextureArray(const char* filePath, PixelFormat pixelFormat, const char* key) {
+    TextureContainer container;
+    if (!container.Load(filePath)) {
+        Log::Error("Failed to load texture array: %s", filePath);
+        return;
+    }
+
+    if (container.IsCube()) {
+        Log::Error("Cube map containers are loaded with LoadTextureCube: %s", filePath);
+        return;
+    }
+
+    Texture2DArray::Descriptor textureDesc = {};
+    textureDesc.width = container.GetWidth();
+    textureDesc.height = container.GetHeight();
+    textureDesc.layers = container.GetLayers();
+    textureDesc.data = container.GetData();
+    textureDesc.format = GetContainerTextureFormat(container, pixelFormat);
+    textureDesc.mipLevels = container.GetMipLevels();
+    textureDesc.dataMipLevels = container.GetMipLevels();
+    textureDesc.memProperty = MemoryProperty::Static;
+    textureDesc.texUsages = TextureUsage::ShaderResource;
+    textureDesc.initialLayout = TextureLayout::ShaderReadOnly;
+
+    Ref<Texture2DArray> texture = g_graphicsContext->CreateTexture2DArray(textureDesc);
+    RegisterAsset(g_textureArrays, key, texture);
+    Residency_Track(ResidencyCategory::Textures, filePath, texture, textureDesc.layers * GetMipChainSize(textureDesc.format, textureDesc.width, textureDesc.height, textureDesc.mipLevels));
+}
+
+// NOTE: Bounding sphere around the box of the vertices the segment draws, and the square root of its UV area over its surface area
+static void ComputeSegmentBounds(const TexturedVertex* vertices, const uint32_t* indices, MeshSegment& segment) {
+    if (segment.indexCount == 0) {
+        return;
+    }
+
+    const TexturedVertex* base = vertices + segment.vertexOffset;
+    const uint32_t* segmentIndices = indices + segment.indexOffset;
+
+    vec3 minPos = base[segmentIndices[0]].position;
+    vec3 maxPos = minPos;
+    for (uint32_t i = 1; i < segment.indexCount; ++i) {
+        const vec3& position = base[segmentIndices[i]].position;
+        minPos = glm::min(minPos, position);
+        maxPos = glm::max(maxPos, position);
+    }
+
+    segment.boundsCenter = (minPos + maxPos) * 0.5f;
+    segment.boundsRadius = 0.0f;
+
+    float worldArea = 0.0f;
+    float uvArea = 0.0f;
+    for (uint32_t i = 0; i + 2 < segment.indexCount; i += 3) {
+        const TexturedVertex& v0 = base[segmentIndices[i]];
+        const TexturedVertex& v1 = base[segmentIndices[i + 1]];
+        const TexturedVertex& v2 = base[segmentIndices[i + 2]];
+
+        worldArea += glm::length(glm::cross(v1.position - v0.position, v2.position - v0.position));
+
+        const vec2 uv0 = v1.texCoord - v0.texCoord;
+        const vec2 uv1 = v2.texCoord - v0.texCoord;
+        uvArea += std::abs(uv0.x * uv1.y - uv0.y * uv1.x);
+    }
+
+    for (uint32_t i = 0; i < segment.indexCount; ++i) {
+        segment.boundsRadius = std::max(segment.boundsRadius, glm::length(base[segmentIndices[i]].position - segment.boundsCenter));
+    }
+
+    segment.uvDensity = worldArea > 0.0f ? std::sqrt(uvArea / worldArea) : 0.0f;
+}
+
+// NOTE: Static geometry goes to the shared mesh pool, a mesh only gets buffers of its own if the pool cannot take it.
+// Segments must be filled in first, pooling moves their offsets.
+static void UploadMeshGeometry(Mesh& mesh, uint32_t vertexStride, const void* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount) {
+    if (MeshPool_Upload(mesh, vertexStride, vertices, vertexCount, indices, indexCount)) {
+        return;
+    }
+
+    VertexBuffer::Descriptor vertexBufferDesc;
+    vertexBufferDesc.memProperty = MemoryProperty::Static;
+    vertexBufferDesc.elmSize = vertexStride;
+    vertexBufferDesc.bufferSize = vertexStride * vertexCount;
+    vertexBufferDesc.initialData = vertices;
+
+    mesh.vertexBuffer = g_graphicsContext->CreateVertexBuffer(vertexBufferDesc);
+
+    IndexBuffer::Descriptor indexBufferDesc;
+    indexBufferDesc.memProperty = MemoryProperty::Static;
+    indexBufferDesc.bufferSize = sizeof(uint32_t) * indexCount;
+    indexBufferDesc.initialData = indices;
+
+    mesh.indexBuffer = g_graphicsContext->CreateIndexBuffer(indexBufferDesc);
+}
+
+// NOTE: Geometry the loader already wrote to staging memory, copied to buffers of the mesh's own if the pool cannot take it
+static void UploadStagedMeshGeometry(Mesh& mesh, MeshPoolStaging& staging) {
+    if (MeshPool_UploadStaging(mesh, staging)) {
+        return;
+    }
 
     VertexBuffer::Descriptor vertexBufferDesc;
     vertexBufferDesc.memProperty = MemoryProperty::Static;
-    vertexBufferDesc.elmSize = sizeof(TexturedVertex);
-    vertexBufferDesc.bufferSize = sizeof(TexturedVertex) * vertices.size();
-    vertexBufferDesc.initialData = vertices.data();
+    vertexBufferDesc.elmSize = staging.vertexStride;
+    vertexBufferDesc.bufferSize = staging.vertexStride * staging.vertexCount;
 
-    mesh->vertexBuffer = g_graphicsContext->CreateVertexBuffer(vertexBufferDesc);
+    mesh.vertexBuffer = g_graphicsContext->CreateVertexBuffer(vertexBufferDesc);
+    staging.vertexBuffer->CopyTo(mesh.vertexBuffer);
 
     IndexBuffer::Descriptor indexBufferDesc;
     indexBufferDesc.memProperty = MemoryProperty::Static;
-    indexBufferDesc.bufferSize = sizeof(uint32_t) * indices.size();
-    indexBufferDesc.initialData = indices.data();
+    indexBufferDesc.bufferSize = sizeof(uint32_t) * staging.indexCount;
+
+    mesh.indexBuffer = g_graphicsContext->CreateIndexBuffer(indexBufferDesc);
+    staging.indexBuffer->CopyTo(mesh.indexBuffer);
+
+    staging = MeshPoolStaging();
+}
+
+// NOTE: Colors follow the geometry, into the color stream of its pool page or a buffer of the mesh's own
+static void UploadMeshColors(Mesh& mesh, const std::vector<uint32_t>& colors) {
+    if (colors.empty() || MeshPool_UploadColors(mesh, colors.data())) {
+        return;
+    }
+
+    VertexBuffer::Descriptor colorBufferDesc;
+    colorBufferDesc.memProperty = MemoryProperty::Static;
+    colorBufferDesc.elmSize = sizeof(uint32_t);
+    colorBufferDesc.bufferSize = sizeof(uint32_t) * colors.size();
+    colorBufferDesc.initialData = colors.data();
 
-    mesh->indexBuffer = g_graphicsContext->CreateIndexBuffer(indexBufferDesc);
+    mesh.colorBuffer = g_graphicsContext->CreateVertexBuffer(colorBufferDesc);
+}
+
+void LoadPrimitiveModel(const std::vector<TexturedVertex>& vertices, const std::vector<uint32_t>& indices, const char* key) {
+    Ref<Mesh> mesh = CreateRef<Mesh>();
 
     MeshSegment subMesh;
     subMesh.vertexOffset = 0;
     subMesh.indexOffset = 0;
     subMesh.indexCount = indices.size();
+    ComputeSegmentBounds(vertices.data(), indices.data(), subMesh);
 
     mesh->segments.push_back(subMesh);
-    mesh->materials.push_back(g_materials["default"]);
+    mesh->materials.push_back(ResolveAsset(g_materials, g_defaultMaterial));
 
-    g_meshes[key] = mesh;
+    UploadMeshGeometry(*mesh, sizeof(TexturedVertex), vertices.data(), vertices.size(), indices.data(), indices.size());
+
+    RegisterAsset(g_meshes, key, mesh);
+    Residency_Track(ResidencyCategory::Meshes, key, mesh, GetResidentMeshSize(*mesh));
 }
 
-void LoadModel(const char* filePath, float scale, const char* key) {
-    Ref<Mesh> mesh = CreateRef<Mesh>();
-    Model model(filePath, scale);
+// NOTE: Cooked import results are written here and mapped on later runs instead of running the importer again
+constexpr const char* AssetCacheDirectory = "assets/cache";
+
+// NOTE: See Asset_SetCookedGeometryCompression
+static bool g_compressCookedGeometry = false;
+
+constexpr CookedTextureSlot CookedTextureSlots[] = {
+    CookedTextureSlot::Diffuse,
+    CookedTextureSlot::Specular,
+    CookedTextureSlot::Normal,
+    CookedTextureSlot::Displacement,
+    CookedTextureSlot::AmbientOcclusion,
+};
+
+// NOTE: Model textures are block compressed on the loading thread, BC1/BC3 for color, BC5 for normals and BC4 for masks.
+// On the Sponza textures with Fast quality, per core: BC1 35.3 dB at 15 MP/s, BC3 40.9 dB at 15 MP/s, BC5 44.3 dB at 39 MP/s
+// and BC4 at 78 MP/s. High quality BC7 reaches 42.0 dB on color at 2.4 MP/s. Results are cached in AssetCacheDirectory.
+constexpr bool CompressModelTextures = true;
+constexpr TextureCompressionQuality ModelTextureQuality = TextureCompressionQuality::Fast;
+
+// NOTE: Model vertices are packed on the loading thread, meshes whose UVs go past the limit keep the textured format since half UVs lose about a texel of a 1024 texture there.
+// Everything stays textured where IsVertexFormatSupported finds no packed shaders.
+constexpr VertexFormat ModelVertexFormat = VertexFormat::PackedQuantized;
+constexpr float PackedTexCoordLimit = 4.0f;
+
+static PixelFormat GetCookedTextureFormat(CookedTextureSlot slot) {
+    switch (slot) {
+    case CookedTextureSlot::Diffuse:
+        return PixelFormat::RGBA8Srgb;
+    case CookedTextureSlot::AmbientOcclusion:
+        return PixelFormat::R8Unorm;
+    default:
+        return PixelFormat::RGBA8Unorm;
+    }
+}
+
+static TextureRole GetCookedTextureRole(CookedTextureSlot slot) {
+    switch (slot) {
+    case CookedTextureSlot::Diffuse:
+        return TextureRole::Color;
+    case CookedTextureSlot::Normal:
+        return TextureRole::Normal;
+    default:
+        return TextureRole::Mask;
+    }
+}
+
+static uint64_t GetModelImportKey(float scale) {
+    Hasher64 hasher;
+    hasher.Update(CookedMesh::Version);
+    hasher.Update(MeshOptimizer::Version);
+    hasher.Update(MeshletBuilder::Version);
+    hasher.Update(Model::GetImportFlags());
+    hasher.Update(scale);
+    hasher.Update(static_cast<uint32_t>(sizeof(TexturedVertex)));
+    hasher.Update(g_compressCookedGeometry);
+
+    return hasher.Digest();
+}
+
+// NOTE: Triangles of every segment of a cooked mesh, segment indices are relative to the segment's first vertex
+struct CookedMeshTriangleSource {
+    const CookedMesh& cooked;
+    std::vector<int32_t> firstTriangles; // per segment, plus the total at the end
+
+    CookedMeshTriangleSource(const CookedMesh& cooked) : cooked(cooked) {
+        firstTriangles.push_back(0);
+        for (uint32_t i = 0; i < cooked.GetSegmentCount(); ++i) {
+            firstTriangles.push_back(firstTriangles.back() + static_cast<int32_t>(cooked.GetSegments()[i].indexCount / 3));
+        }
+    }
+
+    int32_t TriangleCount() const { return firstTriangles.back(); }
+
+    void GetTriangle(int32_t index, vec3& p0, vec3& p1, vec3& p2) const {
+        const size_t segmentIndex = std::upper_bound(firstTriangles.begin(), firstTriangles.end(), index) - firstTriangles.begin() - 1;
+        const CookedMeshSegment& segment = cooked.GetSegments()[segmentIndex];
+
+        const uint32_t* indices = cooked.GetIndexData() + segment.indexOffset + (index - firstTriangles[segmentIndex]) * 3;
+        const uint8_t* vertices = static_cast<const uint8_t*>(cooked.GetVertexData()) + static_cast<size_t>(segment.vertexOffset) * cooked.GetVertexStride();
+
+        // NOTE: Positions lead every cooked vertex
+        memcpy(&p0, vertices + static_cast<size_t>(indices[0]) * cooked.GetVertexStride(), sizeof(vec3));
+        memcpy(&p1, vertices + static_cast<size_t>(indices[1]) * cooked.GetVertexStride(), sizeof(vec3));
+        memcpy(&p2, vertices + static_cast<size_t>(indices[2]) * cooked.GetVertexStride(), sizeof(vec3));
+    }
+};
+
+static std::string GetCookedModelPath(const char* filePath, float scale) {
+    std::filesystem::path path(filePath);
+
+    Hasher64 hasher;
+    hasher.Update(filePath, std::strlen(filePath));
+    hasher.Update(scale);
+
+    char hash[17];
+    snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(hasher.Digest()));
+
+    return (std::filesystem::path(AssetCacheDirectory) / (path.stem().generic_string() + "_" + hash + ".mesh")).generic_string();
+}
+
+static bool CookModel(const char* filePath, float scale, uint64_t sourceKey, uint64_t importKey, const std::string& cookedPath, ModelLoadData& data) {
+    // NOTE: Released once the cooked layout has everything it needs, before the blob is serialized next to the converted vertices
+    Scope<Model> model = CreateScope<Model>(filePath, scale);
+    if (!model->IsValid()) {
+        Log::Error("Failed to load model: %s", filePath);
+        return false;
+    }
 
     std::vector<TexturedVertex> vertices;
-    for (const auto& vertex : model.GetVertices()) {
+    vertices.reserve(model->GetVertices().size());
+
+    vec3 boundsMin(std::numeric_limits<float>::max());
+    vec3 boundsMax(std::numeric_limits<float>::lowest());
+
+    for (const auto& vertex : model->GetVertices()) {
         TexturedVertex texturedVertex;
         texturedVertex.position = vertex.position;
         texturedVertex.color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
@@ -195,141 +740,1014 @@ void LoadModel(const char* filePath, float scale, const char* key) {
         texturedVertex.normal = vertex.normal;
 		texturedVertex.tangent = vertex.tangent;
         vertices.push_back(texturedVertex);
+
+        boundsMin = glm::min(boundsMin, vertex.position);
+        boundsMax = glm::max(boundsMax, vertex.position);
     }
 
-    VertexBuffer::Descriptor vertexBufferDesc;
-    vertexBufferDesc.memProperty = MemoryProperty::Static;
-    vertexBufferDesc.elmSize = sizeof(TexturedVertex);
-    vertexBufferDesc.bufferSize = sizeof(TexturedVertex) * vertices.size();
-    vertexBufferDesc.initialData = vertices.data();
+    // NOTE: Segments index their own vertex range, each is reordered for the vertex cache, overdraw and vertex fetch in turn.
+    // Meshlets are cut from the overdraw order, vertex fetch only renames vertices so their triangles stay where they are.
+    std::vector<uint32_t> indices(model->GetIndices().begin(), model->GetIndices().end());
+    std::vector<Meshlet> meshlets;
+    std::vector<std::pair<uint32_t, uint32_t>> segmentMeshlets;
 
-    mesh->vertexBuffer = g_graphicsContext->CreateVertexBuffer(vertexBufferDesc);
+    MeshOptimizer::VertexCacheStats statsBefore;
+    MeshOptimizer::VertexCacheStats statsAfter;
 
-    const std::vector<uint32_t>& indices = model.GetIndices();
+    for (const auto& modelSubMesh : model->GetMeshs()) {
+        uint32_t* segmentIndices = indices.data() + modelSubMesh.indexStart;
+        TexturedVertex* segmentVertices = vertices.data() + modelSubMesh.vertexStart;
 
-    IndexBuffer::Descriptor indexBufferDesc;
-    indexBufferDesc.memProperty = MemoryProperty::Static;
-    indexBufferDesc.bufferSize = sizeof(uint32_t) * indices.size();
-    indexBufferDesc.initialData = indices.data();
+        statsBefore.Add(MeshOptimizer::AnalyzeVertexCache(segmentIndices, modelSubMesh.indexCount, modelSubMesh.vertexCount));
 
-    mesh->indexBuffer = g_graphicsContext->CreateIndexBuffer(indexBufferDesc);
+        MeshOptimizer::OptimizeVertexCache(segmentIndices, modelSubMesh.indexCount, modelSubMesh.vertexCount);
+        MeshOptimizer::OptimizeOverdraw(segmentIndices, modelSubMesh.indexCount, segmentVertices, modelSubMesh.vertexCount, sizeof(TexturedVertex));
 
-    std::unordered_map<Ref<Image>, Ref<Texture2D>> textureCache;
-    std::function<Ref<Texture2D>(const Ref<Image>&, PixelFormat)> createTexture = [&](const Ref<Image>& image, PixelFormat pixelFormat) {
-        auto it = textureCache.find(image);
-        if (it != textureCache.end()) {
-            return it->second;
-        }
+        const uint32_t meshletOffset = static_cast<uint32_t>(meshlets.size());
+        MeshletBuilder::Build(segmentIndices, modelSubMesh.indexCount, segmentVertices, modelSubMesh.vertexCount, sizeof(TexturedVertex), offsetof(TexturedVertex, normal), meshlets);
+        segmentMeshlets.emplace_back(meshletOffset, static_cast<uint32_t>(meshlets.size()) - meshletOffset);
 
-        Texture2D::Descriptor textureDesc;
-        textureDesc.width = image->Width();
-        textureDesc.height = image->Height();
-        textureDesc.data = image->Data().data();
-        textureDesc.memProperty = MemoryProperty::Static;
-        textureDesc.texUsages = TextureUsage::ShaderResource;
-        textureDesc.format = pixelFormat;
-        textureDesc.mipLevels = 1;
-		textureDesc.initialLayout = TextureLayout::ShaderReadOnly;
+        MeshOptimizer::OptimizeVertexFetch(segmentVertices, modelSubMesh.vertexCount, sizeof(TexturedVertex), segmentIndices, modelSubMesh.indexCount);
 
-        Ref<Texture2D> texture = g_graphicsContext->CreateTexture2D(textureDesc);
-        textureCache[image] = texture;
+        statsAfter.Add(MeshOptimizer::AnalyzeVertexCache(segmentIndices, modelSubMesh.indexCount, modelSubMesh.vertexCount));
+    }
 
-        return texture;
-    };
+    Log::Info("%s vertex cache: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f", filePath, statsBefore.GetACMR(), statsAfter.GetACMR(), statsBefore.GetATVR(), statsAfter.GetATVR());
+    Log::Info("%s meshlets: %u for %u triangles", filePath, static_cast<uint32_t>(meshlets.size()), static_cast<uint32_t>(indices.size() / 3));
 
-    std::unordered_map<uint32_t, Ref<Material>> materialCache;
-    std::function<Ref<Material>(uint32_t, const ModelMaterial&)> createMaterial = [&](uint32_t index, const ModelMaterial& modelMaterial) {
-        auto it = materialCache.find(index);
-        if (it != materialCache.end()) {
-            return it->second;
-        }
+    // NOTE: Materials only reference images by path, an embedded image has no file to reload it from
+    bool hasEmbeddedImages = false;
 
-        Ref<Material> material = CreateRef<Material>();
-        material->diffuseColor = modelMaterial.baseColor;
-        if (modelMaterial.diffuse) {
-            material->diffuseTexture = createTexture(modelMaterial.diffuse, PixelFormat::RGBA8Srgb);
-        }
-        material->specular = 0.3f;
-        if (modelMaterial.specular) {
-            material->specularTexture = createTexture(modelMaterial.specular, PixelFormat::RGBA8Unorm);
+    std::unordered_map<Ref<Image>, std::string> imagePaths;
+    for (const auto& [path, image] : model->GetImages()) {
+        const std::string imagePath = path.generic_string();
+        imagePaths[image] = imagePath;
+        data.images[imagePath] = image;
+
+        if (!std::filesystem::exists(path)) {
+            hasEmbeddedImages = true;
         }
-		if (modelMaterial.normal) {
-			material->normalTexture = createTexture(modelMaterial.normal, PixelFormat::RGBA8Unorm);
-		}
-		if (modelMaterial.displacement) {
-			material->displacementTexture = createTexture(modelMaterial.displacement, PixelFormat::RGBA8Unorm);
-		}
-		if (modelMaterial.ambientOcclusion) {
-			material->ambientOcclusionTexture = createTexture(modelMaterial.ambientOcclusion, PixelFormat::R8Unorm);
-		}
-        material->shininess = 32.0f;
-        materialCache[index] = material;
+    }
 
-        return material;
-        };
+    auto getImagePath = [&](const Ref<Image>& image) {
+        auto it = imagePaths.find(image);
+        return it != imagePaths.end() ? it->second : std::string();
+    };
 
-    for (const auto& modelSubMesh : model.GetMeshs()) {
-        MeshSegment subMesh;
-        subMesh.vertexOffset = modelSubMesh.vertexStart;
-        subMesh.indexOffset = modelSubMesh.indexStart;
-        subMesh.indexCount = modelSubMesh.indexCount;
-        mesh->segments.push_back(subMesh);
+    CookedMeshDesc desc;
+    desc.sourceKey = sourceKey;
+    desc.importKey = importKey;
+    desc.vertices = vertices.data();
+    desc.vertexStride = sizeof(TexturedVertex);
+    desc.vertexCount = static_cast<uint32_t>(vertices.size());
+    desc.indices = indices.data();
+    desc.indexCount = static_cast<uint32_t>(indices.size());
+    desc.boundsMin = vertices.empty() ? vec3(0.0f) : boundsMin;
+    desc.boundsMax = vertices.empty() ? vec3(0.0f) : boundsMax;
+    desc.meshlets = std::move(meshlets);
 
-        Ref<Material> material;
-        if (modelSubMesh.materialIndex == -1) {
-            material = g_materials["default"];
-        }
-        else {
-            material = createMaterial(modelSubMesh.materialIndex, model.GetMaterialAt(modelSubMesh.materialIndex));
+    std::unordered_map<uint32_t, int32_t> materialRemap;
+    for (uint32_t i = 0; i < model->GetMeshs().size(); ++i) {
+        const auto& modelSubMesh = model->GetMeshs()[i];
+
+        CookedMeshSegment segment;
+        segment.vertexOffset = modelSubMesh.vertexStart;
+        segment.indexOffset = modelSubMesh.indexStart;
+        segment.indexCount = modelSubMesh.indexCount;
+        segment.meshletOffset = segmentMeshlets[i].first;
+        segment.meshletCount = segmentMeshlets[i].second;
+
+        if (modelSubMesh.materialIndex != -1) {
+            auto it = materialRemap.find(modelSubMesh.materialIndex);
+            if (it == materialRemap.end()) {
+                const ModelMaterial& modelMaterial = model->GetMaterialAt(modelSubMesh.materialIndex);
+
+                CookedMaterialDesc material;
+                material.baseColor = modelMaterial.baseColor;
+                material.texturePaths[static_cast<uint32_t>(CookedTextureSlot::Diffuse)] = getImagePath(modelMaterial.diffuse);
+                material.texturePaths[static_cast<uint32_t>(CookedTextureSlot::Specular)] = getImagePath(modelMaterial.specular);
+                material.texturePaths[static_cast<uint32_t>(CookedTextureSlot::Normal)] = getImagePath(modelMaterial.normal);
+                material.texturePaths[static_cast<uint32_t>(CookedTextureSlot::Displacement)] = getImagePath(modelMaterial.displacement);
+                material.texturePaths[static_cast<uint32_t>(CookedTextureSlot::AmbientOcclusion)] = getImagePath(modelMaterial.ambientOcclusion);
+
+                it = materialRemap.emplace(modelSubMesh.materialIndex, static_cast<int32_t>(desc.materials.size())).first;
+                desc.materials.push_back(std::move(material));
+            }
+
+            segment.materialIndex = it->second;
         }
 
-        mesh->materials.push_back(material);
+        desc.segments.push_back(segment);
     }
 
-    g_meshes[key] = mesh;
-}
+    model.reset();
 
-void LoadMaterial(const char* key) {
-	Ref<Material> material = CreateRef<Material>();
-	material->diffuseColor = glm::vec3(0.5f, 0.5f, 0.5f);
-    material->specular = 0.3f;
-	material->shininess = 16.0f;
+    // NOTE: Without compression the written file is the layout the model is read through
+    std::vector<uint8_t> buffer;
+    CookedMesh::Serialize(desc, buffer);
 
-	g_materials[key] = material;
-}
+    if (hasEmbeddedImages) {
+        Log::Info("%s has embedded textures, skipping the cooked cache", filePath);
+    }
+    else if (g_compressCookedGeometry) {
+        std::vector<uint8_t> fileBuffer;
+        desc.compressGeometry = true;
+        CookedMesh::Serialize(desc, fileBuffer);
+
+        if (!CookedMesh::Write(cookedPath.c_str(), fileBuffer)) {
+            Log::Warn("Failed to write cooked model: %s", cookedPath.c_str());
+        }
+    }
+    else if (!CookedMesh::Write(cookedPath.c_str(), buffer)) {
+        Log::Warn("Failed to write cooked model: %s", cookedPath.c_str());
+    }
+
+    // NOTE: A freshly imported model is read through the same cooked layout as a mapped one
+    return data.cooked.Open(std::move(buffer));
+}
+
+static Ref<Image> GetModelImage(const ModelLoadData& data, uint32_t materialIndex, CookedTextureSlot slot) {
+    const char* texturePath = data.cooked.GetTexturePath(materialIndex, slot);
+    if (!texturePath) {
+        return nullptr;
+    }
+
+    auto it = data.images.find(texturePath);
+    return it != data.images.end() ? it->second : nullptr;
+}
+
+// NOTE: Images in the order the materials will request them, each with the slot of its first use
+void CollectModelImages(const ModelLoadData& data, std::vector<std::pair<Ref<Image>, CookedTextureSlot>>& outImages) {
+    std::unordered_set<Ref<Image>> visited;
+
+    const CookedMeshSegment* segments = data.cooked.GetSegments();
+    for (uint32_t i = 0; i < data.cooked.GetSegmentCount(); ++i) {
+        if (segments[i].materialIndex == -1) {
+            continue;
+        }
+
+        for (CookedTextureSlot slot : CookedTextureSlots) {
+            Ref<Image> image = GetModelImage(data, segments[i].materialIndex, slot);
+            if (image && visited.insert(image).second) {
+                outImages.emplace_back(image, slot);
+            }
+        }
+    }
+}
+
+// NOTE: Textures with the same pixels are shared between models whatever their paths, the ones found are put in data.textureCache
+// so they are neither compressed nor created again. The key covers everything that changes what CreateModelTexture builds.
+static void ShareModelTextures(ModelLoadData& data) {
+    std::vector<std::pair<Ref<Image>, CookedTextureSlot>> images;
+    CollectModelImages(data, images);
+
+    for (const auto& [image, slot] : images) {
+        if (!image->IsValid()) {
+            continue;
+        }
+
+        Hasher64 hasher;
+        hasher.Update(slot);
+        hasher.Update(image->Channels());
+        hasher.Update(CompressModelTextures);
+        hasher.Update(ModelTextureQuality);
+
+        const TextureContentKey key = TextureCache_MakeKey(*image, GetCookedTextureFormat(slot), hasher.Digest());
+        data.textureKeys[image] = key;
+
+        if (Ref<Texture2D> texture = TextureCache_Acquire(key)) {
+            data.textureCache[image] = texture;
+        }
+    }
+}
+
+// NOTE: Encoded mip chains are cached by what they are built from, like the texture cache, so another model or path with the same pixels finds them too
+static std::string GetCompressedTexturePath(const TextureContentKey& key) {
+    Hasher64 hasher;
+    hasher.Update(key.pixelHash);
+    hasher.Update(key.width);
+    hasher.Update(key.height);
+    hasher.Update(key.format);
+    hasher.Update(key.buildKey);
+    hasher.Update(TextureCompressor::Version);
+
+    char hash[17];
+    snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(hasher.Digest()));
+
+    return (std::filesystem::path(AssetCacheDirectory) / (std::string("texture_") + hash + ".dds")).generic_string();
+}
+
+static bool ReadCompressedTexture(const std::string& path, const Image& image, CompressedTexture& outTexture) {
+    std::error_code ec;
+    if (!std::filesystem::exists(path, ec)) {
+        return false;
+    }
+
+    TextureContainer container;
+    if (!container.Load(path.c_str()) || container.GetWidth() != image.Width() || container.GetHeight() != image.Height() || container.GetLayers() != 1 || container.GetFaces() != 1) {
+        Log::Warn("Cached compressed texture %s does not match its image, encoding it again", path.c_str());
+        return false;
+    }
+
+    outTexture.format = container.GetFormat();
+    outTexture.width = container.GetWidth();
+    outTexture.height = container.GetHeight();
+    outTexture.mipLevels = container.GetMipLevels();
+    outTexture.data.assign(container.GetData(), container.GetData() + container.GetImageSize());
+
+    return true;
+}
+
+// NOTE: Blocks are only encoded when their cache file is missing, the encoded chain is written there for the next load
+static void CompressModelImages(ModelLoadData& data) {
+    std::vector<std::pair<Ref<Image>, CookedTextureSlot>> images;
+    CollectModelImages(data, images);
+
+    uint64_t sourceSize = 0, compressedSize = 0;
+    double psnrSum = 0.0, encodeMs = 0.0;
+    uint32_t psnrCount = 0, cachedCount = 0;
+
+    for (const auto& [image, slot] : images) {
+        if (!image->IsValid() || image->Channels() != 4 || data.textureCache.find(image) != data.textureCache.end()) {
+            continue;
+        }
+
+        auto keyIt = data.textureKeys.find(image);
+        const std::string cachePath = keyIt != data.textureKeys.end() ? GetCompressedTexturePath(keyIt->second) : std::string();
+
+        CompressedTexture compressed;
+        if (!cachePath.empty() && ReadCompressedTexture(cachePath, *image, compressed)) {
+            cachedCount++;
+            data.compressedTextures[image] = std::move(compressed);
+            continue;
+        }
+
+        TextureCompressionStats stats;
+        if (!TextureCompressor::CompressImage(*image, GetCookedTextureRole(slot), slot == CookedTextureSlot::Diffuse, ModelTextureQuality, compressed, &stats, g_assetThreadPool.get())) {
+            continue;
+        }
+
+        if (!cachePath.empty() && !TextureContainer::WriteDDS(cachePath.c_str(), compressed.format, compressed.width, compressed.height, compressed.mipLevels, compressed.data.data(), compressed.data.size())) {
+            Log::Warn("Failed to write compressed texture: %s", cachePath.c_str());
+        }
+
+        sourceSize += image->Data().size();
+        compressedSize += compressed.data.size();
+        encodeMs += stats.encodeMs;
+        if (std::isfinite(stats.psnr)) {
+            psnrSum += stats.psnr;
+            psnrCount++;
+        }
+
+        data.compressedTextures[image] = std::move(compressed);
+    }
+
+    if (data.compressedTextures.size() > cachedCount) {
+        Log::Info("Compressed %zu textures, %.1f MB -> %.1f MB with mips, %.1f ms, average PSNR %.2f dB",
+            data.compressedTextures.size() - cachedCount, sourceSize / (1024.0 * 1024.0), compressedSize / (1024.0 * 1024.0), encodeMs, psnrCount ? psnrSum / psnrCount : 0.0);
+    }
+    if (cachedCount > 0) {
+        Log::Info("Read %u compressed textures from the cache", cachedCount);
+    }
+}
+
+static void GenerateModelMips(ModelLoadData& data) {
+    std::vector<std::pair<Ref<Image>, CookedTextureSlot>> images;
+    CollectModelImages(data, images);
+
+    for (const auto& [image, slot] : images) {
+        if (!image->IsValid() || image->Channels() != 4 || GetSizePerPixel(GetCookedTextureFormat(slot)) != 4 || data.textureCache.find(image) != data.textureCache.end()) {
+            continue;
+        }
+
+        MipGenerationDesc mipDesc;
+        mipDesc.srgb = slot == CookedTextureSlot::Diffuse;
+        mipDesc.normalMap = slot == CookedTextureSlot::Normal;
+        mipDesc.preserveAlphaCoverage = slot == CookedTextureSlot::Diffuse && TextureCompressor::HasAlpha(*image);
+        mipDesc.pool = g_assetThreadPool.get();
+
+        MipChain mipChain;
+        if (MipGenerator::Generate(image->Data().data(), image->Width(), image->Height(), mipDesc, mipChain)) {
+            data.mipChains[image] = std::move(mipChain);
+        }
+    }
+}
+
+template<typename T>
+static void PackVertexAttributes(const TexturedVertex& vertex, T& outVertex) {
+    outVertex.texCoord[0] = FloatToHalf(vertex.texCoord.x);
+    outVertex.texCoord[1] = FloatToHalf(vertex.texCoord.y);
+    EncodeOctahedral(vertex.normal, outVertex.normal);
+    EncodeOctahedral(vertex.tangent, outVertex.tangent);
+}
+
+// NOTE: CPU only. Picks the format the vertices are written in, one pass over the cooked vertices for the decode and the colors.
+// Quantized positions cover the box of the whole mesh, flat axes keep a unit extent so the decode stays invertible.
+static void ChooseModelVertexFormat(ModelLoadData& data, VertexFormat format) {
+    const CookedMesh& cooked = data.cooked;
+    if (format == VertexFormat::Textured || cooked.GetVertexStride() != sizeof(TexturedVertex) || cooked.GetVertexCount() == 0) {
+        return;
+    }
+
+    const TexturedVertex* vertices = static_cast<const TexturedVertex*>(cooked.GetVertexData());
+    const uint32_t vertexCount = cooked.GetVertexCount();
+
+    vec3 boundsMin = vertices[0].position;
+    vec3 boundsMax = vertices[0].position;
+    float texCoordMax = 0.0f;
+    bool whiteColors = true;
+    for (uint32_t i = 0; i < vertexCount; ++i) {
+        const TexturedVertex& vertex = vertices[i];
+        boundsMin = glm::min(boundsMin, vertex.position);
+        boundsMax = glm::max(boundsMax, vertex.position);
+        texCoordMax = std::max(texCoordMax, std::max(std::abs(vertex.texCoord.x), std::abs(vertex.texCoord.y)));
+        whiteColors = whiteColors && vertex.color == vec4(1.0f);
+    }
+
+    if (texCoordMax > PackedTexCoordLimit) {
+        Log::Info("Texture coordinates reach %.1f, keeping the textured vertex format", texCoordMax);
+        return;
+    }
+
+    if (format == VertexFormat::PackedQuantized) {
+        vec3 extent = boundsMax - boundsMin;
+        for (int32_t axis = 0; axis < 3; ++axis) {
+            extent[axis] = extent[axis] > 0.0f ? extent[axis] : 1.0f;
+        }
+
+        data.positionDecode = glm::translate(mat4(1.0f), boundsMin) * glm::scale(mat4(1.0f), extent);
+    }
+
+    // NOTE: Packed vertices have no color, white meshes are drawn without a color stream and the shaders use white
+    if (!whiteColors) {
+        data.packedColors.resize(vertexCount);
+        for (uint32_t i = 0; i < vertexCount; ++i) {
+            const vec4& color = vertices[i].color;
+            data.packedColors[i] = PackUnorm8(color.r) | (PackUnorm8(color.g) << 8) | (PackUnorm8(color.b) << 16) | (PackUnorm8(color.a) << 24);
+        }
+    }
+
+    data.vertexFormat = format;
+}
+
+static uint32_t GetModelVertexStride(const ModelLoadData& data) {
+    switch (data.vertexFormat) {
+    case VertexFormat::Packed: return sizeof(PackedVertex);
+    case VertexFormat::PackedQuantized: return sizeof(QuantizedPackedVertex);
+    default: return data.cooked.GetVertexStride();
+    }
+}
+
+// NOTE: CPU only. Converts the cooked vertices to the chosen format in a single pass into outVertices, GetModelVertexStride bytes each
+static void WriteModelVertices(const ModelLoadData& data, void* outVertices) {
+    const CookedMesh& cooked = data.cooked;
+    const uint32_t vertexCount = cooked.GetVertexCount();
+
+    if (data.vertexFormat == VertexFormat::Textured) {
+        memcpy(outVertices, cooked.GetVertexData(), static_cast<size_t>(cooked.GetVertexStride()) * vertexCount);
+        return;
+    }
+
+    const TexturedVertex* vertices = static_cast<const TexturedVertex*>(cooked.GetVertexData());
+
+    if (data.vertexFormat == VertexFormat::Packed) {
+        PackedVertex* packed = static_cast<PackedVertex*>(outVertices);
+
+        for (uint32_t i = 0; i < vertexCount; ++i) {
+            packed[i].position = vertices[i].position;
+            PackVertexAttributes(vertices[i], packed[i]);
+        }
+    }
+    else {
+        const vec3 boundsMin = vec3(data.positionDecode[3]);
+        const vec3 extent = vec3(data.positionDecode[0][0], data.positionDecode[1][1], data.positionDecode[2][2]);
+
+        QuantizedPackedVertex* packed = static_cast<QuantizedPackedVertex*>(outVertices);
+
+        for (uint32_t i = 0; i < vertexCount; ++i) {
+            const vec3 normalized = (vertices[i].position - boundsMin) / extent;
+            packed[i].position[0] = PackUnorm16(normalized.x);
+            packed[i].position[1] = PackUnorm16(normalized.y);
+            packed[i].position[2] = PackUnorm16(normalized.z);
+            packed[i].position[3] = 0;
+            PackVertexAttributes(vertices[i], packed[i]);
+        }
+    }
+}
+
+// NOTE: Main thread only. Upload memory for the model sized from the cooked counts, left empty where the backend cannot map it.
+void CreateModelStaging(ModelLoadData& data) {
+    const CookedMesh& cooked = data.cooked;
+    MeshPool_CreateStaging(data.vertexFormat, GetModelVertexStride(data), cooked.GetVertexCount(), cooked.GetIndexCount(), data.staging);
+}
+
+// NOTE: CPU only, safe to run on a worker thread. Vertices are converted straight into the staging memory and the indices copied
+// next to them. Without staging, packed vertices go to data.packedVertices and textured ones are uploaded from the cooked blob.
+void WriteModelGeometry(ModelLoadData& data) {
+    const CookedMesh& cooked = data.cooked;
+
+    if (data.staging.vertices) {
+        WriteModelVertices(data, data.staging.vertices);
+        memcpy(data.staging.indices, cooked.GetIndexData(), sizeof(uint32_t) * cooked.GetIndexCount());
+        return;
+    }
+
+    if (data.vertexFormat != VertexFormat::Textured) {
+        data.packedVertices.resize(static_cast<size_t>(GetModelVertexStride(data)) * cooked.GetVertexCount());
+        WriteModelVertices(data, data.packedVertices.data());
+    }
+}
+
+// NOTE: CPU only, safe to run on a worker thread
+bool ReadModel(const char* filePath, float scale, ModelLoadData& data) {
+    auto startTime = std::chrono::steady_clock::now();
+
+    const uint64_t sourceKey = CookedMesh::ComputeSourceKey(filePath);
+    if (sourceKey == 0) {
+        Log::Error("Failed to load model: %s", filePath);
+        return false;
+    }
+
+    const uint64_t importKey = GetModelImportKey(scale);
+    const std::string cookedPath = GetCookedModelPath(filePath, scale);
+
+    if (!data.cooked.Open(cookedPath.c_str(), sourceKey, importKey)) {
+        if (!CookModel(filePath, scale, sourceKey, importKey, cookedPath, data)) {
+            return false;
+        }
+    }
+
+    // NOTE: Kept for the BVH, which is only mapped or built once something raycasts the mesh
+    data.cookedPath = cookedPath;
+    data.sourceKey = sourceKey;
+    data.importKey = importKey;
+
+    std::vector<std::string> imagePaths;
+    for (uint32_t i = 0; i < data.cooked.GetMaterialCount(); ++i) {
+        for (CookedTextureSlot slot : CookedTextureSlots) {
+            const char* texturePath = data.cooked.GetTexturePath(i, slot);
+            if (texturePath && data.images.find(texturePath) == data.images.end()) {
+                data.images[texturePath] = nullptr;
+                imagePaths.push_back(texturePath);
+            }
+        }
+    }
+
+    ImageCache::LoadAll(imagePaths, 4, g_assetThreadPool.get());
+    for (const auto& imagePath : imagePaths) {
+        data.images[imagePath] = ImageCache::GetOrLoad(imagePath, 4);
+    }
+
+    if (IsVertexFormatSupported(ModelVertexFormat)) {
+        ChooseModelVertexFormat(data, ModelVertexFormat);
+    }
+
+    ShareModelTextures(data);
+
+    if (CompressModelTextures) {
+        CompressModelImages(data);
+    }
+    else {
+        GenerateModelMips(data);
+    }
+
+    std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    Log::Info("%s read in %.1f ms (%s)", filePath, elapsed.count(), data.cooked.IsMapped() ? "cooked" : "imported");
+
+    return true;
+}
+
+static const char* GetModelImagePath(const ModelLoadData& data, const Ref<Image>& image) {
+    for (const auto& [path, candidate] : data.images) {
+        if (candidate == image) {
+            return path.c_str();
+        }
+    }
+    return "";
+}
+
+// NOTE: Textures with their whole chain on the CPU are handed to the streamer, which keeps the levels and uploads the low ones
+static Ref<Texture2D> CreateModelTexture(ModelLoadData& data, const Ref<Image>& image, CookedTextureSlot slot) {
+    Texture2D::Descriptor textureDesc;
+    textureDesc.width = image->Width();
+    textureDesc.height = image->Height();
+    textureDesc.data = image->Data().data();
+    textureDesc.memProperty = MemoryProperty::Static;
+    textureDesc.texUsages = TextureUsage::ShaderResource;
+    textureDesc.format = GetCookedTextureFormat(slot);
+    textureDesc.mipLevels = 1;
+	textureDesc.initialLayout = TextureLayout::ShaderReadOnly;
+
+    // NOTE: Compressed textures and CPU generated chains carry all their mips and move into the streamer
+    auto it = data.compressedTextures.find(image);
+    if (it != data.compressedTextures.end()) {
+        CompressedTexture& compressed = it->second;
+        textureDesc.format = compressed.format;
+        textureDesc.mipLevels = compressed.mipLevels;
+        textureDesc.dataMipLevels = compressed.mipLevels;
+
+        return TextureStreaming_Register(GetModelImagePath(data, image), textureDesc, std::move(compressed.data));
+    }
+
+    auto mipIt = data.mipChains.find(image);
+    if (mipIt != data.mipChains.end()) {
+        MipChain& mipChain = mipIt->second;
+        textureDesc.mipLevels = mipChain.mipLevels;
+        textureDesc.dataMipLevels = mipChain.mipLevels;
+
+        return TextureStreaming_Register(GetModelImagePath(data, image), textureDesc, std::move(mipChain.data));
+    }
+
+    Ref<Texture2D> texture = g_graphicsContext->CreateTexture2D(textureDesc);
+    Residency_Track(ResidencyCategory::Textures, GetModelImagePath(data, image), texture, GetTextureSize(textureDesc.format, textureDesc.width, textureDesc.height));
+
+    return texture;
+}
+
+// NOTE: Main thread. Looks the key up again since a model finalized after ShareModelTextures may have created the same texture
+Ref<Texture2D> CreateSharedModelTexture(ModelLoadData& data, const Ref<Image>& image, CookedTextureSlot slot) {
+    auto keyIt = data.textureKeys.find(image);
+    if (keyIt == data.textureKeys.end()) {
+        return CreateModelTexture(data, image, slot);
+    }
+
+    if (Ref<Texture2D> texture = TextureCache_Acquire(keyIt->second)) {
+        return texture;
+    }
+
+    // NOTE: The size is taken before CreateModelTexture moves the levels into the streamer
+    uint64_t sizeBytes = static_cast<uint64_t>(GetSizePerPixel(GetCookedTextureFormat(slot))) * image->Width() * image->Height();
+    auto compressedIt = data.compressedTextures.find(image);
+    auto mipIt = data.mipChains.find(image);
+    if (compressedIt != data.compressedTextures.end()) {
+        sizeBytes = compressedIt->second.data.size();
+    }
+    else if (mipIt != data.mipChains.end()) {
+        sizeBytes = mipIt->second.data.size();
+    }
+
+    Ref<Texture2D> texture = CreateModelTexture(data, image, slot);
+    if (texture) {
+        TextureCache_Add(keyIt->second, texture, sizeBytes, GetModelImagePath(data, image));
+    }
+
+    return texture;
+}
+
+// NOTE: Main thread only, textures already in data.textureCache are reused
+Ref<Mesh> CreateModelMesh(ModelLoadData& data) {
+    const CookedMesh& cooked = data.cooked;
+
+    Ref<Mesh> mesh = CreateRef<Mesh>();
+    mesh->vertexFormat = data.vertexFormat;
+    mesh->positionDecode = data.positionDecode;
+    mesh->cookedPath = data.cookedPath;
+    mesh->cookedSourceKey = data.sourceKey;
+    mesh->cookedImportKey = data.importKey;
+
+    auto& textureCache = data.textureCache;
+    std::function<Ref<Texture2D>(uint32_t, CookedTextureSlot)> createTexture = [&](uint32_t materialIndex, CookedTextureSlot slot) -> Ref<Texture2D> {
+        Ref<Image> image = GetModelImage(data, materialIndex, slot);
+        if (!image) {
+            return nullptr;
+        }
+
+        auto it = textureCache.find(image);
+        if (it != textureCache.end()) {
+            return it->second;
+        }
+
+        Ref<Texture2D> texture = CreateSharedModelTexture(data, image, slot);
+        textureCache[image] = texture;
+
+        return texture;
+    };
+
+    std::unordered_map<uint32_t, Ref<Material>> materialCache;
+    std::function<Ref<Material>(uint32_t)> createMaterial = [&](uint32_t index) {
+        auto it = materialCache.find(index);
+        if (it != materialCache.end()) {
+            return it->second;
+        }
+
+        Ref<Material> material = CreateRef<Material>();
+        material->diffuseColor = cooked.GetMaterials()[index].baseColor;
+        material->diffuseTexture = createTexture(index, CookedTextureSlot::Diffuse);
+        material->specular = 0.3f;
+        material->specularTexture = createTexture(index, CookedTextureSlot::Specular);
+		material->normalTexture = createTexture(index, CookedTextureSlot::Normal);
+		material->displacementTexture = createTexture(index, CookedTextureSlot::Displacement);
+		material->ambientOcclusionTexture = createTexture(index, CookedTextureSlot::AmbientOcclusion);
+        material->shininess = 32.0f;
+        materialCache[index] = material;
+
+        TextureStreaming_Track(material);
+
+        return material;
+        };
+
+    const bool texturedVertices = cooked.GetVertexStride() == sizeof(TexturedVertex);
+
+    const CookedMeshSegment* segments = cooked.GetSegments();
+    for (uint32_t i = 0; i < cooked.GetSegmentCount(); ++i) {
+        MeshSegment subMesh;
+        subMesh.vertexOffset = segments[i].vertexOffset;
+        subMesh.indexOffset = segments[i].indexOffset;
+        subMesh.indexCount = segments[i].indexCount;
+        subMesh.meshletOffset = static_cast<uint32_t>(mesh->meshlets.size());
+        subMesh.meshletCount = segments[i].meshletCount;
+
+        mesh->meshlets.insert(mesh->meshlets.end(), cooked.GetMeshlets() + segments[i].meshletOffset, cooked.GetMeshlets() + segments[i].meshletOffset + segments[i].meshletCount);
+
+        if (texturedVertices) {
+            ComputeSegmentBounds(static_cast<const TexturedVertex*>(cooked.GetVertexData()), cooked.GetIndexData(), subMesh);
+        }
+
+        mesh->segments.push_back(subMesh);
+
+        Ref<Material> material;
+        if (segments[i].materialIndex == -1) {
+            material = ResolveAsset(g_materials, g_defaultMaterial);
+        }
+        else {
+            material = createMaterial(segments[i].materialIndex);
+        }
+
+        mesh->materials.push_back(material);
+    }
+
+    // NOTE: Staged geometry is already in upload memory, otherwise it is uploaded straight from the cooked blob, the mapped file
+    // itself unless its geometry was compressed or packed
+    if (data.staging.vertexBuffer) {
+        UploadStagedMeshGeometry(*mesh, data.staging);
+    }
+    else if (data.vertexFormat == VertexFormat::Textured) {
+        UploadMeshGeometry(*mesh, cooked.GetVertexStride(), cooked.GetVertexData(), cooked.GetVertexCount(), cooked.GetIndexData(), cooked.GetIndexCount());
+    }
+    else {
+        UploadMeshGeometry(*mesh, static_cast<uint32_t>(data.packedVertices.size() / cooked.GetVertexCount()), data.packedVertices.data(), cooked.GetVertexCount(), cooked.GetIndexData(), cooked.GetIndexCount());
+    }
+
+    UploadMeshColors(*mesh, data.packedColors);
+
+    return mesh;
+}
+
+void LoadModel(const char* filePath, float scale, const char* key) {
+    ModelLoadData data;
+    if (!ReadModel(filePath, scale, data)) {
+        return;
+    }
+
+    CreateModelStaging(data);
+    WriteModelGeometry(data);
+
+    RegisterAsset(g_meshes, key, CreateModelMesh(data));
+    HotReload_WatchModel(filePath, scale, key, data);
+}
+
+void PushFinalizeTask(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(g_finalizeMutex);
+        g_finalizeTasks.push(std::move(task));
+    }
+
+    g_finalizeCondition.notify_one();
+}
+
+std::shared_future<Ref<Texture2D>> LoadTextureAsync(const char* filePath, PixelFormat pixelFormat, const char* key) {
+    auto promise = CreateRef<std::promise<Ref<Texture2D>>>();
+    std::shared_future<Ref<Texture2D>> future = promise->get_future().share();
+
+    ReadTextureAsync(filePath, pixelFormat, [promise, path = std::string(filePath), pixelFormat, key = std::string(key)](const Ref<Texture2D>& texture, uint32_t placeholderColor) {
+        if (texture) {
+            RegisterAsset(g_textures, key, texture);
+            HotReload_WatchTexture(path, pixelFormat, key, placeholderColor);
+        }
+
+        promise->set_value(texture);
+    });
+
+    return future;
+}
+
+std::shared_future<Ref<Mesh>> LoadModelAsync(const char* filePath, float scale, const char* key) {
+    auto promise = CreateRef<std::promise<Ref<Mesh>>>();
+    std::shared_future<Ref<Mesh>> future = promise->get_future().share();
+
+    ReadModelAsync(filePath, scale, [promise, path = std::string(filePath), scale, key = std::string(key)](const Ref<Mesh>& mesh, const ModelLoadData& data) {
+        if (mesh) {
+            RegisterAsset(g_meshes, key, mesh);
+            HotReload_WatchModel(path, scale, key, data);
+        }
+
+        promise->set_value(mesh);
+    });
+
+    return future;
+}
+
+// NOTE: Materials and sprites hold their textures directly, so every slot holding the old texture is pointed at the new one.
+// The old texture is then released by the delayed deletion of the graphics context, after the frames in flight.
+static void ReplaceTexture(const Ref<Texture2D>& oldTexture, const Ref<Texture2D>& newTexture) {
+    auto replaceInMaterial = [&](Material& material) {
+        for (Ref<Texture2D>* slot : { &material.diffuseTexture, &material.specularTexture, &material.normalTexture, &material.displacementTexture, &material.ambientOcclusionTexture }) {
+            if (*slot == oldTexture) {
+                *slot = newTexture;
+            }
+        }
+    };
+
+    for (auto& slot : g_materials.slots) {
+        if (slot.asset) {
+            replaceInMaterial(*slot.asset);
+        }
+    }
+
+    for (auto& slot : g_meshes.slots) {
+        if (!slot.asset) {
+            continue;
+        }
+
+        for (const Ref<Material>& material : slot.asset->materials) {
+            if (material) {
+                replaceInMaterial(*material);
+            }
+        }
+    }
+
+    for (const Object& object : g_objects) {
+        Ref<SpriteComponent> sprite = object.GetComponent<SpriteComponent>();
+        if (sprite && sprite->texture == oldTexture) {
+            sprite->texture = newTexture;
+        }
+    }
+}
+
+bool SwapTexture(const std::string& key, const Ref<Texture2D>& texture) {
+    auto nameIt = g_textures.names.find(key);
+    if (nameIt == g_textures.names.end()) {
+        return false;
+    }
+
+    ReplaceTexture(g_textures.slots[nameIt->second.index].asset, texture);
+    RegisterAsset(g_textures, key, texture);
+
+    return true;
+}
+
+// NOTE: Moved into the registered mesh so the components holding it draw the new data. The old buffers and pool ranges
+// are freed after the frames in flight, the old materials go with their streamed textures.
+bool SwapMesh(const std::string& key, Mesh&& mesh) {
+    auto nameIt = g_meshes.names.find(key);
+    if (nameIt == g_meshes.names.end()) {
+        return false;
+    }
+
+    *g_meshes.slots[nameIt->second.index].asset = std::move(mesh);
+    World_InvalidateRenderQueue();
+
+    return true;
+}
+
+// NOTE: An evicted texture is drawn as a 1x1 texture of its placeholder color until it is drawn again and reloaded from its source.
+// Each gets a placeholder of its own so draws of it can still be told apart.
+ResidencyEviction EvictTexture(const std::string& key, uint32_t placeholderColor) {
+    auto nameIt = g_textures.names.find(key);
+    if (nameIt == g_textures.names.end()) {
+        return {};
+    }
+
+    Ref<Texture2D> texture = g_textures.slots[nameIt->second.index].asset;
+    if (!texture) {
+        return {};
+    }
+
+    Ref<Texture2D> placeholder = CreatePlaceholderTexture(texture->GetPixelFormat(), placeholderColor);
+    if (!placeholder) {
+        return {};
+    }
+
+    ReplaceTexture(texture, placeholder);
+    RegisterAsset(g_textures, key, placeholder);
+
+    return { placeholder, GetTextureSize(placeholder->GetPixelFormat(), 1, 1) };
+}
+
+// NOTE: An evicted mesh keeps its segments and meshlets so it is still culled, and marked used when it would be drawn. It is
+// skipped by the draws until its model is reloaded, its pool ranges are freed after the frames in flight. Both the eviction and
+// the reload swap what the render queue was built from, so both rebuild it.
+ResidencyEviction EvictMesh(const std::string& key) {
+    auto nameIt = g_meshes.names.find(key);
+    if (nameIt == g_meshes.names.end()) {
+        return {};
+    }
+
+    const Ref<Mesh>& mesh = g_meshes.slots[nameIt->second.index].asset;
+    if (!mesh || !mesh->vertexBuffer) {
+        return {};
+    }
+
+    mesh->vertexBuffer.reset();
+    mesh->indexBuffer.reset();
+    mesh->colorBuffer.reset();
+    mesh->poolAllocation.reset();
+    World_InvalidateRenderQueue();
+
+    return { mesh, 0 };
+}
+
+
+static bool RunFinalizeTask() {
+    std::function<void()> task;
+
+    {
+        std::lock_guard<std::mutex> lock(g_finalizeMutex);
+        if (g_finalizeTasks.empty()) {
+            return false;
+        }
+
+        task = std::move(g_finalizeTasks.front());
+        g_finalizeTasks.pop();
+    }
+
+    task();
+
+    return true;
+}
+
+void Asset_Update(float budgetMs) {
+    auto start = std::chrono::steady_clock::now();
+
+    HotReload_Update();
+
+    // NOTE: At least one task runs per call so a single expensive upload can't stall the queue forever
+    while (RunFinalizeTask()) {
+        std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() >= budgetMs) {
+            break;
+        }
+    }
+}
+
+void Asset_WaitForLoads() {
+    while (g_pendingLoadCount > 0) {
+        if (RunFinalizeTask()) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(g_finalizeMutex);
+        g_finalizeCondition.wait(lock, [] { return !g_finalizeTasks.empty() || g_pendingLoadCount == 0; });
+    }
+}
+
+bool Asset_IsLoading() {
+    return g_pendingLoadCount > 0;
+}
+
+void LoadMaterial(const char* key) {
+	Ref<Material> material = CreateRef<Material>();
+	material->diffuseColor = glm::vec3(0.5f, 0.5f, 0.5f);
+    material->specular = 0.3f;
+	material->shininess = 16.0f;
+
+	RegisterAsset(g_materials, key, material);
+}
+
+Texture2DHandle FindTexture2D(const char* key) {
+    return FindAsset(g_textures, key);
+}
+
+TextureCubeHandle FindTextureCube(const char* key) {
+    return FindAsset(g_textureCubes, key);
+}
+
+Texture2DArrayHandle FindTexture2DArray(const char* key) {
+    return FindAsset(g_textureArrays, key);
+}
+
+MeshHandle FindMesh(const char* key) {
+    return FindAsset(g_meshes, key);
+}
+
+MaterialHandle FindMaterial(const char* key) {
+    return FindAsset(g_materials, key);
+}
+
+const Ref<Texture2D>& GetTexture2D(Texture2DHandle handle) {
+    return ResolveAsset(g_textures, handle);
+}
+
+const Ref<TextureCube>& GetTextureCube(TextureCubeHandle handle) {
+    return ResolveAsset(g_textureCubes, handle);
+}
+
+const Ref<Texture2DArray>& GetTexture2DArray(Texture2DArrayHandle handle) {
+    return ResolveAsset(g_textureArrays, handle);
+}
+
+const Ref<Mesh>& GetMesh(MeshHandle handle) {
+    return ResolveAsset(g_meshes, handle);
+}
+
+const Ref<Material>& GetMaterial(MaterialHandle handle) {
+    return ResolveAsset(g_materials, handle);
+}
 
 Ref<Texture2D> GetTexture2D(const char* key) {
-	auto it = g_textures.find(key);
-	if (it != g_textures.end()) {
-		return it->second;
-	}
-	Log::Error("Texture2D with key '%s' not found.", key);
-	return nullptr;
+    return GetTexture2D(FindTexture2D(key));
 }
 
 Ref<TextureCube> GetTextureCube(const char* key) {
-	auto it = g_textureCubes.find(key);
-	if (it != g_textureCubes.end()) {
-		return it->second;
-	}
-	Log::Error("TextureCube with key '%s' not found.", key);
-	return nullptr;
+    return GetTextureCube(FindTextureCube(key));
+}
+
+Ref<Texture2DArray> GetTexture2DArray(const char* key) {
+    return GetTexture2DArray(FindTexture2DArray(key));
 }
 
 Ref<Mesh> GetMesh(const char* key) {
-	auto it = g_meshes.find(key);
-	if (it != g_meshes.end()) {
-		return it->second;
-	}
-	Log::Error("Mesh with key '%s' not found.", key);
-	return nullptr;
+    return GetMesh(FindMesh(key));
 }
 
 Ref<Material> GetMaterial(const char* key) {
-	auto it = g_materials.find(key);
-	if (it != g_materials.end()) {
-		return it->second;
-	}
-	Log::Error("Material with key '%s' not found.", key);
-	return nullptr;
-}
\ No newline at end of file
+    return GetMaterial(FindMaterial(key));
+}
+
+void Asset_SetCookedGeometryCompression(bool enabled) {
+    g_compressCookedGeometry = enabled;
+}
+
+const BVHCache* Asset_GetMeshBVH(Mesh& mesh) {
+    if (mesh.bvh) {
+        return mesh.bvh.get();
+    }
+
+    if (mesh.cookedPath.empty()) {
+        return nullptr;
+    }
+
+    // NOTE: Cleared up front so a mesh whose cooked file is gone only fails once
+    const std::string cookedPath = std::move(mesh.cookedPath);
+    mesh.cookedPath.clear();
+
+    CookedMesh cooked;
+    if (!cooked.Open(cookedPath.c_str(), mesh.cookedSourceKey, mesh.cookedImportKey)) {
+        Log::Warn("Failed to build BVH, cooked mesh is missing or stale: %s", cookedPath.c_str());
+        return nullptr;
+    }
+
+    // NOTE: The BVH is only built when its cache is missing or was made from other cooked data
+    Hasher64 bvhKey;
+    bvhKey.Update(mesh.cookedSourceKey);
+    bvhKey.Update(mesh.cookedImportKey);
+
+    Ref<BVHCache> bvh = CreateRef<BVHCache>();
+    if (!bvh->LoadOrBuild(std::filesystem::path(cookedPath).replace_extension(".bvh").generic_string().c_str(), bvhKey.Digest(), CookedMeshTriangleSource(cooked))) {
+        return nullptr;
+    }
+
+    mesh.bvh = bvh;
+    return mesh.bvh.get();
+}
+
+template<typename T>
+void Asset_Acquire(AssetHandle<T> handle) {
+    AssetTable<T>& table = GetAssetTable<T>();
+
+    auto slot = GetAssetSlot(table, handle);
+    if (!slot) {
+        Log::Error("Acquiring a stale %s handle", table.typeName);
+        return;
+    }
+
+    slot->refCount++;
+}
+
+template<typename T>
+void Asset_Release(AssetHandle<T> handle) {
+    AssetTable<T>& table = GetAssetTable<T>();
+
+    auto slot = GetAssetSlot(table, handle);
+    if (!slot || slot->refCount == 0) {
+        Log::Warn("Releasing a %s handle that is not acquired", table.typeName);
+        return;
+    }
+
+    if (--slot->refCount == 0) {
+        Log::Info("Unloading unused %s '%s'", table.typeName, slot->key.c_str());
+        UnloadAsset(table, handle);
+    }
+}
+
+template void Asset_Acquire(Texture2DHandle);
+template void Asset_Acquire(TextureCubeHandle);
+template void Asset_Acquire(Texture2DArrayHandle);
+template void Asset_Acquire(MeshHandle);
+template void Asset_Acquire(MaterialHandle);
+
+template void Asset_Release(Texture2DHandle);
+template void Asset_Release(TextureCubeHandle);
+template void Asset_Release(Texture2DArrayHandle);
+template void Asset_Release(MeshHandle);
+template void Asset_Release(MaterialHandle);
@@ -4,17 +4,93 @@
 
 #include <vector>
 #include <array>
+#include <future>
+
+constexpr float DefaultAssetFinalizeBudgetMs = 2.0f;
+
+// NOTE: Slot in the table of its asset type and the generation the slot had when the handle was issued. Resolving is an array
+// lookup, a handle that outlived its asset resolves to nullptr rather than to whatever was loaded into the slot since.
+template<typename T>
+struct AssetHandle {
+    constexpr static uint32_t InvalidIndex = ~0u;
+
+    uint32_t index = InvalidIndex;
+    uint32_t generation = 0;
+
+    bool IsValid() const { return index != InvalidIndex; }
+
+    bool operator==(const AssetHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const AssetHandle& other) const { return !(*this == other); }
+};
+
+using Texture2DHandle = AssetHandle<Texture2D>;
+using TextureCubeHandle = AssetHandle<TextureCube>;
+using Texture2DArrayHandle = AssetHandle<Texture2DArray>;
+using MeshHandle = AssetHandle<Mesh>;
+using MaterialHandle = AssetHandle<Material>;
+
+// NOTE: Built in assets registered by Asset_Init
+extern Texture2DHandle g_dummyTexture;
+extern MeshHandle g_quadMesh;
+extern MeshHandle g_cubeMesh;
+extern MeshHandle g_sphereMesh;
+extern MaterialHandle g_defaultMaterial;
 
 void Asset_Init();
 void Asset_Cleanup();
 
 void LoadTexture(const char* filePath, PixelFormat pixelFormat, const char* key);
 void LoadTextureCube(const std::array<const char*, 6>& faceFilePaths, const char* key);
+// NOTE: .dds and .ktx2 files go to the GPU as stored, including their mip chains. LoadTexture accepts them as well.
+void LoadTextureCube(const char* filePath, const char* key);
+void LoadTextureArray(const char* filePath, PixelFormat pixelFormat, const char* key);
 void LoadPrimitiveModel(const std::vector<TexturedVertex>& vertices, const std::vector<uint32_t>& indices, const char* key);
 void LoadModel(const char* filePath, float scale, const char* key);
 void LoadMaterial(const char* key);
 
+// NOTE: Async loads read and decode on worker threads, GPU resources are created on the main thread by Asset_Update or Asset_WaitForLoads.
+// The future becomes ready once the resource is registered (nullptr on failure), so the main thread must not block on it directly.
+std::shared_future<Ref<Texture2D>> LoadTextureAsync(const char* filePath, PixelFormat pixelFormat, const char* key);
+std::shared_future<Ref<Mesh>> LoadModelAsync(const char* filePath, float scale, const char* key);
+
+// NOTE: Textures and models loaded from files are reloaded when their sources change. The new data replaces the old in the
+// registered mesh and in the materials and sprites using the texture, so nothing holding them has to be re-created.
+void Asset_Update(float budgetMs = DefaultAssetFinalizeBudgetMs);
+void Asset_WaitForLoads();
+bool Asset_IsLoading();
+
+// NOTE: Name lookups hash the key, meant for load time. Loading again under a key keeps its handle and swaps the asset in place.
+Texture2DHandle FindTexture2D(const char* key);
+TextureCubeHandle FindTextureCube(const char* key);
+Texture2DArrayHandle FindTexture2DArray(const char* key);
+MeshHandle FindMesh(const char* key);
+MaterialHandle FindMaterial(const char* key);
+
+const Ref<Texture2D>& GetTexture2D(Texture2DHandle handle);
+const Ref<TextureCube>& GetTextureCube(TextureCubeHandle handle);
+const Ref<Texture2DArray>& GetTexture2DArray(Texture2DArrayHandle handle);
+const Ref<Mesh>& GetMesh(MeshHandle handle);
+const Ref<Material>& GetMaterial(MaterialHandle handle);
+
 Ref<Texture2D> GetTexture2D(const char* key);
 Ref<TextureCube> GetTextureCube(const char* key);
+Ref<Texture2DArray> GetTexture2DArray(const char* key);
 Ref<Mesh> GetMesh(const char* key);
 Ref<Material> GetMaterial(const char* key);
+
+// NOTE: Off by default. Uncompressed cooked meshes are uploaded straight from the mapped file, compressed ones are about a third
+// of the size (tools/meshcodec reports the ratio and decode speed) but decoded on every load. Part of the cooked mesh key, so
+// switching it recooks the models, call it before any are loaded.
+void Asset_SetCookedGeometryCompression(bool enabled);
+
+// NOTE: Main thread only. Maps the mesh's BVH from its cache on the first call, building it from the cooked mesh when the cache is
+// missing or stale. nullptr for meshes without a cooked file, a failed attempt is not retried until the model is reloaded.
+const BVHCache* Asset_GetMeshBVH(Mesh& mesh);
+
+// NOTE: Counted users of an asset. When the last one releases it the asset is unloaded and its handles go stale, assets nobody
+// acquired stay loaded until Asset_Cleanup. Holders of the Ref itself keep the GPU resource alive regardless.
+template<typename T>
+void Asset_Acquire(AssetHandle<T> handle);
+
+template<typename T>
+void Asset_Release(AssetHandle<T> handle);
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "EngineCore.h"
+#include "meshpool.h"
+#include "texturecache.h"
+#include "residency.h"
+#include "Image/TextureCompressor.h"
+#include "Image/MipGenerator.h"
+#include "Model/CookedMesh.h"
+
+#include <atomic>
+
+namespace flaw {
+    class Image;
+    class TextureContainer;
+    class ThreadPool;
+}
+
+// NOTE: Loading steps of asset.cpp shared with hotreload.cpp, which reads the same files again when they change or after an
+// eviction. Not meant for anything else, assets are loaded through asset.h.
+
+// NOTE: Workers decode and parse, GPU resources are created on the main thread by the finalize tasks Asset_Update drains
+extern Scope<ThreadPool> g_assetThreadPool;
+extern std::atomic<int32_t> g_pendingLoadCount;
+
+void PushFinalizeTask(std::function<void()> task);
+
+bool GenerateTextureMips(const Image& image, PixelFormat pixelFormat, MipChain& outChain);
+uint32_t GetPlaceholderColor(PixelFormat pixelFormat, const MipChain* mipChain);
+Ref<Texture2D> CreateTexture(const Image& image, PixelFormat pixelFormat, const MipChain* mipChain = nullptr);
+Ref<Texture2D> CreateContainerTexture(const TextureContainer& container, PixelFormat pixelFormat);
+
+uint64_t GetResidentTextureSize(const Texture2D& texture);
+uint64_t GetResidentMeshSize(const Mesh& mesh);
+
+struct ModelLoadData {
+    CookedMesh cooked;
+    std::unordered_map<std::string, Ref<Image>> images;
+    std::unordered_map<Ref<Image>, CompressedTexture> compressedTextures;
+    std::unordered_map<Ref<Image>, MipChain> mipChains; // only when textures are not compressed
+    std::unordered_map<Ref<Image>, Ref<Texture2D>> textureCache;
+    std::unordered_map<Ref<Image>, TextureContentKey> textureKeys;
+
+    VertexFormat vertexFormat = VertexFormat::Textured;
+    mat4 positionDecode = mat4(1.0f);
+    MeshPoolStaging staging;
+    std::vector<uint8_t> packedVertices; // only when there is no staging memory to write to
+    std::vector<uint32_t> packedColors; // only when the colors are not all white
+
+    std::string cookedPath;
+    uint64_t sourceKey = 0;
+    uint64_t importKey = 0;
+};
+
+// NOTE: ReadModel and WriteModelGeometry run on any thread, the others on the main thread
+bool ReadModel(const char* filePath, float scale, ModelLoadData& data);
+void CollectModelImages(const ModelLoadData& data, std::vector<std::pair<Ref<Image>, CookedTextureSlot>>& outImages);
+Ref<Texture2D> CreateSharedModelTexture(ModelLoadData& data, const Ref<Image>& image, CookedTextureSlot slot);
+void CreateModelStaging(ModelLoadData& data);
+void WriteModelGeometry(ModelLoadData& data);
+Ref<Mesh> CreateModelMesh(ModelLoadData& data);
+
+// NOTE: Swap the asset registered under key for a new one in place, false when nothing is registered under it
+bool SwapTexture(const std::string& key, const Ref<Texture2D>& texture);
+bool SwapMesh(const std::string& key, Mesh&& mesh);
+
+ResidencyEviction EvictTexture(const std::string& key, uint32_t placeholderColor);
+ResidencyEviction EvictMesh(const std::string& key);
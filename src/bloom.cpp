@@ -58,7 +58,7 @@ void Bloom_Render() {
 
 	auto& commandQueue = g_graphicsContext->GetCommandQueue();
 
-	auto quad = GetMesh("quad");
+	auto quad = GetMesh(g_quadMesh);
 
 	auto sceneFramebuffer = g_sceneFramebufferGroup->Get();
 
@@ -68,5 +68,5 @@ void Bloom_Render() {
 	commandQueue.SetPipeline(g_bloomPipeline);
 	commandQueue.SetVertexBuffers({ quad->vertexBuffer });
 	commandQueue.SetShaderResources({ shaderResources });
-	commandQueue.DrawIndexed(quad->indexBuffer, quad->indexBuffer->IndexCount());
+	commandQueue.DrawIndexed(quad->indexBuffer, quad->segments[0].indexCount, quad->segments[0].indexOffset, quad->segments[0].vertexOffset);
 }
\ No newline at end of file
@@ -9,6 +9,8 @@ static Ref<GraphicsResourcesPool<ShaderResources>> g_dynamicShaderResourcesPool;
 static Ref<GraphicsPipeline> g_explodePipeline;
 static Ref<GraphicsPipeline> g_viewNormalPipeline;
 
+static TextureCubeHandle g_skyboxTexture;
+
 void Geometry_Init() {
 	// NOTE: Create shader resources
 	ShaderResourcesLayout::Descriptor staticSRLDesc;
@@ -108,11 +110,16 @@ void Geometry_Init() {
 	obj.scale = vec3(1.0f);
 
 	auto meshComp = obj.AddComponent<StaticMeshComponent>();
-	meshComp->mesh = GetMesh("sphere");
+	meshComp->mesh = GetMesh(g_sphereMesh);
 	meshComp->excludeFromRendering = true;
+
+	g_skyboxTexture = FindTextureCube("skybox");
+	Asset_Acquire(g_skyboxTexture);
 }
 
 void Geometry_Cleanup() {
+	Asset_Release(g_skyboxTexture);
+
 	g_staticShaderResourcesLayout.reset();
 	g_dynamicShaderResourcesLayout.reset();
 	g_staticShaderResources.reset();
@@ -141,6 +148,9 @@ void Geometry_Render() {
 
 	objectConstantsCB->Update(&objConstants, sizeof(ObjectConstants));
 
+	const Ref<Texture2D>& dummyTexture = GetTexture2D(g_dummyTexture);
+	const Ref<TextureCube>& skyboxTexture = GetTextureCube(g_skyboxTexture);
+
 #if false
 	for (uint32_t i = 0; i < meshComp->mesh->segments.size(); i++) {
 		auto& subMesh = meshComp->mesh->segments[i];
@@ -153,17 +163,17 @@ void Geometry_Render() {
 			dynamicShaderResources->BindTexture2D(material->diffuseTexture, 2);
 		}
 		else {
-			dynamicShaderResources->BindTexture2D(GetTexture2D("dummy"), 2);
+			dynamicShaderResources->BindTexture2D(dummyTexture, 2);
 		}
 
 		if (material->specularTexture) {
 			dynamicShaderResources->BindTexture2D(material->specularTexture, 3);
 		}
 		else {
-			dynamicShaderResources->BindTexture2D(GetTexture2D("dummy"), 3);
+			dynamicShaderResources->BindTexture2D(dummyTexture, 3);
 		}
 
-		dynamicShaderResources->BindTextureCube(GetTextureCube("skybox"), 4);
+		dynamicShaderResources->BindTextureCube(skyboxTexture, 4);
 
 		commandQueue.SetVertexBuffers({ meshComp->mesh->vertexBuffer });
 		commandQueue.SetPipeline(g_explodePipeline);
@@ -177,6 +187,11 @@ void Geometry_Render() {
 
 		auto meshComp = object.GetComponent<StaticMeshComponent>();
 
+		// NOTE: The normal view pipeline only reads the textured vertex format, evicted meshes have nothing to draw
+		if (meshComp->mesh->vertexFormat != VertexFormat::Textured || !meshComp->mesh->vertexBuffer) {
+			continue;
+		}
+
 		auto dynamicShaderResources = g_dynamicShaderResourcesPool->Get();
 		auto objectConstantsCB = g_objConstantsCBPool->Get();
 		auto materialConstantsCB = g_objMaterialCBPool->Get();
@@ -195,13 +210,13 @@ void Geometry_Render() {
 
 			MaterialConstants materialConstants = GetMaterialConstants(material);
 			materialConstantsCB->Update(&materialConstants, sizeof(MaterialConstants));
-			dynamicShaderResources->BindTexture2D(GetTexture2D("dummy"), 2);
-			dynamicShaderResources->BindTexture2D(GetTexture2D("dummy"), 3);
-			dynamicShaderResources->BindTextureCube(GetTextureCube("skybox"), 4);
-			dynamicShaderResources->BindTexture2D(GetTexture2D("dummy"), 5);
-			dynamicShaderResources->BindTextureCube(GetTextureCube("skybox"), 6);
-			dynamicShaderResources->BindTexture2D(GetTexture2D("dummy"), 7);
-			dynamicShaderResources->BindTexture2D(GetTexture2D("dummy"), 8);
+			dynamicShaderResources->BindTexture2D(dummyTexture, 2);
+			dynamicShaderResources->BindTexture2D(dummyTexture, 3);
+			dynamicShaderResources->BindTextureCube(skyboxTexture, 4);
+			dynamicShaderResources->BindTexture2D(dummyTexture, 5);
+			dynamicShaderResources->BindTextureCube(skyboxTexture, 6);
+			dynamicShaderResources->BindTexture2D(dummyTexture, 7);
+			dynamicShaderResources->BindTexture2D(dummyTexture, 8);
 
 			commandQueue.SetVertexBuffers({ meshComp->mesh->vertexBuffer });
 			commandQueue.SetPipeline(g_viewNormalPipeline);
@@ -0,0 +1,334 @@
+#include "pch.h"
+#include "hotreload.h"
+#include "assetload.h"
+#include "asset.h"
+#include "Image/Image.h"
+#include "Image/ImageCache.h"
+#include "Image/TextureContainer.h"
+#include "Log/Log.h"
+#include "Utils/ThreadPool.h"
+#include "Utils/AssetPack.h"
+#include "Platform/FileWatch.h"
+
+#include <algorithm>
+
+struct WatchedSource {
+    std::string filePath;
+    std::string canonicalPath;
+    std::vector<std::string> dependencies; // canonical paths of the textures a model references
+    PixelFormat pixelFormat = PixelFormat::RGBA8Unorm;
+    float scale = 1.0f;
+    uint32_t reloadSerial = 0; // only the latest reload of an asset is swapped in
+
+    ResidencyHandle residency;
+    uint32_t placeholderColor = 0; // RGBA8 the texture is drawn with while evicted
+};
+
+static std::unordered_map<std::string, Scope<filewatch::FileWatch<std::string>>> g_sourceWatches; // by canonical directory
+static std::unordered_map<std::string, WatchedSource> g_textureSources; // by asset key
+static std::unordered_map<std::string, WatchedSource> g_modelSources; // by asset key
+static std::mutex g_changedSourceMutex;
+static std::unordered_map<std::string, std::chrono::steady_clock::time_point> g_changedSources; // canonical path to its last change
+
+void HotReload_Cleanup() {
+    // NOTE: Joining the watchers first guarantees no change is recorded after the list is cleared
+    g_sourceWatches.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(g_changedSourceMutex);
+        g_changedSources.clear();
+    }
+    g_textureSources.clear();
+    g_modelSources.clear();
+}
+
+void ReadTextureAsync(const std::string& filePath, PixelFormat pixelFormat, std::function<void(const Ref<Texture2D>&, uint32_t)> onLoaded) {
+    g_pendingLoadCount++;
+
+    g_assetThreadPool->EnqueueTask([path = filePath, pixelFormat, onLoaded = std::move(onLoaded)]() {
+        if (TextureContainer::IsContainerFile(path.c_str())) {
+            auto container = CreateRef<TextureContainer>();
+            const bool loaded = container->Load(path.c_str());
+
+            PushFinalizeTask([container, loaded, path, pixelFormat, onLoaded]() {
+                Ref<Texture2D> texture;
+
+                if (loaded) {
+                    texture = CreateContainerTexture(*container, pixelFormat);
+                }
+                else {
+                    Log::Error("Failed to load texture: %s", path.c_str());
+                }
+
+                onLoaded(texture, GetPlaceholderColor(pixelFormat, nullptr));
+                g_pendingLoadCount--;
+            });
+            return;
+        }
+
+        auto image = CreateRef<Image>(path.c_str(), 4);
+
+        auto mipChain = CreateRef<MipChain>();
+        const bool hasMips = GenerateTextureMips(*image, pixelFormat, *mipChain);
+
+        PushFinalizeTask([image, mipChain, hasMips, path, pixelFormat, onLoaded]() {
+            Ref<Texture2D> texture;
+
+            if (image->IsValid()) {
+                texture = CreateTexture(*image, pixelFormat, hasMips ? mipChain.get() : nullptr);
+            }
+            else {
+                Log::Error("Failed to load texture: %s", path.c_str());
+            }
+
+            onLoaded(texture, GetPlaceholderColor(pixelFormat, hasMips ? mipChain.get() : nullptr));
+            g_pendingLoadCount--;
+        });
+    });
+}
+
+void ReadModelAsync(const std::string& filePath, float scale, std::function<void(const Ref<Mesh>&, const ModelLoadData&)> onLoaded) {
+    g_pendingLoadCount++;
+
+    g_assetThreadPool->EnqueueTask([path = filePath, scale, onLoaded = std::move(onLoaded)]() {
+        auto data = CreateRef<ModelLoadData>();
+
+        if (!ReadModel(path.c_str(), scale, *data)) {
+            PushFinalizeTask([data, onLoaded]() {
+                onLoaded(nullptr, *data);
+                g_pendingLoadCount--;
+            });
+            return;
+        }
+
+        // NOTE: One finalize task per texture so a large model is spread over several frames
+        std::vector<std::pair<Ref<Image>, CookedTextureSlot>> images;
+        CollectModelImages(*data, images);
+
+        for (const auto& [image, slot] : images) {
+            if (data->textureCache.find(image) != data->textureCache.end()) {
+                continue;
+            }
+
+            PushFinalizeTask([data, image = image, slot = slot]() {
+                data->textureCache[image] = CreateSharedModelTexture(*data, image, slot);
+            });
+        }
+
+        // NOTE: Staging memory is created on the main thread and filled back on a worker, the mesh is created after the textures
+        // as the last finalize task of the model
+        PushFinalizeTask([data, onLoaded]() {
+            CreateModelStaging(*data);
+
+            g_assetThreadPool->EnqueueTask([data, onLoaded]() {
+                WriteModelGeometry(*data);
+
+                PushFinalizeTask([data, onLoaded]() {
+                    onLoaded(CreateModelMesh(*data), *data);
+                    g_pendingLoadCount--;
+                });
+            });
+        });
+    });
+}
+
+static std::string GetCanonicalSourcePath(const std::filesystem::path& path) {
+    std::error_code ec;
+    std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(path, ec);
+
+    return ec ? path.lexically_normal().generic_string() : canonicalPath.generic_string();
+}
+
+static void WatchSourceDirectory(const std::string& canonicalPath) {
+    const std::string directory = std::filesystem::path(canonicalPath).parent_path().generic_string();
+    if (g_sourceWatches.find(directory) != g_sourceWatches.end()) {
+        return;
+    }
+
+    // NOTE: A directory that can't be watched keeps its empty entry so it is not tried again
+    Scope<filewatch::FileWatch<std::string>>& watch = g_sourceWatches[directory];
+
+    try {
+        watch = CreateScope<filewatch::FileWatch<std::string>>(directory, [directory](const std::string& file, const filewatch::Event event) {
+            if (event == filewatch::Event::removed || event == filewatch::Event::renamed_old) {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(g_changedSourceMutex);
+            g_changedSources[(std::filesystem::path(directory) / file).generic_string()] = std::chrono::steady_clock::now();
+        });
+    }
+    catch (const std::exception& e) {
+        Log::Warn("Failed to watch %s for changes: %s", directory.c_str(), e.what());
+    }
+}
+
+static ResidencyCallbacks GetTextureResidencyCallbacks(const std::string& key);
+static ResidencyCallbacks GetMeshResidencyCallbacks(const std::string& key);
+
+void HotReload_WatchTexture(const std::string& filePath, PixelFormat pixelFormat, const std::string& key, uint32_t placeholderColor) {
+    WatchedSource& source = g_textureSources[key];
+    source.filePath = filePath;
+    source.canonicalPath = GetCanonicalSourcePath(filePath);
+    source.pixelFormat = pixelFormat;
+    source.placeholderColor = placeholderColor;
+
+    Ref<Texture2D> texture = GetTexture2D(key.c_str());
+    if (!Residency_SetResource(source.residency, texture, GetResidentTextureSize(*texture))) {
+        source.residency = Residency_Track(ResidencyCategory::Textures, filePath, texture, GetResidentTextureSize(*texture), GetTextureResidencyCallbacks(key));
+    }
+
+    if (WatchAssetSources) {
+        WatchSourceDirectory(source.canonicalPath);
+    }
+}
+
+void HotReload_WatchModel(const std::string& filePath, float scale, const std::string& key, const ModelLoadData& data) {
+    WatchedSource& source = g_modelSources[key];
+    source.filePath = filePath;
+    source.canonicalPath = GetCanonicalSourcePath(filePath);
+    source.scale = scale;
+
+    Ref<Mesh> mesh = GetMesh(key.c_str());
+    if (!Residency_SetResource(source.residency, mesh, GetResidentMeshSize(*mesh))) {
+        source.residency = Residency_Track(ResidencyCategory::Meshes, filePath, mesh, GetResidentMeshSize(*mesh), GetMeshResidencyCallbacks(key));
+    }
+
+    source.dependencies.clear();
+    for (const auto& [imagePath, image] : data.images) {
+        source.dependencies.push_back(GetCanonicalSourcePath(imagePath));
+    }
+
+    if (WatchAssetSources) {
+        WatchSourceDirectory(source.canonicalPath);
+
+        for (const std::string& dependency : source.dependencies) {
+            WatchSourceDirectory(dependency);
+        }
+    }
+}
+
+// NOTE: Companion files of a model are the ones CookedMesh::ComputeSourceKey hashes along with it, gltf buffers and obj material libraries
+static bool IsSourceChanged(const WatchedSource& source, bool withCompanions, const std::unordered_set<std::string>& changedPaths) {
+    const std::filesystem::path sourcePath(source.canonicalPath);
+
+    for (const std::string& changedPath : changedPaths) {
+        if (changedPath == source.canonicalPath) {
+            return true;
+        }
+
+        if (std::find(source.dependencies.begin(), source.dependencies.end(), changedPath) != source.dependencies.end()) {
+            return true;
+        }
+
+        const std::filesystem::path path(changedPath);
+        if (withCompanions && path.parent_path() == sourcePath.parent_path() && path.stem() == sourcePath.stem()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// NOTE: A reload that fails keeps the asset as it was
+static void ReloadTexture(const std::string& key, WatchedSource& source) {
+    const uint32_t serial = ++source.reloadSerial;
+
+    Log::Info("Reloading texture %s", source.filePath.c_str());
+
+    ReadTextureAsync(source.filePath, source.pixelFormat, [key, serial](const Ref<Texture2D>& texture, uint32_t placeholderColor) {
+        auto sourceIt = g_textureSources.find(key);
+        if (!texture || sourceIt == g_textureSources.end() || sourceIt->second.reloadSerial != serial || !SwapTexture(key, texture)) {
+            return;
+        }
+
+        sourceIt->second.placeholderColor = placeholderColor;
+        Residency_SetResource(sourceIt->second.residency, texture, GetResidentTextureSize(*texture));
+    });
+}
+
+static void ReloadModel(const std::string& key, WatchedSource& source) {
+    const uint32_t serial = ++source.reloadSerial;
+
+    Log::Info("Reloading model %s", source.filePath.c_str());
+
+    ReadModelAsync(source.filePath, source.scale, [key, serial, path = source.filePath, scale = source.scale](const Ref<Mesh>& mesh, const ModelLoadData& data) {
+        auto sourceIt = g_modelSources.find(key);
+        if (!mesh || sourceIt == g_modelSources.end() || sourceIt->second.reloadSerial != serial || !SwapMesh(key, std::move(*mesh))) {
+            return;
+        }
+
+        HotReload_WatchModel(path, scale, key, data);
+    });
+}
+
+static ResidencyCallbacks GetTextureResidencyCallbacks(const std::string& key) {
+    ResidencyCallbacks callbacks;
+    callbacks.evict = [key]() {
+        auto it = g_textureSources.find(key);
+        return it != g_textureSources.end() ? EvictTexture(key, it->second.placeholderColor) : ResidencyEviction{};
+    };
+    callbacks.reload = [key]() {
+        auto it = g_textureSources.find(key);
+        if (it != g_textureSources.end()) {
+            ReloadTexture(key, it->second);
+        }
+    };
+
+    return callbacks;
+}
+
+static ResidencyCallbacks GetMeshResidencyCallbacks(const std::string& key) {
+    ResidencyCallbacks callbacks;
+    callbacks.evict = [key]() { return EvictMesh(key); };
+    // NOTE: ReloadModel swaps the new mesh in and invalidates the render queue, which drops the materials and segments of the old one
+    callbacks.reload = [key]() {
+        auto it = g_modelSources.find(key);
+        if (it != g_modelSources.end()) {
+            ReloadModel(key, it->second);
+        }
+    };
+
+    return callbacks;
+}
+
+void HotReload_Update() {
+    const auto now = std::chrono::steady_clock::now();
+
+    std::unordered_set<std::string> changedPaths;
+    {
+        std::lock_guard<std::mutex> lock(g_changedSourceMutex);
+
+        for (auto it = g_changedSources.begin(); it != g_changedSources.end();) {
+            std::chrono::duration<float, std::milli> quietTime = now - it->second;
+            if (quietTime.count() >= AssetReloadDelayMs) {
+                changedPaths.insert(it->first);
+                it = g_changedSources.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+    }
+
+    if (changedPaths.empty()) {
+        return;
+    }
+
+    for (const std::string& changedPath : changedPaths) {
+        ImageCache::Invalidate(changedPath);
+        AssetFiles::Exclude(changedPath.c_str());
+    }
+
+    for (auto& [key, source] : g_textureSources) {
+        if (GetTexture2D(key.c_str()) && IsSourceChanged(source, false, changedPaths)) {
+            ReloadTexture(key, source);
+        }
+    }
+
+    for (auto& [key, source] : g_modelSources) {
+        if (GetMesh(key.c_str()) && IsSourceChanged(source, true, changedPaths)) {
+            ReloadModel(key, source);
+        }
+    }
+}
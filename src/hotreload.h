@@ -0,0 +1,32 @@
+#pragma once
+
+#include "EngineCore.h"
+
+#include <functional>
+#include <string>
+
+struct ModelLoadData;
+
+// NOTE: Source files of loaded textures and models are watched per directory and reloaded when they change. Editors write a
+// file in several steps, so a file is reloaded only once it has been quiet for AssetReloadDelayMs. The sources are recorded
+// either way, evicted assets are reloaded from them.
+constexpr bool WatchAssetSources = true;
+constexpr float AssetReloadDelayMs = 300.0f;
+
+// NOTE: Stops the watchers, called by Asset_Cleanup before the asset workers are joined
+void HotReload_Cleanup();
+
+// NOTE: Record where the asset registered under key was loaded from and hand it to the residency tracking, a key loaded again
+// keeps its entry. placeholderColor is the RGBA8 the texture is drawn with while evicted.
+void HotReload_WatchTexture(const std::string& filePath, PixelFormat pixelFormat, const std::string& key, uint32_t placeholderColor);
+void HotReload_WatchModel(const std::string& filePath, float scale, const std::string& key, const ModelLoadData& data);
+
+// NOTE: Main thread, called by Asset_Update. Reloads run on the workers like async loads, the new assets are swapped in by
+// their finalize tasks between frames.
+void HotReload_Update();
+
+// NOTE: onLoaded runs on the main thread with the new texture and the color it is evicted to, or with nullptr if the file could not be read
+void ReadTextureAsync(const std::string& filePath, PixelFormat pixelFormat, std::function<void(const Ref<Texture2D>&, uint32_t)> onLoaded);
+
+// NOTE: onLoaded runs on the main thread with the new mesh and the data it was created from, or with nullptr if the model could not be read
+void ReadModelAsync(const std::string& filePath, float scale, std::function<void(const Ref<Mesh>&, const ModelLoadData&)> onLoaded);
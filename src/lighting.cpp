@@ -189,7 +189,7 @@ void Lighting_Render() {
 	dynamicSR->BindTexture2D(gBuffer.ambientOcclusion, 3);
 	dynamicSR->BindTexture2D(GetSSAOTexture(), 4);
 
-	auto quadMesh = GetMesh("quad");
+	auto quadMesh = GetMesh(g_quadMesh);
 
 	auto directLightInstanceVB = g_directLightInstanceDataPool->Get();
 	directLightInstanceVB->Update(&g_directionalLightInstanceData, sizeof(DirectionalLightInstanceData));
@@ -197,9 +197,9 @@ void Lighting_Render() {
 	commandQueue.SetPipeline(g_directionalLightingPipeline);
 	commandQueue.SetShaderResources({ g_lightingStaticSR, dynamicSR });
 	commandQueue.SetVertexBuffers({ quadMesh->vertexBuffer, directLightInstanceVB });
-	commandQueue.DrawIndexedInstanced(quadMesh->indexBuffer, quadMesh->indexBuffer->IndexCount(), 1);
+	commandQueue.DrawIndexedInstanced(quadMesh->indexBuffer, quadMesh->segments[0].indexCount, 1, quadMesh->segments[0].indexOffset, quadMesh->segments[0].vertexOffset);
 	
-	auto sphereMesh = GetMesh("sphere");
+	auto sphereMesh = GetMesh(g_sphereMesh);
 
 	auto pointLightInstanceVB = g_pointLightInstanceDataPool->Get();
 	pointLightInstanceVB->Update(g_pointLightInstanceDatas.data(), sizeof(PointLightInstanceData) * g_pointLightInstanceDatas.size());
@@ -207,5 +207,5 @@ void Lighting_Render() {
 	commandQueue.SetPipeline(g_pointLightingPipeline);
 	commandQueue.SetShaderResources({ g_lightingStaticSR, dynamicSR });
 	commandQueue.SetVertexBuffers({ sphereMesh->vertexBuffer, pointLightInstanceVB });
-	commandQueue.DrawIndexedInstanced(sphereMesh->indexBuffer, sphereMesh->indexBuffer->IndexCount(), g_pointLightInstanceDatas.size());
+	commandQueue.DrawIndexedInstanced(sphereMesh->indexBuffer, sphereMesh->segments[0].indexCount, g_pointLightInstanceDatas.size(), sphereMesh->segments[0].indexOffset, sphereMesh->segments[0].vertexOffset);
 }
\ No newline at end of file
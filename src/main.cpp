@@ -8,38 +8,55 @@
 #include "Time/Time.h"
 #include "Math/Math.h"
 #include "Image/Image.h"
+#include "Image/ImageCache.h"
 #include "Model/Model.h"
 #include "world.h"
 #include "outliner.h"
 #include "sprite.h"
 #include "asset.h"
+#include "streaming.h"
+#include "meshpool.h"
+#include "texturecache.h"
+#include "residency.h"
+#include "shaderreload.h"
+#include "Input/Input.h"
+#include "Utils/AssetPack.h"
 
 using namespace flaw;
 
 int main() {
     World_Init();
+    MeshPool_Init();
     Asset_Init();
+    TextureStreaming_Init();
+    Residency_Init();
 
     srand(static_cast<uint32_t>(time(0)));
 
-    LoadTexture("assets/textures/grass.png", PixelFormat::RGBA8Srgb, "grass");
-    LoadTexture("assets/textures/window.png", PixelFormat::RGBA8Srgb, "window");
-    LoadTexture("assets/textures/haus.jpg", PixelFormat::RGBA8Srgb, "haus");
-    LoadTexture("assets/textures/container2.png", PixelFormat::RGBA8Srgb, "container2");
-    LoadTexture("assets/textures/container2_specular.png", PixelFormat::RGBA8Srgb, "container2_specular");
-	LoadTexture("assets/textures/container2_norm.png", PixelFormat::RGBA8Unorm, "container2_norm");
-	LoadTexture("assets/textures/brickwall.jpg", PixelFormat::RGBA8Srgb, "brickwall");
-	LoadTexture("assets/textures/brickwall_normal.jpg", PixelFormat::RGBA8Unorm, "brickwall_normal");
-	LoadTexture("assets/textures/brickwall_disp.jpg", PixelFormat::RGBA8Unorm, "brickwall_disp");
-	LoadTexture("assets/textures/paving.png", PixelFormat::RGBA8Srgb, "paving");
-	LoadTexture("assets/textures/paving_spec.png", PixelFormat::RGBA8Unorm, "paving_spec");
-	LoadTexture("assets/textures/paving_norm.png", PixelFormat::RGBA8Unorm, "paving_norm");
-
-    LoadModel("assets/models/girl.obj", 1.0f, "girl");
-    LoadModel("assets/models/survival-guitar-backpack/backpack.obj", 1.0f, "survival_backpack");
-    LoadModel("assets/models/Sponza/Sponza.gltf", 0.05f, "sponza");
-    LoadModel("assets/models/planet/planet.obj", 1.0f, "planet");
-	LoadModel("assets/models/rock/rock.obj", 1.0f, "rock");
+    LoadTextureAsync("assets/textures/grass.png", PixelFormat::RGBA8Srgb, "grass");
+    LoadTextureAsync("assets/textures/window.png", PixelFormat::RGBA8Srgb, "window");
+    LoadTextureAsync("assets/textures/haus.jpg", PixelFormat::RGBA8Srgb, "haus");
+    LoadTextureAsync("assets/textures/container2.png", PixelFormat::RGBA8Srgb, "container2");
+    LoadTextureAsync("assets/textures/container2_specular.png", PixelFormat::RGBA8Srgb, "container2_specular");
+	LoadTextureAsync("assets/textures/container2_norm.png", PixelFormat::RGBA8Unorm, "container2_norm");
+	LoadTextureAsync("assets/textures/brickwall.jpg", PixelFormat::RGBA8Srgb, "brickwall");
+	LoadTextureAsync("assets/textures/brickwall_normal.jpg", PixelFormat::RGBA8Unorm, "brickwall_normal");
+	LoadTextureAsync("assets/textures/brickwall_disp.jpg", PixelFormat::RGBA8Unorm, "brickwall_disp");
+	LoadTextureAsync("assets/textures/paving.png", PixelFormat::RGBA8Srgb, "paving");
+	LoadTextureAsync("assets/textures/paving_spec.png", PixelFormat::RGBA8Unorm, "paving_spec");
+	LoadTextureAsync("assets/textures/paving_norm.png", PixelFormat::RGBA8Unorm, "paving_norm");
+
+    LoadModelAsync("assets/models/girl.obj", 1.0f, "girl");
+    LoadModelAsync("assets/models/survival-guitar-backpack/backpack.obj", 1.0f, "survival_backpack");
+    LoadModelAsync("assets/models/Sponza/Sponza.gltf", 0.05f, "sponza");
+    LoadModelAsync("assets/models/planet/planet.obj", 1.0f, "planet");
+	LoadModelAsync("assets/models/rock/rock.obj", 1.0f, "rock");
+
+    // NOTE: Decoding runs on the asset workers while this thread creates the GPU resources as they arrive
+    Asset_WaitForLoads();
+
+    // NOTE: Decoded pixels live on the GPU now, drop the CPU copies shared between models during import
+    ImageCache::Clear();
 
 	std::vector<TexturedVertex> sphereVertices;
 	std::vector<uint32_t> sphereIndices;
@@ -110,8 +127,14 @@ int main() {
     Sprite_Init();
 #if USE_VULKAN
     Geometry_Init();
+    ShaderReload_Init("./assets/shaders");
 #endif
 
+    // NOTE: Compare the I/O time of a run with the pack against one without. The trace lists the files in the order they were
+    // first read, pass it to tools/assetpack with --order so the pack is laid out in that order.
+    AssetFiles::LogReport("Startup");
+    AssetFiles::WriteTrace("assets/cache/load_trace.csv");
+
 	g_camera->SetPosition({ 0.0f, 0.0f, -8.0f });
 
     struct ObjectCreateInfo {
@@ -214,13 +237,42 @@ int main() {
 
         Time::Update();
 
+        Asset_Update();
+        MeshPool_Update();
+#if USE_VULKAN
+        ShaderReload_Update();
+#endif
+
         std::string title = "Flaw Application - FPS: " + std::to_string(Time::FPS()) + " | Delta Time: " + std::to_string(Time::DeltaTime() * 1000.0f) + " ms";
         g_context->SetTitle(title.c_str());
 
         g_camera->OnUpdate();
 
 		World_Update();
+        Residency_Update();
+        TextureStreaming_Update();
         Lighting_Update();
+
+        if (Input::GetKeyDown(KeyCode::R)) {
+            TextureStreaming_LogReport();
+        }
+
+        if (Input::GetKeyDown(KeyCode::M)) {
+            World_LogMeshletReport();
+        }
+
+        if (Input::GetKeyDown(KeyCode::P)) {
+            MeshPool_LogReport();
+        }
+
+        if (Input::GetKeyDown(KeyCode::T)) {
+            TextureCache_LogReport();
+        }
+
+        if (Input::GetKeyDown(KeyCode::G)) {
+            Residency_LogReport();
+        }
+
         Shadow_Update();
 
 		if (g_context->GetWindowSizeState() == WindowSizeState::Minimized) {
@@ -307,6 +359,7 @@ int main() {
     }
 
 #if USE_VULKAN
+    ShaderReload_Cleanup();
     Geometry_Cleanup();
 #endif
     Sprite_Cleanup();
@@ -316,7 +369,10 @@ int main() {
 	Shadow_Cleanup();
 	Lighting_Cleanup();
 	SSAO_Cleanup();
+    Residency_Cleanup();
+    TextureStreaming_Cleanup();
     Asset_Cleanup();
+    MeshPool_Cleanup();
     World_Cleanup();
 
     return 0;
@@ -0,0 +1,392 @@
+#include "pch.h"
+#include "meshpool.h"
+#include "world.h"
+#include "Utils/OffsetAllocator.h"
+#include "Log/Log.h"
+
+// NOTE: Geometry reaches the pages through a temporary buffer. Vulkan copies from host visible memory, DX11 staging buffers
+// cannot carry vertex or index bind flags so a default buffer is the source there.
+#if USE_VULKAN
+constexpr MemoryProperty MeshPoolUploadMemory = MemoryProperty::Staging;
+#else
+constexpr MemoryProperty MeshPoolUploadMemory = MemoryProperty::Static;
+#endif
+
+struct VertexPage {
+    VertexFormat format;
+    uint32_t stride;
+    Ref<VertexBuffer> buffer;
+    Ref<VertexBuffer> colors; // RGBA8 per vertex of the page, created by the first mesh with colors
+    OffsetAllocator allocator;
+};
+
+struct IndexPage {
+    Ref<IndexBuffer> buffer;
+    OffsetAllocator allocator;
+};
+
+struct PendingFree {
+    uint64_t releaseFrame;
+    uint32_t vertexPage;
+    uint32_t vertexOffset;
+    uint32_t vertexCount;
+    uint32_t indexPage;
+    uint32_t indexOffset;
+    uint32_t indexCount;
+};
+
+static std::vector<VertexPage> g_vertexPages;
+static std::vector<IndexPage> g_indexPages;
+static std::vector<PendingFree> g_pendingFrees;
+
+static bool g_meshPoolAlive = false;
+static uint64_t g_meshPoolFrame = 0;
+static uint32_t g_meshPoolMeshCount = 0;
+
+static const char* GetVertexFormatName(VertexFormat format) {
+    switch (format) {
+    case VertexFormat::Textured: return "textured";
+    case VertexFormat::Packed: return "packed";
+    case VertexFormat::PackedQuantized: return "quantized";
+    default: return "unknown";
+    }
+}
+
+MeshPoolAllocation::~MeshPoolAllocation() {
+    // NOTE: Meshes outliving the pool, such as ones still held by objects at shutdown, go away with their pages
+    if (!g_meshPoolAlive) {
+        return;
+    }
+
+    g_pendingFrees.push_back({ g_meshPoolFrame + g_graphicsContext->GetFrameCount(), vertexPage, vertexOffset, vertexCount, indexPage, indexOffset, indexCount });
+    g_meshPoolMeshCount--;
+}
+
+void MeshPool_Init() {
+    g_meshPoolAlive = true;
+    g_meshPoolFrame = 0;
+    g_meshPoolMeshCount = 0;
+}
+
+void MeshPool_Cleanup() {
+    g_meshPoolAlive = false;
+
+    g_pendingFrees.clear();
+    g_vertexPages.clear();
+    g_indexPages.clear();
+}
+
+// NOTE: New pages go to the slots of released ones first, the indices of the pages in use never move
+template<typename Page>
+static uint32_t AddPage(std::vector<Page>& pages, Page&& page) {
+    for (uint32_t i = 0; i < pages.size(); ++i) {
+        if (!pages[i].buffer) {
+            pages[i] = std::move(page);
+            return i;
+        }
+    }
+
+    pages.push_back(std::move(page));
+
+    return static_cast<uint32_t>(pages.size() - 1);
+}
+
+static uint32_t AllocateVertices(VertexFormat format, uint32_t stride, uint32_t vertexCount, uint32_t& outOffset) {
+    for (uint32_t i = 0; i < g_vertexPages.size(); ++i) {
+        VertexPage& page = g_vertexPages[i];
+        if (!page.buffer || page.format != format || page.stride != stride) {
+            continue;
+        }
+
+        outOffset = page.allocator.Allocate(vertexCount);
+        if (outOffset != OffsetAllocator::InvalidOffset) {
+            return i;
+        }
+    }
+
+    const uint32_t capacity = std::max(MeshPoolVertexPageSize / stride, vertexCount);
+
+    VertexBuffer::Descriptor desc;
+    desc.memProperty = MemoryProperty::Static;
+    desc.elmSize = stride;
+    desc.bufferSize = capacity * stride;
+
+    VertexPage page;
+    page.format = format;
+    page.stride = stride;
+    page.buffer = g_graphicsContext->CreateVertexBuffer(desc);
+    page.allocator = OffsetAllocator(capacity);
+
+    outOffset = page.allocator.Allocate(vertexCount);
+
+    Log::Info("Mesh pool: new %s vertex page of %u vertices, %.1f MB", GetVertexFormatName(format), capacity, desc.bufferSize / (1024.0f * 1024.0f));
+
+    return AddPage(g_vertexPages, std::move(page));
+}
+
+static uint32_t AllocateIndices(uint32_t indexCount, uint32_t& outOffset) {
+    for (uint32_t i = 0; i < g_indexPages.size(); ++i) {
+        if (!g_indexPages[i].buffer) {
+            continue;
+        }
+
+        outOffset = g_indexPages[i].allocator.Allocate(indexCount);
+        if (outOffset != OffsetAllocator::InvalidOffset) {
+            return i;
+        }
+    }
+
+    const uint32_t capacity = std::max(MeshPoolIndexPageSize / static_cast<uint32_t>(sizeof(uint32_t)), indexCount);
+
+    IndexBuffer::Descriptor desc;
+    desc.memProperty = MemoryProperty::Static;
+    desc.bufferSize = capacity * sizeof(uint32_t);
+
+    IndexPage page;
+    page.buffer = g_graphicsContext->CreateIndexBuffer(desc);
+    page.allocator = OffsetAllocator(capacity);
+
+    outOffset = page.allocator.Allocate(indexCount);
+
+    Log::Info("Mesh pool: new index page of %u indices, %.1f MB", capacity, desc.bufferSize / (1024.0f * 1024.0f));
+
+    return AddPage(g_indexPages, std::move(page));
+}
+
+// NOTE: Records one copy per buffer from the upload buffers into the ranges allocated for the mesh
+static void CopyToPages(Mesh& mesh, const Ref<VertexBuffer>& vertexUpload, uint32_t vertexStride, uint32_t vertexCount, const Ref<IndexBuffer>& indexUpload, uint32_t indexCount) {
+    uint32_t vertexOffset = 0;
+    uint32_t indexOffset = 0;
+    const uint32_t vertexPage = AllocateVertices(mesh.vertexFormat, vertexStride, vertexCount, vertexOffset);
+    const uint32_t indexPage = AllocateIndices(indexCount, indexOffset);
+
+    vertexUpload->CopyTo(g_vertexPages[vertexPage].buffer, 0, vertexOffset * vertexStride);
+    indexUpload->CopyTo(g_indexPages[indexPage].buffer, 0, indexOffset * sizeof(uint32_t));
+
+    mesh.vertexBuffer = g_vertexPages[vertexPage].buffer;
+    mesh.indexBuffer = g_indexPages[indexPage].buffer;
+
+    // NOTE: Draws reach the mesh through base vertex and first index, nothing else about the segments changes
+    for (MeshSegment& segment : mesh.segments) {
+        segment.vertexOffset += vertexOffset;
+        segment.indexOffset += indexOffset;
+    }
+
+    mesh.poolAllocation = CreateRef<MeshPoolAllocation>();
+    mesh.poolAllocation->vertexPage = vertexPage;
+    mesh.poolAllocation->vertexOffset = vertexOffset;
+    mesh.poolAllocation->vertexCount = vertexCount;
+    mesh.poolAllocation->indexPage = indexPage;
+    mesh.poolAllocation->indexOffset = indexOffset;
+    mesh.poolAllocation->indexCount = indexCount;
+
+    g_meshPoolMeshCount++;
+}
+
+bool MeshPool_Upload(Mesh& mesh, uint32_t vertexStride, const void* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount) {
+    if (!g_meshPoolAlive || vertexStride == 0 || vertexCount == 0 || indexCount == 0) {
+        return false;
+    }
+
+    VertexBuffer::Descriptor vertexUploadDesc;
+    vertexUploadDesc.memProperty = MeshPoolUploadMemory;
+    vertexUploadDesc.elmSize = vertexStride;
+    vertexUploadDesc.bufferSize = vertexCount * vertexStride;
+    vertexUploadDesc.initialData = vertices;
+
+    IndexBuffer::Descriptor indexUploadDesc;
+    indexUploadDesc.memProperty = MeshPoolUploadMemory;
+    indexUploadDesc.bufferSize = indexCount * sizeof(uint32_t);
+    indexUploadDesc.initialData = indices;
+
+    CopyToPages(mesh, g_graphicsContext->CreateVertexBuffer(vertexUploadDesc), vertexStride, vertexCount, g_graphicsContext->CreateIndexBuffer(indexUploadDesc), indexCount);
+
+    return true;
+}
+
+bool MeshPool_UploadColors(Mesh& mesh, const uint32_t* colors) {
+    if (!g_meshPoolAlive || !mesh.poolAllocation) {
+        return false;
+    }
+
+    const MeshPoolAllocation& allocation = *mesh.poolAllocation;
+    VertexPage& page = g_vertexPages[allocation.vertexPage];
+
+    if (!page.colors) {
+        VertexBuffer::Descriptor desc;
+        desc.memProperty = MemoryProperty::Static;
+        desc.elmSize = sizeof(uint32_t);
+        desc.bufferSize = page.allocator.GetCapacity() * sizeof(uint32_t);
+
+        page.colors = g_graphicsContext->CreateVertexBuffer(desc);
+
+        Log::Info("Mesh pool: new color stream for a %s vertex page, %.1f MB", GetVertexFormatName(page.format), desc.bufferSize / (1024.0f * 1024.0f));
+    }
+
+    VertexBuffer::Descriptor uploadDesc;
+    uploadDesc.memProperty = MeshPoolUploadMemory;
+    uploadDesc.elmSize = sizeof(uint32_t);
+    uploadDesc.bufferSize = allocation.vertexCount * sizeof(uint32_t);
+    uploadDesc.initialData = colors;
+
+    g_graphicsContext->CreateVertexBuffer(uploadDesc)->CopyTo(page.colors, 0, allocation.vertexOffset * sizeof(uint32_t));
+
+    mesh.colorBuffer = page.colors;
+    mesh.poolAllocation->hasColors = true;
+
+    return true;
+}
+
+bool MeshPool_CreateStaging(VertexFormat format, uint32_t vertexStride, uint32_t vertexCount, uint32_t indexCount, MeshPoolStaging& outStaging) {
+    if (!g_meshPoolAlive || MeshPoolUploadMemory != MemoryProperty::Staging || vertexStride == 0 || vertexCount == 0 || indexCount == 0) {
+        return false;
+    }
+
+    VertexBuffer::Descriptor vertexDesc;
+    vertexDesc.memProperty = MemoryProperty::Staging;
+    vertexDesc.elmSize = vertexStride;
+    vertexDesc.bufferSize = vertexCount * vertexStride;
+
+    IndexBuffer::Descriptor indexDesc;
+    indexDesc.memProperty = MemoryProperty::Staging;
+    indexDesc.bufferSize = indexCount * sizeof(uint32_t);
+
+    MeshPoolStaging staging;
+    staging.format = format;
+    staging.vertexStride = vertexStride;
+    staging.vertexCount = vertexCount;
+    staging.indexCount = indexCount;
+    staging.vertexBuffer = g_graphicsContext->CreateVertexBuffer(vertexDesc);
+    staging.indexBuffer = g_graphicsContext->CreateIndexBuffer(indexDesc);
+    staging.vertices = staging.vertexBuffer->GetMappedData();
+    staging.indices = staging.indexBuffer->GetMappedData();
+
+    if (!staging.vertices || !staging.indices) {
+        return false;
+    }
+
+    outStaging = std::move(staging);
+
+    return true;
+}
+
+bool MeshPool_UploadStaging(Mesh& mesh, MeshPoolStaging& staging) {
+    if (!g_meshPoolAlive || !staging.vertexBuffer || !staging.indexBuffer) {
+        return false;
+    }
+
+    mesh.vertexFormat = staging.format;
+
+    CopyToPages(mesh, staging.vertexBuffer, staging.vertexStride, staging.vertexCount, staging.indexBuffer, staging.indexCount);
+
+    staging = MeshPoolStaging();
+
+    return true;
+}
+
+void MeshPool_Update() {
+    g_meshPoolFrame++;
+
+    for (uint32_t i = 0; i < g_pendingFrees.size();) {
+        const PendingFree& pending = g_pendingFrees[i];
+        if (pending.releaseFrame > g_meshPoolFrame) {
+            ++i;
+            continue;
+        }
+
+        g_vertexPages[pending.vertexPage].allocator.Free(pending.vertexOffset, pending.vertexCount);
+        g_indexPages[pending.indexPage].allocator.Free(pending.indexOffset, pending.indexCount);
+
+        g_pendingFrees[i] = g_pendingFrees.back();
+        g_pendingFrees.pop_back();
+    }
+}
+
+uint64_t MeshPool_GetAllocationSize(const MeshPoolAllocation& allocation) {
+    if (allocation.vertexPage >= g_vertexPages.size()) {
+        return 0;
+    }
+
+    const uint32_t vertexSize = g_vertexPages[allocation.vertexPage].stride + (allocation.hasColors ? sizeof(uint32_t) : 0);
+
+    return static_cast<uint64_t>(allocation.vertexCount) * vertexSize + static_cast<uint64_t>(allocation.indexCount) * sizeof(uint32_t);
+}
+
+uint64_t MeshPool_GetPageBytes() {
+    uint64_t bytes = 0;
+
+    for (const VertexPage& page : g_vertexPages) {
+        if (page.buffer) {
+            bytes += static_cast<uint64_t>(page.allocator.GetCapacity()) * page.stride;
+        }
+
+        if (page.colors) {
+            bytes += static_cast<uint64_t>(page.allocator.GetCapacity()) * sizeof(uint32_t);
+        }
+    }
+
+    for (const IndexPage& page : g_indexPages) {
+        if (page.buffer) {
+            bytes += static_cast<uint64_t>(page.allocator.GetCapacity()) * sizeof(uint32_t);
+        }
+    }
+
+    return bytes;
+}
+
+void MeshPool_ReleaseEmptyPages() {
+    for (VertexPage& page : g_vertexPages) {
+        if (page.buffer && page.allocator.GetUsed() == 0) {
+            Log::Info("Mesh pool: released empty %s vertex page, %.1f MB", GetVertexFormatName(page.format), page.allocator.GetCapacity() * page.stride / (1024.0f * 1024.0f));
+            page.buffer.reset();
+            page.colors.reset();
+            page.allocator = OffsetAllocator();
+        }
+    }
+
+    for (IndexPage& page : g_indexPages) {
+        if (page.buffer && page.allocator.GetUsed() == 0) {
+            Log::Info("Mesh pool: released empty index page, %.1f MB", page.allocator.GetCapacity() * sizeof(uint32_t) / (1024.0f * 1024.0f));
+            page.buffer.reset();
+            page.allocator = OffsetAllocator();
+        }
+    }
+}
+
+void MeshPool_LogReport() {
+    constexpr float MB = 1024.0f * 1024.0f;
+
+    Log::Info("Mesh pool: %u meshes in %u vertex pages and %u index pages, %.1f MB", g_meshPoolMeshCount, static_cast<uint32_t>(g_vertexPages.size()), static_cast<uint32_t>(g_indexPages.size()), MeshPool_GetPageBytes() / MB);
+
+    for (const VertexPage& page : g_vertexPages) {
+        if (!page.buffer) {
+            continue;
+        }
+
+        const OffsetAllocator& allocator = page.allocator;
+        Log::Info("  %s vertices%s: %u of %u used (%.1f of %.1f MB), %u free ranges, largest %u",
+            GetVertexFormatName(page.format),
+            page.colors ? " with colors" : "",
+            allocator.GetUsed(),
+            allocator.GetCapacity(),
+            allocator.GetUsed() * page.stride / MB,
+            allocator.GetCapacity() * page.stride / MB,
+            allocator.GetFreeRangeCount(),
+            allocator.GetLargestFree());
+    }
+
+    for (const IndexPage& page : g_indexPages) {
+        if (!page.buffer) {
+            continue;
+        }
+
+        const OffsetAllocator& allocator = page.allocator;
+        Log::Info("  indices: %u of %u used (%.1f of %.1f MB), %u free ranges, largest %u",
+            allocator.GetUsed(),
+            allocator.GetCapacity(),
+            allocator.GetUsed() * sizeof(uint32_t) / MB,
+            allocator.GetCapacity() * sizeof(uint32_t) / MB,
+            allocator.GetFreeRangeCount(),
+            allocator.GetLargestFree());
+    }
+}
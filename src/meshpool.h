@@ -0,0 +1,64 @@
+#pragma once
+
+#include "EngineCore.h"
+
+// NOTE: Pages are sized in bytes, vertex pages hold as many whole vertices of their format as fit. A mesh larger than a page gets a page of its own.
+constexpr uint32_t MeshPoolVertexPageSize = 64 * 1024 * 1024;
+constexpr uint32_t MeshPoolIndexPageSize = 32 * 1024 * 1024;
+
+// NOTE: Ranges of a mesh in the pool pages, given back when the last reference to the mesh goes away
+struct MeshPoolAllocation {
+    uint32_t vertexPage;
+    uint32_t vertexOffset;
+    uint32_t vertexCount;
+    uint32_t indexPage;
+    uint32_t indexOffset;
+    uint32_t indexCount;
+    bool hasColors = false;
+
+    ~MeshPoolAllocation();
+};
+
+// NOTE: Upload memory a loader writes geometry into directly, sized from the vertex and index counts before any of it is converted
+struct MeshPoolStaging {
+    VertexFormat format = VertexFormat::Textured;
+    uint32_t vertexStride = 0;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+
+    Ref<VertexBuffer> vertexBuffer;
+    Ref<IndexBuffer> indexBuffer;
+
+    // NOTE: Mapped memory of the buffers, may be filled from any thread until MeshPool_UploadStaging
+    void* vertices = nullptr;
+    uint32_t* indices = nullptr;
+};
+
+void MeshPool_Init();
+void MeshPool_Cleanup();
+
+// NOTE: Copies the geometry into pages shared by every mesh of the same vertex format. Call once the segments are filled in,
+// mesh.vertexBuffer and mesh.indexBuffer are set to the pages and the segment offsets are moved by where the mesh landed.
+bool MeshPool_Upload(Mesh& mesh, uint32_t vertexStride, const void* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount);
+
+// NOTE: Writes RGBA8 colors for the vertices of a pooled mesh to the color stream of its page, which is created on first use and
+// indexed like the page itself. mesh.colorBuffer is set to it, meshes without colors leave it unset and never bind it.
+bool MeshPool_UploadColors(Mesh& mesh, const uint32_t* colors);
+
+// NOTE: Main thread only. False where the backend keeps no upload memory mapped, the geometry then goes through MeshPool_Upload.
+bool MeshPool_CreateStaging(VertexFormat format, uint32_t vertexStride, uint32_t vertexCount, uint32_t indexCount, MeshPoolStaging& outStaging);
+
+// NOTE: Main thread only. MeshPool_Upload for geometry already written to the staging memory, which is released once its copies are recorded.
+bool MeshPool_UploadStaging(Mesh& mesh, MeshPoolStaging& staging);
+
+// NOTE: Freed ranges are reused only after the frames in flight that may still draw from them are done
+void MeshPool_Update();
+
+// NOTE: Bytes of the pages the allocation takes a range of, its share of the pool
+uint64_t MeshPool_GetAllocationSize(const MeshPoolAllocation& allocation);
+uint64_t MeshPool_GetPageBytes();
+
+// NOTE: Gives the buffers of pages nothing is allocated from back, their slots are taken by the next pages created
+void MeshPool_ReleaseEmptyPages();
+
+void MeshPool_LogReport();
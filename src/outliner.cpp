@@ -9,9 +9,9 @@ static Ref<ShaderResources> g_staticShaderResources;
 static Ref<ShaderResourcesLayout> g_dynamicShaderResourcesLayout;
 static std::vector<std::vector<Ref<ShaderResources>>> g_dynamicShaderResourcesPerFrame;
 static uint32_t g_dynamicShaderResourcesUsed = 0;
-static Ref<GraphicsPipeline> g_writeStencilPipeline;
-static Ref<GraphicsPipeline> g_outlinePipeline;
-static Ref<GraphicsPipeline> g_cleareStencilPipeline;
+static std::array<Ref<GraphicsPipeline>, static_cast<size_t>(VertexFormat::Count)> g_writeStencilPipelines;
+static std::array<Ref<GraphicsPipeline>, static_cast<size_t>(VertexFormat::Count)> g_outlinePipelines;
+static std::array<Ref<GraphicsPipeline>, static_cast<size_t>(VertexFormat::Count)> g_cleareStencilPipelines;
 
 const uint32_t cameraConstantsCBBinding = 0;
 const uint32_t objectConstantsCBBinding = 0;
@@ -43,84 +43,95 @@ void Outliner_Init() {
 
 	g_dynamicShaderResourcesPerFrame.resize(g_graphicsContext->GetFrameCount());
 
-	// NOTE: Create pipelines
-	GraphicsShader::Descriptor objectShaderDesc;
+	// NOTE: Create pipelines, one set per vertex format the meshes may use
+	for (uint32_t i = 0; i < static_cast<uint32_t>(VertexFormat::Count); i++) {
+		const VertexFormat format = static_cast<VertexFormat>(i);
+		if (!IsVertexFormatSupported(format)) {
+			continue;
+		}
+
+		GraphicsShader::Descriptor objectShaderDesc;
 #if USE_VULKAN
-	objectShaderDesc.vertexShaderFile = "assets/shaders/object.vert.spv";
-	objectShaderDesc.vertexShaderEntry = "main";
+		objectShaderDesc.vertexShaderFile = GetVertexShaderPath("object", format);
+		objectShaderDesc.vertexShaderEntry = "main";
 #else USE_DX11
-	objectShaderDesc.vertexShaderFile = "assets/shaders/object.fx";
-	objectShaderDesc.vertexShaderEntry = "VSMain";
+		objectShaderDesc.vertexShaderFile = "assets/shaders/object.fx";
+		objectShaderDesc.vertexShaderEntry = "VSMain";
 #endif
 
-	auto objectShader = g_graphicsContext->CreateGraphicsShader(objectShaderDesc);
-
-	GraphicsPipeline::StencilOperation stencilOp;
-	stencilOp.failOp = StencilOp::Keep;
-	stencilOp.depthFailOp = StencilOp::Keep;
-	stencilOp.passOp = StencilOp::Replace;
-	stencilOp.compareOp = CompareOp::Always;
-	stencilOp.reference = 1;
-
-	g_writeStencilPipeline = g_graphicsContext->CreateGraphicsPipeline();
-	g_writeStencilPipeline->SetShader(objectShader);
-	g_writeStencilPipeline->SetRenderPass(g_sceneRenderPass, 0);
-	g_writeStencilPipeline->EnableDepthTest(false);
-	g_writeStencilPipeline->EnableStencilTest(true);
-	g_writeStencilPipeline->SetStencilTest(stencilOp, stencilOp);
-	g_writeStencilPipeline->EnableBlendMode(0, false);
-	g_writeStencilPipeline->SetShaderResourcesLayouts({ g_staticShaderResourcesLayout, g_dynamicShaderResourcesLayout });
-	g_writeStencilPipeline->SetVertexInputLayouts({ g_texturedVertexInputLayout });
-	g_writeStencilPipeline->SetBehaviorStates(GraphicsPipeline::Behavior::AutoResizeViewport | GraphicsPipeline::Behavior::AutoResizeScissor);
-
-	GraphicsShader::Descriptor outlineShaderDesc;
+		auto objectShader = g_graphicsContext->CreateGraphicsShader(objectShaderDesc);
+
+		GraphicsPipeline::StencilOperation stencilOp;
+		stencilOp.failOp = StencilOp::Keep;
+		stencilOp.depthFailOp = StencilOp::Keep;
+		stencilOp.passOp = StencilOp::Replace;
+		stencilOp.compareOp = CompareOp::Always;
+		stencilOp.reference = 1;
+
+		auto writeStencilPipeline = g_graphicsContext->CreateGraphicsPipeline();
+		writeStencilPipeline->SetShader(objectShader);
+		writeStencilPipeline->SetRenderPass(g_sceneRenderPass, 0);
+		writeStencilPipeline->EnableDepthTest(false);
+		writeStencilPipeline->EnableStencilTest(true);
+		writeStencilPipeline->SetStencilTest(stencilOp, stencilOp);
+		writeStencilPipeline->EnableBlendMode(0, false);
+		writeStencilPipeline->SetShaderResourcesLayouts({ g_staticShaderResourcesLayout, g_dynamicShaderResourcesLayout });
+		writeStencilPipeline->SetVertexInputLayouts({ GetVertexInputLayout(format) });
+		writeStencilPipeline->SetBehaviorStates(GraphicsPipeline::Behavior::AutoResizeViewport | GraphicsPipeline::Behavior::AutoResizeScissor);
+
+		GraphicsShader::Descriptor outlineShaderDesc;
 #if USE_VULKAN
-	outlineShaderDesc.vertexShaderFile = "assets/shaders/outline.vert.spv";
-	outlineShaderDesc.vertexShaderEntry = "main";
-	outlineShaderDesc.pixelShaderFile = "assets/shaders/outline.frag.spv";
-	outlineShaderDesc.pixelShaderEntry = "main";
+		outlineShaderDesc.vertexShaderFile = GetVertexShaderPath("outline", format);
+		outlineShaderDesc.vertexShaderEntry = "main";
+		outlineShaderDesc.pixelShaderFile = "assets/shaders/outline.frag.spv";
+		outlineShaderDesc.pixelShaderEntry = "main";
 #else USE_DX11
-	outlineShaderDesc.vertexShaderFile = "assets/shaders/outline.fx";
-	outlineShaderDesc.vertexShaderEntry = "VSMain";
-	outlineShaderDesc.pixelShaderFile = "assets/shaders/outline.fx";
-	outlineShaderDesc.pixelShaderEntry = "PSMain";
+		outlineShaderDesc.vertexShaderFile = "assets/shaders/outline.fx";
+		outlineShaderDesc.vertexShaderEntry = "VSMain";
+		outlineShaderDesc.pixelShaderFile = "assets/shaders/outline.fx";
+		outlineShaderDesc.pixelShaderEntry = "PSMain";
 #endif
 
-	auto outlineShader = g_graphicsContext->CreateGraphicsShader(outlineShaderDesc);
-
-	stencilOp.failOp = StencilOp::Keep;
-	stencilOp.depthFailOp = StencilOp::Keep;
-	stencilOp.passOp = StencilOp::Keep;
-	stencilOp.compareOp = CompareOp::NotEqual;
-	stencilOp.reference = 1;
-
-	g_outlinePipeline = g_graphicsContext->CreateGraphicsPipeline();
-	g_outlinePipeline->SetShader(outlineShader);
-	g_outlinePipeline->SetRenderPass(g_sceneRenderPass, 0);
-	g_outlinePipeline->EnableBlendMode(0, true);
-	g_outlinePipeline->SetBlendMode(0, BlendMode::Default);
-	g_outlinePipeline->EnableStencilTest(true);
-	g_outlinePipeline->SetStencilTest(stencilOp, stencilOp);
-	g_outlinePipeline->SetShaderResourcesLayouts({ g_staticShaderResourcesLayout, g_dynamicShaderResourcesLayout });
-	g_outlinePipeline->SetVertexInputLayouts({ g_texturedVertexInputLayout });
-	g_outlinePipeline->SetBehaviorStates(GraphicsPipeline::Behavior::AutoResizeViewport | GraphicsPipeline::Behavior::AutoResizeScissor);
-
-	stencilOp.failOp = StencilOp::Keep;
-	stencilOp.depthFailOp = StencilOp::Keep;
-	stencilOp.passOp = StencilOp::Replace;
-	stencilOp.compareOp = CompareOp::Always;
-	stencilOp.reference = 0;
-
-	g_cleareStencilPipeline = g_graphicsContext->CreateGraphicsPipeline();
-	g_cleareStencilPipeline->SetShader(objectShader);
-	g_cleareStencilPipeline->SetRenderPass(g_sceneRenderPass, 0);
-	g_cleareStencilPipeline->EnableDepthTest(false);
-	g_cleareStencilPipeline->EnableStencilTest(true);
-	g_cleareStencilPipeline->SetStencilTest(stencilOp, stencilOp);
-	g_cleareStencilPipeline->EnableBlendMode(0, false);
-	g_cleareStencilPipeline->SetShaderResourcesLayouts({ g_staticShaderResourcesLayout, g_dynamicShaderResourcesLayout });
-	g_cleareStencilPipeline->SetVertexInputLayouts({ g_texturedVertexInputLayout });
-	g_cleareStencilPipeline->SetBehaviorStates(GraphicsPipeline::Behavior::AutoResizeViewport | GraphicsPipeline::Behavior::AutoResizeScissor);
+		auto outlineShader = g_graphicsContext->CreateGraphicsShader(outlineShaderDesc);
+
+		stencilOp.failOp = StencilOp::Keep;
+		stencilOp.depthFailOp = StencilOp::Keep;
+		stencilOp.passOp = StencilOp::Keep;
+		stencilOp.compareOp = CompareOp::NotEqual;
+		stencilOp.reference = 1;
+
+		auto outlinePipeline = g_graphicsContext->CreateGraphicsPipeline();
+		outlinePipeline->SetShader(outlineShader);
+		outlinePipeline->SetRenderPass(g_sceneRenderPass, 0);
+		outlinePipeline->EnableBlendMode(0, true);
+		outlinePipeline->SetBlendMode(0, BlendMode::Default);
+		outlinePipeline->EnableStencilTest(true);
+		outlinePipeline->SetStencilTest(stencilOp, stencilOp);
+		outlinePipeline->SetShaderResourcesLayouts({ g_staticShaderResourcesLayout, g_dynamicShaderResourcesLayout });
+		outlinePipeline->SetVertexInputLayouts({ GetVertexInputLayout(format) });
+		outlinePipeline->SetBehaviorStates(GraphicsPipeline::Behavior::AutoResizeViewport | GraphicsPipeline::Behavior::AutoResizeScissor);
+
+		stencilOp.failOp = StencilOp::Keep;
+		stencilOp.depthFailOp = StencilOp::Keep;
+		stencilOp.passOp = StencilOp::Replace;
+		stencilOp.compareOp = CompareOp::Always;
+		stencilOp.reference = 0;
+
+		auto cleareStencilPipeline = g_graphicsContext->CreateGraphicsPipeline();
+		cleareStencilPipeline->SetShader(objectShader);
+		cleareStencilPipeline->SetRenderPass(g_sceneRenderPass, 0);
+		cleareStencilPipeline->EnableDepthTest(false);
+		cleareStencilPipeline->EnableStencilTest(true);
+		cleareStencilPipeline->SetStencilTest(stencilOp, stencilOp);
+		cleareStencilPipeline->EnableBlendMode(0, false);
+		cleareStencilPipeline->SetShaderResourcesLayouts({ g_staticShaderResourcesLayout, g_dynamicShaderResourcesLayout });
+		cleareStencilPipeline->SetVertexInputLayouts({ GetVertexInputLayout(format) });
+		cleareStencilPipeline->SetBehaviorStates(GraphicsPipeline::Behavior::AutoResizeViewport | GraphicsPipeline::Behavior::AutoResizeScissor);
+
+		g_writeStencilPipelines[i] = writeStencilPipeline;
+		g_outlinePipelines[i] = outlinePipeline;
+		g_cleareStencilPipelines[i] = cleareStencilPipeline;
+	}
 }
 
 void Outliner_Cleanup() {
@@ -129,9 +140,9 @@ void Outliner_Cleanup() {
 	g_staticShaderResources.reset();
 	g_dynamicShaderResourcesLayout.reset();
 	g_dynamicShaderResourcesPerFrame.clear();
-	g_writeStencilPipeline.reset();
-	g_outlinePipeline.reset();
-	g_cleareStencilPipeline.reset();
+	g_writeStencilPipelines.fill(nullptr);
+	g_outlinePipelines.fill(nullptr);
+	g_cleareStencilPipelines.fill(nullptr);
 }
 
 static Ref<ShaderResources> GetDynamicShaderResources(uint32_t frameIndex) {
@@ -171,27 +182,42 @@ void Outliner_Render() {
 
 		auto meshComp = object.GetComponent<StaticMeshComponent>();
 
+		// NOTE: Evicted meshes have nothing to draw until they are reloaded
+		if (!meshComp->mesh->vertexBuffer) {
+			continue;
+		}
+
 		auto dynamicResources = GetDynamicShaderResources(frameIndex);
 		auto objectConstantsCB = GetObjectConstantsCB(frameIndex);
 
 		dynamicResources->BindConstantBuffer(objectConstantsCB, objectConstantsCBBinding);
 
+		const auto& mesh = meshComp->mesh;
+		const size_t formatIndex = static_cast<size_t>(mesh->vertexFormat);
+
 		ObjectConstants objectConstants;
 		objectConstants.model_matrix = ModelMatrix(object.position, object.rotation, object.scale);
 		objectConstants.inv_model_matrix = glm::inverse(objectConstants.model_matrix);
+		objectConstants.model_matrix = objectConstants.model_matrix * mesh->positionDecode;
 
 		objectConstantsCB->Update(&objectConstants, sizeof(ObjectConstants));
 
-		commandQueue.SetPipeline(g_writeStencilPipeline);
-		commandQueue.SetVertexBuffers({ meshComp->mesh->vertexBuffer });
+		auto drawSegments = [&]() {
+			for (const auto& segment : mesh->segments) {
+				commandQueue.DrawIndexed(mesh->indexBuffer, segment.indexCount, segment.indexOffset, segment.vertexOffset);
+			}
+		};
+
+		commandQueue.SetPipeline(g_writeStencilPipelines[formatIndex]);
+		commandQueue.SetVertexBuffers({ mesh->vertexBuffer });
 		commandQueue.SetShaderResources({ g_staticShaderResources, dynamicResources });
-		commandQueue.DrawIndexed(meshComp->mesh->indexBuffer, meshComp->mesh->indexBuffer->IndexCount());
+		drawSegments();
 
-		commandQueue.SetPipeline(g_outlinePipeline);
-		commandQueue.DrawIndexed(meshComp->mesh->indexBuffer, meshComp->mesh->indexBuffer->IndexCount());
+		commandQueue.SetPipeline(g_outlinePipelines[formatIndex]);
+		drawSegments();
 
-		commandQueue.SetPipeline(g_cleareStencilPipeline);
-		commandQueue.DrawIndexed(meshComp->mesh->indexBuffer, meshComp->mesh->indexBuffer->IndexCount());
+		commandQueue.SetPipeline(g_cleareStencilPipelines[formatIndex]);
+		drawSegments();
 	}
 }
 
@@ -0,0 +1,353 @@
+#include "pch.h"
+#include "residency.h"
+#include "streaming.h"
+#include "meshpool.h"
+#include "Log/Log.h"
+
+// NOTE: An asset drawn within this many frames is never evicted, so what is on screen is not thrown out and reloaded every frame
+constexpr uint64_t ResidencyEvictDelayFrames = 300;
+
+// NOTE: A reload that has not brought the asset back by then, as when its source failed to load, is tried again
+constexpr uint64_t ResidencyReloadRetryFrames = 600;
+
+struct ResidentAsset {
+    ResidencyCategory category = ResidencyCategory::Textures;
+    std::string name;
+    std::weak_ptr<void> resource;
+    const void* resourceKey = nullptr;
+    uint64_t bytes = 0;
+    uint64_t lastUsedFrame = 0;
+    uint64_t reloadFrame = 0;
+    bool evicted = false;
+    bool reloading = false;
+    ResidencyCallbacks callbacks;
+
+    uint32_t generation = 0;
+    bool tracked = false;
+};
+
+static std::vector<ResidentAsset> g_residentAssets;
+static std::vector<uint32_t> g_freeResidentAssets;
+static std::unordered_map<const void*, uint32_t> g_residentAssetIndices; // by resource
+
+static uint64_t g_residencyBudget = DefaultGpuMemoryBudget;
+static uint64_t g_residencyFrame = 1;
+static std::array<ResidencyCategoryStats, static_cast<size_t>(ResidencyCategory::Count)> g_residencyCounters; // evictions and reloads
+
+static const char* GetResidencyCategoryName(ResidencyCategory category) {
+    switch (category) {
+    case ResidencyCategory::Textures: return "textures";
+    case ResidencyCategory::StreamedTextures: return "streamed textures";
+    case ResidencyCategory::Meshes: return "meshes";
+    default: return "unknown";
+    }
+}
+
+static ResidentAsset* GetResidentAsset(ResidencyHandle handle) {
+    if (handle.index >= g_residentAssets.size()) {
+        return nullptr;
+    }
+
+    ResidentAsset& asset = g_residentAssets[handle.index];
+    if (!asset.tracked || asset.generation != handle.generation) {
+        return nullptr;
+    }
+
+    return &asset;
+}
+
+static void SetResidentAssetKey(uint32_t index, const void* resourceKey) {
+    ResidentAsset& asset = g_residentAssets[index];
+
+    auto it = g_residentAssetIndices.find(asset.resourceKey);
+    if (it != g_residentAssetIndices.end() && it->second == index) {
+        g_residentAssetIndices.erase(it);
+    }
+
+    asset.resourceKey = resourceKey;
+    if (resourceKey) {
+        g_residentAssetIndices[resourceKey] = index;
+    }
+}
+
+static void UntrackResidentAsset(uint32_t index) {
+    SetResidentAssetKey(index, nullptr);
+
+    ResidentAsset& asset = g_residentAssets[index];
+    asset.tracked = false;
+    asset.generation++;
+    asset.resource.reset();
+    asset.callbacks = {};
+    asset.name.clear();
+
+    g_freeResidentAssets.push_back(index);
+}
+
+void Residency_Init(uint64_t budgetBytes) {
+    g_residencyBudget = budgetBytes;
+    g_residencyFrame = 1;
+    g_residencyCounters = {};
+}
+
+void Residency_Cleanup() {
+    g_residentAssetIndices.clear();
+    g_freeResidentAssets.clear();
+    g_residentAssets.clear();
+}
+
+ResidencyHandle Residency_Track(ResidencyCategory category, const std::string& name, const Ref<void>& resource, uint64_t bytes, ResidencyCallbacks callbacks) {
+    if (!resource) {
+        return ResidencyHandle();
+    }
+
+    ResidencyHandle handle;
+    if (!g_freeResidentAssets.empty()) {
+        handle.index = g_freeResidentAssets.back();
+        g_freeResidentAssets.pop_back();
+    }
+    else {
+        handle.index = static_cast<uint32_t>(g_residentAssets.size());
+        g_residentAssets.emplace_back();
+    }
+
+    ResidentAsset& asset = g_residentAssets[handle.index];
+    asset.category = category;
+    asset.name = name;
+    asset.resource = resource;
+    asset.bytes = bytes;
+    asset.lastUsedFrame = g_residencyFrame;
+    asset.reloadFrame = 0;
+    asset.evicted = false;
+    asset.reloading = false;
+    asset.callbacks = std::move(callbacks);
+    asset.tracked = true;
+    handle.generation = asset.generation;
+
+    SetResidentAssetKey(handle.index, resource.get());
+
+    return handle;
+}
+
+void Residency_Untrack(ResidencyHandle handle) {
+    if (GetResidentAsset(handle)) {
+        UntrackResidentAsset(handle.index);
+    }
+}
+
+bool Residency_SetResource(ResidencyHandle handle, const Ref<void>& resource, uint64_t bytes) {
+    ResidentAsset* asset = GetResidentAsset(handle);
+    if (!asset || !resource) {
+        return false;
+    }
+
+    if (asset->evicted) {
+        g_residencyCounters[static_cast<size_t>(asset->category)].reloads++;
+    }
+
+    asset->resource = resource;
+    asset->bytes = bytes;
+    asset->evicted = false;
+    asset->reloading = false;
+
+    SetResidentAssetKey(handle.index, resource.get());
+
+    return true;
+}
+
+void Residency_MarkUsed(const void* resource) {
+    auto it = g_residentAssetIndices.find(resource);
+    if (it != g_residentAssetIndices.end()) {
+        g_residentAssets[it->second].lastUsedFrame = g_residencyFrame;
+    }
+}
+
+// NOTE: Assets go away with their resource, as when their model is released or reloaded
+static void ReleaseExpiredAssets() {
+    for (uint32_t i = 0; i < g_residentAssets.size(); ++i) {
+        if (g_residentAssets[i].tracked && g_residentAssets[i].resource.expired()) {
+            UntrackResidentAsset(i);
+        }
+    }
+}
+
+static void ReloadUsedAssets() {
+    for (uint32_t i = 0; i < g_residentAssets.size(); ++i) {
+        ResidentAsset& asset = g_residentAssets[i];
+        if (!asset.tracked || !asset.evicted || asset.lastUsedFrame != g_residencyFrame || !asset.callbacks.reload) {
+            continue;
+        }
+
+        if (asset.reloading && g_residencyFrame - asset.reloadFrame < ResidencyReloadRetryFrames) {
+            continue;
+        }
+
+        asset.reloading = true;
+        asset.reloadFrame = g_residencyFrame;
+
+        // NOTE: Copied, the callback may track assets and grow the entries
+        std::function<void()> reload = asset.callbacks.reload;
+        reload();
+    }
+}
+
+static uint64_t GetTrackedBytes() {
+    uint64_t bytes = 0;
+    for (const ResidentAsset& asset : g_residentAssets) {
+        if (asset.tracked) {
+            bytes += asset.bytes;
+        }
+    }
+    return bytes;
+}
+
+// NOTE: Least recently drawn first and the larger of those drawn in the same frame, only assets idle for the evict delay
+static void EvictIdleAssets(uint64_t targetBytes) {
+    uint64_t trackedBytes = GetTrackedBytes();
+    if (trackedBytes <= targetBytes) {
+        return;
+    }
+
+    std::vector<uint32_t> candidates;
+    for (uint32_t i = 0; i < g_residentAssets.size(); ++i) {
+        const ResidentAsset& asset = g_residentAssets[i];
+        if (asset.tracked && !asset.evicted && asset.callbacks.evict && g_residencyFrame - asset.lastUsedFrame > ResidencyEvictDelayFrames) {
+            candidates.push_back(i);
+        }
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](uint32_t a, uint32_t b) {
+        const ResidentAsset& assetA = g_residentAssets[a];
+        const ResidentAsset& assetB = g_residentAssets[b];
+        if (assetA.lastUsedFrame != assetB.lastUsedFrame) {
+            return assetA.lastUsedFrame < assetB.lastUsedFrame;
+        }
+        return assetA.bytes > assetB.bytes;
+    });
+
+    for (uint32_t index : candidates) {
+        if (trackedBytes <= targetBytes) {
+            break;
+        }
+
+        std::function<ResidencyEviction()> evict = g_residentAssets[index].callbacks.evict;
+        const ResidencyEviction eviction = evict();
+
+        ResidentAsset& asset = g_residentAssets[index];
+        if (!eviction.resource) {
+            continue;
+        }
+
+        Log::Info("Residency: evicted %s %s, %.2f MB", GetResidencyCategoryName(asset.category), asset.name.c_str(), (asset.bytes - std::min(asset.bytes, eviction.bytes)) / (1024.0f * 1024.0f));
+
+        trackedBytes -= asset.bytes;
+        trackedBytes += eviction.bytes;
+
+        asset.resource = eviction.resource;
+        asset.bytes = eviction.bytes;
+        asset.evicted = true;
+        asset.reloading = false;
+        SetResidentAssetKey(index, eviction.resource.get());
+
+        g_residencyCounters[static_cast<size_t>(asset.category)].evictions++;
+    }
+}
+
+void Residency_Update() {
+    ReleaseExpiredAssets();
+    ReloadUsedAssets();
+
+    // NOTE: Streamed textures lose levels first as that only lowers their resolution. The other assets are evicted once even the
+    // startup levels of the streamed textures would not fit next to them.
+    const TextureStreamingStats streaming = TextureStreaming_GetStats();
+    const uint64_t trackedBudget = g_residencyBudget - std::min(g_residencyBudget, streaming.startupBytes);
+
+    EvictIdleAssets(trackedBudget);
+
+    const uint64_t trackedBytes = GetTrackedBytes();
+    TextureStreaming_SetBudget(g_residencyBudget - std::min(g_residencyBudget, trackedBytes));
+
+    // NOTE: Pages emptied by evicted meshes are given back only while over budget, a page kept empty is reused by the next load
+    if (trackedBytes + streaming.residentBytes > g_residencyBudget) {
+        MeshPool_ReleaseEmptyPages();
+    }
+
+    g_residencyFrame++;
+}
+
+void Residency_SetBudget(uint64_t budgetBytes) {
+    g_residencyBudget = budgetBytes;
+}
+
+ResidencyStats Residency_GetStats() {
+    ResidencyStats stats;
+    stats.budgetBytes = g_residencyBudget;
+    stats.categories = g_residencyCounters;
+    stats.meshPoolBytes = MeshPool_GetPageBytes();
+
+    for (const ResidentAsset& asset : g_residentAssets) {
+        if (!asset.tracked) {
+            continue;
+        }
+
+        ResidencyCategoryStats& category = stats.categories[static_cast<size_t>(asset.category)];
+        category.bytes += asset.bytes;
+        category.assets++;
+        if (asset.evicted) {
+            category.evictedAssets++;
+        }
+    }
+
+    const TextureStreamingStats streaming = TextureStreaming_GetStats();
+    ResidencyCategoryStats& streamed = stats.categories[static_cast<size_t>(ResidencyCategory::StreamedTextures)];
+    streamed.bytes = streaming.residentBytes;
+    streamed.assets = streaming.textureCount;
+    streamed.evictedAssets = streaming.startupCount;
+    streamed.evictions = streaming.evictions;
+    streamed.reloads = streaming.streamIns;
+
+    for (const ResidencyCategoryStats& category : stats.categories) {
+        stats.totalBytes += category.bytes;
+    }
+
+    return stats;
+}
+
+void Residency_LogReport() {
+    constexpr float MB = 1024.0f * 1024.0f;
+
+    const ResidencyStats stats = Residency_GetStats();
+    Log::Info("Residency: %.1f MB of %.1f MB budget, mesh pool pages %.1f MB", stats.totalBytes / MB, stats.budgetBytes / MB, stats.meshPoolBytes / MB);
+
+    for (uint32_t i = 0; i < stats.categories.size(); ++i) {
+        const ResidencyCategoryStats& category = stats.categories[i];
+        Log::Info("  %s: %.1f MB, %u assets, %u evicted, %u evictions, %u reloads",
+            GetResidencyCategoryName(static_cast<ResidencyCategory>(i)),
+            category.bytes / MB,
+            category.assets,
+            category.evictedAssets,
+            category.evictions,
+            category.reloads);
+    }
+
+    // NOTE: The least recently drawn first, the order they would be evicted in
+    std::vector<uint32_t> order;
+    for (uint32_t i = 0; i < g_residentAssets.size(); ++i) {
+        if (g_residentAssets[i].tracked && g_residentAssets[i].callbacks.evict) {
+            order.push_back(i);
+        }
+    }
+
+    std::sort(order.begin(), order.end(), [](uint32_t a, uint32_t b) {
+        return g_residentAssets[a].lastUsedFrame < g_residentAssets[b].lastUsedFrame;
+    });
+
+    for (uint32_t index : order) {
+        const ResidentAsset& asset = g_residentAssets[index];
+        Log::Info("  %s %s: %.2f MB, %s, drawn %llu frames ago",
+            GetResidencyCategoryName(asset.category),
+            asset.name.c_str(),
+            asset.bytes / MB,
+            asset.evicted ? (asset.reloading ? "reloading" : "evicted") : "resident",
+            static_cast<unsigned long long>(g_residencyFrame - asset.lastUsedFrame));
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "EngineCore.h"
+
+#include <array>
+#include <functional>
+
+constexpr uint64_t DefaultGpuMemoryBudget = 1024ull * 1024 * 1024;
+
+// NOTE: Streamed textures are counted by the streamer, the other categories by the assets tracked here
+enum class ResidencyCategory : uint32_t {
+    Textures,
+    StreamedTextures,
+    Meshes,
+    Count
+};
+
+struct ResidencyCategoryStats {
+    uint64_t bytes = 0; // device memory held now
+    uint32_t assets = 0;
+    uint32_t evictedAssets = 0; // at their lowest mip or placeholder
+    uint32_t evictions = 0; // since startup
+    uint32_t reloads = 0;
+};
+
+struct ResidencyStats {
+    uint64_t budgetBytes = 0;
+    uint64_t totalBytes = 0;
+    uint64_t meshPoolBytes = 0; // pages of the mesh pool, the meshes category counts the ranges in them
+    std::array<ResidencyCategoryStats, static_cast<size_t>(ResidencyCategory::Count)> categories;
+};
+
+// NOTE: Same scheme as the asset handles, a handle whose asset stopped being tracked is ignored
+struct ResidencyHandle {
+    constexpr static uint32_t InvalidIndex = ~0u;
+
+    uint32_t index = InvalidIndex;
+    uint32_t generation = 0;
+
+    bool IsValid() const { return index != InvalidIndex; }
+};
+
+// NOTE: What an evicted asset is drawn through until it is reloaded, a placeholder or the asset itself emptied
+struct ResidencyEviction {
+    Ref<void> resource;
+    uint64_t bytes = 0;
+};
+
+// NOTE: evict gives the memory of the asset up and returns what stands in for it, an empty resource when it could not.
+// reload brings it back when it is drawn again and calls Residency_SetResource once it is. An asset without them is only counted.
+struct ResidencyCallbacks {
+    std::function<ResidencyEviction()> evict;
+    std::function<void()> reload;
+};
+
+void Residency_Init(uint64_t budgetBytes = DefaultGpuMemoryBudget);
+void Residency_Cleanup();
+
+// NOTE: resource is what draws go through, the tracking ends on its own once nothing holds it any more
+ResidencyHandle Residency_Track(ResidencyCategory category, const std::string& name, const Ref<void>& resource, uint64_t bytes, ResidencyCallbacks callbacks = {});
+void Residency_Untrack(ResidencyHandle handle);
+
+// NOTE: For an asset whose resource was swapped, by a reload here or by a hot reload of its source. False when the handle
+// no longer tracks anything.
+bool Residency_SetResource(ResidencyHandle handle, const Ref<void>& resource, uint64_t bytes);
+
+// NOTE: Called for everything drawn this frame, evicted assets drawn again are reloaded by the next Residency_Update
+void Residency_MarkUsed(const void* resource);
+
+// NOTE: Once per frame before TextureStreaming_Update. Evicts the assets drawn least recently while over budget, the streamer
+// gets what the other categories leave of the budget.
+void Residency_Update();
+
+void Residency_SetBudget(uint64_t budgetBytes);
+ResidencyStats Residency_GetStats();
+void Residency_LogReport();
@@ -0,0 +1,260 @@
+#include "pch.h"
+#include "shaderreload.h"
+#include "world.h"
+#include "Platform/FileSystem.h"
+#include "Log/Log.h"
+#include "Utils/ThreadPool.h"
+#include "Platform/FileWatch.h"
+
+#include <cstdio>
+
+// NOTE: Saving a file touches it several times, it is compiled once it has been quiet this long
+constexpr float ShaderReloadDelayMs = 100.0f;
+
+#ifdef _WIN32
+constexpr const char* ShaderBuildScript = "build.bat";
+#else
+constexpr const char* ShaderBuildScript = "build.sh";
+#endif
+
+struct ShaderCompileCommand {
+    std::string source; // canonical
+    std::string output; // canonical
+    std::string arguments; // compiler flags before the source, as in the build script
+};
+
+struct ShaderCompileResult {
+    std::string output;
+    uint32_t serial = 0;
+    bool compiled = false;
+    std::vector<int8_t> code;
+    std::string log;
+    std::chrono::steady_clock::time_point changeTime;
+    float compileMs = 0.0f;
+};
+
+static std::vector<ShaderCompileCommand> g_shaderCompileCommands;
+static std::unordered_map<std::string, uint32_t> g_shaderCompileSerials; // by output, only the latest compile is applied
+static Scope<filewatch::FileWatch<std::string>> g_shaderWatch;
+static Scope<ThreadPool> g_shaderCompileThreadPool;
+
+static std::mutex g_shaderReloadMutex;
+static std::unordered_map<std::string, std::chrono::steady_clock::time_point> g_changedShaderFiles; // canonical path to its last change
+static std::vector<ShaderCompileResult> g_shaderCompileResults;
+
+static std::string GetCanonicalShaderPath(const std::filesystem::path& path) {
+    std::error_code ec;
+    std::filesystem::path canonicalPath = std::filesystem::weakly_canonical(path, ec);
+
+    return ec ? path.lexically_normal().generic_string() : canonicalPath.generic_string();
+}
+
+// NOTE: Lines of the form "glslangValidator <flags> <source> -o <output>", paths relative to the script
+static void ReadShaderCompileCommands(const std::filesystem::path& directory) {
+    std::ifstream file(directory / ShaderBuildScript);
+    if (!file) {
+        Log::Warn("%s not found, shaders in %s are not reloaded", ShaderBuildScript, directory.generic_string().c_str());
+        return;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream lineStream(line);
+
+        std::vector<std::string> tokens;
+        std::string token;
+        while (lineStream >> token) {
+            tokens.push_back(token);
+        }
+
+        auto outputIt = std::find(tokens.begin(), tokens.end(), "-o");
+        if (tokens.empty() || tokens[0] != "glslangValidator" || outputIt - tokens.begin() < 2 || outputIt + 1 == tokens.end()) {
+            continue;
+        }
+
+        ShaderCompileCommand command;
+        command.source = GetCanonicalShaderPath(directory / *(outputIt - 1));
+        command.output = GetCanonicalShaderPath(directory / *(outputIt + 1));
+
+        for (auto it = tokens.begin() + 1; it != outputIt - 1; ++it) {
+            command.arguments += *it;
+            command.arguments += ' ';
+        }
+
+        g_shaderCompileCommands.push_back(std::move(command));
+    }
+}
+
+// NOTE: Only the includes of the source itself are followed, which is how common.glsl is used
+static bool IsShaderSourceChanged(const ShaderCompileCommand& command, const std::unordered_set<std::string>& changedFiles) {
+    if (changedFiles.find(command.source) != changedFiles.end()) {
+        return true;
+    }
+
+    const std::filesystem::path sourceDirectory = std::filesystem::path(command.source).parent_path();
+
+    std::ifstream file(command.source);
+    std::string line;
+    while (std::getline(file, line)) {
+        const size_t include = line.find("#include");
+        const size_t begin = include == std::string::npos ? std::string::npos : line.find('"', include);
+        const size_t end = begin == std::string::npos ? std::string::npos : line.find('"', begin + 1);
+        if (end == std::string::npos) {
+            continue;
+        }
+
+        if (changedFiles.find(GetCanonicalShaderPath(sourceDirectory / line.substr(begin + 1, end - begin - 1))) != changedFiles.end()) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// NOTE: Worker thread. The binary is written next to the old one and moved over it only on success, so a failed compile
+// leaves the previous binary for the next start as well.
+static void CompileShader(const ShaderCompileCommand& command, ShaderCompileResult& result) {
+    auto startTime = std::chrono::steady_clock::now();
+
+    const std::string tempOutput = command.output + "." + std::to_string(result.serial) + ".tmp";
+    const std::string commandLine = "glslangValidator " + command.arguments + "\"" + command.source + "\" -o \"" + tempOutput + "\" 2>&1";
+
+#ifdef _WIN32
+    FILE* pipe = _popen(commandLine.c_str(), "r");
+#else
+    FILE* pipe = popen(commandLine.c_str(), "r");
+#endif
+    if (!pipe) {
+        result.log = "glslangValidator could not be started";
+        return;
+    }
+
+    char buffer[512];
+    while (fgets(buffer, sizeof(buffer), pipe)) {
+        result.log += buffer;
+    }
+
+#ifdef _WIN32
+    const int32_t status = _pclose(pipe);
+#else
+    const int32_t status = pclose(pipe);
+#endif
+
+    result.compiled = status == 0 && FileSystem::ReadFile(tempOutput.c_str(), result.code);
+
+    std::error_code ec;
+    if (result.compiled) {
+        std::filesystem::rename(tempOutput, command.output, ec);
+    }
+    else {
+        std::filesystem::remove(tempOutput, ec);
+    }
+
+    std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+    result.compileMs = elapsed.count();
+}
+
+void ShaderReload_Init(const char* shaderDirectory) {
+    const std::filesystem::path directory = GetCanonicalShaderPath(shaderDirectory);
+
+    ReadShaderCompileCommands(directory);
+    if (g_shaderCompileCommands.empty()) {
+        return;
+    }
+
+    try {
+        g_shaderWatch = CreateScope<filewatch::FileWatch<std::string>>(directory.generic_string(), [directory](const std::string& file, const filewatch::Event event) {
+            const std::filesystem::path path = directory / file;
+            if (event == filewatch::Event::removed || event == filewatch::Event::renamed_old || path.extension() == ".spv" || path.extension() == ".tmp") {
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(g_shaderReloadMutex);
+            g_changedShaderFiles[path.generic_string()] = std::chrono::steady_clock::now();
+        });
+    }
+    catch (const std::exception& e) {
+        Log::Warn("Failed to watch %s for changes: %s", directory.generic_string().c_str(), e.what());
+        g_shaderCompileCommands.clear();
+        return;
+    }
+
+    g_shaderCompileThreadPool = CreateScope<ThreadPool>(std::max(1, static_cast<int32_t>(std::thread::hardware_concurrency()) / 2));
+}
+
+void ShaderReload_Cleanup() {
+    // NOTE: Joining the watcher and the compiles first guarantees nothing is added to the lists after they are cleared
+    g_shaderWatch.reset();
+    g_shaderCompileThreadPool.reset();
+
+    g_changedShaderFiles.clear();
+    g_shaderCompileResults.clear();
+    g_shaderCompileSerials.clear();
+    g_shaderCompileCommands.clear();
+}
+
+void ShaderReload_Update() {
+    if (!g_shaderCompileThreadPool) {
+        return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+
+    std::unordered_set<std::string> changedFiles;
+    std::chrono::steady_clock::time_point changeTime;
+    std::vector<ShaderCompileResult> results;
+    {
+        std::lock_guard<std::mutex> lock(g_shaderReloadMutex);
+
+        for (auto it = g_changedShaderFiles.begin(); it != g_changedShaderFiles.end();) {
+            std::chrono::duration<float, std::milli> quietTime = now - it->second;
+            if (quietTime.count() >= ShaderReloadDelayMs) {
+                changedFiles.insert(it->first);
+                changeTime = std::max(changeTime, it->second);
+                it = g_changedShaderFiles.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+
+        results.swap(g_shaderCompileResults);
+    }
+
+    for (const ShaderCompileCommand& command : g_shaderCompileCommands) {
+        if (changedFiles.empty() || !IsShaderSourceChanged(command, changedFiles)) {
+            continue;
+        }
+
+        ShaderCompileResult result;
+        result.output = command.output;
+        result.serial = ++g_shaderCompileSerials[command.output];
+        result.changeTime = changeTime;
+
+        g_shaderCompileThreadPool->EnqueueTask([command, result]() mutable {
+            CompileShader(command, result);
+
+            std::lock_guard<std::mutex> lock(g_shaderReloadMutex);
+            g_shaderCompileResults.push_back(std::move(result));
+        });
+    }
+
+    // NOTE: Latency runs from the last change of the files to the pipelines being rebuilt, so it includes ShaderReloadDelayMs
+    for (const ShaderCompileResult& result : results) {
+        if (result.serial != g_shaderCompileSerials[result.output]) {
+            continue;
+        }
+
+        const std::string name = std::filesystem::path(result.output).filename().generic_string();
+
+        if (!result.compiled) {
+            Log::Error("Failed to compile %s, the previous pipelines stay in use:\n%s", name.c_str(), result.log.c_str());
+            continue;
+        }
+
+        const uint32_t rebuiltCount = g_graphicsContext->ReloadShaderFile(result.output.c_str(), result.code);
+
+        std::chrono::duration<float, std::milli> latency = std::chrono::steady_clock::now() - result.changeTime;
+        Log::Info("Reloaded %s in %.1f ms (compile %.1f ms), %u pipelines rebuilt", name.c_str(), latency.count(), result.compileMs, rebuiltCount);
+    }
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "EngineCore.h"
+
+// NOTE: Watches the shader sources in shaderDirectory and recompiles the SPIR-V binaries whose sources or includes changed,
+// with the commands of the directory's build script. Compiles run on a worker, the pipelines using a rebuilt binary are
+// recreated by ShaderReload_Update. A stage that fails to compile keeps the binary and the pipelines it had.
+void ShaderReload_Init(const char* shaderDirectory);
+void ShaderReload_Cleanup();
+
+void ShaderReload_Update();
@@ -18,8 +18,8 @@ struct PointLightShadowConstants {
 static Ref<RenderPass> g_shadowRenderPass;
 static Ref<ShaderResourcesLayout> g_shadowShaderResourcesLayout;
 static Ref<ShaderResourcesLayout> g_pointShadowShaderResourcesLayout;
-static Ref<GraphicsPipeline> g_shadowPipeline;
-static Ref<GraphicsPipeline> g_pointLightShadowPipeline;
+static std::array<Ref<GraphicsPipeline>, static_cast<size_t>(VertexFormat::Count)> g_shadowPipelines;
+static std::array<Ref<GraphicsPipeline>, static_cast<size_t>(VertexFormat::Count)> g_pointLightShadowPipelines;
 
 static Ref<GraphicsResourcesPool<ShaderResources>> g_shadowShaderResourcesPool;
 static Ref<GraphicsResourcesPool<ShaderResources>> g_pointShadowShaderResourcesPool;
@@ -92,58 +92,69 @@ void Shadow_Init() {
 		return context.CreateConstantBuffer(desc);
 	});
 
-	// NOTE: Create shadow pipeline
-	GraphicsShader::Descriptor shadowPipelineShaderDesc;
+	// NOTE: Create shadow pipelines, one per vertex format the meshes may use
+	for (uint32_t i = 0; i < static_cast<uint32_t>(VertexFormat::Count); i++) {
+		const VertexFormat format = static_cast<VertexFormat>(i);
+		if (!IsVertexFormatSupported(format)) {
+			continue;
+		}
+
+		GraphicsShader::Descriptor shadowPipelineShaderDesc;
 #if USE_VULKAN
-	shadowPipelineShaderDesc.vertexShaderFile = "assets/shaders/shadow.vert.spv";
-	shadowPipelineShaderDesc.vertexShaderEntry = "main";
-	shadowPipelineShaderDesc.pixelShaderFile = "assets/shaders/shadow.frag.spv";
-	shadowPipelineShaderDesc.pixelShaderEntry = "main";
+		shadowPipelineShaderDesc.vertexShaderFile = GetVertexShaderPath("shadow", format);
+		shadowPipelineShaderDesc.vertexShaderEntry = "main";
+		shadowPipelineShaderDesc.pixelShaderFile = "assets/shaders/shadow.frag.spv";
+		shadowPipelineShaderDesc.pixelShaderEntry = "main";
 #elif USE_DX11
-	shadowPipelineShaderDesc.vertexShaderFile = "assets/shaders/shadow.fx";
-	shadowPipelineShaderDesc.vertexShaderEntry = "VSMain";
-	shadowPipelineShaderDesc.pixelShaderFile = "assets/shaders/shadow.fx";
-	shadowPipelineShaderDesc.pixelShaderEntry = "PSMain";
+		shadowPipelineShaderDesc.vertexShaderFile = "assets/shaders/shadow.fx";
+		shadowPipelineShaderDesc.vertexShaderEntry = "VSMain";
+		shadowPipelineShaderDesc.pixelShaderFile = "assets/shaders/shadow.fx";
+		shadowPipelineShaderDesc.pixelShaderEntry = "PSMain";
 #endif
 
-	auto shadowShader = g_graphicsContext->CreateGraphicsShader(shadowPipelineShaderDesc);
+		auto shadowShader = g_graphicsContext->CreateGraphicsShader(shadowPipelineShaderDesc);
 
-	g_shadowPipeline = g_graphicsContext->CreateGraphicsPipeline();
-	g_shadowPipeline->SetShader(shadowShader);
-	g_shadowPipeline->SetRenderPass(g_shadowRenderPass, 0);
-	g_shadowPipeline->SetVertexInputLayouts({ g_texturedVertexInputLayout, g_instanceVertexInputLayout });
-	g_shadowPipeline->SetShaderResourcesLayouts({ g_shadowShaderResourcesLayout });
-	g_shadowPipeline->SetCullMode(CullMode::None);
-	g_shadowPipeline->SetViewport(0, 0, ShadowMapSize, ShadowMapSize);
-	g_shadowPipeline->SetScissor(0, 0, ShadowMapSize, ShadowMapSize);
+		auto shadowPipeline = g_graphicsContext->CreateGraphicsPipeline();
+		shadowPipeline->SetShader(shadowShader);
+		shadowPipeline->SetRenderPass(g_shadowRenderPass, 0);
+		shadowPipeline->SetVertexInputLayouts({ GetVertexInputLayout(format), g_instanceVertexInputLayout });
+		shadowPipeline->SetShaderResourcesLayouts({ g_shadowShaderResourcesLayout });
+		shadowPipeline->SetCullMode(CullMode::None);
+		shadowPipeline->SetViewport(0, 0, ShadowMapSize, ShadowMapSize);
+		shadowPipeline->SetScissor(0, 0, ShadowMapSize, ShadowMapSize);
 
-	GraphicsShader::Descriptor pointLightShadowPipelineShaderDesc;
+		g_shadowPipelines[i] = shadowPipeline;
+
+		GraphicsShader::Descriptor pointLightShadowPipelineShaderDesc;
 #if USE_VULKAN
-	pointLightShadowPipelineShaderDesc.vertexShaderFile = "assets/shaders/shadow_point.vert.spv";
-	pointLightShadowPipelineShaderDesc.vertexShaderEntry = "main";
-	pointLightShadowPipelineShaderDesc.geometryShaderFile = "assets/shaders/shadow_point.geom.spv";
-	pointLightShadowPipelineShaderDesc.geometryShaderEntry = "main";
-	pointLightShadowPipelineShaderDesc.pixelShaderFile = "assets/shaders/shadow_point.frag.spv";
-	pointLightShadowPipelineShaderDesc.pixelShaderEntry = "main";
+		pointLightShadowPipelineShaderDesc.vertexShaderFile = GetVertexShaderPath("shadow_point", format);
+		pointLightShadowPipelineShaderDesc.vertexShaderEntry = "main";
+		pointLightShadowPipelineShaderDesc.geometryShaderFile = "assets/shaders/shadow_point.geom.spv";
+		pointLightShadowPipelineShaderDesc.geometryShaderEntry = "main";
+		pointLightShadowPipelineShaderDesc.pixelShaderFile = "assets/shaders/shadow_point.frag.spv";
+		pointLightShadowPipelineShaderDesc.pixelShaderEntry = "main";
 #elif USE_DX11
-	pointLightShadowPipelineShaderDesc.vertexShaderFile = "assets/shaders/shadow_point.fx";
-	pointLightShadowPipelineShaderDesc.vertexShaderEntry = "VSMain";
-	pointLightShadowPipelineShaderDesc.geometryShaderFile = "assets/shaders/shadow_point.fx";
-	pointLightShadowPipelineShaderDesc.geometryShaderEntry = "GSMain";
-	pointLightShadowPipelineShaderDesc.pixelShaderFile = "assets/shaders/shadow_point.fx";
-	pointLightShadowPipelineShaderDesc.pixelShaderEntry = "PSMain";
+		pointLightShadowPipelineShaderDesc.vertexShaderFile = "assets/shaders/shadow_point.fx";
+		pointLightShadowPipelineShaderDesc.vertexShaderEntry = "VSMain";
+		pointLightShadowPipelineShaderDesc.geometryShaderFile = "assets/shaders/shadow_point.fx";
+		pointLightShadowPipelineShaderDesc.geometryShaderEntry = "GSMain";
+		pointLightShadowPipelineShaderDesc.pixelShaderFile = "assets/shaders/shadow_point.fx";
+		pointLightShadowPipelineShaderDesc.pixelShaderEntry = "PSMain";
 #endif
 
-	auto pointLightShadowShader = g_graphicsContext->CreateGraphicsShader(pointLightShadowPipelineShaderDesc);
+		auto pointLightShadowShader = g_graphicsContext->CreateGraphicsShader(pointLightShadowPipelineShaderDesc);
 
-	g_pointLightShadowPipeline = g_graphicsContext->CreateGraphicsPipeline();
-	g_pointLightShadowPipeline->SetShader(pointLightShadowShader);
-	g_pointLightShadowPipeline->SetRenderPass(g_shadowRenderPass, 0);
-	g_pointLightShadowPipeline->SetVertexInputLayouts({ g_texturedVertexInputLayout, g_instanceVertexInputLayout });
-	g_pointLightShadowPipeline->SetShaderResourcesLayouts({ g_pointShadowShaderResourcesLayout });
-	g_pointLightShadowPipeline->SetCullMode(CullMode::None);
-	g_pointLightShadowPipeline->SetViewport(0, 0, ShadowMapSize, ShadowMapSize);
-	g_pointLightShadowPipeline->SetScissor(0, 0, ShadowMapSize, ShadowMapSize);
+		auto pointLightShadowPipeline = g_graphicsContext->CreateGraphicsPipeline();
+		pointLightShadowPipeline->SetShader(pointLightShadowShader);
+		pointLightShadowPipeline->SetRenderPass(g_shadowRenderPass, 0);
+		pointLightShadowPipeline->SetVertexInputLayouts({ GetVertexInputLayout(format), g_instanceVertexInputLayout });
+		pointLightShadowPipeline->SetShaderResourcesLayouts({ g_pointShadowShaderResourcesLayout });
+		pointLightShadowPipeline->SetCullMode(CullMode::None);
+		pointLightShadowPipeline->SetViewport(0, 0, ShadowMapSize, ShadowMapSize);
+		pointLightShadowPipeline->SetScissor(0, 0, ShadowMapSize, ShadowMapSize);
+
+		g_pointLightShadowPipelines[i] = pointLightShadowPipeline;
+	}
 
 	// NOTE: set global shadow map info
 	g_globalShadowMap.lightSpaceView = ViewMatrix(vec3(0.0f, 0.0f, -5.0f), vec3(0.0f));
@@ -194,8 +205,8 @@ void Shadow_Cleanup() {
 	g_shadowRenderPass.reset();
 	g_shadowShaderResourcesLayout.reset();
 	g_pointShadowShaderResourcesLayout.reset();
-	g_shadowPipeline.reset();
-	g_pointLightShadowPipeline.reset();
+	g_shadowPipelines.fill(nullptr);
+	g_pointLightShadowPipelines.fill(nullptr);
 	g_shadowShaderResourcesPool.reset();
 	g_pointShadowShaderResourcesPool.reset();
 	g_shadowConstantsCBPool.reset();
@@ -230,8 +241,6 @@ void Shadow_Render() {
 
 	commandQueue.BeginRenderPass(g_shadowRenderPass, frameBuffer);
 
-	commandQueue.SetPipeline(g_shadowPipeline);
-
 	auto shadowSR = g_shadowShaderResourcesPool->Get();
 	auto shadowCB = g_shadowConstantsCBPool->Get();
 
@@ -243,9 +252,9 @@ void Shadow_Render() {
 
 	shadowSR->BindConstantBuffer(shadowCB, 0);
 
-	commandQueue.SetShaderResources({ shadowSR });
-
 	uint32_t instanceOffset = 0;
+	VertexFormat currentFormat = VertexFormat::Count;
+	Ref<VertexBuffer> currentVertexBuffer;
 
 	g_meshOnlyRenderQueue.Reset();
 	while (!g_meshOnlyRenderQueue.Empty()) {
@@ -256,8 +265,27 @@ void Shadow_Render() {
 				continue;
 			}
 
-			commandQueue.SetVertexBuffers({ obj.mesh->vertexBuffer, instanceVB });
-			commandQueue.DrawIndexedInstanced(obj.mesh->indexBuffer, obj.mesh->indexBuffer->IndexCount(), obj.instanceCount, 0, 0, instanceOffset);
+			// NOTE: Evicted meshes cast no shadow until they are reloaded
+			if (!obj.mesh->vertexBuffer) {
+				instanceOffset += obj.instanceCount;
+				continue;
+			}
+
+			if (obj.mesh->vertexFormat != currentFormat) {
+				currentFormat = obj.mesh->vertexFormat;
+				commandQueue.SetPipeline(g_shadowPipelines[static_cast<size_t>(currentFormat)]);
+				commandQueue.SetShaderResources({ shadowSR });
+			}
+
+			// NOTE: Pooled meshes share their pages, the buffers are bound again only when a mesh lives in another one
+			if (obj.mesh->vertexBuffer != currentVertexBuffer) {
+				currentVertexBuffer = obj.mesh->vertexBuffer;
+				commandQueue.SetVertexBuffers({ currentVertexBuffer, instanceVB });
+			}
+
+			for (const auto& segment : obj.mesh->segments) {
+				commandQueue.DrawIndexedInstanced(obj.mesh->indexBuffer, segment.indexCount, obj.instanceCount, segment.indexOffset, segment.vertexOffset, instanceOffset);
+			}
 
 			instanceOffset += obj.instanceCount;
 		}
@@ -282,8 +310,6 @@ void Shadow_Render() {
 
 	commandQueue.BeginRenderPass(g_shadowRenderPass, frameBuffer);
 
-	commandQueue.SetPipeline(g_pointLightShadowPipeline);
-
 	auto pointShadowSR = g_pointShadowShaderResourcesPool->Get();
 
 	auto pointLightShadowCB = g_pointLightShadowConstantsCBPool->Get();
@@ -300,9 +326,9 @@ void Shadow_Render() {
 
 	pointShadowSR->BindConstantBuffer(pointLightShadowCB, 0);
 
-	commandQueue.SetShaderResources({ pointShadowSR });
-
 	instanceOffset = 0;
+	currentFormat = VertexFormat::Count;
+	currentVertexBuffer.reset();
 	g_meshOnlyRenderQueue.Reset();
 	while (!g_meshOnlyRenderQueue.Empty()) {
 		const auto& entry = g_meshOnlyRenderQueue.Front();
@@ -312,8 +338,27 @@ void Shadow_Render() {
 				continue;
 			}
 
-			commandQueue.SetVertexBuffers({ obj.mesh->vertexBuffer, instanceVB });
-			commandQueue.DrawIndexedInstanced(obj.mesh->indexBuffer, obj.mesh->indexBuffer->IndexCount(), obj.instanceCount, 0, 0, instanceOffset);
+			// NOTE: Evicted meshes cast no shadow until they are reloaded
+			if (!obj.mesh->vertexBuffer) {
+				instanceOffset += obj.instanceCount;
+				continue;
+			}
+
+			if (obj.mesh->vertexFormat != currentFormat) {
+				currentFormat = obj.mesh->vertexFormat;
+				commandQueue.SetPipeline(g_pointLightShadowPipelines[static_cast<size_t>(currentFormat)]);
+				commandQueue.SetShaderResources({ pointShadowSR });
+			}
+
+			// NOTE: Pooled meshes share their pages, the buffers are bound again only when a mesh lives in another one
+			if (obj.mesh->vertexBuffer != currentVertexBuffer) {
+				currentVertexBuffer = obj.mesh->vertexBuffer;
+				commandQueue.SetVertexBuffers({ currentVertexBuffer, instanceVB });
+			}
+
+			for (const auto& segment : obj.mesh->segments) {
+				commandQueue.DrawIndexedInstanced(obj.mesh->indexBuffer, segment.indexCount, obj.instanceCount, segment.indexOffset, segment.vertexOffset, instanceOffset);
+			}
 
 			instanceOffset += obj.instanceCount;
 		}
@@ -9,6 +9,8 @@ static Ref<GraphicsResourcesPool<ShaderResources>> g_dynamicShaderResourcesPool;
 
 static Ref<GraphicsPipeline> g_skyboxPipeline;
 
+static TextureCubeHandle g_skyboxTexture;
+
 void Skybox_Init() {
 	// NOTE: Create assets
 	LoadTextureCube(
@@ -22,6 +24,9 @@ void Skybox_Init() {
 		}, 
 		"skybox"
 	);
+
+	g_skyboxTexture = FindTextureCube("skybox");
+	Asset_Acquire(g_skyboxTexture);
 	
 	// NOTE: Create shader resources
 	ShaderResourcesLayout::Descriptor staticSRLDesc;
@@ -78,6 +83,8 @@ void Skybox_Init() {
 }
 
 void Skybox_Cleanup() {
+	Asset_Release(g_skyboxTexture);
+
 	g_staticShaderResourcesLayout.reset();
 	g_dynamicShaderResourcesLayout.reset();
 	g_staticShaderResources.reset();
@@ -87,8 +94,8 @@ void Skybox_Cleanup() {
 
 void Skybox_Render() {
 	auto& commandQueue = g_graphicsContext->GetCommandQueue();
-	auto cubeMesh = GetMesh("cube");
-	auto cubemapTex = GetTextureCube("skybox");
+	auto cubeMesh = GetMesh(g_cubeMesh);
+	auto cubemapTex = GetTextureCube(g_skyboxTexture);
 
 	g_dynamicShaderResourcesPool->Reset();
 
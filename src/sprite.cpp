@@ -2,6 +2,7 @@
 #include "sprite.h"
 #include "world.h"
 #include "asset.h"
+#include "residency.h"
 
 #include <map>
 
@@ -115,7 +116,7 @@ void Sprite_Render() {
     g_objectConstantsCBUsed = 0;
     g_dynamicShaderResourcesUsed = 0;
 
-    auto quadMesh = GetMesh("quad");
+    auto quadMesh = GetMesh(g_quadMesh);
 
     std::map<float, Object*> sorted;
     vec3 cameraPos = g_camera->GetPosition();
@@ -140,16 +141,17 @@ void Sprite_Render() {
         dynamicShaderResources->BindConstantBuffer(objectConstantsCB, objectConstantsCBBinding);
         
         if (!spriteComponent->texture) {
-            spriteComponent->texture = GetTexture2D("dummy");
+            spriteComponent->texture = GetTexture2D(g_dummyTexture);
         }
         else {
             dynamicShaderResources->BindTexture2D(spriteComponent->texture, diffuseTextureBinding);
+            Residency_MarkUsed(spriteComponent->texture.get());
         }
 
         commandQueue.SetPipeline(g_spritePipeline);
         commandQueue.SetVertexBuffers({ quadMesh->vertexBuffer });
         commandQueue.SetShaderResources({ g_staticShaderResources, dynamicShaderResources });
-        commandQueue.DrawIndexed(quadMesh->indexBuffer, quadMesh->indexBuffer->IndexCount());
+        commandQueue.DrawIndexed(quadMesh->indexBuffer, quadMesh->segments[0].indexCount, quadMesh->segments[0].indexOffset, quadMesh->segments[0].vertexOffset);
     }
 }
 
@@ -236,7 +236,7 @@ void SSAO_Render() {
 	auto ssaoBlurFramebuffer = g_ssaoBlurFramebufferGroup->Get();
 
 	auto gBuffer = GetGBuffer();
-	auto quadMesh = GetMesh("quad");
+	auto quadMesh = GetMesh(g_quadMesh);
 
 	commandQueue.SetVertexBuffers({ quadMesh->vertexBuffer });
 
@@ -251,7 +251,7 @@ void SSAO_Render() {
 
 	commandQueue.SetPipeline(g_ssaoPipeline);
 	commandQueue.SetShaderResources({ ssaoSR });
-	commandQueue.DrawIndexed(quadMesh->indexBuffer, quadMesh->indexBuffer->IndexCount());
+	commandQueue.DrawIndexed(quadMesh->indexBuffer, quadMesh->segments[0].indexCount, quadMesh->segments[0].indexOffset, quadMesh->segments[0].vertexOffset);
 
 	commandQueue.EndRenderPass();
 
@@ -272,7 +272,7 @@ void SSAO_Render() {
 
 	commandQueue.SetPipeline(g_ssaoBlurPipeline);
 	commandQueue.SetShaderResources({ ssaoBlurSR });
-	commandQueue.DrawIndexed(quadMesh->indexBuffer, quadMesh->indexBuffer->IndexCount());
+	commandQueue.DrawIndexed(quadMesh->indexBuffer, quadMesh->segments[0].indexCount, quadMesh->segments[0].indexOffset, quadMesh->segments[0].vertexOffset);
 
 	commandQueue.EndRenderPass();
 
@@ -0,0 +1,425 @@
+#include "pch.h"
+#include "streaming.h"
+#include "world.h"
+#include "texturecache.h"
+#include "residency.h"
+#include "Graphics/GraphicsFunc.h"
+#include "Log/Log.h"
+
+#include <array>
+#include <cmath>
+
+// NOTE: A texture nobody asked for keeps its levels this long before falling back to the startup levels
+constexpr uint64_t StreamingEvictDelayFrames = 120;
+
+// NOTE: Each stream in re-creates and uploads a texture, so only a few run per frame
+constexpr uint32_t MaxStreamInsPerFrame = 2;
+
+struct StreamingTexture {
+    std::string name;
+    Texture2D::Descriptor desc; // full resolution, data is taken from mipData
+    std::vector<uint8_t> mipData;
+
+    uint32_t startupMip = 0;
+    uint32_t residentMip = 0;
+    uint32_t wantedMip = 0; // finest level requested in lastRequestFrame
+    uint64_t lastRequestFrame = 0;
+    bool requested = false;
+
+    Ref<Texture2D> texture;
+    std::vector<std::weak_ptr<Material>> users;
+};
+
+struct StreamingMaterial {
+    std::weak_ptr<Material> material;
+    std::vector<uint32_t> textureIndices;
+};
+
+static std::vector<StreamingTexture> g_streamingTextures;
+static std::unordered_map<Texture2D*, uint32_t> g_streamingTextureIndices;
+static std::unordered_map<Material*, StreamingMaterial> g_streamingMaterials;
+
+static uint64_t g_streamingBudget = DefaultTextureStreamingBudget;
+static uint64_t g_streamingResidentBytes = 0;
+static uint64_t g_streamingFrame = 1;
+static uint32_t g_streamingEvictions = 0;
+static uint32_t g_streamingStreamIns = 0;
+
+static std::array<Ref<Texture2D>*, 5> GetMaterialTextureSlots(Material& material) {
+    return {
+        &material.diffuseTexture,
+        &material.specularTexture,
+        &material.normalTexture,
+        &material.displacementTexture,
+        &material.ambientOcclusionTexture,
+    };
+}
+
+static uint32_t GetMipWidth(const StreamingTexture& texture, uint32_t mip) {
+    return std::max(1u, texture.desc.width >> mip);
+}
+
+static uint32_t GetMipHeight(const StreamingTexture& texture, uint32_t mip) {
+    return std::max(1u, texture.desc.height >> mip);
+}
+
+// NOTE: GPU memory taken by the texture when mip is its top level
+static uint64_t GetResidentSize(const StreamingTexture& texture, uint32_t mip) {
+    return GetMipChainSize(texture.desc.format, GetMipWidth(texture, mip), GetMipHeight(texture, mip), texture.desc.mipLevels - mip);
+}
+
+static Ref<Texture2D> CreateResidentTexture(const StreamingTexture& texture, uint32_t mip) {
+    Texture2D::Descriptor desc = texture.desc;
+    desc.width = GetMipWidth(texture, mip);
+    desc.height = GetMipHeight(texture, mip);
+    desc.mipLevels = texture.desc.mipLevels - mip;
+    desc.dataMipLevels = desc.mipLevels;
+    desc.data = texture.mipData.data() + GetMipChainSize(texture.desc.format, texture.desc.width, texture.desc.height, mip);
+
+    return g_graphicsContext->CreateTexture2D(desc);
+}
+
+static void SetResidentMip(uint32_t index, uint32_t mip) {
+    StreamingTexture& texture = g_streamingTextures[index];
+
+    Ref<Texture2D> newTexture = CreateResidentTexture(texture, mip);
+    if (!newTexture) {
+        Log::Error("Failed to stream texture %s to mip %u", texture.name.c_str(), mip);
+        return;
+    }
+
+    for (const auto& user : texture.users) {
+        Ref<Material> material = user.lock();
+        if (!material) {
+            continue;
+        }
+
+        for (Ref<Texture2D>* slot : GetMaterialTextureSlots(*material)) {
+            if (*slot == texture.texture) {
+                *slot = newTexture;
+            }
+        }
+    }
+
+    g_streamingTextureIndices.erase(texture.texture.get());
+    g_streamingTextureIndices[newTexture.get()] = index;
+    TextureCache_Replace(texture.texture, newTexture);
+
+    g_streamingResidentBytes -= GetResidentSize(texture, texture.residentMip);
+    g_streamingResidentBytes += GetResidentSize(texture, mip);
+
+    if (mip > texture.residentMip) {
+        g_streamingEvictions++;
+    }
+    else {
+        g_streamingStreamIns++;
+    }
+
+    texture.texture = newTexture;
+    texture.residentMip = mip;
+}
+
+void TextureStreaming_Init(uint64_t budgetBytes) {
+    g_streamingBudget = budgetBytes;
+    g_streamingResidentBytes = 0;
+    g_streamingFrame = 1;
+    g_streamingEvictions = 0;
+    g_streamingStreamIns = 0;
+}
+
+void TextureStreaming_Cleanup() {
+    g_streamingMaterials.clear();
+    g_streamingTextureIndices.clear();
+    g_streamingTextures.clear();
+    g_streamingResidentBytes = 0;
+}
+
+Ref<Texture2D> TextureStreaming_Register(const char* name, const Texture2D::Descriptor& desc, std::vector<uint8_t>&& mipData) {
+    StreamingTexture texture;
+    texture.name = name;
+    texture.desc = desc;
+    texture.desc.data = nullptr;
+
+    const uint32_t maxSide = std::max(desc.width, desc.height);
+    while ((maxSide >> texture.startupMip) > TextureStreamingStartupSize && texture.startupMip + 1 < desc.mipLevels) {
+        texture.startupMip++;
+    }
+
+    // NOTE: Textures without their whole chain on the CPU or already small enough are uploaded as they are
+    const bool hasAllMips = desc.dataMipLevels >= desc.mipLevels && mipData.size() >= GetMipChainSize(desc.format, desc.width, desc.height, desc.mipLevels);
+    if (!hasAllMips || texture.startupMip == 0) {
+        Texture2D::Descriptor fullDesc = desc;
+        fullDesc.data = mipData.data();
+
+        // NOTE: Counted with the textures that are not streamed
+        Ref<Texture2D> result = g_graphicsContext->CreateTexture2D(fullDesc);
+        Residency_Track(ResidencyCategory::Textures, name, result, GetMipChainSize(desc.format, desc.width, desc.height, desc.mipLevels));
+
+        return result;
+    }
+
+    texture.mipData = std::move(mipData);
+    texture.residentMip = texture.startupMip;
+    texture.wantedMip = texture.startupMip;
+    texture.texture = CreateResidentTexture(texture, texture.startupMip);
+    if (!texture.texture) {
+        return nullptr;
+    }
+
+    const uint32_t index = static_cast<uint32_t>(g_streamingTextures.size());
+    g_streamingTextureIndices[texture.texture.get()] = index;
+    g_streamingResidentBytes += GetResidentSize(texture, texture.residentMip);
+
+    Ref<Texture2D> result = texture.texture;
+    g_streamingTextures.push_back(std::move(texture));
+
+    return result;
+}
+
+void TextureStreaming_Track(const Ref<Material>& material) {
+    StreamingMaterial streamingMaterial;
+    streamingMaterial.material = material;
+
+    for (Ref<Texture2D>* slot : GetMaterialTextureSlots(*material)) {
+        if (!*slot) {
+            continue;
+        }
+
+        auto it = g_streamingTextureIndices.find(slot->get());
+        if (it == g_streamingTextureIndices.end()) {
+            continue;
+        }
+
+        auto& textureIndices = streamingMaterial.textureIndices;
+        if (std::find(textureIndices.begin(), textureIndices.end(), it->second) != textureIndices.end()) {
+            continue;
+        }
+
+        textureIndices.push_back(it->second);
+        g_streamingTextures[it->second].users.push_back(material);
+    }
+
+    if (!streamingMaterial.textureIndices.empty()) {
+        g_streamingMaterials[material.get()] = std::move(streamingMaterial);
+    }
+}
+
+void TextureStreaming_Request(const Ref<Material>& material, float uvPerPixel) {
+    auto it = g_streamingMaterials.find(material.get());
+    if (it == g_streamingMaterials.end()) {
+        return;
+    }
+
+    for (uint32_t index : it->second.textureIndices) {
+        StreamingTexture& texture = g_streamingTextures[index];
+
+        // NOTE: Level whose texels are closest to one per pixel along the larger side
+        const float texelsPerPixel = uvPerPixel * std::max(texture.desc.width, texture.desc.height);
+        uint32_t mip = 0;
+        if (texelsPerPixel > 1.0f) {
+            mip = static_cast<uint32_t>(std::floor(std::log2(texelsPerPixel)));
+        }
+        mip = std::min(mip, texture.startupMip);
+
+        if (texture.lastRequestFrame != g_streamingFrame) {
+            texture.lastRequestFrame = g_streamingFrame;
+            texture.wantedMip = mip;
+        }
+        else {
+            texture.wantedMip = std::min(texture.wantedMip, mip);
+        }
+
+        texture.requested = true;
+    }
+}
+
+// NOTE: Textures whose materials are all gone, as after their model was reloaded, give their memory back.
+// The entries stay so the indices held by the other materials don't move.
+static void ReleaseUnusedTextures() {
+    for (auto it = g_streamingMaterials.begin(); it != g_streamingMaterials.end();) {
+        if (it->second.material.expired()) {
+            it = g_streamingMaterials.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    for (StreamingTexture& texture : g_streamingTextures) {
+        if (!texture.texture || texture.users.empty()) {
+            continue;
+        }
+
+        const bool used = std::any_of(texture.users.begin(), texture.users.end(), [](const std::weak_ptr<Material>& user) { return !user.expired(); });
+        if (used) {
+            continue;
+        }
+
+        g_streamingTextureIndices.erase(texture.texture.get());
+        g_streamingResidentBytes -= GetResidentSize(texture, texture.residentMip);
+
+        texture.texture.reset();
+        texture.mipData = {};
+        texture.users.clear();
+        texture.requested = false;
+    }
+}
+
+static bool IsRequestedRecently(const StreamingTexture& texture) {
+    return texture.requested && g_streamingFrame - texture.lastRequestFrame <= StreamingEvictDelayFrames;
+}
+
+void TextureStreaming_Update() {
+    ReleaseUnusedTextures();
+
+    const uint32_t textureCount = static_cast<uint32_t>(g_streamingTextures.size());
+
+    // NOTE: Requested textures get their wanted level, recently seen ones keep theirs and the rest fall back to the startup levels
+    std::vector<uint32_t> targetMips(textureCount);
+    uint64_t targetBytes = 0;
+    for (uint32_t i = 0; i < textureCount; ++i) {
+        const StreamingTexture& texture = g_streamingTextures[i];
+
+        if (!texture.texture) {
+            targetMips[i] = texture.residentMip;
+            continue;
+        }
+
+        if (texture.requested && texture.lastRequestFrame == g_streamingFrame) {
+            targetMips[i] = texture.wantedMip;
+        }
+        else if (IsRequestedRecently(texture)) {
+            targetMips[i] = texture.residentMip;
+        }
+        else {
+            targetMips[i] = texture.startupMip;
+        }
+
+        targetBytes += GetResidentSize(texture, targetMips[i]);
+    }
+
+    // NOTE: Over budget, drop one level at a time from textures not drawn this frame first, then from the ones requested least
+    // recently and then from the largest ones. The startup levels always stay resident.
+    while (targetBytes > g_streamingBudget) {
+        int32_t victim = -1;
+        bool victimDrawn = true;
+        uint64_t victimRequestFrame = 0;
+        uint64_t victimSize = 0;
+
+        for (uint32_t i = 0; i < textureCount; ++i) {
+            const StreamingTexture& texture = g_streamingTextures[i];
+            if (!texture.texture || targetMips[i] >= texture.startupMip) {
+                continue;
+            }
+
+            const bool drawn = texture.lastRequestFrame == g_streamingFrame;
+            const uint64_t size = GetResidentSize(texture, targetMips[i]);
+
+            bool better = victim == -1 || (victimDrawn && !drawn);
+            if (!better && drawn == victimDrawn) {
+                better = texture.lastRequestFrame < victimRequestFrame || (texture.lastRequestFrame == victimRequestFrame && size > victimSize);
+            }
+
+            if (better) {
+                victim = i;
+                victimDrawn = drawn;
+                victimRequestFrame = texture.lastRequestFrame;
+                victimSize = size;
+            }
+        }
+
+        if (victim == -1) {
+            break;
+        }
+
+        const StreamingTexture& texture = g_streamingTextures[victim];
+        targetBytes -= victimSize;
+        targetBytes += GetResidentSize(texture, ++targetMips[victim]);
+    }
+
+    // NOTE: Evictions free memory right away, stream ins go to the largest missing resolution first
+    std::vector<uint32_t> streamIns;
+    for (uint32_t i = 0; i < textureCount; ++i) {
+        if (targetMips[i] > g_streamingTextures[i].residentMip) {
+            SetResidentMip(i, targetMips[i]);
+        }
+        else if (targetMips[i] < g_streamingTextures[i].residentMip) {
+            streamIns.push_back(i);
+        }
+    }
+
+    std::sort(streamIns.begin(), streamIns.end(), [&targetMips](uint32_t a, uint32_t b) {
+        return g_streamingTextures[a].residentMip - targetMips[a] > g_streamingTextures[b].residentMip - targetMips[b];
+    });
+
+    for (uint32_t i = 0; i < streamIns.size() && i < MaxStreamInsPerFrame; ++i) {
+        SetResidentMip(streamIns[i], targetMips[streamIns[i]]);
+    }
+
+    g_streamingFrame++;
+}
+
+void TextureStreaming_SetBudget(uint64_t budgetBytes) {
+    g_streamingBudget = budgetBytes;
+}
+
+uint64_t TextureStreaming_GetResidentBytes() {
+    return g_streamingResidentBytes;
+}
+
+TextureStreamingStats TextureStreaming_GetStats() {
+    TextureStreamingStats stats;
+    stats.residentBytes = g_streamingResidentBytes;
+    stats.evictions = g_streamingEvictions;
+    stats.streamIns = g_streamingStreamIns;
+
+    for (const StreamingTexture& texture : g_streamingTextures) {
+        if (!texture.texture) {
+            continue;
+        }
+
+        stats.textureCount++;
+        stats.startupBytes += GetResidentSize(texture, texture.startupMip);
+        if (texture.residentMip == texture.startupMip) {
+            stats.startupCount++;
+        }
+    }
+
+    return stats;
+}
+
+void TextureStreaming_LogReport() {
+    constexpr float MB = 1024.0f * 1024.0f;
+
+    Log::Info("Texture streaming: %u textures, %.1f MB resident of %.1f MB budget", static_cast<uint32_t>(g_streamingTextures.size()), g_streamingResidentBytes / MB, g_streamingBudget / MB);
+
+    std::vector<uint32_t> order(g_streamingTextures.size());
+    for (uint32_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+
+    std::sort(order.begin(), order.end(), [](uint32_t a, uint32_t b) {
+        return GetResidentSize(g_streamingTextures[a], g_streamingTextures[a].residentMip) > GetResidentSize(g_streamingTextures[b], g_streamingTextures[b].residentMip);
+    });
+
+    for (uint32_t index : order) {
+        const StreamingTexture& texture = g_streamingTextures[index];
+        if (!texture.texture) {
+            continue;
+        }
+
+        char wanted[32] = "-";
+        if (IsRequestedRecently(texture)) {
+            snprintf(wanted, sizeof(wanted), "%ux%u", GetMipWidth(texture, texture.wantedMip), GetMipHeight(texture, texture.wantedMip));
+        }
+
+        Log::Info("  %s: wanted %s, resident %ux%u (mip %u, startup mip %u), %.2f MB",
+            texture.name.c_str(),
+            wanted,
+            GetMipWidth(texture, texture.residentMip),
+            GetMipHeight(texture, texture.residentMip),
+            texture.residentMip,
+            texture.startupMip,
+            GetResidentSize(texture, texture.residentMip) / MB);
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "EngineCore.h"
+
+#include <vector>
+
+constexpr uint64_t DefaultTextureStreamingBudget = 256ull * 1024 * 1024;
+
+// NOTE: Streamed textures start with the levels whose larger side is at most this many texels
+constexpr uint32_t TextureStreamingStartupSize = 64;
+
+struct TextureStreamingStats {
+    uint32_t textureCount = 0;
+    uint32_t startupCount = 0; // holding only their startup levels
+    uint64_t residentBytes = 0;
+    uint64_t startupBytes = 0; // what the textures take at their startup levels, the least they are ever given
+    uint32_t evictions = 0; // level changes since startup
+    uint32_t streamIns = 0;
+};
+
+void TextureStreaming_Init(uint64_t budgetBytes = DefaultTextureStreamingBudget);
+void TextureStreaming_Cleanup();
+
+// NOTE: mipData holds every level of desc packed back to back from level 0 and is kept on the CPU to stream from.
+// The returned texture only holds the startup levels, materials using it must be passed to TextureStreaming_Track.
+Ref<Texture2D> TextureStreaming_Register(const char* name, const Texture2D::Descriptor& desc, std::vector<uint8_t>&& mipData);
+void TextureStreaming_Track(const Ref<Material>& material);
+
+// NOTE: uvPerPixel is the smallest UV step between neighboring screen pixels the material was drawn with this frame
+void TextureStreaming_Request(const Ref<Material>& material, float uvPerPixel);
+
+// NOTE: Evictions apply at once, stream ins are spread over frames. Replaced textures are released by the delayed deletion of the graphics context.
+void TextureStreaming_Update();
+
+void TextureStreaming_SetBudget(uint64_t budgetBytes);
+uint64_t TextureStreaming_GetResidentBytes();
+TextureStreamingStats TextureStreaming_GetStats();
+void TextureStreaming_LogReport();
@@ -0,0 +1,156 @@
+#include "pch.h"
+#include "texturecache.h"
+#include "Image/Image.h"
+#include "Utils/Hash.h"
+#include "Log/Log.h"
+
+#include <map>
+
+struct TextureContentKeyHash {
+    size_t operator()(const TextureContentKey& key) const {
+        Hasher64 hasher;
+        hasher.Update(key.pixelHash);
+        hasher.Update(key.width);
+        hasher.Update(key.height);
+        hasher.Update(key.format);
+        hasher.Update(key.buildKey);
+        return static_cast<size_t>(hasher.Digest());
+    }
+};
+
+struct TextureCacheEntry {
+    std::weak_ptr<Texture2D> texture;
+    std::string name; // of the first load
+    uint64_t sizeBytes = 0;
+    uint32_t shareCount = 0;
+};
+
+static std::mutex g_textureCacheMutex;
+static std::unordered_map<TextureContentKey, TextureCacheEntry, TextureContentKeyHash> g_textureCacheEntries;
+
+// NOTE: Keyed by the control block of the texture rather than its address, which another texture may get once this one is
+// freed. A control block is not reused while a weak_ptr to it is held here, so a key can't be matched by an unrelated texture.
+static std::map<std::weak_ptr<Texture2D>, TextureContentKey, std::owner_less<std::weak_ptr<Texture2D>>> g_textureCacheKeys;
+static uint64_t g_textureCacheBytesSaved = 0;
+static size_t g_textureCachePruneSize = 64; // entries at which the expired ones are dropped next
+
+static void PruneExpiredEntries() {
+    for (auto it = g_textureCacheEntries.begin(); it != g_textureCacheEntries.end();) {
+        if (it->second.texture.expired()) {
+            g_textureCacheKeys.erase(it->second.texture);
+            it = g_textureCacheEntries.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    // NOTE: Pruning again only once the live entries have doubled keeps the cost of adding constant on average
+    g_textureCachePruneSize = std::max<size_t>(64, g_textureCacheEntries.size() * 2);
+}
+
+TextureContentKey TextureCache_MakeKey(const Image& image, PixelFormat format, uint64_t buildKey) {
+    TextureContentKey key;
+    key.pixelHash = Hash64(image.Data().data(), image.Data().size());
+    key.width = static_cast<uint32_t>(image.Width());
+    key.height = static_cast<uint32_t>(image.Height());
+    key.format = format;
+    key.buildKey = buildKey;
+
+    return key;
+}
+
+Ref<Texture2D> TextureCache_Acquire(const TextureContentKey& key) {
+    std::lock_guard<std::mutex> lock(g_textureCacheMutex);
+
+    auto it = g_textureCacheEntries.find(key);
+    if (it == g_textureCacheEntries.end()) {
+        return nullptr;
+    }
+
+    Ref<Texture2D> texture = it->second.texture.lock();
+    if (!texture) {
+        g_textureCacheKeys.erase(it->second.texture);
+        g_textureCacheEntries.erase(it);
+        return nullptr;
+    }
+
+    it->second.shareCount++;
+    g_textureCacheBytesSaved += it->second.sizeBytes;
+
+    return texture;
+}
+
+void TextureCache_Add(const TextureContentKey& key, const Ref<Texture2D>& texture, uint64_t sizeBytes, const char* name) {
+    std::lock_guard<std::mutex> lock(g_textureCacheMutex);
+
+    if (g_textureCacheEntries.size() >= g_textureCachePruneSize) {
+        PruneExpiredEntries();
+    }
+
+    // NOTE: Replaces an entry whose texture is gone, the key of that texture is dropped with it
+    TextureCacheEntry& entry = g_textureCacheEntries[key];
+    g_textureCacheKeys.erase(entry.texture);
+
+    entry.texture = texture;
+    entry.name = name;
+    entry.sizeBytes = sizeBytes;
+    entry.shareCount = 0;
+
+    g_textureCacheKeys[texture] = key;
+}
+
+void TextureCache_Replace(const Ref<Texture2D>& oldTexture, const Ref<Texture2D>& newTexture) {
+    std::lock_guard<std::mutex> lock(g_textureCacheMutex);
+
+    auto it = g_textureCacheKeys.find(oldTexture);
+    if (it == g_textureCacheKeys.end()) {
+        return;
+    }
+
+    const TextureContentKey key = it->second;
+    g_textureCacheKeys.erase(it);
+
+    g_textureCacheEntries[key].texture = newTexture;
+    g_textureCacheKeys[newTexture] = key;
+}
+
+void TextureCache_Cleanup() {
+    std::lock_guard<std::mutex> lock(g_textureCacheMutex);
+
+    g_textureCacheEntries.clear();
+    g_textureCacheKeys.clear();
+    g_textureCacheBytesSaved = 0;
+    g_textureCachePruneSize = 64;
+}
+
+void TextureCache_LogReport() {
+    constexpr float MB = 1024.0f * 1024.0f;
+
+    std::lock_guard<std::mutex> lock(g_textureCacheMutex);
+
+    uint32_t liveCount = 0;
+    uint32_t sharedCount = 0;
+    std::vector<const TextureCacheEntry*> sharedEntries;
+    for (const auto& [key, entry] : g_textureCacheEntries) {
+        if (entry.texture.expired()) {
+            continue;
+        }
+
+        liveCount++;
+        if (entry.shareCount > 0) {
+            sharedCount += entry.shareCount;
+            sharedEntries.push_back(&entry);
+        }
+    }
+
+    Log::Info("Texture cache: %u textures, %u loads shared an existing one, %.1f MB saved", liveCount, sharedCount, g_textureCacheBytesSaved / MB);
+
+    std::sort(sharedEntries.begin(), sharedEntries.end(), [](const TextureCacheEntry* a, const TextureCacheEntry* b) {
+        return a->sizeBytes * a->shareCount > b->sizeBytes * b->shareCount;
+    });
+
+    for (const TextureCacheEntry* entry : sharedEntries) {
+        Log::Info("  %s: shared %u times, %.2f MB saved", entry->name.c_str(), entry->shareCount, entry->sizeBytes * entry->shareCount / MB);
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "EngineCore.h"
+
+namespace flaw {
+    class Image;
+}
+
+// NOTE: Identifies a texture by what it is built from rather than by where it was loaded from. buildKey is up to the caller and
+// covers everything besides the pixels and the format that changes the result, like compression or how the mips are filtered.
+struct TextureContentKey {
+    uint64_t pixelHash = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    PixelFormat format = PixelFormat::Undefined;
+    uint64_t buildKey = 0;
+
+    bool operator==(const TextureContentKey& other) const {
+        return pixelHash == other.pixelHash && width == other.width && height == other.height && format == other.format && buildKey == other.buildKey;
+    }
+};
+
+// NOTE: Process wide and thread safe, textures are held weakly so one nobody uses any more is not found.
+// Hashes the decoded pixels, meant to run on the thread that decoded them.
+TextureContentKey TextureCache_MakeKey(const Image& image, PixelFormat format, uint64_t buildKey);
+
+// NOTE: A texture found is counted as shared, sizeBytes of the entry are added to the bytes saved
+Ref<Texture2D> TextureCache_Acquire(const TextureContentKey& key);
+void TextureCache_Add(const TextureContentKey& key, const Ref<Texture2D>& texture, uint64_t sizeBytes, const char* name);
+
+// NOTE: Called when a texture is swapped for another version of itself, as the streamer does, so the entry follows it
+void TextureCache_Replace(const Ref<Texture2D>& oldTexture, const Ref<Texture2D>& newTexture);
+
+void TextureCache_Cleanup();
+void TextureCache_LogReport();
@@ -1,5 +1,7 @@
 #include "pch.h"
 #include "world.h"
+#include "streaming.h"
+#include "residency.h"
 #include "Platform/PlatformEvents.h"
 #include "Event/EventDispatcher.h"
 #include "Graphics/Vulkan/VkContext.h"
@@ -12,6 +14,7 @@
 #include "Model/Model.h"
 #include "Input/Input.h"
 #include "Log/Log.h"
+#include "Utils/AssetPack.h"
 
 Ref<PlatformContext> g_context;
 EventDispatcher g_eventDispatcher;
@@ -23,6 +26,14 @@ std::vector<uint32_t> g_outlineObjects;
 std::vector<uint32_t> g_viewNormalObjects;
 std::vector<uint32_t> g_spriteObjects;
 
+// NOTE: Vertex shaders drawing model meshes, each needs a <name>_packed.vert.spv build. shader_color is shader.vert with the color stream.
+constexpr const char* PackedVertexShaderNames[] = { "shader", "shader_color", "shadow", "shadow_point", "object", "outline" };
+
+// NOTE: Built by tools/assetpack, images and shaders found in it are read from it and everything else from the loose files.
+// Sequential suits slow disks and network filesystems, the data section is read in large blocks instead of faulted in pages.
+constexpr const char* AssetPackPath = "assets/assets.pack";
+constexpr AssetPackReadMode AssetPackMode = AssetPackReadMode::Mapped;
+
 const uint32_t camersConstantsCBBinding = 0;
 const uint32_t lightConstantsCBBinding = 1;
 const uint32_t materialConstantsCBBinding = 0;
@@ -41,6 +52,9 @@ const uint32_t pointShadowMapTextureBinding = 6;
 RenderQueue g_meshOnlyRenderQueue;
 RenderQueue g_renderQueue;
 
+// NOTE: The queues are built from the objects once and again only after a mesh they hold changed
+static bool g_renderQueueDirty = true;
+
 DirectionalLight g_directionalLight;
 std::vector<PointLight> g_pointLights;
 
@@ -57,14 +71,18 @@ Ref<RenderPass> g_postProcessRenderPass;
 Ref<FramebufferGroup> g_postProcessFramebufferGroup;
 
 Ref<VertexInputLayout> g_texturedVertexInputLayout;
+Ref<VertexInputLayout> g_packedVertexInputLayout;
+Ref<VertexInputLayout> g_quantizedPackedVertexInputLayout;
 Ref<VertexInputLayout> g_instanceVertexInputLayout;
+Ref<VertexInputLayout> g_colorVertexInputLayout;
 
 Ref<ConstantBuffer> g_cameraCB;
 Ref<ConstantBuffer> g_lightCB;
 Ref<ConstantBuffer> g_globalCB;
 Ref<StructuredBuffer> g_pointLightSB;
 Ref<StructuredBuffer> g_spotLightSB;
-Ref<GraphicsPipeline> g_objPipeline;
+std::array<Ref<GraphicsPipeline>, static_cast<size_t>(VertexFormat::Count)> g_objPipelines;
+std::array<Ref<GraphicsPipeline>, static_cast<size_t>(VertexFormat::Count)> g_objColorPipelines; // packed formats only
 Ref<ShaderResourcesLayout> g_objShaderResourcesLayout;
 Ref<ShaderResources> g_objShaderResources;
 Ref<ShaderResourcesLayout> g_objDynamicShaderResourcesLayout;
@@ -88,6 +106,10 @@ void InitObjectGraphicsPipeline();
 void World_Init() {
     Log::Initialize();
 
+    if (!AssetFiles::Mount(AssetPackPath, AssetPackMode)) {
+        Log::Info("No asset pack at %s, reading loose files", AssetPackPath);
+    }
+
     const int32_t windowWidth = 800;
     const int32_t windowHeight = 600;
 
@@ -411,6 +433,20 @@ void InitBaseResources() {
 
     g_texturedVertexInputLayout = g_graphicsContext->CreateVertexInputLayout(vertexInputLayoutDesc);
 
+    // NOTE: Packed static layouts, the shaders built with PACKED_VERTEX unfold the normal and tangent themselves
+    vertexInputLayoutDesc.inputElements = {
+        { "POSITION", ElementType::Float, 3 },
+        { "TEXCOORD", ElementType::Half, 2 },
+        { "NORMAL", ElementType::Snorm16, 2 },
+        { "TANGENT", ElementType::Snorm16, 2 }
+    };
+
+    g_packedVertexInputLayout = g_graphicsContext->CreateVertexInputLayout(vertexInputLayoutDesc);
+
+    vertexInputLayoutDesc.inputElements[0] = { "POSITION", ElementType::Unorm16, 4 };
+
+    g_quantizedPackedVertexInputLayout = g_graphicsContext->CreateVertexInputLayout(vertexInputLayoutDesc);
+
 	VertexInputLayout::Descriptor instanceInputLayoutDesc;
 	instanceInputLayoutDesc.vertexInputRate = VertexInputRate::Instance;
     instanceInputLayoutDesc.inputElements = {
@@ -426,6 +462,13 @@ void InitBaseResources() {
 
 	g_instanceVertexInputLayout = g_graphicsContext->CreateVertexInputLayout(instanceInputLayoutDesc);
 
+    // NOTE: Optional third stream of packed meshes whose vertex colors are not all white, see Mesh::colorBuffer
+    vertexInputLayoutDesc.inputElements = {
+        { "COLOR", ElementType::Unorm8, 4 }
+    };
+
+    g_colorVertexInputLayout = g_graphicsContext->CreateVertexInputLayout(vertexInputLayoutDesc);
+
 	// NOTE: Create instance vertex buffer pool
 	g_instanceVBPool = CreateRef<GraphicsResourcesPool<VertexBuffer>>(*g_graphicsContext, [](GraphicsContext& context) {
 		VertexBuffer::Descriptor desc;
@@ -565,37 +608,98 @@ void InitObjectShaderResources() {
     });
 }
 
-void InitObjectGraphicsPipeline() {
+static Ref<GraphicsPipeline> CreateObjectGraphicsPipeline(const std::string& vertexShaderFile, const std::vector<Ref<VertexInputLayout>>& vertexInputLayouts) {
     GraphicsShader::Descriptor shaderDesc;
 #if USE_VULKAN
-    shaderDesc.vertexShaderFile = "./assets/shaders/shader.vert.spv";
+    shaderDesc.vertexShaderFile = vertexShaderFile;
     shaderDesc.vertexShaderEntry = "main";
     shaderDesc.pixelShaderFile = "./assets/shaders/object_deffered.frag.spv";
     shaderDesc.pixelShaderEntry = "main";
 #elif USE_DX11
-	shaderDesc.vertexShaderFile = "./assets/shaders/shader.fx";
-	shaderDesc.vertexShaderEntry = "VSMain";
-	shaderDesc.pixelShaderFile = "./assets/shaders/shader.fx";
-	shaderDesc.pixelShaderEntry = "PSMain";
+    shaderDesc.vertexShaderFile = "./assets/shaders/shader.fx";
+    shaderDesc.vertexShaderEntry = "VSMain";
+    shaderDesc.pixelShaderFile = "./assets/shaders/shader.fx";
+    shaderDesc.pixelShaderEntry = "PSMain";
 #endif
 
     auto graphicsShader = g_graphicsContext->CreateGraphicsShader(shaderDesc);
 
-    g_objPipeline = g_graphicsContext->CreateGraphicsPipeline();
-	g_objPipeline->SetShaderResourcesLayouts({ g_objShaderResourcesLayout, g_objDynamicShaderResourcesLayout });
-    g_objPipeline->SetShader(graphicsShader);
-    g_objPipeline->SetPrimitiveTopology(PrimitiveTopology::TriangleList);
-    g_objPipeline->SetVertexInputLayouts({ g_texturedVertexInputLayout, g_instanceVertexInputLayout });
-	g_objPipeline->SetRenderPass(g_geometryRenderPass, 0);
-	g_objPipeline->EnableBlendMode(0, true);
-	g_objPipeline->EnableBlendMode(1, true);
-	g_objPipeline->EnableBlendMode(2, true);
-	g_objPipeline->EnableBlendMode(3, true);
-	g_objPipeline->SetBlendMode(0, BlendMode::Default);
-	g_objPipeline->SetBlendMode(1, BlendMode::Default);
-	g_objPipeline->SetBlendMode(2, BlendMode::Default);
-	g_objPipeline->SetBlendMode(3, BlendMode::Default);
-    g_objPipeline->SetBehaviorStates(GraphicsPipeline::Behavior::AutoResizeViewport | GraphicsPipeline::Behavior::AutoResizeScissor);
+    auto pipeline = g_graphicsContext->CreateGraphicsPipeline();
+    pipeline->SetShaderResourcesLayouts({ g_objShaderResourcesLayout, g_objDynamicShaderResourcesLayout });
+    pipeline->SetShader(graphicsShader);
+    pipeline->SetPrimitiveTopology(PrimitiveTopology::TriangleList);
+    // NOTE: Meshlets rejected by the cone test in CullMeshlets hold only back faces, which must be culled here as well
+    pipeline->SetCullMode(CullMode::Back);
+    pipeline->SetVertexInputLayouts(vertexInputLayouts);
+    pipeline->SetRenderPass(g_geometryRenderPass, 0);
+    pipeline->EnableBlendMode(0, true);
+    pipeline->EnableBlendMode(1, true);
+    pipeline->EnableBlendMode(2, true);
+    pipeline->EnableBlendMode(3, true);
+    pipeline->SetBlendMode(0, BlendMode::Default);
+    pipeline->SetBlendMode(1, BlendMode::Default);
+    pipeline->SetBlendMode(2, BlendMode::Default);
+    pipeline->SetBlendMode(3, BlendMode::Default);
+    pipeline->SetBehaviorStates(GraphicsPipeline::Behavior::AutoResizeViewport | GraphicsPipeline::Behavior::AutoResizeScissor);
+
+    return pipeline;
+}
+
+void InitObjectGraphicsPipeline() {
+    for (uint32_t i = 0; i < static_cast<uint32_t>(VertexFormat::Count); i++) {
+        const VertexFormat format = static_cast<VertexFormat>(i);
+        if (!IsVertexFormatSupported(format)) {
+            continue;
+        }
+
+        g_objPipelines[i] = CreateObjectGraphicsPipeline(GetVertexShaderPath("shader", format), { GetVertexInputLayout(format), g_instanceVertexInputLayout });
+
+        // NOTE: Only the geometry pass reads vertex colors, the shadow and outline pipelines never bind the color stream
+        if (format != VertexFormat::Textured) {
+            g_objColorPipelines[i] = CreateObjectGraphicsPipeline(GetVertexShaderPath("shader_color", format), { GetVertexInputLayout(format), g_instanceVertexInputLayout, g_colorVertexInputLayout });
+        }
+    }
+}
+
+bool IsVertexFormatSupported(VertexFormat format) {
+    if (format == VertexFormat::Textured) {
+        return true;
+    }
+
+#if USE_VULKAN
+    // NOTE: Packed variants are compiled from the same sources with -DPACKED_VERTEX by build.sh, older shader builds lack them
+    static const bool packedShadersBuilt = [] {
+        for (const char* name : PackedVertexShaderNames) {
+            if (!std::filesystem::exists(GetVertexShaderPath(name, VertexFormat::Packed))) {
+                Log::Warn("%s is missing, meshes keep the textured vertex format", GetVertexShaderPath(name, VertexFormat::Packed).c_str());
+                return false;
+            }
+        }
+        return true;
+    }();
+
+    return packedShadersBuilt;
+#else
+    return false;
+#endif
+}
+
+Ref<VertexInputLayout> GetVertexInputLayout(VertexFormat format) {
+    switch (format) {
+    case VertexFormat::Packed:
+        return g_packedVertexInputLayout;
+    case VertexFormat::PackedQuantized:
+        return g_quantizedPackedVertexInputLayout;
+    default:
+        return g_texturedVertexInputLayout;
+    }
+}
+
+std::string GetVertexShaderPath(const char* name, VertexFormat format) {
+    if (format == VertexFormat::Textured) {
+        return std::string("./assets/shaders/") + name + ".vert.spv";
+    }
+    return std::string("./assets/shaders/") + name + "_packed.vert.spv";
 }
 
 void World_Cleanup() {
@@ -606,7 +710,8 @@ void World_Cleanup() {
 	g_finalizeDynamicShaderResourcesPool.reset();
 	g_finalizeShaderResourcesLayout.reset();
 	g_instanceVBPool.reset();
-    g_objPipeline.reset();
+    g_objPipelines.fill(nullptr);
+    g_objColorPipelines.fill(nullptr);
     g_objShaderResources.reset();
     g_objShaderResourcesLayout.reset();
     g_objDynamicShaderResourcesPool.reset();
@@ -620,7 +725,10 @@ void World_Cleanup() {
     g_lightCB.reset();
     g_cameraCB.reset();
 	g_globalCB.reset();
+	g_colorVertexInputLayout.reset();
 	g_instanceVertexInputLayout.reset();
+    g_quantizedPackedVertexInputLayout.reset();
+    g_packedVertexInputLayout.reset();
     g_texturedVertexInputLayout.reset();
 	g_postProcessFramebufferGroup.reset();
 	g_postProcessRenderPass.reset();
@@ -633,11 +741,200 @@ void World_Cleanup() {
     g_graphicsContext.reset();
     g_context.reset();
 
+    AssetFiles::Cleanup();
+
     Log::Info("World resources cleaned up successfully.");
 
     Log::Cleanup();
 }
 
+// NOTE: Finest UV step per screen pixel each material is drawn with, from the segment bounds closest to the camera.
+// The queue outlives frames, so the density is recomputed from it every frame instead of while pushing.
+static void RequestStreamingMips(int32_t viewportHeight) {
+    const vec3 cameraPosition = g_camera->GetPosition();
+    const float nearClip = g_camera->GetNearFarClip().x;
+    const float pixelsPerUnitAtOne = g_camera->GetProjectionMatrix()[1][1] * viewportHeight * 0.5f;
+
+    g_renderQueue.Reset();
+    while (!g_renderQueue.Empty()) {
+        auto& entry = g_renderQueue.Front();
+
+        float uvPerPixel = std::numeric_limits<float>::max();
+        for (const auto& instancingObj : entry.instancingObjects) {
+            const MeshSegment* segment = instancingObj.GetSegment();
+            if (!segment || segment->uvDensity <= 0.0f) {
+                continue;
+            }
+
+            // NOTE: Instance matrices of packed meshes include the position decode, take it back out to get the object's own
+            const mat4 positionEncode = inverse(instancingObj.mesh->positionDecode);
+
+            for (const auto& instanceData : instancingObj.instanceDatas) {
+                const mat4 modelMatrix = instanceData.model_matrix * positionEncode;
+                const float scale = std::max({ length(vec3(modelMatrix[0])), length(vec3(modelMatrix[1])), length(vec3(modelMatrix[2])) });
+                const vec3 center = vec3(modelMatrix * vec4(segment->boundsCenter, 1.0f));
+                const float distance = std::max(length(center - cameraPosition) - segment->boundsRadius * scale, nearClip);
+
+                uvPerPixel = std::min(uvPerPixel, segment->uvDensity * distance / (scale * pixelsPerUnitAtOne));
+            }
+        }
+
+        if (uvPerPixel < std::numeric_limits<float>::max()) {
+            TextureStreaming_Request(entry.material, uvPerPixel);
+        }
+
+        g_renderQueue.Next();
+    }
+}
+
+// NOTE: Meshes with meshlets left after culling and the textures of their materials count as drawn for the residency budget,
+// evicted ones among them are reloaded
+static void MarkResidentAssetsUsed() {
+    g_renderQueue.Reset();
+    while (!g_renderQueue.Empty()) {
+        auto& entry = g_renderQueue.Front();
+
+        bool drawn = false;
+        for (const auto& instancingObj : entry.instancingObjects) {
+            if (!instancingObj.visibleRanges.empty()) {
+                Residency_MarkUsed(instancingObj.mesh.get());
+                drawn = true;
+            }
+        }
+
+        if (drawn) {
+            for (const Ref<Texture2D>* texture : { &entry.material->diffuseTexture, &entry.material->specularTexture, &entry.material->normalTexture, &entry.material->displacementTexture, &entry.material->ambientOcclusionTexture }) {
+                if (*texture) {
+                    Residency_MarkUsed(texture->get());
+                }
+            }
+        }
+
+        g_renderQueue.Next();
+    }
+}
+
+struct MeshletCullingStats {
+    uint64_t triangles = 0;
+    uint64_t frustumRejected = 0;
+    uint64_t coneRejected = 0;
+    uint64_t drawn = 0;
+    uint32_t views = 0;
+
+    void Add(const MeshletCullingStats& other) {
+        triangles += other.triangles;
+        frustumRejected += other.frustumRejected;
+        coneRejected += other.coneRejected;
+        drawn += other.drawn;
+        views += other.views;
+    }
+};
+
+static MeshletCullingStats g_meshletLastView;
+static MeshletCullingStats g_meshletTotal;
+
+// NOTE: Keeps the meshlets any instance of a segment sees from the main camera, a meshlet is rejected for an instance when its
+// sphere is outside the frustum or its normal cone faces away from the camera. Triangles are counted once per instance.
+static void CullMeshlets() {
+    MeshletCullingStats stats;
+    stats.views = 1;
+
+    // NOTE: The orthographic camera has no frustum yet, everything is drawn
+    const bool cull = g_camera->IsPerspective();
+    Frustum frustum = g_camera->GetCurrentCamera()->GetFrustum();
+    const vec3 cameraPosition = g_camera->GetPosition();
+
+    std::vector<mat4> modelMatrices;
+    std::vector<vec3> objectCameraPositions;
+
+    g_renderQueue.Reset();
+    while (!g_renderQueue.Empty()) {
+        auto& entry = g_renderQueue.Front();
+
+        for (auto& instancingObj : entry.instancingObjects) {
+            instancingObj.visibleRanges.clear();
+
+            const MeshSegment* segment = instancingObj.GetSegment();
+            if (!segment) {
+                continue;
+            }
+
+            if (!cull || segment->meshletCount == 0) {
+                instancingObj.visibleRanges.push_back({ 0, segment->indexCount });
+                continue;
+            }
+
+            // NOTE: Meshlet bounds are in the object's own space, without the position decode of packed meshes
+            const mat4 positionEncode = inverse(instancingObj.mesh->positionDecode);
+
+            modelMatrices.clear();
+            objectCameraPositions.clear();
+            for (const auto& instanceData : instancingObj.instanceDatas) {
+                modelMatrices.push_back(instanceData.model_matrix * positionEncode);
+                objectCameraPositions.push_back(vec3(instanceData.inv_model_matrix * vec4(cameraPosition, 1.0f)));
+            }
+
+            for (uint32_t i = segment->meshletOffset; i < segment->meshletOffset + segment->meshletCount; ++i) {
+                const Meshlet& meshlet = instancingObj.mesh->meshlets[i];
+                const uint32_t triangleCount = meshlet.indexCount / 3;
+
+                bool visible = false;
+                for (uint32_t j = 0; j < modelMatrices.size(); ++j) {
+                    stats.triangles += triangleCount;
+
+                    if (!frustum.TestInside(meshlet.center, meshlet.radius, modelMatrices[j])) {
+                        stats.frustumRejected += triangleCount;
+                    }
+                    else if (MeshletBuilder::IsBackfacing(meshlet, objectCameraPositions[j])) {
+                        stats.coneRejected += triangleCount;
+                    }
+                    else {
+                        visible = true;
+                    }
+                }
+
+                if (!visible) {
+                    continue;
+                }
+
+                stats.drawn += static_cast<uint64_t>(triangleCount) * modelMatrices.size();
+
+                auto& ranges = instancingObj.visibleRanges;
+                if (!ranges.empty() && ranges.back().indexOffset + ranges.back().indexCount == meshlet.indexOffset) {
+                    ranges.back().indexCount += meshlet.indexCount;
+                }
+                else {
+                    ranges.push_back({ meshlet.indexOffset, meshlet.indexCount });
+                }
+            }
+        }
+
+        g_renderQueue.Next();
+    }
+
+    if (stats.triangles != 0) {
+        g_meshletLastView = stats;
+        g_meshletTotal.Add(stats);
+    }
+}
+
+void World_LogMeshletReport() {
+    auto percent = [](uint64_t part, uint64_t total) {
+        return total ? 100.0 * static_cast<double>(part) / static_cast<double>(total) : 0.0;
+    };
+
+    const MeshletCullingStats& last = g_meshletLastView;
+    const MeshletCullingStats& total = g_meshletTotal;
+
+    Log::Info("Meshlet culling, last view: %llu triangles, %.1f%% rejected by frustum, %.1f%% by cone, %.1f%% drawn",
+        static_cast<unsigned long long>(last.triangles), percent(last.frustumRejected, last.triangles), percent(last.coneRejected, last.triangles), percent(last.drawn, last.triangles));
+
+    Log::Info("Meshlet culling, %u views: %.1f%% rejected by frustum, %.1f%% by cone, %.1f%% drawn",
+        total.views, percent(total.frustumRejected, total.triangles), percent(total.coneRejected, total.triangles), percent(total.drawn, total.triangles));
+
+    g_meshletTotal = MeshletCullingStats();
+}
+
 void World_Update() {
 	g_objDynamicShaderResourcesPool->Reset();
 	g_objMaterialCBPool->Reset();
@@ -716,9 +1013,7 @@ void World_Update() {
 
 	g_globalCB->Update(&globalConstants, sizeof(GlobalConstants));
 
-    static bool initRender = false;
-
-    if (!initRender) {
+    if (g_renderQueueDirty) {
 		g_meshOnlyRenderQueue.Clear();
 		g_renderQueue.Clear();
         g_outlineObjects.clear();
@@ -761,8 +1056,16 @@ void World_Update() {
         g_renderQueue.Close();
 		g_meshOnlyRenderQueue.Close();
 
-		initRender = true;
+		g_renderQueueDirty = false;
     }
+
+    RequestStreamingMips(height);
+    CullMeshlets();
+    MarkResidentAssetsUsed();
+}
+
+void World_InvalidateRenderQueue() {
+    g_renderQueueDirty = true;
 }
 
 void World_Geometry_Render() {
@@ -772,7 +1075,11 @@ void World_Geometry_Render() {
 	objInstanceVB->Update(g_renderQueue.AllInstanceDatas().data(), sizeof(InstanceData) * g_renderQueue.AllInstanceDatas().size());
 
 	uint32_t instanceOffset = 0;
-    commandQueue.SetPipeline(g_objPipeline);
+    Ref<GraphicsPipeline> currentPipeline;
+    Ref<VertexBuffer> currentVertexBuffer;
+    Ref<VertexBuffer> currentColorBuffer;
+
+    const Ref<Texture2D>& dummyTexture = GetTexture2D(g_dummyTexture);
 
     g_renderQueue.Reset();
 	while (!g_renderQueue.Empty()) {
@@ -783,7 +1090,21 @@ void World_Geometry_Render() {
         objMaterialCB->Update(&materialConstants, sizeof(MaterialConstants));
 
         for (const auto& instancingObj : entry.instancingObjects) {
-			const auto& segment = instancingObj.mesh->segments[instancingObj.segmentIndex];
+			const MeshSegment* segment = instancingObj.GetSegment();
+
+            // NOTE: Meshes evicted by the residency budget have no buffers until their reload lands
+            if (!segment || instancingObj.visibleRanges.empty() || !instancingObj.mesh->vertexBuffer) {
+                instanceOffset += instancingObj.instanceCount;
+                continue;
+            }
+
+            const Mesh& mesh = *instancingObj.mesh;
+            const size_t formatIndex = static_cast<size_t>(mesh.vertexFormat);
+            const Ref<GraphicsPipeline>& pipeline = mesh.colorBuffer ? g_objColorPipelines[formatIndex] : g_objPipelines[formatIndex];
+            if (pipeline != currentPipeline) {
+                currentPipeline = pipeline;
+                commandQueue.SetPipeline(currentPipeline);
+            }
 
             auto objDynamicResources = g_objDynamicShaderResourcesPool->Get();
 
@@ -793,40 +1114,55 @@ void World_Geometry_Render() {
                 objDynamicResources->BindTexture2D(entry.material->diffuseTexture, diffuseTextureBinding);
             }
             else {
-                objDynamicResources->BindTexture2D(GetTexture2D("dummy"), diffuseTextureBinding);
+                objDynamicResources->BindTexture2D(dummyTexture, diffuseTextureBinding);
             }
 
             if (entry.material->specularTexture) {
                 objDynamicResources->BindTexture2D(entry.material->specularTexture, specularTextureBinding);
             }
             else {
-                objDynamicResources->BindTexture2D(GetTexture2D("dummy"), specularTextureBinding);
+                objDynamicResources->BindTexture2D(dummyTexture, specularTextureBinding);
             }
 
 			if (entry.material->normalTexture) {
 				objDynamicResources->BindTexture2D(entry.material->normalTexture, normalTextureBinding);
 			}
 			else {
-				objDynamicResources->BindTexture2D(GetTexture2D("dummy"), normalTextureBinding);
+				objDynamicResources->BindTexture2D(dummyTexture, normalTextureBinding);
 			}
 
 			if (entry.material->displacementTexture) {
 				objDynamicResources->BindTexture2D(entry.material->displacementTexture, displacementTextureBinding);
 			}
 			else {
-				objDynamicResources->BindTexture2D(GetTexture2D("dummy"), displacementTextureBinding);
+				objDynamicResources->BindTexture2D(dummyTexture, displacementTextureBinding);
 			}
 
 			if (entry.material->ambientOcclusionTexture) {
 				objDynamicResources->BindTexture2D(entry.material->ambientOcclusionTexture, occlusionTextureBinding);
 			}
 			else {
-				objDynamicResources->BindTexture2D(GetTexture2D("dummy"), occlusionTextureBinding);
+				objDynamicResources->BindTexture2D(dummyTexture, occlusionTextureBinding);
 			}
 
-            commandQueue.SetVertexBuffers({ instancingObj.mesh->vertexBuffer, objInstanceVB });
+            // NOTE: Pooled meshes share their pages, the buffers are bound again only when a mesh lives in another one.
+            // A mesh without colors leaves the color stream of the previous one bound, its pipeline does not read it.
+            if (mesh.vertexBuffer != currentVertexBuffer || (mesh.colorBuffer && mesh.colorBuffer != currentColorBuffer)) {
+                currentVertexBuffer = mesh.vertexBuffer;
+                currentColorBuffer = mesh.colorBuffer;
+
+                if (currentColorBuffer) {
+                    commandQueue.SetVertexBuffers({ currentVertexBuffer, objInstanceVB, currentColorBuffer });
+                }
+                else {
+                    commandQueue.SetVertexBuffers({ currentVertexBuffer, objInstanceVB });
+                }
+            }
+
             commandQueue.SetShaderResources({ g_objShaderResources, objDynamicResources });
-            commandQueue.DrawIndexedInstanced(instancingObj.mesh->indexBuffer, segment.indexCount, instancingObj.instanceCount, segment.indexOffset, segment.vertexOffset, instanceOffset);
+            for (const auto& range : instancingObj.visibleRanges) {
+                commandQueue.DrawIndexedInstanced(instancingObj.mesh->indexBuffer, range.indexCount, instancingObj.instanceCount, segment->indexOffset + range.indexOffset, segment->vertexOffset, instanceOffset);
+            }
 
 			instanceOffset += instancingObj.instanceCount;
         }
@@ -838,7 +1174,7 @@ void World_Geometry_Render() {
 void World_FinalizeRender() {
     auto& commandQueue = g_graphicsContext->GetCommandQueue();
 
-    auto quad = GetMesh("quad");
+    auto quad = GetMesh(g_quadMesh);
 	auto sceneFramebuffer = g_sceneFramebufferGroup->Get();
 	auto bloomFramebuffer = g_bloomFramebufferGroup->Get();
 
@@ -851,7 +1187,7 @@ void World_FinalizeRender() {
 	commandQueue.SetPipeline(g_finalizePipeline);
 	commandQueue.SetVertexBuffers({ quad->vertexBuffer });
 	commandQueue.SetShaderResources({ finalizeSR });
-	commandQueue.DrawIndexed(quad->indexBuffer, quad->indexBuffer->IndexCount());
+	commandQueue.DrawIndexed(quad->indexBuffer, quad->segments[0].indexCount, quad->segments[0].indexOffset, quad->segments[0].vertexOffset);
 
 	commandQueue.ResetShaderResources();
 }
@@ -54,7 +54,10 @@ extern Ref<FramebufferGroup> g_bloomFramebufferGroup;
 extern Ref<RenderPass> g_postProcessRenderPass;
 extern Ref<FramebufferGroup> g_postProcessFramebufferGroup;
 extern Ref<VertexInputLayout> g_texturedVertexInputLayout;
+extern Ref<VertexInputLayout> g_packedVertexInputLayout;
+extern Ref<VertexInputLayout> g_quantizedPackedVertexInputLayout;
 extern Ref<VertexInputLayout> g_instanceVertexInputLayout;
+extern Ref<VertexInputLayout> g_colorVertexInputLayout;
 extern Ref<ConstantBuffer> g_cameraCB;
 extern Ref<ConstantBuffer> g_globalCB;
 extern Ref<ConstantBuffer> g_lightCB;
@@ -70,6 +73,15 @@ void World_Cleanup();
 void World_Update();
 void World_Geometry_Render();
 void World_FinalizeRender();
+void World_LogMeshletReport();
+
+// NOTE: Called when the contents of a mesh are swapped, the render queue keeps its segments and materials and is built again
+void World_InvalidateRenderQueue();
+
+// NOTE: Model mesh passes keep one pipeline per supported vertex format and switch on Mesh::vertexFormat
+bool IsVertexFormatSupported(VertexFormat format);
+Ref<VertexInputLayout> GetVertexInputLayout(VertexFormat format);
+std::string GetVertexShaderPath(const char* name, VertexFormat format);
 
 void SSAO_Init();
 void SSAO_Cleanup();
@@ -0,0 +1,143 @@
+#include "pch.h"
+#include "Log/Log.h"
+#include "Utils/AssetPack.h"
+
+#include <algorithm>
+#include <cctype>
+
+using namespace flaw;
+
+// NOTE: Only the files the application reads through AssetFiles are packed. Models are imported by assimp from their loose files
+// and EXR images are decoded from a path, packing them would only make the pack larger.
+static const std::unordered_set<std::string> PackedExtensions = { ".png", ".jpg", ".jpeg", ".bmp", ".tga", ".hdr", ".spv" };
+
+// NOTE: Directories of generated files, they differ per machine and are rebuilt on demand
+static const std::unordered_set<std::string> SkippedDirectories = { "cache" };
+
+static void PrintUsage() {
+	Log::Info("Usage: assetpack <assets directory> <output pack> [--order <load_trace.csv>] [--align <bytes>] [--no-compress]");
+	Log::Info("Files are laid out in the order of the trace written by the application, the rest follow sorted by path");
+}
+
+// NOTE: The second column of the trace written by AssetFiles::WriteTrace
+static std::vector<std::string> ReadLoadOrder(const char* tracePath) {
+	std::vector<std::string> order;
+
+	std::ifstream file(tracePath);
+	if (!file) {
+		Log::Warn("Load trace %s not found, files are sorted by path", tracePath);
+		return order;
+	}
+
+	std::string line;
+	std::getline(file, line);
+	while (std::getline(file, line)) {
+		const size_t begin = line.find(',');
+		const size_t end = begin == std::string::npos ? std::string::npos : line.find(',', begin + 1);
+		if (end != std::string::npos) {
+			order.push_back(line.substr(begin + 1, end - begin - 1));
+		}
+	}
+
+	return order;
+}
+
+int main(int argc, char** argv) {
+	Log::Initialize();
+
+	if (argc < 3) {
+		PrintUsage();
+		Log::Cleanup();
+		return 1;
+	}
+
+	const char* assetDirectory = argv[1];
+	const char* packPath = argv[2];
+	const char* tracePath = nullptr;
+	uint32_t alignment = 4096;
+	bool compress = true;
+
+	for (int32_t i = 3; i < argc; ++i) {
+		const std::string argument = argv[i];
+		if (argument == "--order" && i + 1 < argc) {
+			tracePath = argv[++i];
+		}
+		else if (argument == "--align" && i + 1 < argc) {
+			alignment = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (argument == "--no-compress") {
+			compress = false;
+		}
+		else {
+			PrintUsage();
+			Log::Cleanup();
+			return 1;
+		}
+	}
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	// NOTE: Names are the paths as the application opens them, relative to the directory the tool runs in
+	std::vector<std::string> files;
+	std::error_code ec;
+	for (auto it = std::filesystem::recursive_directory_iterator(assetDirectory, ec); it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+		if (ec) {
+			break;
+		}
+
+		if (it->is_directory() && SkippedDirectories.find(it->path().filename().generic_string()) != SkippedDirectories.end()) {
+			it.disable_recursion_pending();
+			continue;
+		}
+
+		std::string extension = it->path().extension().generic_string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+		if (it->is_regular_file() && PackedExtensions.find(extension) != PackedExtensions.end()) {
+			files.push_back(AssetPack::NormalizePath(it->path().generic_string().c_str()));
+		}
+	}
+
+	std::sort(files.begin(), files.end());
+
+	std::vector<std::string> orderedFiles;
+	std::unordered_set<std::string> remainingFiles(files.begin(), files.end());
+	if (tracePath) {
+		for (const std::string& file : ReadLoadOrder(tracePath)) {
+			if (remainingFiles.erase(file)) {
+				orderedFiles.push_back(file);
+			}
+		}
+	}
+
+	const size_t tracedCount = orderedFiles.size();
+	for (const std::string& file : files) {
+		if (remainingFiles.find(file) != remainingFiles.end()) {
+			orderedFiles.push_back(file);
+		}
+	}
+
+	AssetPackBuilder builder(alignment, compress);
+	for (const std::string& file : orderedFiles) {
+		if (!builder.AddFile(file, file)) {
+			Log::Error("Failed to read %s", file.c_str());
+			Log::Cleanup();
+			return 1;
+		}
+	}
+
+	if (!builder.Write(packPath)) {
+		Log::Error("Failed to write %s", packPath);
+		Log::Cleanup();
+		return 1;
+	}
+
+	constexpr double MB = 1024.0 * 1024.0;
+	std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+	Log::Info("Packed %u files (%zu in load order) into %s, %.1f MB -> %.1f MB in %.1f ms",
+		builder.GetEntryCount(), tracedCount, packPath, builder.GetSourceSize() / MB, builder.GetStoredSize() / MB, elapsed.count());
+
+	Log::Cleanup();
+
+	return 0;
+}
@@ -0,0 +1,341 @@
+#include "pch.h"
+#include "Log/Log.h"
+#include "Model/MeshCodec.h"
+#include "Model/CookedMesh.h"
+
+#include <cstring>
+
+using namespace flaw;
+
+// NOTE: Round trips geometry through MeshCodec and through compressed cooked meshes, any bit that differs fails the run. The
+// generated meshes cover the index codes and vertex group widths, cooked meshes from assets/cache show the ratio on real data.
+
+static void PrintUsage() {
+	Log::Info("Usage: meshcodec [<cooked mesh>...]");
+	Log::Info("Checks generated meshes, then every cooked mesh given, e.g. the .mesh files in assets/cache");
+}
+
+struct RoundTripStats {
+	uint64_t rawBytes = 0;
+	uint64_t encodedBytes = 0;
+	double decodeSeconds = 0.0;
+
+	void Add(const RoundTripStats& other) {
+		rawBytes += other.rawBytes;
+		encodedBytes += other.encodedBytes;
+		decodeSeconds += other.decodeSeconds;
+	}
+};
+
+static bool CheckCodec(const char* name, const void* vertices, uint32_t vertexCount, uint32_t vertexStride, const uint32_t* indices, uint32_t indexCount, RoundTripStats& stats) {
+	std::vector<uint8_t> encodedVertices;
+	if (!MeshCodec::EncodeVertexBuffer(vertices, vertexCount, vertexStride, encodedVertices)) {
+		Log::Error("%s: vertex stride %u is not encodable", name, vertexStride);
+		return false;
+	}
+
+	std::vector<uint8_t> encodedIndices;
+	MeshCodec::EncodeIndexBuffer(indices, indexCount, encodedIndices);
+
+	std::vector<uint8_t> decodedVertices(static_cast<size_t>(vertexStride) * vertexCount);
+	std::vector<uint32_t> decodedIndices(indexCount);
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	if (!MeshCodec::DecodeVertexBuffer(encodedVertices.data(), encodedVertices.size(), decodedVertices.data(), vertexCount, vertexStride)
+		|| !MeshCodec::DecodeIndexBuffer(encodedIndices.data(), encodedIndices.size(), decodedIndices.data(), indexCount))
+	{
+		Log::Error("%s: failed to decode", name);
+		return false;
+	}
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+	if ((!decodedVertices.empty() && std::memcmp(decodedVertices.data(), vertices, decodedVertices.size()) != 0)
+		|| (!decodedIndices.empty() && std::memcmp(decodedIndices.data(), indices, sizeof(uint32_t) * indexCount) != 0))
+	{
+		Log::Error("%s: decoded geometry differs from the input", name);
+		return false;
+	}
+
+	// NOTE: Truncated streams must be rejected rather than read past their end
+	if (!encodedVertices.empty() && vertexCount != 0
+		&& MeshCodec::DecodeVertexBuffer(encodedVertices.data(), encodedVertices.size() - 1, decodedVertices.data(), vertexCount, vertexStride))
+	{
+		Log::Error("%s: truncated vertex stream was accepted", name);
+		return false;
+	}
+
+	if (!encodedIndices.empty() && indexCount != 0
+		&& MeshCodec::DecodeIndexBuffer(encodedIndices.data(), encodedIndices.size() - 1, decodedIndices.data(), indexCount))
+	{
+		Log::Error("%s: truncated index stream was accepted", name);
+		return false;
+	}
+
+	stats.rawBytes = decodedVertices.size() + sizeof(uint32_t) * static_cast<uint64_t>(indexCount);
+	stats.encodedBytes = encodedVertices.size() + encodedIndices.size();
+	stats.decodeSeconds = elapsed.count();
+
+	return true;
+}
+
+// NOTE: Serializes with compressed geometry and opens the result, the CookedMesh must hand out the same geometry and tables
+static bool CheckCookedMesh(const char* name, const CookedMeshDesc& desc) {
+	CookedMeshDesc compressedDesc = desc;
+	compressedDesc.compressGeometry = true;
+
+	std::vector<uint8_t> buffer;
+	CookedMesh::Serialize(compressedDesc, buffer);
+
+	CookedMesh cooked;
+	if (!cooked.Open(std::move(buffer))) {
+		Log::Error("%s: compressed cooked mesh failed to open", name);
+		return false;
+	}
+
+	if (!cooked.IsCompressed()) {
+		Log::Error("%s: cooked mesh was not compressed", name);
+		return false;
+	}
+
+	const uint64_t vertexDataSize = static_cast<uint64_t>(desc.vertexStride) * desc.vertexCount;
+	if (cooked.GetVertexCount() != desc.vertexCount
+		|| cooked.GetVertexStride() != desc.vertexStride
+		|| cooked.GetIndexCount() != desc.indexCount
+		|| cooked.GetSegmentCount() != desc.segments.size()
+		|| cooked.GetMeshletCount() != desc.meshlets.size()
+		|| cooked.GetMaterialCount() != desc.materials.size()
+		|| (vertexDataSize != 0 && std::memcmp(cooked.GetVertexData(), desc.vertices, vertexDataSize) != 0)
+		|| (desc.indexCount != 0 && std::memcmp(cooked.GetIndexData(), desc.indices, sizeof(uint32_t) * desc.indexCount) != 0)
+		|| (!desc.segments.empty() && std::memcmp(cooked.GetSegments(), desc.segments.data(), sizeof(CookedMeshSegment) * desc.segments.size()) != 0)
+		|| (!desc.meshlets.empty() && std::memcmp(cooked.GetMeshlets(), desc.meshlets.data(), sizeof(Meshlet) * desc.meshlets.size()) != 0))
+	{
+		Log::Error("%s: compressed cooked mesh differs from the input", name);
+		return false;
+	}
+
+	for (uint32_t i = 0; i < cooked.GetMaterialCount(); ++i) {
+		for (uint32_t slot = 0; slot < CookedTextureSlotCount; ++slot) {
+			const char* texturePath = cooked.GetTexturePath(i, static_cast<CookedTextureSlot>(slot));
+			if (std::string(texturePath ? texturePath : "") != desc.materials[i].texturePaths[slot]) {
+				Log::Error("%s: texture path of material %u differs", name, i);
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static void LogStats(const char* name, const RoundTripStats& stats) {
+	constexpr double MB = 1024.0 * 1024.0;
+	Log::Info("%s: %.2f MB -> %.2f MB (%.1f%%), decode %.0f MB/s", name, stats.rawBytes / MB, stats.encodedBytes / MB,
+		stats.rawBytes != 0 ? 100.0 * stats.encodedBytes / stats.rawBytes : 100.0, stats.decodeSeconds > 0.0 ? stats.rawBytes / MB / stats.decodeSeconds : 0.0);
+}
+
+// NOTE: Grid of position, normal and uv floats followed by a color word, indexed row by row as a vertex cache optimized mesh would be
+static void GenerateGrid(uint32_t size, std::vector<uint8_t>& vertices, uint32_t& vertexStride, std::vector<uint32_t>& indices) {
+	struct GridVertex {
+		float position[3];
+		float normal[3];
+		float texCoord[2];
+		uint32_t color;
+	};
+
+	vertexStride = sizeof(GridVertex);
+	vertices.resize(sizeof(GridVertex) * size * size);
+
+	GridVertex* gridVertices = reinterpret_cast<GridVertex*>(vertices.data());
+	for (uint32_t y = 0; y < size; ++y) {
+		for (uint32_t x = 0; x < size; ++x) {
+			const float u = static_cast<float>(x) / (size - 1);
+			const float v = static_cast<float>(y) / (size - 1);
+
+			GridVertex& vertex = gridVertices[y * size + x];
+			vertex.position[0] = u * 10.0f;
+			vertex.position[1] = std::sin(u * 6.0f) * std::cos(v * 6.0f);
+			vertex.position[2] = v * 10.0f;
+			vertex.normal[0] = 0.0f;
+			vertex.normal[1] = 1.0f;
+			vertex.normal[2] = 0.0f;
+			vertex.texCoord[0] = u;
+			vertex.texCoord[1] = v;
+			vertex.color = 0xFFFFFFFFu;
+		}
+	}
+
+	indices.clear();
+	for (uint32_t y = 0; y + 1 < size; ++y) {
+		for (uint32_t x = 0; x + 1 < size; ++x) {
+			const uint32_t i = y * size + x;
+			indices.insert(indices.end(), { i, i + size, i + 1, i + 1, i + size, i + size + 1 });
+		}
+	}
+}
+
+static bool CheckGeneratedMeshes(RoundTripStats& totalStats) {
+	std::mt19937 random(1234);
+
+	std::vector<uint8_t> vertices;
+	uint32_t vertexStride = 0;
+	std::vector<uint32_t> indices;
+
+	GenerateGrid(257, vertices, vertexStride, indices);
+	const uint32_t vertexCount = static_cast<uint32_t>(vertices.size() / vertexStride);
+
+	struct Case {
+		std::string name;
+		std::vector<uint8_t> vertices;
+		uint32_t vertexStride;
+		std::vector<uint32_t> indices;
+	};
+
+	std::vector<Case> cases;
+	cases.push_back({ "grid", vertices, vertexStride, indices });
+
+	// NOTE: Triangles in random order mostly miss the FIFO, which exercises the literal index code
+	std::vector<uint32_t> shuffledIndices = indices;
+	std::vector<uint32_t> triangleOrder(indices.size() / 3);
+	std::iota(triangleOrder.begin(), triangleOrder.end(), 0);
+	std::shuffle(triangleOrder.begin(), triangleOrder.end(), random);
+	for (size_t i = 0; i < triangleOrder.size(); ++i) {
+		std::copy_n(indices.begin() + triangleOrder[i] * 3, 3, shuffledIndices.begin() + i * 3);
+	}
+	cases.push_back({ "shuffled grid", vertices, vertexStride, shuffledIndices });
+
+	// NOTE: Random bytes need the full 8 bit width in every group
+	std::vector<uint8_t> noise(static_cast<size_t>(MeshCodec::MaxVertexStride) * 1000);
+	std::generate(noise.begin(), noise.end(), [&]() { return static_cast<uint8_t>(random()); });
+	std::vector<uint32_t> noiseIndices(3000);
+	std::generate(noiseIndices.begin(), noiseIndices.end(), [&]() { return random() % 1000; });
+	cases.push_back({ "noise", noise, MeshCodec::MaxVertexStride, noiseIndices });
+
+	// NOTE: Vertex counts around the block size and the smallest inputs
+	for (uint32_t count : { 0u, 1u, MeshCodec::VertexBlockSize - 1, MeshCodec::VertexBlockSize, MeshCodec::VertexBlockSize + 1 }) {
+		std::vector<uint8_t> partialVertices(vertices.begin(), vertices.begin() + static_cast<size_t>(count) * vertexStride);
+		std::vector<uint32_t> partialIndices;
+		for (uint32_t i = 0; i + 2 < count; ++i) {
+			partialIndices.insert(partialIndices.end(), { i, i + 1, i + 2 });
+		}
+		cases.push_back({ "grid of " + std::to_string(count) + " vertices", partialVertices, vertexStride, partialIndices });
+	}
+
+	for (const Case& testCase : cases) {
+		const uint32_t caseVertexCount = static_cast<uint32_t>(testCase.vertices.size() / testCase.vertexStride);
+
+		RoundTripStats stats;
+		if (!CheckCodec(testCase.name.c_str(), testCase.vertices.data(), caseVertexCount, testCase.vertexStride, testCase.indices.data(), static_cast<uint32_t>(testCase.indices.size()), stats)) {
+			return false;
+		}
+
+		LogStats(testCase.name.c_str(), stats);
+		totalStats.Add(stats);
+	}
+
+	CookedMeshDesc desc;
+	desc.vertices = vertices.data();
+	desc.vertexStride = vertexStride;
+	desc.vertexCount = vertexCount;
+	desc.indices = indices.data();
+	desc.indexCount = static_cast<uint32_t>(indices.size());
+	desc.boundsMax = vec3(10.0f, 1.0f, 10.0f);
+	desc.boundsMin = vec3(0.0f, -1.0f, 0.0f);
+
+	// NOTE: Two segments over the same vertices, the second starts one row in
+	CookedMeshSegment firstSegment;
+	firstSegment.indexCount = desc.indexCount / 2;
+	firstSegment.materialIndex = 0;
+
+	CookedMeshSegment secondSegment;
+	secondSegment.vertexOffset = 257;
+	secondSegment.indexOffset = firstSegment.indexCount;
+	secondSegment.indexCount = 6;
+	secondSegment.materialIndex = 0;
+
+	desc.segments = { firstSegment, secondSegment };
+
+	CookedMaterialDesc material;
+	material.baseColor = vec3(1.0f);
+	material.texturePaths[static_cast<uint32_t>(CookedTextureSlot::Diffuse)] = "assets/textures/grid.png";
+	desc.materials.push_back(material);
+
+	return CheckCookedMesh("generated cooked mesh", desc);
+}
+
+static bool CheckCookedFile(const char* path, RoundTripStats& totalStats) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file) {
+		Log::Error("Failed to read %s", path);
+		return false;
+	}
+
+	std::vector<uint8_t> buffer(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+
+	CookedMesh cooked;
+	if (!cooked.Open(std::move(buffer))) {
+		Log::Error("%s is not a cooked mesh of this version", path);
+		return false;
+	}
+
+	RoundTripStats stats;
+	if (!CheckCodec(path, cooked.GetVertexData(), cooked.GetVertexCount(), cooked.GetVertexStride(), cooked.GetIndexData(), cooked.GetIndexCount(), stats)) {
+		return false;
+	}
+
+	LogStats(path, stats);
+	totalStats.Add(stats);
+
+	CookedMeshDesc desc;
+	desc.vertices = cooked.GetVertexData();
+	desc.vertexStride = cooked.GetVertexStride();
+	desc.vertexCount = cooked.GetVertexCount();
+	desc.indices = cooked.GetIndexData();
+	desc.indexCount = cooked.GetIndexCount();
+	desc.boundsMin = cooked.GetBoundsMin();
+	desc.boundsMax = cooked.GetBoundsMax();
+	desc.segments.assign(cooked.GetSegments(), cooked.GetSegments() + cooked.GetSegmentCount());
+	desc.meshlets.assign(cooked.GetMeshlets(), cooked.GetMeshlets() + cooked.GetMeshletCount());
+
+	for (uint32_t i = 0; i < cooked.GetMaterialCount(); ++i) {
+		CookedMaterialDesc material;
+		material.baseColor = cooked.GetMaterials()[i].baseColor;
+		for (uint32_t slot = 0; slot < CookedTextureSlotCount; ++slot) {
+			const char* texturePath = cooked.GetTexturePath(i, static_cast<CookedTextureSlot>(slot));
+			material.texturePaths[slot] = texturePath ? texturePath : "";
+		}
+		desc.materials.push_back(material);
+	}
+
+	return CheckCookedMesh(path, desc);
+}
+
+int main(int argc, char** argv) {
+	Log::Initialize();
+
+	for (int32_t i = 1; i < argc; ++i) {
+		if (argv[i][0] == '-') {
+			PrintUsage();
+			Log::Cleanup();
+			return 1;
+		}
+	}
+
+	RoundTripStats totalStats;
+
+	bool succeeded = CheckGeneratedMeshes(totalStats);
+	for (int32_t i = 1; i < argc && succeeded; ++i) {
+		succeeded = CheckCookedFile(argv[i], totalStats);
+	}
+
+	if (succeeded) {
+		LogStats("Total", totalStats);
+		Log::Info("All round trips matched");
+	}
+
+	Log::Cleanup();
+
+	return succeeded ? 0 : 1;
+}